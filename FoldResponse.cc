@@ -0,0 +1,247 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file FoldResponse.cc
+/// \brief Folding of a neutron spectrum with the probe response matrix
+//
+// Reads the response matrix written by a Monitor run in response-matrix mode
+// (see ResponseMatrix.hh for the file layout) and one or more group spectra,
+// and prints the expected count rate of each spectrum, without simulation.
+// A spectrum file has one group per line, "emin emax fluence" with the
+// energies in MeV and the group fluence (or fluence rate) in cm-2 (cm-2 s-1);
+// lines starting with # are skipped. Between the grid energies the response
+// is linear in ln(E), beyond them it is that of the nearest energy, and it
+// is averaged over the lethargy of each group. The neutrons are isotropic,
+// unless a direction is given, in which case the nearest direction of the
+// grid is used. Does not depend on Geant4.
+//
+//   FoldResponse matrix.bin spectrum [spectrum ...] [-d cosTheta phi(deg)]
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace
+{
+  const char kMagic[8] = { 'M','O','N','R','M','0','0','1' };
+
+  struct Matrix {
+    int fNbE, fNbCos, fNbPhi;
+    std::string fTally;
+    double fRadius;
+    std::vector<double> fEnergy, fCosTheta, fPhi;
+    // per energy, for the requested direction(s): response and variance
+    std::vector<double> fResponse, fVariance;
+  };
+
+  bool ReadMatrix(const char* fileName, Matrix& m)
+  {
+    std::ifstream in(fileName, std::ios::binary);
+    char magic[8], tally[16];
+    int dims[3];
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(dims), sizeof(dims));
+    in.read(tally, sizeof(tally));
+    if (!in || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+        dims[0] < 1 || dims[1] < 1 || dims[2] < 1) {
+      std::cerr << "FoldResponse: " << fileName
+                << " is not a response-matrix file" << std::endl;
+      return false;
+    }
+    m.fNbE = dims[0];  m.fNbCos = dims[1];  m.fNbPhi = dims[2];
+    tally[sizeof(tally) - 1] = 0;
+    m.fTally = tally;
+    m.fEnergy.resize(m.fNbE);
+    m.fCosTheta.resize(m.fNbCos);
+    m.fPhi.resize(m.fNbPhi);
+    in.read(reinterpret_cast<char*>(&m.fRadius), sizeof(double));
+    in.read(reinterpret_cast<char*>(&m.fEnergy[0]), m.fNbE*sizeof(double));
+    in.read(reinterpret_cast<char*>(&m.fCosTheta[0]),
+            m.fNbCos*sizeof(double));
+    in.read(reinterpret_cast<char*>(&m.fPhi[0]), m.fNbPhi*sizeof(double));
+    int nbPoints = m.fNbE*m.fNbCos*m.fNbPhi;
+    std::vector<double> values(3*nbPoints);
+    in.read(reinterpret_cast<char*>(&values[0]),
+            values.size()*sizeof(double));
+    if (!in) {
+      std::cerr << "FoldResponse: " << fileName << " is truncated"
+                << std::endl;
+      return false;
+    }
+    // keep histories, response, error as the full matrix for now
+    m.fResponse.swap(values);
+    return true;
+  }
+
+  // reduce the full matrix to one response per energy: the average over
+  // all directions (equal solid angles), or the nearest direction
+  void SelectDirection(Matrix& m, bool isotropic, double cosTheta, double phi)
+  {
+    int nbDirections = m.fNbCos*m.fNbPhi, first = 0;
+    if (!isotropic) {
+      int c = int((cosTheta + 1.)*0.5*m.fNbCos);
+      double turns = phi/360. - std::floor(phi/360.);
+      int p = int(turns*m.fNbPhi);
+      c = std::min(std::max(c, 0), m.fNbCos - 1);
+      p = std::min(std::max(p, 0), m.fNbPhi - 1);
+      first = c*m.fNbPhi + p;
+      std::cout << " Direction cos(theta) " << m.fCosTheta[c] << ", phi "
+                << m.fPhi[p] << " deg" << std::endl;
+    }
+    std::vector<double> response(m.fNbE, 0.), variance(m.fNbE, 0.);
+    for (int e=0; e<m.fNbE; e++) {
+      int last  = isotropic ? nbDirections : first + 1;
+      double nb = last - first;
+      for (int d=first; d<last; d++) {
+        const double* v = &m.fResponse[3*(e*nbDirections + d)];
+        response[e] += v[1]/nb;
+        variance[e] += v[2]*v[2]/(nb*nb);
+      }
+    }
+    m.fResponse.swap(response);
+    m.fVariance.swap(variance);
+  }
+
+  // weights of the grid energies in the lethargy average of [emin, emax]
+  void GroupWeights(const Matrix& m, double emin, double emax,
+                    std::vector<double>& weights)
+  {
+    double u0 = std::log(emin), u1 = std::log(emax), width = u1 - u0;
+    int n = m.fNbE;
+    double uFirst = std::log(m.fEnergy[0]), uLast = std::log(m.fEnergy[n-1]);
+    // below and above the grid: the nearest energy
+    if (u0 < uFirst) weights[0]   += (std::min(u1, uFirst) - u0)/width;
+    if (u1 > uLast)  weights[n-1] += (u1 - std::max(u0, uLast))/width;
+    // linear in ln(E) between two grid energies
+    for (int i=0; i+1<n; i++) {
+      double ua = std::log(m.fEnergy[i]), ub = std::log(m.fEnergy[i+1]);
+      double s = std::max(u0, ua), t = std::min(u1, ub);
+      if (t <= s) continue;
+      double length = t - s, mid = 0.5*(s + t);
+      weights[i]   += length*(ub - mid)/((ub - ua)*width);
+      weights[i+1] += length*(mid - ua)/((ub - ua)*width);
+    }
+  }
+
+  bool Fold(const Matrix& m, const char* fileName)
+  {
+    std::ifstream in(fileName);
+    if (!in) {
+      std::cerr << "FoldResponse: cannot open " << fileName << std::endl;
+      return false;
+    }
+    // weight of each grid energy in the folding of the whole spectrum
+    std::vector<double> weights(m.fNbE, 0.);
+    double total = 0., outside = 0.;
+    int nbGroups = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.empty() || line[0] == '#') continue;
+      std::istringstream is(line);
+      double emin, emax, fluence;
+      if (!(is >> emin >> emax >> fluence)) continue;
+      if (emin <= 0. || emax <= emin) {
+        std::cerr << "FoldResponse: " << fileName << ", bad group " << line
+                  << std::endl;
+        return false;
+      }
+      std::vector<double> group(m.fNbE, 0.);
+      GroupWeights(m, emin, emax, group);
+      for (int e=0; e<m.fNbE; e++) weights[e] += fluence*group[e];
+      double u0 = std::log(emin), u1 = std::log(emax);
+      double low  = std::log(m.fEnergy[0]), high = std::log(m.fEnergy.back());
+      double out  = std::max(0., std::min(u1, low) - u0)
+                  + std::max(0., u1 - std::max(u0, high));
+      outside += fluence*out/(u1 - u0);
+      total   += fluence;
+      nbGroups++;
+    }
+    double rate = 0., variance = 0.;
+    for (int e=0; e<m.fNbE; e++) {
+      rate     += weights[e]*m.fResponse[e];
+      variance += weights[e]*weights[e]*m.fVariance[e];
+    }
+    std::cout << " " << fileName << " : " << nbGroups << " groups, fluence "
+              << total << ", " << m.fTally << " " << rate << " +- "
+              << std::sqrt(variance);
+    if (outside > 0.)
+      std::cout << " (" << 100.*outside/total
+                << " % of the fluence off the energy grid)";
+    std::cout << std::endl;
+    return true;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  std::vector<const char*> spectra;
+  bool isotropic = true;
+  double cosTheta = 0., phi = 0.;
+  for (int i=2; i<argc; i++) {
+    if (std::strcmp(argv[i], "-d") == 0 && i+2 < argc) {
+      isotropic = false;
+      cosTheta = std::atof(argv[i+1]);
+      phi      = std::atof(argv[i+2]);
+      i += 2;
+    }
+    else spectra.push_back(argv[i]);
+  }
+  if (argc < 3 || spectra.empty()) {
+    std::cerr << "usage: FoldResponse matrix.bin spectrum [spectrum ...]"
+              << " [-d cosTheta phi(deg)]" << std::endl;
+    return 1;
+  }
+
+  Matrix matrix;
+  if (!ReadMatrix(argv[1], matrix)) return 1;
+  std::cout << " Response matrix " << argv[1] << " : " << matrix.fTally
+            << ", " << matrix.fNbE << " energies " << matrix.fEnergy[0]
+            << " to " << matrix.fEnergy.back() << " MeV, " << matrix.fNbCos
+            << " x " << matrix.fNbPhi << " directions, beam radius "
+            << matrix.fRadius << " cm" << std::endl;
+  SelectDirection(matrix, isotropic, cosTheta, phi);
+
+  std::cout << std::setprecision(5);
+  int status = 0;
+  for (std::size_t s=0; s<spectra.size(); s++)
+    if (!Fold(matrix, spectra[s])) status = 1;
+  return status;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -49,16 +49,27 @@
 #include "G4UIExecutive.hh"
 #include "G4VisExecutive.hh"
 
-#include "QGSP_BERT_HP.hh"
-#include "QGSP_BIC_AllHP.hh"
-
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 int main(int argc,char** argv) {
 
-  //detect interactive mode (if no arguments) and define UI session
+  //usage: Monitor [--physics reference|lean|fast|neutron] [macro]
+  G4String preset = "reference";
+  G4String macro;
+  for (G4int i=1; i<argc; i++) {
+    G4String arg = argv[i];
+    if (arg == "--physics" && i+1 < argc) preset = argv[++i];
+    else macro = arg;
+  }
+  if (!PhysicsList::IsPreset(preset)) {
+    G4cerr << "Monitor: unknown physics preset " << preset
+           << " (valid: " << PhysicsList::PresetNames() << ")" << G4endl;
+    return 1;
+  }
+
+  //detect interactive mode (if no macro) and define UI session
   G4UIExecutive* ui = nullptr;
-  if (argc == 1) ui = new G4UIExecutive(argc,argv);
+  if (macro.empty()) ui = new G4UIExecutive(argc,argv);
 
   //choose the Random engine
   G4Random::setTheEngine(new CLHEP::RanecuEngine);
@@ -77,8 +88,7 @@ int main(int argc,char** argv) {
   DetectorConstruction* det= new DetectorConstruction;
   runManager->SetUserInitialization(det);
 
-  G4VModularPhysicsList* phys = new QGSP_BERT_HP;
-  runManager->SetUserInitialization(phys);
+  runManager->SetUserInitialization(new PhysicsList(preset));
   runManager->SetUserInitialization(new ActionInitialization(det));
 
   //initialize visualization
@@ -99,8 +109,7 @@ int main(int argc,char** argv) {
   else  {
    //batch mode
    G4String command = "/control/execute ";
-   G4String fileName = argv[1];
-   UImanager->ApplyCommand(command+fileName);
+   UImanager->ApplyCommand(command+macro);
   }
 
   //job termination
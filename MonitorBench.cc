@@ -0,0 +1,379 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file MonitorBench.cc
+/// \brief Microbenchmark of the user stepping, stacking and tracking actions
+//
+// A short run on the real geometry records a stream of G4Step snapshots and
+// of new secondary tracks. A second run replays them, in a tight loop, through
+// SteppingAction::UserSteppingAction, StackingAction::ClassifyNewTrack and
+// the TrackingAction hooks, and reports nanoseconds per call for each path.
+//
+//   MonitorBench [nEvents] [nRepeat] [maxSnapshots]
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "G4Types.hh"
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4VUserActionInitialization.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4DynamicParticle.hh"
+#include "G4VProcess.hh"
+#include "Randomize.hh"
+
+#include "DetectorConstruction.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "RunAction.hh"
+#include "EventAction.hh"
+#include "TrackingAction.hh"
+#include "SteppingAction.hh"
+#include "StackingAction.hh"
+
+#include "PhysicsList.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace
+{
+  enum BenchPhase { kRecord, kReplay, kIdle };
+  BenchPhase gPhase = kIdle;
+  std::size_t gMaxSnapshots = 200000;
+  G4int gRepeat = 20;
+
+  // code paths timed separately
+  enum StepPath { kNeutronBoundary, kNeutronInteraction, kGamma, kCharged,
+                  kOther, kNbPath };
+  const char* gPathName[kNbPath] = { "neutron boundary", "neutron interaction",
+                                     "gamma", "charged", "other" };
+
+  struct StepSnapshot {
+    G4ParticleDefinition* fDefinition;
+    G4int                 fTrackID, fParentID;
+    const G4VProcess*     fCreator;
+    const G4VProcess*     fProcess;
+    G4double              fWeight, fTrackLength, fLocalTime;
+    G4ThreeVector         fPrePos, fPostPos, fDirection;
+    G4double              fPreEkin, fPostEkin;
+    G4TouchableHandle     fPreTouch, fPostTouch;
+    G4StepStatus          fPostStatus;
+  };
+
+  std::vector<StepSnapshot> gSteps;
+  std::vector<G4Track*>     gNewTracks;
+
+  G4double Now()
+  {
+    return std::chrono::duration<G4double, std::nano>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  StepPath PathOf(const StepSnapshot& s)
+  {
+    const G4String& name = s.fDefinition->GetParticleName();
+    if (name == "neutron") {
+      return (s.fPostStatus == fGeomBoundary) ? kNeutronBoundary
+                                               : kNeutronInteraction;
+    }
+    if (name == "gamma") return kGamma;
+    if (s.fDefinition->GetPDGCharge() != 0.) return kCharged;
+    return kOther;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class RecordingSteppingAction : public SteppingAction
+{
+  public:
+    RecordingSteppingAction(EventAction* evt, TrackingAction* trk)
+      : SteppingAction(evt, trk) {}
+
+    virtual void UserSteppingAction(const G4Step* step)
+    {
+      if (gPhase == kRecord && gSteps.size() < gMaxSnapshots) {
+        const G4Track* track = step->GetTrack();
+        const G4StepPoint* pre = step->GetPreStepPoint();
+        const G4StepPoint* post = step->GetPostStepPoint();
+        StepSnapshot s;
+        s.fDefinition  = track->GetDefinition();
+        s.fTrackID     = track->GetTrackID();
+        s.fParentID    = track->GetParentID();
+        s.fCreator     = track->GetCreatorProcess();
+        s.fProcess     = post->GetProcessDefinedStep();
+        s.fWeight      = track->GetWeight();
+        s.fTrackLength = track->GetTrackLength();
+        s.fLocalTime   = track->GetLocalTime();
+        s.fPrePos      = pre->GetPosition();
+        s.fPostPos     = post->GetPosition();
+        s.fDirection   = post->GetMomentumDirection();
+        s.fPreEkin     = pre->GetKineticEnergy();
+        s.fPostEkin    = post->GetKineticEnergy();
+        s.fPreTouch    = pre->GetTouchableHandle();
+        s.fPostTouch   = post->GetTouchableHandle();
+        s.fPostStatus  = post->GetStepStatus();
+        gSteps.push_back(s);
+      }
+      SteppingAction::UserSteppingAction(step);
+    }
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class RecordingStackingAction : public StackingAction
+{
+  public:
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track)
+    {
+      if (gPhase == kRecord && gNewTracks.size() < gMaxSnapshots) {
+        gNewTracks.push_back(new G4Track(*track));
+        gNewTracks.back()->SetParentID(track->GetParentID());
+        gNewTracks.back()->SetTrackID(track->GetTrackID());
+        gNewTracks.back()->SetCreatorProcess(track->GetCreatorProcess());
+      }
+      return StackingAction::ClassifyNewTrack(track);
+    }
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class ReplayEventAction : public EventAction
+{
+  public:
+    ReplayEventAction(RunAction* run, SteppingAction* step,
+                      StackingAction* stack, TrackingAction* trk)
+      : EventAction(run), fStepping(step), fStacking(stack), fTracking(trk) {}
+
+    virtual void BeginOfEventAction(const G4Event* evt)
+    {
+      EventAction::BeginOfEventAction(evt);
+      if (gPhase == kReplay) { Replay(); gPhase = kIdle; }
+    }
+
+    void SetSteppingAction(SteppingAction* step) { fStepping = step; }
+    void SetTrackingAction(TrackingAction* trk)  { fTracking = trk; }
+    void SetStackingAction(StackingAction* stk)  { fStacking = stk; }
+
+  private:
+    void Replay();
+
+    SteppingAction* fStepping;
+    StackingAction* fStacking;
+    TrackingAction* fTracking;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ReplayEventAction::Replay()
+{
+  // rebuild real G4Step/G4Track objects from the snapshots, grouped by path
+  std::vector<G4Step*>  steps[kNbPath];
+  std::vector<G4Track*> tracks;
+  for (std::size_t i = 0; i < gSteps.size(); ++i) {
+    const StepSnapshot& s = gSteps[i];
+    G4Track* track = new G4Track(
+      new G4DynamicParticle(s.fDefinition, s.fDirection, s.fPostEkin),
+      s.fLocalTime, s.fPostPos);
+    track->SetTrackID(s.fTrackID);
+    track->SetParentID(s.fParentID);
+    track->SetCreatorProcess(s.fCreator);
+    track->SetWeight(s.fWeight);
+    track->SetLocalTime(s.fLocalTime);
+    track->AddTrackLength(s.fTrackLength);
+    track->SetTouchableHandle(s.fPreTouch);
+
+    G4Step* step = new G4Step();
+    step->SetTrack(track);
+    track->SetStep(step);
+    G4StepPoint* pre = step->GetPreStepPoint();
+    pre->SetPosition(s.fPrePos);
+    pre->SetKineticEnergy(s.fPreEkin);
+    pre->SetTouchableHandle(s.fPreTouch);
+    pre->SetWeight(s.fWeight);
+    G4StepPoint* post = step->GetPostStepPoint();
+    post->SetPosition(s.fPostPos);
+    post->SetKineticEnergy(s.fPostEkin);
+    post->SetTouchableHandle(s.fPostTouch);
+    post->SetProcessDefinedStep(s.fProcess);
+    post->SetStepStatus(s.fPostStatus);
+    post->SetWeight(s.fWeight);
+    post->SetMomentumDirection(s.fDirection);
+
+    steps[PathOf(s)].push_back(step);
+    tracks.push_back(track);
+  }
+
+  G4cout << "\n------------------ MonitorBench results ------------------"
+         << "\n replayed " << gSteps.size() << " steps and "
+         << gNewTracks.size() << " new tracks, best of " << gRepeat
+         << " repetitions" << G4endl;
+  G4cout << std::setw(24) << "code path" << std::setw(12) << "calls"
+         << std::setw(14) << "ns/call" << G4endl;
+
+  // SteppingAction, per path and all together
+  G4double totalTime = 0.;
+  std::size_t totalCalls = 0;
+  for (G4int p = 0; p < kNbPath; ++p) {
+    if (steps[p].empty()) continue;
+    G4double best = 0.;
+    for (G4int r = 0; r < gRepeat; ++r) {
+      G4double t0 = Now();
+      for (std::size_t i = 0; i < steps[p].size(); ++i)
+        fStepping->UserSteppingAction(steps[p][i]);
+      G4double dt = Now() - t0;
+      if (r == 0 || dt < best) best = dt;
+    }
+    totalTime += best;
+    totalCalls += steps[p].size();
+    G4cout << std::setw(24) << G4String("stepping: ") + gPathName[p]
+           << std::setw(12) << steps[p].size()
+           << std::setw(14) << best/steps[p].size() << G4endl;
+  }
+  if (totalCalls > 0) {
+    G4cout << std::setw(24) << "stepping: all" << std::setw(12) << totalCalls
+           << std::setw(14) << totalTime/totalCalls << G4endl;
+  }
+
+  // StackingAction::ClassifyNewTrack
+  if (!gNewTracks.empty()) {
+    G4double best = 0.;
+    for (G4int r = 0; r < gRepeat; ++r) {
+      G4double t0 = Now();
+      for (std::size_t i = 0; i < gNewTracks.size(); ++i)
+        fStacking->ClassifyNewTrack(gNewTracks[i]);
+      G4double dt = Now() - t0;
+      if (r == 0 || dt < best) best = dt;
+    }
+    G4cout << std::setw(24) << "stacking: classify"
+           << std::setw(12) << gNewTracks.size()
+           << std::setw(14) << best/gNewTracks.size() << G4endl;
+  }
+
+  // TrackingAction: pre + per-step update + post for each track
+  if (!tracks.empty()) {
+    G4double best = 0.;
+    for (G4int r = 0; r < gRepeat; ++r) {
+      G4double t0 = Now();
+      for (std::size_t i = 0; i < tracks.size(); ++i) {
+        G4Track* track = tracks[i];
+        fTracking->PreUserTrackingAction(track);
+        fTracking->UpdateTrackInfo(track->GetKineticEnergy(),
+                                   track->GetTrackLength(),
+                                   track->GetLocalTime());
+        fTracking->PostUserTrackingAction(track);
+      }
+      G4double dt = Now() - t0;
+      if (r == 0 || dt < best) best = dt;
+    }
+    G4cout << std::setw(24) << "tracking: pre+upd+post"
+           << std::setw(12) << tracks.size()
+           << std::setw(14) << best/tracks.size() << G4endl;
+  }
+  G4cout << "----------------------------------------------------------"
+         << G4endl;
+
+  for (G4int p = 0; p < kNbPath; ++p) {
+    for (std::size_t i = 0; i < steps[p].size(); ++i) delete steps[p][i];
+  }
+  for (std::size_t i = 0; i < tracks.size(); ++i) delete tracks[i];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class BenchActionInitialization : public G4VUserActionInitialization
+{
+  public:
+    BenchActionInitialization(DetectorConstruction* det) : fDetector(det) {}
+
+    virtual void Build() const
+    {
+      PrimaryGeneratorAction* primary = new PrimaryGeneratorAction();
+      SetUserAction(primary);
+      RunAction* runAction = new RunAction(fDetector, primary);
+      SetUserAction(runAction);
+      ReplayEventAction* eventAction = new ReplayEventAction(runAction, 0, 0, 0);
+      SetUserAction(eventAction);
+      TrackingAction* trackingAction = new TrackingAction();
+      SetUserAction(trackingAction);
+      RecordingSteppingAction* steppingAction
+        = new RecordingSteppingAction(eventAction, trackingAction);
+      SetUserAction(steppingAction);
+      RecordingStackingAction* stackingAction = new RecordingStackingAction();
+      SetUserAction(stackingAction);
+      eventAction->SetSteppingAction(steppingAction);
+      eventAction->SetTrackingAction(trackingAction);
+      eventAction->SetStackingAction(stackingAction);
+    }
+
+  private:
+    DetectorConstruction* fDetector;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc,char** argv) {
+
+  G4int nEvents = (argc > 1) ? std::atoi(argv[1]) : 200;
+  if (argc > 2) gRepeat = std::atoi(argv[2]);
+  if (argc > 3) gMaxSnapshots = std::atol(argv[3]);
+
+  G4Random::setTheEngine(new CLHEP::RanecuEngine);
+
+  // sequential on purpose: the replay must run on the thread that recorded
+  G4RunManager* runManager = new G4RunManager;
+
+  DetectorConstruction* det = new DetectorConstruction;
+  runManager->SetUserInitialization(det);
+  runManager->SetUserInitialization(new PhysicsList);
+  runManager->SetUserInitialization(new BenchActionInitialization(det));
+
+  G4UImanager* UImanager = G4UImanager::GetUIpointer();
+  UImanager->ApplyCommand("/control/verbose 0");
+  UImanager->ApplyCommand("/run/verbose 0");
+  UImanager->ApplyCommand("/control/execute analysis.mac");
+  UImanager->ApplyCommand("/analysis/setFileName bench");
+  runManager->Initialize();
+
+  // record
+  gPhase = kRecord;
+  runManager->BeamOn(nEvents);
+
+  // replay inside an event, with the run and the analysis file open
+  gPhase = kReplay;
+  runManager->BeamOn(1);
+
+  for (std::size_t i = 0; i < gNewTracks.size(); ++i) delete gNewTracks[i];
+  gSteps.clear();
+  delete runManager;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
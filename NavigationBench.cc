@@ -0,0 +1,264 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file NavigationBench.cc
+/// \brief Microbenchmark of BoxNavigation against the standard navigator
+//
+// Builds the geometry, then walks straight rays from boundary to boundary
+// out of the world with two navigators on the same volumes: a standard
+// G4Navigator (smart voxels) and one with BoxNavigation as its external
+// navigation. The rays start at random points, isotropic, either anywhere
+// in the world or near the shield and the probe, where the fallback to
+// G4NormalNavigation is exercised. Each walk is a LocateGlobalPointAndSetup
+// and a ComputeStep per boundary crossing. The crossings of both
+// navigators are compared (same volumes, same step lengths within 1e-9
+// relative) and the nanoseconds per crossing and per safety computation
+// are reported.
+//
+//   NavigationBench [nRays] [nRepeat]
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "G4Types.hh"
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4GeometryManager.hh"
+#include "G4Navigator.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Box.hh"
+#include "G4RandomDirection.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include "DetectorConstruction.hh"
+#include "BoxNavigation.hh"
+
+#include "PhysicsList.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace
+{
+  const G4int kMaxCrossings = 1000;
+
+  struct Ray {
+    G4ThreeVector fPos, fDir;
+  };
+
+  struct Crossing {
+    G4double           fStep;     // -1 closes a ray
+    G4VPhysicalVolume* fVolume;
+  };
+
+  G4double Now()
+  {
+    return std::chrono::duration<G4double, std::nano>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  std::vector<Ray> SampleRays(std::size_t n, const G4ThreeVector& centre,
+                              const G4ThreeVector& half)
+  {
+    std::vector<Ray> rays(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      rays[i].fPos = centre + G4ThreeVector((2*G4UniformRand() - 1)*half.x(),
+                                            (2*G4UniformRand() - 1)*half.y(),
+                                            (2*G4UniformRand() - 1)*half.z());
+      rays[i].fDir = G4RandomDirection();
+    }
+    return rays;
+  }
+
+  // walk every ray out of the world; returns the number of crossings
+  std::size_t Walk(G4Navigator* nav, const std::vector<Ray>& rays,
+                   std::vector<Crossing>* record)
+  {
+    std::size_t crossings = 0;
+    for (std::size_t r = 0; r < rays.size(); ++r) {
+      G4ThreeVector pos = rays[r].fPos;
+      const G4ThreeVector& dir = rays[r].fDir;
+      G4VPhysicalVolume* vol
+        = nav->LocateGlobalPointAndSetup(pos, &dir, false, false);
+      for (G4int i = 0; vol && i < kMaxCrossings; ++i) {
+        G4double safety;
+        G4double step = nav->ComputeStep(pos, dir, kInfinity, safety);
+        if (step >= kInfinity) break;
+        pos += step*dir;
+        nav->SetGeometricallyLimitedStep();
+        vol = nav->LocateGlobalPointAndSetup(pos, &dir, true);
+        ++crossings;
+        if (record) { Crossing c = { step, vol }; record->push_back(c); }
+      }
+      if (record) { Crossing c = { -1., 0 }; record->push_back(c); }
+    }
+    return crossings;
+  }
+
+  // locate the start points and compute the safety there; returns the sum
+  G4double Safety(G4Navigator* nav, const std::vector<Ray>& rays)
+  {
+    G4double sum = 0.;
+    for (std::size_t r = 0; r < rays.size(); ++r) {
+      nav->LocateGlobalPointAndSetup(rays[r].fPos, 0, false, true);
+      sum += nav->ComputeSafety(rays[r].fPos);
+    }
+    return sum;
+  }
+
+  // number of rays whose crossings differ
+  std::size_t Compare(const std::vector<Crossing>& a,
+                      const std::vector<Crossing>& b)
+  {
+    std::size_t bad = 0, i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+      G4bool same = true;
+      while (a[i].fStep >= 0. && b[j].fStep >= 0.) {
+        G4double tol = 1.e-9*std::max(1., std::max(a[i].fStep, b[j].fStep));
+        if (a[i].fVolume != b[j].fVolume
+            || std::fabs(a[i].fStep - b[j].fStep) > tol) same = false;
+        ++i; ++j;
+      }
+      if (a[i].fStep >= 0. || b[j].fStep >= 0.) same = false;
+      while (a[i].fStep >= 0.) ++i;
+      while (b[j].fStep >= 0.) ++j;
+      if (!same) ++bad;
+      ++i; ++j;
+    }
+    return bad;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc,char** argv) {
+
+  std::size_t nRays = (argc > 1) ? std::atol(argv[1]) : 100000;
+  G4int nRepeat = (argc > 2) ? std::atoi(argv[2]) : 5;
+
+  G4Random::setTheEngine(new CLHEP::RanecuEngine);
+
+  G4RunManager* runManager = new G4RunManager;
+  DetectorConstruction* det = new DetectorConstruction;
+  runManager->SetUserInitialization(det);
+  runManager->SetUserInitialization(new PhysicsList);
+
+  G4UImanager* UImanager = G4UImanager::GetUIpointer();
+  UImanager->ApplyCommand("/control/verbose 0");
+  UImanager->ApplyCommand("/run/verbose 0");
+  runManager->Initialize();
+  G4GeometryManager::GetInstance()->CloseGeometry(true);
+
+  G4VPhysicalVolume* world = det->GetWorld();
+  const G4Box* worldBox
+    = static_cast<const G4Box*>(world->GetLogicalVolume()->GetSolid());
+  G4ThreeVector worldHalf(worldBox->GetXHalfLength(),
+                          worldBox->GetYHalfLength(),
+                          worldBox->GetZHalfLength());
+
+  const G4int nbSet = 2;
+  const char* setName[nbSet] = { "world", "shield+probe" };
+  std::vector<Ray> rays[nbSet];
+  rays[0] = SampleRays(nRays, G4ThreeVector(), worldHalf);
+  rays[1] = SampleRays(nRays, det->GetPolyPosition(),
+                       G4ThreeVector(40*cm, 40*cm, 40*cm));
+
+  G4Navigator standard;
+  standard.SetWorldVolume(world);
+  G4Navigator box;
+  box.SetWorldVolume(world);
+  box.SetExternalNavigation(new BoxNavigation());
+
+  G4cout << "\n---------------- NavigationBench results ----------------"
+         << "\n " << nRays << " rays per set, best of " << nRepeat
+         << " repetitions" << G4endl;
+  G4cout << std::setw(14) << "rays" << std::setw(12) << "crossings"
+         << std::setw(12) << "mismatch" << std::setw(14) << "ns/cross std"
+         << std::setw(14) << "ns/cross box" << std::setw(9) << "speedup"
+         << G4endl;
+
+  for (G4int s = 0; s < nbSet; ++s) {
+    std::vector<Crossing> recStd, recBox;
+    std::size_t crossings = Walk(&standard, rays[s], &recStd);
+    Walk(&box, rays[s], &recBox);
+    std::size_t bad = Compare(recStd, recBox);
+
+    G4double best[2] = { 0., 0. };
+    G4Navigator* nav[2] = { &standard, &box };
+    for (G4int r = 0; r < nRepeat; ++r) {
+      for (G4int k = 0; k < 2; ++k) {
+        G4double t0 = Now();
+        Walk(nav[k], rays[s], 0);
+        G4double dt = Now() - t0;
+        if (r == 0 || dt < best[k]) best[k] = dt;
+      }
+    }
+    G4double n = std::max(crossings, std::size_t(1));
+    G4cout << std::setw(14) << setName[s] << std::setw(12) << crossings
+           << std::setw(12) << bad << std::setw(14) << best[0]/n
+           << std::setw(14) << best[1]/n << std::setw(9)
+           << std::setprecision(3) << best[0]/best[1]
+           << std::setprecision(6) << G4endl;
+  }
+
+  // locate and safety at the start points
+  G4cout << "\n" << std::setw(14) << "rays" << std::setw(12) << "<safety>/mm"
+         << std::setw(12) << "box/std" << std::setw(14) << "ns/call std"
+         << std::setw(14) << "ns/call box" << std::setw(9) << "speedup"
+         << G4endl;
+  for (G4int s = 0; s < nbSet; ++s) {
+    G4double best[2] = { 0., 0. }, sum[2] = { 0., 0. };
+    G4Navigator* nav[2] = { &standard, &box };
+    for (G4int r = 0; r < nRepeat; ++r) {
+      for (G4int k = 0; k < 2; ++k) {
+        G4double t0 = Now();
+        sum[k] = Safety(nav[k], rays[s]);
+        G4double dt = Now() - t0;
+        if (r == 0 || dt < best[k]) best[k] = dt;
+      }
+    }
+    G4cout << std::setw(14) << setName[s]
+           << std::setw(12) << sum[0]/nRays/mm
+           << std::setw(12) << std::setprecision(4)
+           << ((sum[0] > 0.) ? sum[1]/sum[0] : 0.)
+           << std::setprecision(6) << std::setw(14) << best[0]/nRays
+           << std::setw(14) << best[1]/nRays << std::setw(9)
+           << std::setprecision(3) << best[0]/best[1]
+           << std::setprecision(6) << G4endl;
+  }
+  G4cout << "----------------------------------------------------------"
+         << G4endl;
+
+  G4GeometryManager::GetInstance()->OpenGeometry();
+  delete runManager;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,53 @@
+#!/bin/bash
+#
+# Efficiency of the neutron variance reduction of Monitor.
+#
+# Runs the presets.mac workload once analog and once with the biasing
+# commands of a macro (default biasing.mac), then compares every tally of
+# the run summary :
+#   FOM ratio = FOM_biased/FOM_analog, FOM = 1/(R^2 T) per tally
+#   z         = (mean - mean_analog)/sqrt(sigma^2 + sigma_analog^2)
+# A FOM ratio above 1 is a gain; a |z| above 3 flags a biased tally.
+#
+# usage: ./biasing.sh [events] [threads] [macro] [preset]
+#   events  default: 200000
+#   threads default: number of cores
+#   macro   default: biasing.mac
+#   preset  default: lean
+#
+# The raw logs are kept in biasing_logs/ .
+
+EXE=${MONITOR_EXE:-./Monitor}
+NEVT=${1:-200000}
+NTHR=${2:-$(nproc)}
+BIAS=${3:-biasing.mac}
+PRESET=${4:-lean}
+LOGDIR=biasing_logs
+. "$(dirname "$0")/tallies.sh"
+mkdir -p $LOGDIR
+
+run() {
+  # $1 analog|biased
+  local mac=$LOGDIR/$1.mac log=$LOGDIR/$1.log
+  {
+    echo "/run/numberOfThreads $NTHR"
+    [ $1 = biased ] && echo "/control/execute $BIAS"
+    echo "/control/execute presets.mac"
+    echo "/run/beamOn $NEVT"
+  } > $mac
+  $EXE --physics $PRESET $mac > $log 2>&1
+}
+
+run analog
+run biased
+
+ana=$LOGDIR/analog.log
+bia=$LOGDIR/biased.log
+for log in $ana $bia; do
+  if ! grep -q "Tally statistics" $log; then echo "run failed, see $log"; exit 1; fi
+done
+
+printf "\n%s versus analog (%s preset, %s events, %s threads)\n" \
+  $BIAS $PRESET $NEVT $NTHR
+header analog biased "FOM ratio"
+for t in $TALLIES; do compare $ana $bia $t fom; done
@@ -0,0 +1,71 @@
+#!/bin/bash
+#
+# Accuracy and speed of the condensed source term of Monitor.
+#
+# 1. records the leakage of the shielded DD source through the B-poly
+#    surface in a run of the presets.mac workload (source_logs/dd.source),
+# 2. runs the workload again from the DD head (other seeds),
+# 3. runs it from the condensed source term, one sampled particle per
+#    history, weighted by the leakage per history,
+# then compares every tally of the run summary and the event rate :
+#   z = (mean - mean_detailed)/sqrt(sigma^2 + sigma_detailed^2)
+# A |z| above 3 flags a tally that the condensed source changes
+# significantly; capPoly is expected to drop, as the captures in the poly
+# before the first leakage are not simulated again.
+#
+# usage: ./condensed.sh [events] [threads] [record events] [preset]
+#   events        default: 200000
+#   threads       default: number of cores
+#   record events default: 5 x events
+#   preset        default: lean
+#
+# The raw logs and the source-term file are kept in source_logs/ .
+
+EXE=${MONITOR_EXE:-./Monitor}
+NEVT=${1:-200000}
+NTHR=${2:-$(nproc)}
+NRECORD=${3:-$((5*NEVT))}
+PRESET=${4:-lean}
+LOGDIR=source_logs
+SOURCE=$LOGDIR/dd.source
+. "$(dirname "$0")/tallies.sh"
+mkdir -p $LOGDIR
+
+run() {
+  # $1 record|detailed|condensed
+  local mac=$LOGDIR/$1.mac log=$LOGDIR/$1.log
+  {
+    echo "/run/numberOfThreads $NTHR"
+    echo "/control/execute presets.mac"
+    case $1 in
+      record)    echo "/testhadr/source/record $SOURCE"
+                 echo "/random/setSeeds 1234 5678"
+                 echo "/run/beamOn $NRECORD" ;;
+      detailed)  echo "/random/setSeeds 8765 4321"
+                 echo "/run/beamOn $NEVT" ;;
+      condensed) echo "/testhadr/source/load $SOURCE"
+                 echo "/testhadr/source/print"
+                 echo "/random/setSeeds 2468 1357"
+                 echo "/run/beamOn $NEVT" ;;
+    esac
+  } > $mac
+  $EXE --physics $PRESET $mac > $log 2>&1
+}
+
+run record
+if [ ! -s $SOURCE ]; then echo "recording failed, see $LOGDIR/record.log"; exit 1; fi
+grep -A3 "Condensed source term written" $LOGDIR/record.log
+run detailed
+run condensed
+
+ref=$LOGDIR/detailed.log
+log=$LOGDIR/condensed.log
+for l in $ref $log; do
+  if ! grep -q "Tally statistics" $l; then echo "run failed, see $l"; exit 1; fi
+done
+
+printf "\ncondensed versus DD-head source (%s preset, %s events, %s threads)\n" \
+  $PRESET $NEVT $NTHR
+header detailed condensed
+for t in $TALLIES; do compare $ref $log $t; done
+compare_rate $ref $log
@@ -0,0 +1,67 @@
+#!/bin/bash
+#
+# Check of the DXTRAN sphere of Monitor.
+#
+# Runs the presets.mac workload once analog and once with a DXTRAN sphere
+# around the He-3 probe (other seeds), then compares every tally of the
+# run summary :
+#   z = (mean - mean_analog)/sqrt(sigma^2 + sigma_analog^2)
+# The probe tally must agree within its errors : the script fails if its
+# |z| is above 3. The FOM ratio of the probe is the gain of the sphere.
+#
+# usage: ./dxtran.sh [events] [threads] [radius] [preset]
+#   events  default: 200000
+#   threads default: number of cores
+#   radius  default: 25 cm
+#   preset  default: lean
+#
+# The raw logs are kept in dxtran_logs/ .
+
+EXE=${MONITOR_EXE:-./Monitor}
+NEVT=${1:-200000}
+NTHR=${2:-$(nproc)}
+RADIUS=${3:-25}
+PRESET=${4:-lean}
+LOGDIR=dxtran_logs
+. "$(dirname "$0")/tallies.sh"
+mkdir -p $LOGDIR
+
+run() {
+  # $1 analog|dxtran
+  local mac=$LOGDIR/$1.mac log=$LOGDIR/$1.log
+  {
+    echo "/run/numberOfThreads $NTHR"
+    echo "/control/execute presets.mac"
+    case $1 in
+      analog) echo "/random/setSeeds 8765 4321" ;;
+      dxtran) echo "/testhadr/bias/dxtranRadius $RADIUS cm"
+              echo "/random/setSeeds 2468 1357" ;;
+    esac
+    echo "/run/beamOn $NEVT"
+  } > $mac
+  $EXE --physics $PRESET $mac > $log 2>&1
+}
+
+run analog
+run dxtran
+
+ana=$LOGDIR/analog.log
+dxt=$LOGDIR/dxtran.log
+for log in $ana $dxt; do
+  if ! grep -q "Tally statistics" $log; then echo "run failed, see $log"; exit 1; fi
+done
+
+printf "\nDXTRAN sphere of %s cm versus analog (%s preset, %s events, %s threads)\n" \
+  $RADIUS $PRESET $NEVT $NTHR
+grep "dxtran" $dxt
+header analog dxtran
+for t in $TALLIES; do compare $ana $dxt $t; done
+header analog dxtran "FOM ratio"
+compare $ana $dxt probe fom
+
+z=$(compare $ana $dxt probe | awk '{print $7}')
+if [ "$z" = "n/a" ] || awk -v z=$z 'BEGIN{exit !(z > 3 || z < -3)}'; then
+  echo "probe tally: DXTRAN and analog disagree (z = $z)"
+  exit 1
+fi
+echo "probe tally: DXTRAN and analog agree (z = $z)"
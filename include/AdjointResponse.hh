@@ -0,0 +1,174 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file AdjointResponse.hh
+/// \brief Definition of the AdjointResponse class
+//
+// Adjoint (reverse) Monte Carlo for the probe response map (ResponseMap).
+// Geant4's reverse Monte Carlo (G4AdjointSimManager) has no adjoint
+// neutron physics, so the adjoint neutron walk is done here, in multigroup
+// form, on the master at the start of a run, with its own navigators on a
+// pool of threads. The group constants are averaged over log-uniform
+// points of each group from the hadronic processes (the HP data of the
+// forward runs): elastic per element, and absorption, which takes in
+// capture, fission and inelastic reactions. Elastic transfers are those of
+// a target at rest, except for the outgoing energies below 4 kT, which are
+// spread over a Maxwellian of the material temperature.
+// Adjoint neutrons start in the He-3 gas, in group g with probability
+// proportional to its capture cross section (the adjoint source of the
+// capDetector response), isotropic. At a collision in group g they go to
+// a group g' from which elastic scattering leads to g, with probability
+// proportional to sum_i N_i sigma_i(g') K_i(g'->g), their weight is
+// multiplied by this sum over Sigma_t(g), and the angle follows from the
+// two energies (isotropic for thermalised transfers). Russian roulette and
+// splitting keep the weights near 1. The track lengths in the cells of the
+// map, folded into its energy bins, estimate the importance of a source
+// neutron per cell and bin, which is the response to an isotropic source
+// of one neutron there:
+//   R(c,b) = V_det sum_g Sigma_c,det(g) / (N V_c) x sum w l(c,b)
+// Set with /testhadr/responseMap/adjoint commands (ResponseMapMessenger).
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef AdjointResponse_h
+#define AdjointResponse_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <cmath>
+#include <vector>
+
+class DetectorConstruction;
+class G4Material;
+class G4Navigator;
+class G4VPhysicalVolume;
+class G4VSolid;
+
+namespace CLHEP { class HepRandomEngine; }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class AdjointResponse
+{
+  public:
+    static AdjointResponse* Instance();
+
+    // adjoint histories at the start of every run (0: off)
+    void  SetNbHistories(G4int n)      {fNbHistories = n;};
+    G4int GetNbHistories() const       {return fNbHistories;};
+    void  SetGroupsPerDecade(G4int n)  {fGroupsPerDecade = n;};
+    void  SetNbThreads(G4int n)        {fNbThreads = n;};
+    // "none": results printed only
+    void  SetOutputFile(const G4String& name) {fOutputFile = name;};
+    void  Print() const;
+
+    // the adjoint walk and the report of the map (master)
+    void  BeginOfRun(DetectorConstruction*);
+
+  private:
+    AdjointResponse();
+   ~AdjointResponse() {};
+
+    // group constants of a material: per element, target mass, kT and
+    // Maxwellian cut; per group, total cross section, and per arrival
+    // group g the cumulated probabilities of the (element, departure
+    // group) pairs: fCumul[(g*nbElements + i)*nbGroups + g']
+    struct Material {
+      std::vector<G4double> fMass;
+      std::vector<G4double> fThermal;
+      std::vector<G4double> fTotal;
+      std::vector<G4double> fScatter;
+      std::vector<G4double> fCumul;
+    };
+
+    // sums per stratum of the map, of a thread
+    struct Scores {
+      std::vector<G4double> fSum, fSum2;
+      G4double fCollisions, fSplit, fKilled;
+    };
+
+    // an adjoint neutron
+    struct Particle {
+      G4ThreeVector fPosition, fDirection;
+      G4double      fEnergy, fWeight;
+      G4int         fGroup;
+    };
+
+    G4double GroupBound(G4int g) const
+      {return std::exp(fLogEmin + g*fLogWidth);};
+    G4int    Group(G4double e) const;
+    // cross sections per atom averaged over group g: elastic, capture,
+    // absorption
+    void     GroupCrossSections(const G4Material*, G4int element, G4int g,
+                                G4double* xs) const;
+    void     BuildTables();
+    void     BuildMaterial(G4int index);
+    // elastic transfer of a target of mass A, kT, to all groups from a
+    // departure group: row of nbGroups values
+    void     Transfer(G4double A, G4double kT, G4int from,
+                      const std::vector<G4double>& maxwell,
+                      G4double* row) const;
+    void     Source(CLHEP::HepRandomEngine&, Particle&) const;
+    void     Collide(CLHEP::HepRandomEngine&, G4int material,
+                     Particle&) const;
+    // track length of a flight in the cells of the map, in group g
+    void     Score(const G4ThreeVector& from, const G4ThreeVector& to,
+                   G4double weight, G4int g, std::vector<G4double>& track,
+                   std::vector<G4int>& touched) const;
+    // a neutron and its split copies, until escape or roulette
+    void     Walk(G4Navigator*, CLHEP::HepRandomEngine&, Particle&,
+                  std::vector<Particle>& stack, std::vector<G4double>& track,
+                  std::vector<G4int>& touched, Scores&) const;
+    void     TransportRange(G4int firstBatch, G4int lastBatch,
+                            Scores* scores) const;
+
+    G4int    fNbHistories;
+    G4int    fGroupsPerDecade;
+    G4int    fNbThreads;
+    G4String fOutputFile;
+
+    // per run: groups, materials, the detector and the map
+    G4int    fNbGroups;
+    G4double fLogEmin, fLogWidth;
+    std::vector<Material>  fMaterials;
+    std::vector<G4double>  fSourceCumul;
+    G4double               fSourceStrength;
+    G4VPhysicalVolume*     fWorld;
+    G4VSolid*              fDetectorSolid;
+    G4ThreeVector          fDetectorCentre, fDetectorMin, fDetectorMax;
+    G4ThreeVector          fLow, fHigh;
+    G4int                  fNbCells[3];
+    G4int                  fNbBins;
+    std::vector<G4double>  fFold;       // bin b, group g: fFold[b*nbGroups + g]
+    G4long                 fJobSeed;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
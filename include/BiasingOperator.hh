@@ -0,0 +1,110 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file BiasingOperator.hh
+/// \brief Definition of the BiasingOperator class
+//
+// Neutron variance reduction through the generic biasing scheme:
+// - implicit capture: in the regions where it is enabled (see
+//   RegionInformation), the wrapped nCapture process is given a zero cross
+//   section, so that neutrons never end in capture and
+//   G4BiasingProcessInterface multiplies their weight by the non-capture
+//   probability exp(-Sigma_c l) along each step. The expected captures and
+//   the weight cutoff are handled by SteppingAction.
+// - exponential transform: in selected logical volumes, the cross section
+//   of every neutron process is scaled by 1 - p*mu, mu the cosine between
+//   the neutron direction and a preferred direction (or the direction to a
+//   point), which stretches the paths along it; the framework applies the
+//   exact weight of the modified interaction law.
+// Requires /testhadr/phys/biasing true, which wraps the neutron processes.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef BiasingOperator_h
+#define BiasingOperator_h 1
+
+#include "G4VBiasingOperator.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <map>
+
+class G4BOptnChangeCrossSection;
+class G4ParticleDefinition;
+class G4VProcess;
+class G4LogicalVolume;
+class RegionInformation;
+class DetectorConstruction;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class BiasingOperator : public G4VBiasingOperator
+{
+  public:
+    BiasingOperator(const DetectorConstruction*);
+   ~BiasingOperator();
+
+    virtual void StartRun();
+
+    // the physics process behind a biasing wrapper (or the process itself)
+    static const G4VProcess* PhysicsProcess(const G4VProcess*);
+
+    // variance-reduction settings of the region of a track, if any
+    static const RegionInformation* GetRegionInformation(const G4Track*);
+
+  private:
+    virtual G4VBiasingOperation*
+    ProposeOccurenceBiasingOperation(const G4Track*,
+                                     const G4BiasingProcessInterface*);
+    virtual G4VBiasingOperation*
+    ProposeFinalStateBiasingOperation(const G4Track*,
+                                      const G4BiasingProcessInterface*)
+    {return 0;};
+    virtual G4VBiasingOperation*
+    ProposeNonPhysicsBiasingOperation(const G4Track*,
+                                      const G4BiasingProcessInterface*)
+    {return 0;};
+
+    G4BOptnChangeCrossSection* GetOperation(const G4BiasingProcessInterface*);
+
+    // exponential transform of a volume, the probe resolved to a point
+    struct Stretch {
+      G4double      fP;
+      G4bool        fToPoint;
+      G4ThreeVector fVector;
+    };
+
+    const DetectorConstruction* fDetector;
+    const G4ParticleDefinition* fNeutron;
+    std::map<const G4BiasingProcessInterface*,G4BOptnChangeCrossSection*>
+                                fOperations;
+    std::map<const G4LogicalVolume*,Stretch> fStretches;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
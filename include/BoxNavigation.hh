@@ -0,0 +1,129 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file BoxNavigation.hh
+/// \brief Definition of the BoxNavigation class
+//
+// Navigation specialised for the nested axis-aligned boxes of the geometry
+// (world, room, slab, tank, poly). It is installed as the external
+// navigation of the tracking navigator of every thread, so it is called for
+// every volume in place of the voxel or smart-voxel navigation of Geant4.
+// A volume takes the fast path when it is a G4Box whose daughters are all
+// unrotated, unreplicated G4Box placements: the safety and the distances to
+// the walls of the mother and of the daughters are computed inline with
+// slab tests, on arrays of centres and half lengths cached per logical
+// volume, without calls through G4VSolid. Any other volume (the chamber,
+// which holds the probe sphere, the sphere and the He-3 tube) is handed to
+// G4NormalNavigation. Location is always left to G4NormalNavigation.
+// The results are those of G4Box, to the rounding of the arithmetic; see
+// NavigationBench.cc for a check against the standard navigator.
+// Switched with /testhadr/det/boxNavigation, at the next run.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef BoxNavigation_h
+#define BoxNavigation_h 1
+
+#include "G4VExternalNavigation.hh"
+#include "G4NormalNavigation.hh"
+#include "globals.hh"
+
+#include <map>
+#include <vector>
+
+class G4LogicalVolume;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class BoxNavigation : public G4VExternalNavigation
+{
+  public:
+    BoxNavigation();
+   ~BoxNavigation();
+
+    virtual G4VExternalNavigation* Clone();
+
+    virtual G4double ComputeStep(const G4ThreeVector& localPoint,
+                                 const G4ThreeVector& localDirection,
+                                 const G4double currentProposedStepLength,
+                                       G4double& newSafety,
+                                       G4NavigationHistory& history,
+                                       G4bool& validExitNormal,
+                                       G4ThreeVector& exitNormal,
+                                       G4bool& exiting,
+                                       G4bool& entering,
+                                       G4VPhysicalVolume* (*pBlockedPhysical),
+                                       G4int& blockedReplicaNo);
+
+    virtual G4bool LevelLocate(G4NavigationHistory& history,
+                               const G4VPhysicalVolume* blockedVol,
+                               const G4int blockedNum,
+                               const G4ThreeVector& globalPoint,
+                               const G4ThreeVector* globalDirection,
+                               const G4bool pLocatedOnEdge,
+                               G4ThreeVector& localPoint);
+
+    virtual G4double ComputeSafety(const G4ThreeVector& localPoint,
+                                   const G4NavigationHistory& history,
+                                   const G4double pMaxLength = DBL_MAX);
+
+    // rebuild the cache of the volumes (the geometry may have changed)
+    void ClearCache();
+
+    // per job switch, read by Install()
+    static void   SetEnabled(G4bool flag) { fEnabled = flag; }
+    static G4bool IsEnabled()             { return fEnabled; }
+
+    // set or remove the box navigation of the tracking navigator of the
+    // calling thread, following the switch; called at each begin of run
+    static void Install();
+
+  private:
+    // a mother volume and its daughters, in structure-of-arrays form
+    struct Volume {
+      G4bool   fBoxes;                 // mother and daughters are boxes
+      G4double fHalf[3];               // half lengths of the mother
+      std::vector<G4double> fX, fY, fZ;      // centres of the daughters
+      std::vector<G4double> fDx, fDy, fDz;   // their half lengths
+      std::vector<G4VPhysicalVolume*> fDaughter;
+    };
+
+    const Volume& GetVolume(const G4LogicalVolume*);
+
+    G4NormalNavigation fNormal;
+    G4double           fDelta;
+
+    std::map<const G4LogicalVolume*, Volume> fVolumes;
+    const G4LogicalVolume* fLastLogical;
+    const Volume*          fLastVolume;
+
+    static G4bool fEnabled;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
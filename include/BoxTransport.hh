@@ -0,0 +1,188 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file BoxTransport.hh
+/// \brief Definition of the BoxTransport class
+//
+// Standalone neutron transport engine for design scans of the shield. The
+// geometry is flattened at the start of a scan into a list of unrotated
+// volumes: boxes, plus the full sphere of the probe moderator and the
+// z-axis tube of the He-3 counter. The total, elastic, capture and
+// inelastic cross sections of every element of every material are read
+// once from the hadronic processes (the same HP data as the full
+// simulation) and tabulated on a logarithmic energy grid.
+// Histories are run by batches in structure-of-arrays form; the kernels
+// (cross-section lookup, distance to collision, distance to the next
+// surface of any volume, location) are plain loops over the particles of
+// a batch, with no branches in the loop bodies. The box and sphere loops
+// of the boundary kernel and the location loops vectorise (see
+// CMakeLists.txt); the cross-section lookup and the distance to collision
+// (a log each, and a gather of the table) and the tube loop do not. The
+// batches are shared among a pool of threads.
+// The physics is simplified: analog neutrons only, elastic scattering
+// isotropic in the centre of mass on a free-gas target (target at rest
+// above 400 kT), inelastic reactions and fission taken as absorption.
+// The scalar neutron tallies are printed next to those of the last
+// Geant4 run, as a cross-check of the simplifications for the problem at
+// hand. Set on the master with /testhadr/boxTransport/ commands
+// (BoxTransportMessenger).
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef BoxTransport_h
+#define BoxTransport_h 1
+
+#include "Run.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class DetectorConstruction;
+class G4VPhysicalVolume;
+class G4LogicalVolume;
+class G4Material;
+
+namespace CLHEP { class HepRandomEngine; }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class BoxTransport
+{
+  public:
+    static BoxTransport* Instance();
+
+    void SetBatchSize(G4int n)       {fBatchSize = n;};
+    void SetPointsPerDecade(G4int n) {fPointsPerDecade = n;};
+    void SetNbThreads(G4int n)       {fNbThreads = n;};
+    // energy of the isotropic source at the DD head
+    void SetEnergy(G4double e)       {fEnergy = e;};
+    // the geometry model and the tables of the last scan
+    void Print() const;
+
+    // nbHistories histories of the source, then the report (master)
+    void BeamOn(DetectorConstruction*, G4int nbHistories);
+
+    // tallies of the last Geant4 run, the reference of the cross-check
+    void SetReference(const Run::Moments* tallies, G4int nbHistories,
+                      G4double wallTime);
+
+  private:
+    BoxTransport();
+   ~BoxTransport() {};
+
+    enum Shape   { kBox, kSphere, kTube };
+    enum Channel { kElastic, kCapture, kInelastic, kNbChannels };
+
+    // a volume in the world frame; sphere: radius fHalf[0]; tube along z:
+    // radius fHalf[0], half length fHalf[2]
+    struct Volume {
+      const G4LogicalVolume* fLogical;
+      G4String fName;
+      G4int    fShape;
+      G4int    fDepth;
+      G4int    fMaterial;
+      G4double fCentre[3];
+      G4double fHalf[3];
+    };
+
+    // cross sections of a material on the energy grid: total, and the
+    // cumulated partial ones of every (element, channel) pair
+    struct Material {
+      const G4Material*     fMaterial;
+      G4int                 fNbPairs;
+      std::vector<G4double> fMass;     // target mass / neutron mass
+      std::vector<G4double> fKT;       // kT of the free-gas target
+      std::vector<G4double> fCumul;    // point i, pair j: fCumul[i*n + j]
+    };
+
+    // the particles of a batch, structure of arrays
+    struct Particles {
+      void Resize(G4int n);
+      // particle i moved to slot j (compaction of a batch)
+      void Move(G4int i, G4int j);
+      std::vector<G4double> fX, fY, fZ, fU, fV, fW, fE;
+      std::vector<G4double> fSigma, fRandom, fCollision, fBoundary;
+      std::vector<G4int>    fCell, fNewCell, fMaterial, fHistory,
+                            fCollisions;
+    };
+
+    // counters of a thread
+    struct Counters {
+      Counters() : fSteps(0.), fCollisions(0.), fLost(0.) {}
+      G4double fSteps, fCollisions, fLost;
+      Run::Moments fTally[Run::kNbTally];
+    };
+
+    G4bool   BuildGeometry(DetectorConstruction*);
+    G4bool   AddVolume(const G4VPhysicalVolume*, const G4double* origin,
+                       G4int depth);
+    G4int    MaterialIndex(const G4Material*);
+    // cross sections on the grid of the materials not tabulated yet
+    void     BuildTables();
+
+    // the kernels, on particles [0, n)
+    void     CrossSectionKernel(Particles&, G4int n) const;
+    void     BoundaryKernel(Particles&, G4int n) const;
+    void     LocateKernel(Particles&, G4int n) const;
+
+    // collision of particle i; true if the neutron is absorbed
+    G4bool   Collide(Particles&, G4int i, CLHEP::HepRandomEngine&,
+                     G4double* scores) const;
+    void     TransportBatch(G4int n, CLHEP::HepRandomEngine&,
+                            Counters&) const;
+    void     TransportRange(G4int firstBatch, G4int lastBatch,
+                            G4int nbHistories, Counters*) const;
+    void     Report(const Counters&, G4int nbHistories,
+                    G4double time, G4int nbThreads) const;
+
+    G4int    fBatchSize;
+    G4int    fPointsPerDecade;
+    G4int    fNbThreads;
+    G4double fEnergy;
+    G4long   fJobSeed;
+
+    // geometry model of the current scan
+    std::vector<Volume> fVolumes;
+    G4double fSource[3];
+    G4int    fRoom, fSlab, fTank, fPoly, fProbe, fDetector;
+
+    // energy grid and material tables
+    std::vector<Material> fMaterials;
+    std::vector<G4double> fTotal;      // material m, point i: m*fNbPoints+i
+    G4int    fNbPoints;
+    G4int    fTablesPerDecade;
+    G4double fLogEmin, fInvDelta;
+
+    // reference: the last Geant4 run
+    G4int    fRefHistories;
+    G4double fRefWallTime;
+    G4double fRefMean[Run::kNbTally], fRefError[Run::kNbTally];
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
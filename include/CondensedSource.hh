@@ -0,0 +1,79 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CondensedSource.hh
+/// \brief Definition of the CondensedSource class
+//
+// The condensed source term of the shielded DD source (SourceTerm), shared
+// by all threads and set on the master with /testhadr/source/ commands
+// (CondensedSourceMessenger). When a record file is set, the next runs
+// record the leakage through the outer surface of the B-poly box and stop
+// the leaking particles there; the master writes it at end of run. When a
+// source term is loaded and in use, PrimaryGeneratorAction samples it
+// instead of the DD head.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef CondensedSource_h
+#define CondensedSource_h 1
+
+#include "globals.hh"
+
+class SourceTerm;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class CondensedSource
+{
+  public:
+    static CondensedSource* Instance();
+
+    // "none" or empty: no recording
+    void            SetRecordFile(const G4String& fileName);
+    const G4String& GetRecordFile() const {return fRecordFile;};
+    G4bool          IsRecording() const   {return !fRecordFile.empty();};
+
+    G4bool          Load(const G4String& fileName);
+    void            SetUse(G4bool use);
+    // the source term to sample, or null
+    const SourceTerm* GetSource() const {return fUse ? fSource : 0;};
+    void            Print() const;
+
+  private:
+    CondensedSource();
+   ~CondensedSource();
+
+    G4String    fRecordFile;
+    G4String    fLoadedFile;
+    SourceTerm* fSource;
+    G4bool      fUse;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
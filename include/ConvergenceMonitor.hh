@@ -0,0 +1,108 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file ConvergenceMonitor.hh
+/// \brief Definition of the ConvergenceMonitor class
+//
+// Shared by all threads. Each worker publishes its cumulative tally sums
+// every fCheckEvery events; the publishing thread then checks whether every
+// target tally has reached the requested relative error, or whether the
+// wall-clock budget is spent, and raises a flag that makes all workers
+// soft-abort their event loop.
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef ConvergenceMonitor_h
+#define ConvergenceMonitor_h 1
+
+#include "globals.hh"
+#include "Run.hh"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class ConvergenceMonitor
+{
+  public:
+    enum StopReason { kNotStopped, kPrecisionReached, kWallClockSpent };
+
+    static ConvergenceMonitor* Instance();
+    static G4double RelativeError(G4int n, G4double sum, G4double sum2);
+
+    void SetTargetError(G4double err)   {fTargetError = err;};
+    void SetWallClockLimit(G4double s)  {fWallClockLimit = s;};
+    void SetCheckEvery(G4int n)         {fCheckEvery = n;};
+    void AddTarget(G4int tally);
+    void ClearTargets()                 {fTargets.clear();};
+
+    G4bool IsActive() const
+      {return (!fTargets.empty() && fTargetError > 0.) || fWallClockLimit > 0.;};
+    G4int  GetCheckEvery() const        {return fCheckEvery;};
+
+    // master: reset at the beginning of each run
+    void BeginOfRun();
+    // worker: publish the cumulative sums of its Run, evaluate convergence
+    void Publish(const Run* run);
+    // cheap check done by every worker after each event
+    G4bool StopRequested() const {return fStop.load(std::memory_order_relaxed);};
+
+    // master: final statement of what ended the run
+    void Report(G4int nEvents) const;
+
+  private:
+    ConvergenceMonitor();
+   ~ConvergenceMonitor() {};
+
+    struct Partial {
+      Partial() : fNbHistories(0) {
+        for (G4int k=0; k<Run::kNbTally; k++) { fSum[k] = fSum2[k] = 0.; }
+      }
+      G4int    fNbHistories;
+      G4double fSum[Run::kNbTally];
+      G4double fSum2[Run::kNbTally];
+    };
+
+    G4double ElapsedSeconds() const;
+
+    G4double          fTargetError;
+    G4double          fWallClockLimit;
+    G4int             fCheckEvery;
+    std::vector<G4int> fTargets;
+
+    std::map<const Run*, Partial> fPartials;
+    std::atomic<G4bool>  fStop;
+    StopReason           fReason;
+    G4double             fReasonError;
+    std::chrono::steady_clock::time_point fStart;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,103 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CorrelatedSampling.hh
+/// \brief Definition of the CorrelatedSampling class
+//
+// Comparison of shield variants with common random numbers. A variant is a
+// named list of UI commands (material or geometry settings); the variants
+// are run one after the other in the same job, with the same number of
+// events, and every event i starts from a random state derived only from
+// a job seed and i, whatever the variant, thread or event order. The
+// per-event tallies of the first variant are kept as the reference; each
+// other variant is paired event by event with it, and the difference of
+// every tally is reported with its uncertainty from the paired
+// differences, next to the uncertainty independent runs would give.
+// Shared by all threads and set on the master with /testhadr/correlated/
+// commands (CorrelatedSamplingMessenger).
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef CorrelatedSampling_h
+#define CorrelatedSampling_h 1
+
+#include "Run.hh"
+#include "globals.hh"
+
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class CorrelatedSampling
+{
+  public:
+    static CorrelatedSampling* Instance();
+
+    void   AddVariant(const G4String& name);
+    G4bool AddCommand(const G4String& command);
+    void   Clear();
+    // job seed of the event streams; 0 draws it from the master engine
+    void   SetSeed(G4long seed) {fSeed = seed;};
+    void   Print() const;
+
+    // runs every variant with nbEvents events, then reports (master)
+    void   BeamOn(G4int nbEvents);
+    G4bool IsRunning() const {return fCurrent >= 0;};
+
+    // random state of an event, the same in every variant
+    void   SeedEvent(G4int eventID) const;
+
+    // per-event tallies of the run of the current variant (master)
+    void   EndOfVariant(std::vector<Run::EventScores>& scores);
+
+  private:
+    CorrelatedSampling();
+   ~CorrelatedSampling() {};
+
+    struct Variant {
+      G4String              fName;
+      std::vector<G4String> fCommands;
+      G4int                 fNbPairs;
+      G4double              fMean[Run::kNbTally];
+      G4double              fDiff[Run::kNbTally];
+      // standard errors of the difference, paired and independent
+      G4double              fDiffError[Run::kNbTally];
+      G4double              fIndepError[Run::kNbTally];
+    };
+    void Report() const;
+
+    std::vector<Variant>          fVariants;
+    std::vector<Run::EventScores> fReference;
+    G4int                         fCurrent;
+    G4long                        fSeed;
+    G4long                        fJobSeed;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
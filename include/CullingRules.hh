@@ -0,0 +1,101 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file CullingRules.hh
+/// \brief Definition of the CullingRules class
+//
+// Track-culling rules, shared by all threads and set on the master with
+// /testhadr/cull/ commands (CullingMessenger), from a macro or a file.
+// A rule matches on particle, region or logical volume, kinetic energy,
+// global time and weight windows; the first matching rule applies its
+// action: kill, Russian roulette to a survival weight, or defer the track
+// to a low-priority stack, tracked after the gammas. Rules are evaluated
+// by StackingAction on new tracks and by SteppingAction after each step.
+//
+// Rule syntax, keywords in any order, all but the name and action optional:
+//   <name> [particle <name>] [region <name>] [volume <name>]
+//          [emin <value> <unit>] [emax <value> <unit>]
+//          [tmin <value> <unit>] [tmax <value> <unit>]
+//          [wmin <value>] [wmax <value>] [at stack|step|both]
+//          action kill|roulette <survival weight>|defer
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef CullingRules_h
+#define CullingRules_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class G4ParticleDefinition;
+class G4LogicalVolume;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class CullingRules
+{
+  public:
+    enum Action { kKill, kRoulette, kDefer };
+
+    struct Rule {
+      Rule();
+      G4String fName;
+      G4String fParticle;     // empty: any
+      G4String fRegion;       // empty: any
+      G4String fVolume;       // empty: any
+      G4double fEmin, fEmax;
+      G4double fTmin, fTmax;
+      G4double fWmin, fWmax;
+      G4bool   fAtStack, fAtStep;
+      Action   fAction;
+      G4double fSurvivalWeight;
+    };
+
+    static CullingRules* Instance();
+
+    G4bool AddRule(const G4String& spec);
+    G4bool LoadFile(const G4String& fileName);
+    void   Clear()         {fRules.clear();};
+    void   List() const;
+    G4bool IsEmpty() const {return fRules.empty();};
+
+    // first rule matching a track in a volume, at stacking or after a step
+    const Rule* Match(const G4ParticleDefinition*, const G4LogicalVolume*,
+                      G4double ekin, G4double time, G4double weight,
+                      G4bool atStack) const;
+
+  private:
+    CullingRules() {};
+   ~CullingRules() {};
+
+    std::vector<Rule> fRules;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
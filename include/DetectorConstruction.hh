@@ -35,11 +35,16 @@
 #define DetectorConstruction_h 1
 
 #include "G4VUserDetectorConstruction.hh"
+#include "G4ThreeVector.hh"
 #include "globals.hh"
 
+#include <map>
+
 class G4LogicalVolume;
 class G4Material;
+class G4Region;
 class DetectorMessenger;
+class TransmissionKernel;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -55,15 +60,19 @@ public:
   ~DetectorConstruction();
   
   virtual G4VPhysicalVolume* Construct();
+  virtual void               ConstructSDandField();
   void SetSize     (G4double, G4double, G4double);              
   void SetMaterial (G4String);
+  // boron mass fraction of the B-Poly shield of the source (default 5%)
+  void     SetPolyBoron(G4double);
+  G4double GetPolyBoron() const {return fPolyBoron;};
     
 
   G4Material* 
   MaterialWithSingleIsotope(G4String, G4String, G4double, G4int, G4int);
          
   const
-  G4VPhysicalVolume* GetWorld()      {return worldP;};           
+  G4VPhysicalVolume* GetWorld() const {return worldP;};           
                           
   G4Material*        GetMaterial()   {return fMaterial;};
   G4double           GetSize()       {return fBoxX;};
@@ -72,6 +81,61 @@ public:
   G4double           GetSrcZ()       {return fDDHead_z;};
   void               PrintParameters();
 
+  // per-region production cuts and G4UserLimits (applied by G4StepLimiter
+  // and G4UserSpecialCuts); regions are Probe, Shield, Tank, Slab, RoomAir
+  static const char* RegionNames();
+  static G4bool      IsRegion(const G4String&);
+  G4bool             SetRegionCut  (const G4String& region,
+                                    const G4String& particle, G4double cut);
+  G4bool             SetRegionLimit(const G4String& region,
+                                    const G4String& limit, G4double value);
+  // neutron variance reduction per region (see BiasingOperator)
+  G4bool             SetRegionImplicitCapture(const G4String& region,
+                                              G4bool enable);
+  G4bool             SetRegionWeightCutoff(const G4String& region,
+                                           G4double wLow, G4double wSurvival);
+  // Woodcock tracking of gammas in the envelope of a region (see
+  // WoodcockModel); models are attached at initialisation
+  G4bool             SetRegionWoodcock(const G4String& region, G4bool enable);
+  void               PrintRegions();
+
+  // exponential transform of a logical volume (see BiasingOperator):
+  // neutron cross sections scaled by 1 - p*mu, mu the cosine to a direction,
+  // to the direction of a point, or to the direction of the He-3 probe
+  struct ExpTransform {
+    enum Target { kDirection, kPoint, kProbe };
+    ExpTransform() : fStretch(0.), fTarget(kProbe) {}
+    G4double      fStretch;
+    Target        fTarget;
+    G4ThreeVector fVector;
+  };
+  G4bool             SetExpTransform(const G4String& volume, G4double p,
+                                     ExpTransform::Target target,
+                                     const G4ThreeVector& vector);
+  const std::map<G4String,ExpTransform>&
+                     GetExpTransforms() const {return fExpTransforms;};
+  G4ThreeVector      GetProbePosition() const;
+  G4ThreeVector      GetPolyPosition() const;
+
+  // DXTRAN sphere centred on the He-3 probe (see DxtranSphere); 0 = off
+  void               SetDxtranRadius(G4double);
+  G4double           GetDxtranRadius() const {return fDxtranRadius;};
+
+  // fast transmission of neutrons through the tank walls (see
+  // TransmissionModel): kernels recorded in detailed runs into a file
+  // ("" = off), or read from a file and sampled when enabled
+  void               SetTankKernelBuild(const G4String& file)
+                                               {fTankKernelBuild = file;};
+  const G4String&    GetTankKernelBuild() const {return fTankKernelBuild;};
+  G4bool             LoadTankKernel(const G4String& file);
+  void               SetTankTransmission(G4bool);
+  const TransmissionKernel*
+                     GetTankKernel() const
+                       {return fTankTransmission ? fTankKernel : 0;};
+  void               SetTankKernelMargin(G4double margin)
+                                               {fTankKernelMargin = margin;};
+  G4double           GetTankKernelMargin() const {return fTankKernelMargin;};
+
   //world
   G4LogicalVolume* worldL;
   G4VPhysicalVolume* worldP;
@@ -124,6 +188,9 @@ private:
   G4double fGap;
   G4Material* fMaterial;
   DetectorMessenger* fDetectorMessenger;
+  G4double fPolyBoron;
+
+  G4Material* BoratedPoly(G4double boron);
 
   G4double detectorDiam;
   G4double detectorLen;
@@ -141,8 +208,32 @@ private:
   G4VPhysicalVolume* nSourceP;
   
     
+  // settings of a region, kept across geometry rebuilds
+  struct RegionSettings {
+    RegionSettings() : fMaxTime(DBL_MAX), fMinEkin(0.), fMaxStep(DBL_MAX),
+                       fImplicitCapture(false), fWeightLow(0.),
+                       fWeightSurvival(0.), fWoodcock(false) {}
+    std::map<G4String,G4double> fCuts;
+    G4double fMaxTime;
+    G4double fMinEkin;
+    G4double fMaxStep;
+    G4bool   fImplicitCapture;
+    G4double fWeightLow;
+    G4double fWeightSurvival;
+    G4bool   fWoodcock;
+  };
+  std::map<G4String,RegionSettings> fRegionSettings;
+  std::map<G4String,ExpTransform>   fExpTransforms;
+  G4double                          fDxtranRadius;
+  G4String                          fTankKernelBuild;
+  TransmissionKernel*               fTankKernel;
+  G4bool                            fTankTransmission;
+  G4double                          fTankKernelMargin;
+
   void               DefineMaterials();
   G4VPhysicalVolume* ConstructVolumes();     
+  void               ConstructRegions();
+  void               ApplyRegionSettings(const G4String& region);
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -40,6 +40,7 @@ class DetectorConstruction;
 class G4UIdirectory;
 class G4UIcommand;
 class G4UIcmdWithAString;
+class G4UIcmdWithADouble;
 class G4UIcmdWithADoubleAndUnit;
 class G4UIcmdWithoutParameter;
 class G4UIcmdWithABool;
@@ -64,6 +65,36 @@ private:
   G4UIcmdWithAString*        fMaterCmd;
   G4UIcmdWithADoubleAndUnit* fSizeCmd;
   G4UIcommand*               fIsotopeCmd;
+  G4UIcmdWithADouble*        fBoronCmd;
+  G4UIcmdWithABool*          fBoxNavigationCmd;
+
+  G4UIdirectory*             fRegionDir;
+  G4UIcommand*               fRegionCutCmd;
+  G4UIcommand*               fMaxTimeCmd;
+  G4UIcommand*               fMinEkinCmd;
+  G4UIcommand*               fMaxStepCmd;
+  G4UIcmdWithoutParameter*   fRegionListCmd;
+  G4UIcommand*               fWoodcockCmd;
+
+  G4UIdirectory*             fBiasDir;
+  G4UIcommand*               fImplicitCaptureCmd;
+  G4UIcommand*               fWeightCutoffCmd;
+  G4UIcommand*               fExpTransformCmd;
+  G4UIcommand*               fExpPointCmd;
+  G4UIcommand*               fExpProbeCmd;
+  G4UIcmdWithADoubleAndUnit* fDxtranCmd;
+
+  G4UIdirectory*             fTankDir;
+  G4UIcmdWithAString*        fKernelBuildCmd;
+  G4UIcmdWithAString*        fKernelLoadCmd;
+  G4UIcmdWithABool*          fTransmissionCmd;
+  G4UIcmdWithADoubleAndUnit* fKernelMarginCmd;
+
+  G4UIcommand* MakeExpTransformCmd(const G4String& name,
+                                   const G4String& guidance);
+
+  G4UIcommand* MakeLimitCmd(const G4String& name, const G4String& guidance,
+                            const G4String& unitCategory);
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
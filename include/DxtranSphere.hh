@@ -0,0 +1,119 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file DxtranSphere.hh
+/// \brief Definition of the DxtranSphere class
+//
+// DXTRAN sphere around the He-3 probe. At each neutron emission or
+// collision outside the sphere, a pseudo-neutron is sent deterministically
+// onto it: its direction is sampled uniformly within the cone subtending
+// the sphere and its weight is
+//   w p(mu)/(2 pi q) exp(-tau),
+// p(mu) the angular distribution in the lab, q the cone sampling density
+// and tau the optical depth along the flight to the sphere, integrated
+// through the geometry with a navigator of its own. p(mu) is the elastic
+// one (isotropic in the centre of mass of the struck nucleus) after an
+// elastic collision, and isotropic in the lab for the neutrons of an
+// isotropic source and those of the other channels (inelastic, fission),
+// whose emitted energy is kept. The real neutron carries on with its
+// weight but is killed if it enters the sphere after such an event, the
+// pseudo-neutron standing for it inside the sphere.
+// One instance per thread, owned by SteppingAction.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef DxtranSphere_h
+#define DxtranSphere_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class DetectorConstruction;
+class G4Navigator;
+class G4Material;
+class G4Step;
+class G4Track;
+class G4VPhysicalVolume;
+class G4VProcess;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class DxtranSphere
+{
+  public:
+    DxtranSphere(const DetectorConstruction*);
+   ~DxtranSphere();
+
+    G4bool IsActive() const;
+    // follows the radius and the geometry of the detector: once per step
+    void   Update();
+
+    // pseudo-neutron for an elastic collision on a nucleus of mass number A
+    // at the end of the step, or 0 (collision inside, null contribution)
+    G4Track* Contribution(const G4Step*, G4double massNumber);
+
+    // pseudo-neutron for a neutron of the track emitted isotropically in
+    // the lab at a point, with energy ekin and weight w, or 0
+    G4Track* Emission(const G4Track*, const G4ThreeVector& position,
+                      G4double ekin, G4double time, G4double weight,
+                      const G4VProcess* creator);
+
+    G4bool Inside(const G4ThreeVector&) const;
+    // whether the segment from a to b enters the sphere
+    G4bool Enters(const G4ThreeVector& a, const G4ThreeVector& b) const;
+
+  private:
+    // direction within the cone subtending the sphere seen from a point,
+    // its solid angle over 2 pi and the flight to the sphere; false inside
+    G4bool   SampleDirection(const G4ThreeVector& position,
+                             G4ThreeVector& direction, G4double& cone,
+                             G4double& distance) const;
+    // pseudo-neutron of weight w*exp(-tau), or 0 if too attenuated
+    G4Track* PseudoNeutron(const G4Track*, const G4ThreeVector& position,
+                           const G4ThreeVector& direction, G4double distance,
+                           G4double ekin, G4double weight, G4double time,
+                           const G4VProcess* creator);
+    G4double OpticalDepth(const G4ThreeVector& start,
+                          const G4ThreeVector& direction,
+                          G4double length, G4double ekin);
+    G4double TotalCrossSection(G4double ekin, const G4Material*) const;
+
+    // lab angular density of elastic scattering isotropic in the CM
+    // (per unit mu), and the CM cosine of a lab cosine
+    static G4double ElasticDensity(G4double muLab, G4double A,
+                                   G4double& muCM);
+
+    const DetectorConstruction* fDetector;
+    const G4VPhysicalVolume*    fWorld;
+    G4Navigator*                fNavigator;
+    G4ThreeVector               fCentre;
+    G4double                    fRadius;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
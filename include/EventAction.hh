@@ -37,6 +37,12 @@
 #include "G4UserEventAction.hh"
 #include "globals.hh"
 #include "RunAction.hh"
+#include "Run.hh"
+#include "Perturbation.hh"
+
+#include <map>
+
+class G4Track;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -49,6 +55,15 @@ class EventAction : public G4UserEventAction
   public:
     virtual void BeginOfEventAction(const G4Event*);
     virtual void EndOfEventAction(const G4Event*);  
+
+    // score into a per-history tally (see Run::TallyId); with the
+    // perturbation tallies, also w D of the scoring track (see Perturbation)
+    void AddTally(G4int id, G4double weight, const G4Track* track = 0)
+      { fTally[id] += weight;
+        if (fPerturbed && track) AddSensitivity(id, weight, track); };
+
+    // fill a H1 and its per-history bin score
+    void ScoreH1(G4int ih, G4double value, G4double weight = 1.);
     
     // boundary crossing counters
     G4int fCount_neutron_exitShield;
@@ -69,6 +84,12 @@ class EventAction : public G4UserEventAction
     G4double neutronEnergy_exitshield; // neutrons exiting shield
     G4double neutronEnergy_enterwall; // neutrons entering lab walls
     G4double neutronEnergy_exitlab; // neutrons exiting lab walls/windows/door
+
+    G4double fTally[Run::kNbTally]; // scores of the current history
+    G4bool   fPerturbed;
+    G4double fSensitivity[Perturbation::kNbParameters][Run::kNbTally];
+    void AddSensitivity(G4int id, G4double weight, const G4Track*);
+    std::map<Run::BinKey,G4double> fBinScores; // H1 bins hit by this history
     
     //vector<G4double> gammaEnergy_exitshield; // gammas exiting shield
     //vector<G4double> gammaEnergy_enterArgon; // gammas entering liquid argon
@@ -0,0 +1,115 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file GammaBank.hh
+/// \brief Definition of the GammaBank class
+//
+// Two-pass simulation: the gammas born in a neutron pass are banked to
+// files, then transported in later runs without the neutrons. Shared by
+// all threads and set on the master with /testhadr/twoPass/ commands
+// (GammaBankMessenger).
+//  - pass one (write): each thread writes the secondary gammas, instead of
+//    stacking them, to its part file <file>.part<thread> (Writer), and the
+//    master writes the index <file> with the number of histories;
+//  - pass two (read): the master loads all parts in memory, sorted by
+//    history; event i of the run replays the gammas of history i of pass
+//    one, optionally split into n copies of 1/n of the weight, so that the
+//    tallies keep their normalization per history of pass one.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef GammaBank_h
+#define GammaBank_h 1
+
+#include "globals.hh"
+
+#include <fstream>
+#include <vector>
+
+class G4Track;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class GammaBank
+{
+  public:
+    struct Record {
+      G4int fEvent;
+      float fPosition[3];
+      float fDirection[3];
+      float fEkin, fTime, fWeight;
+    };
+
+    // the part file of a thread in pass one
+    class Writer {
+      public:
+        Writer(const G4String& fileName);
+       ~Writer();
+        void   Write(G4int event, const G4Track*);
+        void   Close();
+        G4bool IsOpen() const {return fOut.is_open();};
+      private:
+        std::ofstream fOut;
+    };
+
+    static GammaBank* Instance();
+    static G4String   PartName(const G4String& fileName, G4int part);
+
+    // pass one; "none" or empty: off
+    void            SetWriteFile(const G4String& fileName);
+    const G4String& GetWriteFile() const {return fWriteFile;};
+    G4bool          IsWriting() const    {return !fWriteFile.empty();};
+    G4bool          WriteIndex(G4int histories, G4int nbParts) const;
+
+    // pass two; "none": unload
+    G4bool Load(const G4String& fileName);
+    G4bool IsLoaded() const        {return fNbHistories > 0;};
+    G4int  GetNbHistories() const  {return fNbHistories;};
+    void   SetSplit(G4int n)       {fSplit = n;};
+    G4int  GetSplit() const        {return fSplit;};
+    // the gammas of a history of pass one
+    const Record* GetHistory(G4int history, G4int& nbGammas) const;
+    // warning if a run does not replay the histories of pass one
+    void   CheckRun(G4int nbEvents) const;
+    void   Print() const;
+
+  private:
+    GammaBank();
+   ~GammaBank() {};
+
+    G4String            fWriteFile;
+    G4String            fLoadedFile;
+    G4int               fNbHistories;
+    G4int               fSplit;
+    std::vector<Record> fRecords;    // sorted by history
+    std::vector<G4int>  fFirst;      // first record per history, and end
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,83 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file GammaSites.hh
+/// \brief Definition of the GammaSites class
+//
+// Birth sites of the capture and inelastic gammas of a run, the source of
+// the point-kernel dose engine (PointKernel). Sites are condensed on the
+// fly into cubic cells and energy groups (log, 40 per decade): each cell
+// and group keeps its weight and weighted mean position, so that the
+// engine casts one ray per occupied cell instead of one per gamma.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef GammaSites_h
+#define GammaSites_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <map>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class GammaSites
+{
+  public:
+    GammaSites(G4double cellSize);
+   ~GammaSites();
+
+    struct Site {
+      Site() : fWeight(0.) {};
+      G4double      fWeight;
+      G4ThreeVector fMoment;     // weight x position
+    };
+
+    // energy groups; gammas below the first are dropped
+    static G4int    NbGroups();
+    static G4int    Group(G4double ekin);
+    static G4double GroupEnergy(G4int group);
+
+    void   Fill(const G4ThreeVector& position, G4double ekin, G4double weight);
+    void   Add(const GammaSites&);
+
+    G4double GetCellSize() const {return fCellSize;};
+    // sites of a group, by cell
+    const std::map<G4long,Site>& GetSites(G4int group) const
+      {return fSites[group];};
+    G4int    GetNbSites() const;
+
+  private:
+    G4double              fCellSize;
+    std::map<G4long,Site>* fSites;    // per group
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
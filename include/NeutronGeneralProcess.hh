@@ -0,0 +1,144 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file NeutronGeneralProcess.hh
+/// \brief Definition of the NeutronGeneralProcess class
+//
+// Single discrete process standing for the elastic, inelastic, capture and
+// fission processes of the neutron, along the lines of G4NeutronGeneralProcess
+// (Geant4 11). The total macroscopic cross section of every material is
+// tabulated at initialisation, so a step costs one table lookup instead of
+// four cross-section evaluations; the channel is sampled from the same
+// tables only when an interaction occurs, and the interaction itself is
+// delegated to the selected process. Each material gets its own grid in
+// log(E), halved until linear interpolation reproduces the total and the
+// channels within the tolerance, as the union grid (UnionGridCrossSection)
+// and from the unbroadened HP data as well; the fixed grid of 100 points
+// per decade, which does not resolve the resonances, is an explicit
+// option. The tables are built by the master and shared by all threads.
+// The step is reported as limited by the selected process (hadElastic,
+// nCapture ...) and its secondaries carry the channel in TrackInformation,
+// so that the user actions see the individual processes. Implicit capture
+// needs nCapture itself and is rejected (CheckCompatibility).
+// At initialisation the tabulated total is checked against the sum of the
+// processes; a maximum error above the tolerance is reported, and a grid
+// that reaches the maximum number of points is a fatal error.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef NeutronGeneralProcess_h
+#define NeutronGeneralProcess_h 1
+
+#include "G4VDiscreteProcess.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4HadronicProcess;
+class G4Material;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class NeutronGeneralProcess : public G4VDiscreteProcess
+{
+  public:
+    NeutronGeneralProcess(const G4String& name = "nGeneral");
+   ~NeutronGeneralProcess();
+
+    enum Channel { kElastic, kInelastic, kCapture, kFission, kNbChannel };
+
+    // the processes are owned by this one and must not be registered
+    // to the process manager
+    void SetProcess(Channel, G4HadronicProcess*);
+
+    virtual G4bool IsApplicable(const G4ParticleDefinition&);
+    virtual void   PreparePhysicsTable(const G4ParticleDefinition&);
+    virtual void   BuildPhysicsTable(const G4ParticleDefinition&);
+    virtual void   StartTracking(G4Track*);
+
+    virtual G4VParticleChange* PostStepDoIt(const G4Track&, const G4Step&);
+
+    // tabulated macroscopic cross section of a channel (kNbChannel: total)
+    G4double GetCrossSection(G4int channel, const G4Material*,
+                             G4double ekin) const;
+
+    // relative tolerance of the tables: refinement of the grids and check
+    // of the total at initialisation
+    static void SetTolerance(G4double tol) {fTolerance = tol;};
+    // the fixed grid of 100 points per decade instead of the refined ones
+    static void SetCoarseGrid(G4bool flag) {fCoarseGrid = flag;};
+
+    // the merged process of the neutron, if registered
+    static const NeutronGeneralProcess* Registered();
+
+    // fatal exception if a feature that needs the individual neutron
+    // processes is requested with the merged one (implicit capture)
+    static void CheckCompatibility();
+
+  protected:
+    virtual G4double GetMeanFreePath(const G4Track&, G4double,
+                                     G4ForceCondition*);
+
+  private:
+    // the cross sections of a material on its grid
+    struct Table {
+      std::vector<G4double> fLogE;     // grid, log(E)
+      std::vector<G4double> fXS;       // channel c (kNbChannel: total),
+                                       // point i: fXS[c*n + i]
+      std::vector<G4int>    fHash;     // first grid point of each hash bin
+      G4double              fHashInvDelta;
+      G4bool                fTruncated;
+    };
+
+    G4double ComputeCrossSection(G4int channel, const G4Material*,
+                                 G4double ekin) const;
+    // the channels and the total at log(E)
+    void     ComputeChannels(const G4Material*, G4double logE,
+                             std::vector<G4double>& xs) const;
+    void     BuildTable(const G4Material*, Table&) const;
+    void     Refine(const G4Material*, Table&,
+                    std::vector< std::vector<G4double> >& points,
+                    G4double logE0, const std::vector<G4double>& xs0,
+                    G4double logE1, const std::vector<G4double>& xs1,
+                    G4int depth) const;
+    void     CheckAccuracy(const G4Material*) const;
+
+    G4HadronicProcess* fProcess[kNbChannel];
+
+    G4double fEmin, fEmax;
+    G4double fLogEmin, fLogEmax;
+
+    // per material index, built by the master and shared by all threads
+    static std::vector<Table> fTables;
+
+    static G4double fTolerance;
+    static G4bool   fCoarseGrid;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
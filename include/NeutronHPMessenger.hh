@@ -39,6 +39,7 @@
 class NeutronHPphysics;
 class G4UIdirectory;
 class G4UIcmdWithABool;
+class G4UIcmdWithADouble;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -55,6 +56,11 @@ class NeutronHPMessenger: public G4UImessenger
     
     G4UIdirectory*     fPhysDir;      
     G4UIcmdWithABool*  fThermalCmd;
+    G4UIcmdWithABool*  fGeneralCmd;
+    G4UIcmdWithABool*  fUnionGridCmd;
+    G4UIcmdWithADouble* fUnionTolCmd;
+    G4UIcmdWithADouble* fGeneralTolCmd;
+    G4UIcmdWithABool*  fGeneralCoarseCmd;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
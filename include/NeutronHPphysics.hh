@@ -52,9 +52,13 @@ class NeutronHPphysics : public G4VPhysicsConstructor
     
   public:
     void SetThermalPhysics(G4bool flag) {fThermal = flag;};  
+    void SetGeneralProcess(G4bool flag) {fGeneral = flag;};
+    void SetUnionGrid(G4bool flag) {fUnionGrid = flag;};
     
   private:
     G4bool  fThermal;
+    G4bool  fGeneral;
+    G4bool  fUnionGrid;
     NeutronHPMessenger* fNeutronMessenger;  
 };
 
@@ -0,0 +1,105 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Perturbation.hh
+/// \brief Definition of the Perturbation class
+//
+// First-order sensitivities of every tally to the boron and hydrogen mass
+// fractions of the B-Poly shield and to the density of the tank water, by
+// the differential operator method. Along a neutron history the derivative
+// D = d ln P / dp of the probability of its path is accumulated: each
+// flight of length l in a perturbed material adds -dSigma_t/dp l, each
+// collision with element X adds (dN_X/dp)/N_X, the secondaries start with
+// the D of their parent. A score w then contributes w D to dR/dp. A change
+// of a mass fraction scales the other elements of the material to keep
+// the sum at one, a change of the water density scales all of them.
+// Shared by all threads and switched on the master with
+// /testhadr/perturbation/ commands (PerturbationMessenger).
+//
+// The derivatives are those of analog neutron transport: implicit capture,
+// the tank transmission model and the flights of the DXTRAN pseudo-neutrons
+// are not differentiated, nor is gamma transport (gammas only carry the D
+// of the neutrons before them).
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef Perturbation_h
+#define Perturbation_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class DetectorConstruction;
+class G4Material;
+class G4Step;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class Perturbation
+{
+  public:
+    static Perturbation* Instance();
+
+    enum Parameter { kBoron, kHydrogen, kWaterDensity, kNbParameters };
+    static const char* ParameterName(G4int);
+
+    void   SetActive(G4bool active) {fActive = active;};
+    G4bool IsActive() const {return fActive;};
+    void   Print() const;
+
+    // perturbed materials and their coefficients at the start of a run
+    // (master)
+    void     BeginOfRun(const DetectorConstruction*);
+    // nominal value of a parameter (mass fraction, or density in g/cm3),
+    // 0 if it is not perturbed in this run
+    G4double GetValue(G4int p) const {return fValue[p];};
+
+    // adds the derivatives of a neutron step to the D of its history
+    void   AddStep(const G4Step*, G4double* derivative) const;
+
+  private:
+    Perturbation();
+   ~Perturbation() {};
+
+    // a parameter of a material: (dN_X/dp)/N_X for each of its elements
+    struct Target {
+      const G4Material*     fMaterial;
+      G4int                 fParameter;
+      std::vector<G4double> fCoefficient;
+    };
+    void AddTarget(const G4Material*, G4int parameter, G4int Z);
+
+    G4bool              fActive;
+    std::vector<Target> fTargets;
+    G4double            fValue[kNbParameters];
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
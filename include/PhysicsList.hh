@@ -34,17 +34,55 @@
 #include "G4VModularPhysicsList.hh"
 #include "globals.hh"
 
+#include <vector>
+
+class PhysicsListMessenger;
+class G4FastSimulationPhysics;
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+// Physics presets, selected before /run/initialize :
+//   reference : the constructors of QGSP_BERT_HP
+//   lean      : NeutronHP + G4EmStandardPhysics
+//   fast      : NeutronHP + G4EmStandardPhysics_option1 with
+//               G4GammaGeneralProcess, no photonuclear
+//   neutron   : NeutronHP only; capture gammas are tallied at birth
+//               and not transported (see StackingAction)
+// With /testhadr/phys/biasing true, the neutron processes are wrapped for
+// the per-region variance reduction of BiasingOperator.
+// With /testhadr/phys/fastSimulation <particle>, the fast simulation models
+// attached to regions (e.g. WoodcockModel for gammas) act on that particle.
+
 class PhysicsList: public G4VModularPhysicsList
 {
 public:
-  PhysicsList();
+  PhysicsList(const G4String& preset = "reference");
  ~PhysicsList();
 
 public:
   virtual void ConstructParticle();
   virtual void SetCuts();
+
+  static const char* PresetNames() {return "reference lean fast neutron";};
+  static G4bool      IsPreset(const G4String&);
+  G4bool          SetPreset(const G4String&);
+  const G4String& GetPreset() const {return fPreset;};
+
+  // production cut of the default region for a particle, as set by
+  // SetCuts; regions without an explicit cut start from it
+  G4double        GetDefaultCut(const G4String& particle) const;
+
+  void            SetBiasing(G4bool);
+  void            SetFastSimulation(const G4String& particle);
+
+private:
+  void AddPhysics(G4VPhysicsConstructor*);
+
+  G4String fPreset;
+  std::vector<G4VPhysicsConstructor*> fPresetPhysics;
+  G4VPhysicsConstructor* fBiasingPhysics;
+  G4FastSimulationPhysics* fFastSimPhysics;
+  PhysicsListMessenger* fMessenger;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
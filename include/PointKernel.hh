@@ -0,0 +1,129 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PointKernel.hh
+/// \brief Definition of the PointKernel class
+//
+// Deterministic point-kernel engine for the gamma dose outside the tank,
+// shared by all threads and set on the master with /testhadr/pointKernel/
+// commands (PointKernelMessenger). When dose points are defined, the runs
+// record the birth sites of the capture and inelastic gammas (GammaSites)
+// and, at the end of the run, the master casts a ray from every condensed
+// site to every point through the geometry, with its own navigators on a
+// pool of threads. The fluence of a site is
+//   S B(E, mfp) exp(-mfp) / (4 pi r^2),   mfp = sum of mu(E, material) x l
+// with mu the photoelectric (Sandia), Compton and pair attenuation of the
+// standard models, and B a Berger buildup factor, 1 + a mfp exp(b mfp),
+// of the material of largest areal density along the ray, read from a
+// file of (material, energy, a, b) lines. The air kerma follows from the
+// mass energy-absorption coefficient of air.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef PointKernel_h
+#define PointKernel_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <map>
+#include <vector>
+
+class GammaSites;
+class G4Navigator;
+class G4VPhysicalVolume;
+class G4VEmModel;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class PointKernel
+{
+  public:
+    static PointKernel* Instance();
+
+    void   AddPoint(const G4ThreeVector&);
+    // the centres of a regular mesh of cells between two corners
+    void   AddMesh(G4int nx, G4int ny, G4int nz,
+                   const G4ThreeVector& low, const G4ThreeVector& high);
+    void   ClearPoints()          {fPoints.clear();};
+    G4bool IsActive() const       {return !fPoints.empty();};
+    void   List() const;
+
+    void     SetSiteCell(G4double size) {fSiteCell = size;};
+    G4double GetSiteCell() const        {return fSiteCell;};
+    void     SetNbThreads(G4int n)      {fNbThreads = n;};
+    // "none": no buildup, uncollided fluence only
+    void     SetBuildupFile(const G4String& name) {fBuildupFile = name;};
+    // "none": results printed only
+    void     SetOutputFile(const G4String& name)  {fOutputFile = name;};
+
+    // fluence and air kerma per history at all points, from the gamma
+    // sites of a run of n histories
+    void   Compute(const GammaSites&, G4double histories);
+
+  private:
+    // per point: fluence, uncollided fluence, kerma, uncollided kerma
+    enum { kFluence, kUncollided, kKerma, kUncollidedKerma, kNbResults };
+
+    PointKernel();
+   ~PointKernel();
+
+    G4bool ReadBuildup();
+    void   PrepareTables();
+    // ray from a site to a point: path length per material
+    void   Trace(G4Navigator*, const G4ThreeVector& from,
+                 const G4ThreeVector& to, G4double* path) const;
+    // the contributions of sites [begin, end) to all points
+    void   ComputeRange(std::size_t begin, std::size_t end,
+                        G4double* results) const;
+
+    std::vector<G4ThreeVector> fPoints;
+    G4double  fSiteCell;
+    G4int     fNbThreads;
+    G4String  fBuildupFile;
+    G4String  fOutputFile;
+
+    // Berger coefficients per material name: energy, a, b
+    struct Berger { G4double fEnergy, fA, fB; };
+    std::map<G4String, std::vector<Berger> > fBuildup;
+
+    // per run: the sites in structure-of-arrays form, and the tables per
+    // group x material
+    G4VPhysicalVolume*    fWorld;
+    G4int                 fNbMaterials;
+    std::vector<G4double> fX, fY, fZ, fWeight;
+    std::vector<G4int>    fGroup;
+    std::vector<G4double> fMu, fBuildupA, fBuildupB;
+    std::vector<G4double> fDensity, fKermaFactor;
+
+    G4VEmModel* fModels[2];    // owned by G4LossTableManager
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -58,6 +58,7 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 
   private:
     G4ParticleGun*  fParticleGun;        //pointer a to G4 service class
+    G4ParticleGun*  fSourceGun;          //condensed source term
     const DetectorConstruction* fDetector;
   DetectorConstruction* det;
 };
@@ -0,0 +1,105 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ResponseMap.hh
+/// \brief Definition of the ResponseMap class
+//
+// Probe response per unit source as a function of the source position and
+// energy, from a single run. Shared by all threads and set on the master
+// with /testhadr/responseMap/ commands (ResponseMapMessenger). The source
+// box is cut into cells and the energy range into log bins; event i of the
+// run starts an isotropic neutron in stratum i modulo the number of cells
+// x bins (uniform in the cell, log-uniform in the bin), so that all strata
+// get the same number of histories, and its score of the response tally
+// (capDetector by default) is accumulated per stratum in Run.
+// The same map of the capDetector response also comes from an adjoint walk
+// from the He-3 tube (AdjointResponse), with no forward source at all.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef ResponseMap_h
+#define ResponseMap_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class ResponseMap
+{
+  public:
+    static ResponseMap* Instance();
+
+    void   SetBox(const G4ThreeVector& low, const G4ThreeVector& high);
+    void   SetCells(G4int nx, G4int ny, G4int nz);
+    void   SetEnergies(G4int n, G4double emin, G4double emax);
+    G4bool SetTally(const G4String& name);
+    void   SetOutputFile(const G4String& name) {fOutputFile = name;};
+    G4bool SetActive(G4bool);
+    G4bool IsActive() const {return fActive;};
+    void   Print() const;
+
+    G4int  GetTally() const     {return fTally;};
+    const G4ThreeVector& GetLow() const  {return fLow;};
+    const G4ThreeVector& GetHigh() const {return fHigh;};
+    G4int  GetNbCells(G4int i) const {return fNb[i];};
+    G4int  GetNbEnergies() const {return fNbE;};
+    G4double GetEmin() const    {return fEmin;};
+    G4double GetEmax() const    {return fEmax;};
+    const G4String& GetOutputFile() const {return fOutputFile;};
+    G4int  GetNbStrata() const  {return fNb[0]*fNb[1]*fNb[2]*fNbE;};
+    G4int  Stratum(G4int eventID) const {return eventID % GetNbStrata();};
+    // a source point and energy of a stratum
+    void   Sample(G4int stratum, G4ThreeVector& position,
+                  G4double& ekin) const;
+
+    // results of a run (forward) or of the adjoint walk: per stratum,
+    // number of histories and the sums of the scores and of their squares
+    void   Report(const G4String& method, const G4String& outputFile,
+                  const std::vector<G4double>& histories,
+                  const std::vector<G4double>& sum,
+                  const std::vector<G4double>& sum2) const;
+
+  private:
+    ResponseMap();
+   ~ResponseMap() {};
+
+    G4ThreeVector fLow, fHigh;
+    G4int         fNb[3];
+    G4int         fNbE;
+    G4double      fEmin, fEmax;
+    G4int         fTally;
+    G4String      fOutputFile;
+    G4bool        fActive;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,117 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ResponseMatrix.hh
+/// \brief Definition of the ResponseMatrix class
+//
+// Response matrix of the He-3 probe, in place in the geometry, to
+// monoenergetic, mono-directional neutron beams, from a single run. Shared
+// by all threads and set on the master with /testhadr/responseMatrix/
+// commands (ResponseMatrixMessenger). The grid has log-spaced energies and
+// directions at the centres of nCos x nPhi bins of equal solid angle
+// (polar angle to the tube axis, z). Event i of the run belongs to grid
+// point i modulo the number of points, so that the points are interleaved
+// over the events of every thread: a parallel beam of that energy and
+// direction, uniform over a disk as wide as the PE moderator and starting
+// just outside it. The score of the response tally (capDetector by
+// default) is accumulated per point in Run; times the disk area it is the
+// response per unit fluence (cm2).
+//
+// The matrix is written to a binary file read by FoldResponse:
+//   char[8]  "MONRM001"
+//   int      nE, nCos, nPhi
+//   char[16] tally name
+//   double   disk radius (cm), energies[nE] (MeV), cosTheta[nCos],
+//            phi[nPhi] (deg)
+//   double   per point, (e*nCos + c)*nPhi + p : histories, response (cm2),
+//            standard error (cm2)
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef ResponseMatrix_h
+#define ResponseMatrix_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class DetectorConstruction;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class ResponseMatrix
+{
+  public:
+    static ResponseMatrix* Instance();
+
+    void   SetEnergies(G4int n, G4double emin, G4double emax);
+    void   SetDirections(G4int nCos, G4int nPhi);
+    G4bool SetTally(const G4String& name);
+    void   SetOutputFile(const G4String& name) {fOutputFile = name;};
+    G4bool SetActive(G4bool);
+    G4bool IsActive() const {return fActive;};
+    void   Print() const;
+
+    // target of the beams, the PE moderator of the probe, at the start of
+    // a run (master)
+    void   BeginOfRun(const DetectorConstruction*, G4int nbEvents);
+
+    G4int  GetTally() const     {return fTally;};
+    G4int  GetNbPoints() const  {return fNbE*fNbCos*fNbPhi;};
+    G4int  Point(G4int eventID) const {return eventID % GetNbPoints();};
+    // a start point, direction and energy of a grid point
+    void   Sample(G4int point, G4ThreeVector& position,
+                  G4ThreeVector& direction, G4double& ekin) const;
+
+    // results of a run: per grid point, number of histories and the sums
+    // of the scores and of their squares
+    void   Report(const std::vector<G4double>& histories,
+                  const std::vector<G4double>& sum,
+                  const std::vector<G4double>& sum2) const;
+
+  private:
+    ResponseMatrix();
+   ~ResponseMatrix() {};
+
+    G4double Energy(G4int e) const;
+    G4double CosTheta(G4int c) const {return -1. + (2.*c + 1.)/fNbCos;};
+    G4double Phi(G4int p) const;
+
+    G4int         fNbE, fNbCos, fNbPhi;
+    G4double      fEmin, fEmax;
+    G4int         fTally;
+    G4String      fOutputFile;
+    G4bool        fActive;
+    G4ThreeVector fCentre;
+    G4double      fRadius;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -35,11 +35,18 @@
 
 #include "G4Run.hh"
 #include "G4VProcess.hh"
+#include "TankWalls.hh"
+#include "GammaBank.hh"
+#include "Perturbation.hh"
 #include "globals.hh"
 #include <map>
+#include <vector>
 
 class DetectorConstruction;
 class G4ParticleDefinition;
+class TransmissionKernel;
+class SourceTerm;
+class GammaSites;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -49,15 +56,112 @@ class Run : public G4Run
     Run(DetectorConstruction*);
    ~Run();
 
+  public:
+    // scalar tallies, accumulated per history (event)
+    enum TallyId { kNeutronTankExit, kGammaTankExit,
+                   kNeutronSlabExit, kGammaSlabExit,
+                   kNeutronProbe, kCaptureDetector, kCaptureTank,
+                   kCapturePoly, kInelasticDetector, kNbTally };
+    static const char* TallyName(G4int id);
+    static G4int       TallyIndex(const G4String& name);
+
+    // first four moments of a per-history score
+    struct Moments {
+      Moments() : fS1(0.), fS2(0.), fS3(0.), fS4(0.) {}
+      void Add(G4double x)
+        { G4double x2 = x*x; fS1 += x; fS2 += x2; fS3 += x2*x; fS4 += x2*x2; }
+      void Add(const Moments& m)
+        { fS1 += m.fS1; fS2 += m.fS2; fS3 += m.fS3; fS4 += m.fS4; }
+      G4double fS1, fS2, fS3, fS4;
+    };
+    // mean, relative error R and variance of the variance of N histories
+    static void Statistics(const Moments&, G4int n,
+                           G4double& mean, G4double& relErr, G4double& vov);
+
+    // per-history H1 bin scores are keyed by (histo, bin), bin numbered
+    // as in the histogram axis (0 underflow, nbins+1 overflow);
+    // bin kTotalBin holds the integral of the histogram
+    typedef std::pair<G4int,G4int> BinKey;
+    static const G4int kTotalBin = -1;
+
   public:
     void CountProcesses(const G4VProcess* process);                  
     void ParticleCount(G4String, G4double);
     void SumTrackLength (G4int,G4int,G4double,G4double,G4double,G4double);
+
+    // capture gammas tallied at birth instead of transported (neutron preset)
+    void AddGammaBirth(const G4String& region, G4double energy, G4double weight);
+
+    // energy of charged secondaries deposited at birth, per logical volume
+    void AddLocalEdep(const G4String& volume, G4double edep)
+                                               {fLocalEdep[volume] += edep;};
+
+    // tracks created or killed by variance reduction, with their weight
+    void AddVarianceReduction(const G4String& what, G4double weight)
+      { std::pair<G4int,G4double>& vr = fVarianceReduction[what];
+        vr.first++; vr.second += weight; };
+
+    // tracks culled by a rule (see CullingRules), per rule and action
+    void AddCulling(const G4String& rule, const G4String& action,
+                    G4double weight)
+      { std::pair<G4int,G4double>& c = fCulling[rule + " " + action];
+        c.first++; c.second += weight; };
+
+    // a Woodcock flight of a gamma (see WoodcockModel), per region
+    void AddWoodcockFlight(const G4String& region, G4int tentative,
+                           G4int real, G4int violations);
+
+    // tank-wall transmission kernels being recorded (see
+    // TransmissionKernel), 0 if not requested
+    TransmissionKernel* GetTankKernel()      {return fTankKernel;};
+    const TankWalls&    GetTankWalls() const {return fTankWalls;};
+
+    // leakage of the shielded DD source being recorded (see
+    // CondensedSource), 0 if not requested
+    SourceTerm*         GetSourceTerm()      {return fSourceTerm;};
+
+    // birth sites of the gammas for the point-kernel dose engine (see
+    // PointKernel), 0 if no dose point is defined
+    GammaSites*         GetGammaSites()      {return fGammaSites;};
+
+    // part file of the gammas banked by this thread in pass one of a
+    // two-pass simulation (see GammaBank), 0 if not requested
+    GammaBank::Writer*  GetGammaWriter()     {return fGammaWriter;};
+
+    // scores of the tallies of one history, kept per event while variants
+    // are compared with common random numbers (see CorrelatedSampling)
+    struct EventScores {
+      G4int    fEvent;
+      G4double fScore[kNbTally];
+    };
+    void AddEventScores(G4int eventID, const G4double* scores);
+
+    // per-history derivatives of the tallies (see Perturbation)
+    void AddEventSensitivities(
+           const G4double scores[Perturbation::kNbParameters][kNbTally]);
+
+    // score of a history of a stratum of the response map (see
+    // ResponseMap) or of a grid point of the response matrix (see
+    // ResponseMatrix)
+    void AddResponse(G4int stratum, G4double score)
+      { fMapHistories[stratum] += 1.; fMapSum[stratum] += score;
+        fMapSum2[stratum] += score*score; };
     
+    void AddEventTallies(const G4double* scores);
+    void AddEventBins(const std::vector<std::pair<BinKey,G4double> >& bins);
+    G4int    GetNbHistories()      const {return fNbHistories;};
+    G4double GetTallySum(G4int k)  const {return fTally[k].fS1;};
+    G4double GetTallySum2(G4int k) const {return fTally[k].fS2;};
+    void     SetWallTime(G4double t)     {fWallTime = t;};
+
     void SetPrimary(G4ParticleDefinition* particle, G4double energy);    
     void EndOfRun(); 
             
     virtual void Merge(const G4Run*);
+
+    // wall-clock time spent in Merge() on the master, summed over workers
+    G4double GetMergeTime() const  {return fMergeTime;};
+    G4int    GetNbMerged()  const  {return fNbMerged;};
    
   private:
     struct ParticleData {
@@ -78,10 +182,63 @@ class Run : public G4Run
         
     std::map<G4String,G4int>        fProcCounter;            
     std::map<G4String,ParticleData> fParticleDataMap;
+
+    struct GammaBirths {
+      GammaBirths() : fCount(0), fWeight(0.), fEnergy(0.) {}
+      G4int    fCount;
+      G4double fWeight;
+      G4double fEnergy;   // weighted
+    };
+    std::map<G4String,GammaBirths> fGammaBirths;
+    std::map<G4String,G4double>    fLocalEdep;
+    std::map<G4String,std::pair<G4int,G4double> > fVarianceReduction;
+    std::map<G4String,std::pair<G4int,G4double> > fCulling;
+
+    struct WoodcockFlights {
+      WoodcockFlights() : fFlights(0), fTentative(0), fReal(0), fViolations(0) {}
+      G4int fFlights;
+      G4int fTentative;
+      G4int fReal;
+      G4int fViolations;
+    };
+    std::map<G4String,WoodcockFlights> fWoodcock;
         
     G4int    fNbStep1, fNbStep2;
     G4double fTrackLen1, fTrackLen2;
     G4double fTime1, fTime2;    
+
+    // snapshot of the scalar tallies for the fluctuation trend check
+    struct Snapshot {
+      G4int    fNbHistories;
+      G4double fS1[kNbTally];
+      G4double fS2[kNbTally];
+    };
+    void PrintTallyStatistics();
+    void PrintSensitivities();
+    void WriteBinStatistics();
+    std::vector<Snapshot> CombineSnapshots() const;
+
+    G4int    fNbHistories;
+    Moments  fTally[kNbTally];
+    Moments  fSensitivity[Perturbation::kNbParameters][kNbTally];
+    std::map<BinKey,Moments> fBinMoments;
+    G4double fWallTime;
+
+    G4int                 fSnapEvery;
+    std::vector<Snapshot> fSnapshots;
+    std::vector<std::pair<G4int, std::vector<Snapshot> > > fWorkerSnapshots;
+
+    G4double fMergeTime;
+    G4int    fNbMerged;
+
+    TransmissionKernel* fTankKernel;
+    TankWalls           fTankWalls;
+    SourceTerm*         fSourceTerm;
+    GammaSites*         fGammaSites;
+    GammaBank::Writer*  fGammaWriter;
+
+    std::vector<G4double> fMapHistories, fMapSum, fMapSum2;
+    std::vector<EventScores> fEventScores;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -42,6 +42,17 @@ class DetectorConstruction;
 class Run;
 class PrimaryGeneratorAction;
 class HistoManager;
+class RunMessenger;
+class CullingMessenger;
+class CondensedSourceMessenger;
+class PointKernelMessenger;
+class GammaBankMessenger;
+class ResponseMapMessenger;
+class ResponseMatrixMessenger;
+class CorrelatedSamplingMessenger;
+class PerturbationMessenger;
+class BoxTransportMessenger;
+class G4Timer;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -55,12 +66,36 @@ class RunAction : public G4UserRunAction
     virtual G4Run* GenerateRun();  
     virtual void BeginOfRunAction(const G4Run*);
     virtual void   EndOfRunAction(const G4Run*);
+
+    void SetNtupleMerging(G4bool flag) {fNtupleMerging = flag;};
                             
   private:
+    void PrintTiming(const G4Run*);
+
     DetectorConstruction*      fDetector;
     PrimaryGeneratorAction*    fPrimary;
     Run*                       fRun;    
     HistoManager*              fHistoManager;
+    RunMessenger*              fRunMessenger;
+    CullingMessenger*          fCullingMessenger;
+    CondensedSourceMessenger*  fSourceMessenger;
+    PointKernelMessenger*      fKernelMessenger;
+    GammaBankMessenger*        fBankMessenger;
+    ResponseMapMessenger*      fMapMessenger;
+    ResponseMatrixMessenger*   fMatrixMessenger;
+    CorrelatedSamplingMessenger* fCorrelatedMessenger;
+    PerturbationMessenger*       fPerturbationMessenger;
+    BoxTransportMessenger*       fBoxMessenger;
+    G4Timer*                   fTimer;
+    G4bool                     fNtupleMerging;
+    G4double                   fMasterWrite;
+    G4double                   fMasterClose;
+
+    // output timing collected from the workers, reported by the master
+    static G4double            fWorkerWriteMax;
+    static G4double            fWorkerCloseMax;
+    static G4double            fWorkerWriteSum;
+    static G4double            fWorkerCloseSum;
         
 };
 
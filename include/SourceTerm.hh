@@ -0,0 +1,111 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SourceTerm.hh
+/// \brief Definition of the SourceTerm class
+//
+// Condensed source term: the leakage of the shielded DD source through the
+// outer surface of the B-poly box, binned jointly per particle (neutron,
+// gamma) in face, position on the face, cosine to the outward normal and
+// azimuth, energy and time. It is recorded in a detailed run (accumulated
+// per thread in Run, sparse) and written to a binary file; read back, its
+// non-empty bins are sampled in constant time with a Walker alias table
+// and the point is uniform within the bin (in log for energy and time).
+// Each sample stands for a whole source history: its weight is the total
+// leakage per history, so that the tallies keep their normalization.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef SourceTerm_h
+#define SourceTerm_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <map>
+#include <vector>
+
+class G4ParticleDefinition;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class SourceTerm
+{
+  public:
+    SourceTerm();
+   ~SourceTerm();
+
+    enum { kNbParticles = 2 };
+    // index of a recorded particle, or -1
+    static G4int Particle(const G4ParticleDefinition*);
+    static G4ParticleDefinition* Definition(G4int particle);
+
+    // the box and its centre in the world frame (no rotation)
+    void   SetBox(const G4ThreeVector& halfSizes, const G4ThreeVector& centre);
+    // face of the box through which a particle of its frame leaves, or -1
+    // if the point is not on its surface
+    G4int  Face(const G4ThreeVector& position,
+                const G4ThreeVector& direction) const;
+
+    // a particle leaving the box, position and direction in its frame
+    void   Fill(G4int particle, G4int face, const G4ThreeVector& position,
+                const G4ThreeVector& direction, G4double ekin, G4double time,
+                G4double weight);
+    void   Add(const SourceTerm&);
+    void   SetHistories(G4double n) {fHistories = n;};
+
+    G4bool Write(const G4String& fileName) const;
+    G4bool Read (const G4String& fileName);
+    void   Print() const;
+
+    // total leakage weight per source history, the weight of each sample
+    // (set when read)
+    G4double GetLeakage() const {return fLeakage;};
+    // a particle leaving the box, in the world frame
+    void   Sample(G4int& particle, G4ThreeVector& position,
+                  G4ThreeVector& direction, G4double& ekin,
+                  G4double& time) const;
+
+  private:
+    void   BuildAliasTable();
+
+    G4ThreeVector                 fHalfSizes;
+    G4ThreeVector                 fCentre;
+    G4double                      fHistories;
+    G4double                      fLeakage;
+    std::map<G4int,G4double>      fBins[kNbParticles];   // sparse
+
+    // alias table over the non-empty bins of all particles
+    std::vector<G4int>            fKeys;      // particle + kNbParticles*bin
+    std::vector<G4double>         fProbability;
+    std::vector<G4int>            fAlias;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
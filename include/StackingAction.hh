@@ -36,6 +36,10 @@
 #include "G4UserStackingAction.hh"
 #include "globals.hh"
 
+class DetectorConstruction;
+class StackingMessenger;
+class Run;
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 class StackingAction : public G4UserStackingAction
@@ -45,6 +49,29 @@ class StackingAction : public G4UserStackingAction
    ~StackingAction();
      
     virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track*);
+    virtual void PrepareNewEvent();
+
+    // false when gammas have no electromagnetic process (neutron preset)
+    static G4bool PhotonTransport();
+
+    // created by a neutron capture, also through NeutronGeneralProcess
+    static G4bool FromCapture(const G4Track*);
+
+    // charged secondaries deposit their energy where they are born,
+    // optionally except in the He-3 tube
+    void SetLocalDeposit(G4bool flag)    {fLocalDeposit = flag;};
+    void SetTrackInDetector(G4bool flag) {fTrackInDetector = flag;};
+
+  private:
+    // action of the first culling rule matching a new track;
+    // fUrgent to go on with the default classification
+    G4ClassificationOfNewTrack Cull(const G4Track*, Run*);
+
+    G4bool fPhotonTransport;
+    G4bool fLocalDeposit;
+    G4bool fTrackInDetector;
+    const DetectorConstruction* fDetector;
+    StackingMessenger* fStackMessenger;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
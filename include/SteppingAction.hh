@@ -40,6 +40,10 @@
 #include "TrackingAction.hh"
 
 class TrackingAction;
+class RegionInformation;
+class DxtranSphere;
+class Run;
+class TrackInformation;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -52,9 +56,32 @@ class SteppingAction : public G4UserSteppingAction
     virtual void UserSteppingAction(const G4Step*);
     
   private:
+    // implicit capture and weight cutoff of the region of a neutron step
+    void SurvivalBiasing(const G4Step*, const G4LogicalVolume*,
+                         const RegionInformation*);
+    // DXTRAN sphere: pseudo-neutrons of the step, real ones kept out;
+    // true if the neutron was killed
+    G4bool DxtranStep(const G4Step*, const G4VProcess*);
+    // whether a new neutron is emitted isotropically in the lab
+    G4bool IsotropicEmission(const G4Track*) const;
+    // pseudo-neutron of the step, if any, on the stack of the secondaries
+    void   PushPseudoNeutron(G4Track*, const TrackInformation*, Run*);
+    // culling rules applied at the end of the step
+    void   Cull(const G4Step*);
+    // entries into and outcomes of the tank walls, for the transmission
+    // kernels (/testhadr/tank/buildKernel)
+    void   RecordTankWalls(const G4Step*, Run*);
+    // leakage through the B-poly surface, for the condensed source term
+    // (/testhadr/source/record); the leaking particle is stopped
+    void   RecordSourceLeakage(const G4Step*, Run*);
+    // derivatives of the history for the perturbation tallies, passed on
+    // to the secondaries of the step
+    void   PerturbationStep(const G4Step*);
+
     EventAction* fEventAction;
     TrackingAction* fTrackingAction;
     const DetectorConstruction* fDetector;
+    DxtranSphere* fDxtran;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
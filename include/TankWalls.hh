@@ -0,0 +1,131 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TankWalls.hh
+/// \brief Definition of the TankWalls class
+//
+// The water walls of the tank seen as slabs: the walls lie between the tank
+// box and its first daughter box (the chamber), and a wall of zero
+// thickness (the open bottom) is ignored. A face is identified by its axis,
+// its side and its layer (outer face toward the room, inner face toward the
+// chamber); the plain part of a wall is the lateral extent of the chamber,
+// where a wall is a slab. Positions and directions are in the tank frame.
+// Used by TransmissionModel and to record its kernels.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef TankWalls_h
+#define TankWalls_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class G4LogicalVolume;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class TankWalls
+{
+  public:
+    TankWalls();
+   ~TankWalls();
+
+    // walls between the box of the tank and of its first daughter; entries
+    // closer than the margin to the edge of the plain part are not slab-like
+    G4bool Set(const G4LogicalVolume* tank, G4double margin);
+
+    // wall kinds: side (x, y faces) or top (z faces), entered from the room
+    // or from the chamber
+    enum { kNbKinds = 2, kNbWalls = 4 };
+    G4double Thickness(G4int kind) const {return fThickness[kind];};
+
+    // an entry into the water through the plain part of a wall: its face,
+    // its wall (kind + 2 if from the chamber) and the cosine to the normal
+    // into the wall
+    struct Crossing {
+      G4int    fFace;
+      G4int    fWall;
+      G4double fMu;
+    };
+    G4bool Entry(const G4ThreeVector& position, const G4ThreeVector& direction,
+                 Crossing&) const;
+
+    // whether every exit within a lateral displacement rho of an entry by
+    // a face lies on the plain part of the wall
+    G4bool Plain(G4int face, const G4ThreeVector& entry, G4double rho) const
+      {return Lateral(face, entry, rho);};
+
+    // exit of the water after an entry by a face: 1 by the same face
+    // (reflected), 2 by the opposite face (transmitted), 0 elsewhere; with
+    // the lateral displacement and the cosine to the outward normal
+    G4int  Exit(G4int face, const G4ThreeVector& entry,
+                const G4ThreeVector& position, const G4ThreeVector& direction,
+                G4double& rho, G4double& mu) const;
+
+    // inverse of Exit: the exit point, just inside the water, and direction
+    // for a lateral displacement rho and a cosine mu, azimuths sampled;
+    // false if the point is off the plain part of the wall
+    G4bool ExitState(G4int face, const G4ThreeVector& entry, G4int exit,
+                     G4double rho, G4double mu,
+                     G4ThreeVector& position, G4ThreeVector& direction) const;
+
+    // a point of the water after an entry by a face: its depth from the
+    // face into the wall and its lateral displacement
+    void   Inside(G4int face, const G4ThreeVector& entry,
+                  const G4ThreeVector& position,
+                  G4double& depth, G4double& rho) const;
+
+    // inverse of Inside, the azimuth sampled; false if the point is off
+    // the plain part of the wall
+    G4bool InsideState(G4int face, const G4ThreeVector& entry,
+                       G4double depth, G4double rho,
+                       G4ThreeVector& position) const;
+
+  private:
+    static G4int Axis (G4int face) {return face%3;};
+    static G4int Sign (G4int face) {return (face/3)%2 ? 1 : -1;};
+    static G4int Layer(G4int face) {return face/6;};
+    static G4int Opposite(G4int face) {return (face + 6)%12;};
+
+    G4double Plane(G4int face) const;
+    // normal pointing into the water
+    G4ThreeVector Normal(G4int face) const;
+    G4bool   Lateral(G4int face, const G4ThreeVector&, G4double margin) const;
+
+    G4bool   fValid;
+    G4double fOuter[3];
+    G4double fInner[3];
+    G4double fCentre[3];
+    G4double fMargin;
+    G4double fThickness[kNbKinds];
+    G4bool   fSlab[12];
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
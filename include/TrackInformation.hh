@@ -0,0 +1,87 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file TrackInformation.hh
+/// \brief Definition of the TrackInformation class
+//
+// Per-track flags of the variance-reduction schemes.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef TrackInformation_h
+#define TrackInformation_h 1
+
+#include "G4VUserTrackInformation.hh"
+#include "G4ThreeVector.hh"
+#include "Perturbation.hh"
+#include "globals.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class TrackInformation : public G4VUserTrackInformation
+{
+  public:
+    TrackInformation();
+   ~TrackInformation();
+
+    virtual void Print() const;
+
+  public:
+    // DXTRAN pseudo-neutron, until it leaves the DXTRAN sphere
+    G4bool fDxtran;
+
+    // the last emission or collision of this neutron sent its
+    // pseudo-neutron onto the DXTRAN sphere: killed if it enters it
+    G4bool fDxtranCovered;
+
+    // already deferred once by a culling rule
+    G4bool fDeferred;
+
+    // channel of NeutronGeneralProcess that created this track, -1 if
+    // created by another process (the creator process is nGeneral then)
+    G4int fGeneralChannel;
+
+    // entry into a tank wall while recording transmission kernels: face
+    // (-1 if none) and kernel bin, point in the tank frame, time and weight
+    G4int         fTankFace;
+    G4int         fTankInput;
+    G4ThreeVector fTankEntry;
+    G4double      fTankTime;
+    G4double      fTankWeight;
+
+    // capture gamma of a tank wall absorption of TransmissionModel (the
+    // creator process is the fast simulation process then)
+    G4bool        fTankCapture;
+
+    // derivative of the log of the probability of the history up to this
+    // track, per perturbed parameter (see Perturbation)
+    G4double      fDerivative[Perturbation::kNbParameters];
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
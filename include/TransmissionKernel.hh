@@ -0,0 +1,124 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TransmissionKernel.hh
+/// \brief Definition of the TransmissionKernel class
+//
+// Transmission kernels of the tank walls for neutrons (see TankWalls and
+// TransmissionModel). For each wall and each bin of entry energy and
+// entry cosine, the kernel holds the weight of the outcomes of the
+// recorded entries: absorption, reflection or transmission, and for the
+// two exits the joint distribution of exit energy and cosine, and, given
+// the exit energy bin, the distributions of lateral displacement and of
+// time delay. Absorptions keep the weight of those that are captures, and
+// for these the distributions of depth into the wall, lateral displacement
+// and time delay of the capture, where its gamma is emitted. The total
+// weight of the outcomes over the weight of the entries is the weight
+// factor applied at sampling.
+// Kernels are accumulated per thread in Run during a detailed run and
+// written to a binary file: a header with the binning and the wall
+// thicknesses, then per entry bin its entry weight and, if not null, its
+// block of floats (native byte order).
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef TransmissionKernel_h
+#define TransmissionKernel_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class TransmissionKernel
+{
+  public:
+    TransmissionKernel();
+   ~TransmissionKernel();
+
+    enum Outcome { kAbsorbed, kReflected, kTransmitted, kNbOutcomes };
+
+    struct Exit {
+      Outcome  fOutcome;
+      G4double fEkin;
+      G4double fMu;
+      G4double fRho;
+      G4double fDelay;
+      G4double fWeight;    // factor on the entry weight
+      G4bool   fCapture;   // absorbed by a capture, at depth fDepth
+      G4double fDepth;
+    };
+
+    // entry bin of a wall, or -1 if the kernel has no data there
+    G4int  Input(G4int wall, G4double ekin, G4double mu) const;
+
+    void   Fill(G4int input, G4double entryWeight, Outcome,
+                G4double ekin, G4double mu, G4double rho, G4double delay,
+                G4double weight);
+    // an absorption, with the depth, displacement and delay of a capture
+    void   FillAbsorbed(G4int input, G4double entryWeight, G4bool capture,
+                        G4double depth, G4double rho, G4double delay,
+                        G4double weight);
+    // an entry whose exit is not slab-like (edges, other faces)
+    void   Exclude(G4double entryWeight) {fExcluded += entryWeight;};
+    void   Add(const TransmissionKernel&);
+    void   Clear();
+
+    // the outcome of an entry; false if no entry was recorded in its bin
+    G4bool Sample(G4int input, Exit&) const;
+    // largest lateral displacement Sample can give for an entry bin
+    G4double MaxDisplacement(G4int input) const {return fMaxRho[input];};
+
+    G4bool Write(const G4String& fileName) const;
+    G4bool Read (const G4String& fileName);
+
+    void     SetThickness(G4int kind, G4double t) {fThickness[kind] = t;};
+    G4double GetThickness(G4int kind) const      {return fThickness[kind];};
+    G4double GetEntries()  const;
+    G4double GetExcluded() const {return fExcluded;};
+
+  private:
+    G4int    Block(G4int input) const {return input*fBlockSize;};
+    G4int    ExitOffset(Outcome) const;
+    G4int    CaptureOffset() const;
+    G4double Thickness(G4int input) const;
+    void     Prepare();
+
+    std::vector<G4double> fEntryWeight;   // per entry bin
+    std::vector<G4double> fData;          // per entry bin, a block
+    std::vector<G4double> fCumulative;    // fData summed per distribution
+    std::vector<G4double> fMaxRho;        // per entry bin, upper rho edge
+    G4int                 fBlockSize;
+    G4double              fThickness[2];
+    G4double              fExcluded;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
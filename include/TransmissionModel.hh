@@ -0,0 +1,88 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TransmissionModel.hh
+/// \brief Definition of the TransmissionModel class
+//
+// Fast simulation of neutrons through the water walls of the tank. A
+// neutron entering the plain part of a wall (see TankWalls) is not
+// transported: its absorption, or its exit point, direction, energy, time
+// and weight on the same face (reflection) or on the opposite face
+// (transmission), is sampled from the kernels recorded in detailed runs
+// (see TransmissionKernel). The exit is left just inside the water so that
+// transportation makes the crossing. An absorption by a capture is scored
+// as a capture in the tank and emits the capture gamma of hydrogen, at a
+// depth, displacement and delay sampled from the captures recorded in its
+// bin. Entries of a bin without data, or closer to the edge of the plain
+// part than the largest displacement recorded in their bin, are
+// transported normally, so that every sampled outcome is used.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef TransmissionModel_h
+#define TransmissionModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "TankWalls.hh"
+#include "TransmissionKernel.hh"
+#include "globals.hh"
+
+class DetectorConstruction;
+class G4Region;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class TransmissionModel : public G4VFastSimulationModel
+{
+  public:
+    TransmissionModel(const G4String& name, G4Region* envelope,
+                      const DetectorConstruction*);
+   ~TransmissionModel();
+
+    virtual G4bool IsApplicable(const G4ParticleDefinition&);
+    virtual G4bool ModelTrigger(const G4FastTrack&);
+    virtual void   DoIt(const G4FastTrack&, G4FastStep&);
+
+  private:
+    // walls and kernel checked at the start of each run
+    void Initialize(const G4FastTrack&);
+
+    const DetectorConstruction* fDetector;
+    const TransmissionKernel*   fKernel;
+    TankWalls                   fWalls;
+    G4int                       fRunID;
+
+    // outcome sampled by ModelTrigger, applied by DoIt
+    TransmissionKernel::Exit    fExit;
+    G4ThreeVector               fPosition;
+    G4ThreeVector               fDirection;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
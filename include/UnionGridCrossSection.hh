@@ -0,0 +1,119 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file UnionGridCrossSection.hh
+/// \brief Definition of the UnionGridCrossSection class
+//
+// Cross-section data set that tabulates, at initialisation, the cross
+// sections of a channel for every element of every material on one energy
+// grid per material. The grid is the union of the points needed by all the
+// elements of the material: starting from a coarse logarithmic grid, each
+// interval is halved until linear interpolation in log(E) reproduces the
+// wrapped (stock) data sets within a relative tolerance. The data are
+// tabulated without the Doppler broadening that the HP data sets sample at
+// each call (as with G4NEUTRONHP_NEGLECT_DOPPLER); a grid that reaches the
+// maximum number of points is a fatal error.
+// Lookups go through a hash table on log(E), so that locating the energy is
+// done once per material and step instead of a binary search per isotope.
+// Outside of the tabulated range, the wrapped data sets are used directly.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef UnionGridCrossSection_h
+#define UnionGridCrossSection_h 1
+
+#include "G4VCrossSectionDataSet.hh"
+#include "globals.hh"
+
+#include <map>
+#include <vector>
+
+class G4CrossSectionDataStore;
+class G4Material;
+class G4Element;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class UnionGridCrossSection : public G4VCrossSectionDataSet
+{
+  public:
+    UnionGridCrossSection(const G4String& name);
+   ~UnionGridCrossSection();
+
+    // data sets to be tabulated, by increasing priority as for
+    // G4HadronicProcess::AddDataSet; they are owned by this data set
+    void AddDataSet(G4VCrossSectionDataSet*);
+
+    virtual G4bool IsElementApplicable(const G4DynamicParticle*, G4int Z,
+                                       const G4Material* mat = 0);
+    virtual G4double GetElementCrossSection(const G4DynamicParticle*, G4int Z,
+                                            const G4Material* mat = 0);
+    virtual void BuildPhysicsTable(const G4ParticleDefinition&);
+    virtual void CrossSectionDescription(std::ostream&) const;
+
+    static void SetTolerance(G4double tol) {fTolerance = tol;};
+
+  private:
+    struct MaterialTable {
+      std::vector<G4double> fLogE;     // union grid, log(E/MeV)
+      std::vector<G4double> fXS;       // element k, point i: fXS[k*n+i]
+      std::vector<G4int>    fZ;        // Z of the elements of the material
+      std::vector<G4int>    fHash;     // first grid point of each hash bin
+      G4double              fHashInvDelta;
+      G4bool                fTruncated;
+    };
+    typedef std::vector<MaterialTable> Tables;
+
+    void     BuildMaterial(const G4Material*, MaterialTable&);
+    void     Refine(const G4Material*, MaterialTable&,
+                    std::vector< std::vector<G4double> >& points,
+                    G4double logE0, const std::vector<G4double>& xs0,
+                    G4double logE1, const std::vector<G4double>& xs1,
+                    G4int depth);
+    void     ComputeElements(const G4Material*, G4double logE,
+                             std::vector<G4double>& xs);
+    void     CheckAccuracy(const G4Material*, const MaterialTable&);
+    G4double Interpolate(const MaterialTable&, G4int k, G4double logE);
+
+    G4CrossSectionDataStore* fStore;   // the wrapped data sets
+    Tables*                  fTables;  // shared by all threads
+
+    G4double fLogEmin, fLogEmax;
+
+    // last lookup, reused by the other elements of the same material
+    const MaterialTable* fLastTable;
+    G4double             fLastLogE;
+    G4int                fLastBin;
+
+    static G4double fTolerance;
+    // tables are built once, by the master, and shared by name
+    static std::map<G4String, Tables*> fSharedTables;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,99 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file WoodcockModel.hh
+/// \brief Definition of the WoodcockModel class
+//
+// Woodcock (delta) tracking of gammas through the envelope of a region (its
+// root volumes and all their daughters), as a fast simulation model. Flights
+// are sampled with a majorant of the gamma macroscopic cross section over
+// every material of the envelope, so that no step stops at an internal
+// boundary: at each tentative collision the material is located and the
+// collision is real with probability sigma/sigma_maj, in which case the
+// interacting process is chosen by its partial cross section and its own
+// PostStepDoIt is applied. The gamma is
+// handed back to normal tracking just inside the envelope boundary, when it
+// is absorbed or when it falls below the majorant table.
+// The majorant is tabulated at the start of each run, over a log grid and
+// with a safety margin; a tentative collision where sigma exceeds it is
+// counted and reported, as the sampling would then be biased. Flights and
+// collisions are summed per region in Run.
+// Production cuts of secondaries and G4UserLimits do not apply within a
+// Woodcock flight.
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef WoodcockModel_h
+#define WoodcockModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "G4TouchableHandle.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4MaterialCutsCouple;
+class G4Navigator;
+class G4Region;
+class G4VProcess;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class WoodcockModel : public G4VFastSimulationModel
+{
+  public:
+    WoodcockModel(const G4String& name, G4Region* envelope);
+   ~WoodcockModel();
+
+    virtual G4bool IsApplicable(const G4ParticleDefinition&);
+    virtual G4bool ModelTrigger(const G4FastTrack&);
+    virtual void   DoIt(const G4FastTrack&, G4FastStep&);
+
+  private:
+    // gamma processes and majorant table, rebuilt at the start of each run
+    void     Initialize();
+    G4double Majorant(G4double ekin) const;
+    // macroscopic cross section, and the partial ones per process if asked
+    G4double CrossSection(G4double ekin, const G4MaterialCutsCouple*,
+                          std::vector<G4double>* partial) const;
+    const G4MaterialCutsCouple* Locate(const G4ThreeVector& position,
+                                       const G4ThreeVector& direction,
+                                       G4bool relative);
+
+    G4Region*                    fRegion;
+    G4Navigator*                 fNavigator;
+    G4TouchableHandle            fTouchable;
+    G4int                        fRunID;
+    std::vector<G4VProcess*>     fProcesses;
+    std::vector<G4double>        fMajorant;       // per bin of the log grid
+    G4int                        fViolations;     // in this run
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,59 @@
+#!/bin/bash
+#
+# End-to-end check and timing of the box navigation of Monitor.
+#
+# Runs the presets.mac workload once with the standard Geant4 navigation and
+# once with /testhadr/det/boxNavigation true, then compares every tally of
+# the run summary and the event rate :
+#   z = (mean - mean_standard)/sqrt(sigma^2 + sigma_standard^2)
+# The navigation does not change the physics, so a |z| above 3 flags a
+# difference in the step lengths or the volumes found.
+# NavigationBench, when built, adds the timing of the navigation alone.
+#
+# usage: ./navigation.sh [events] [threads] [preset]
+#   events  default: 200000
+#   threads default: number of cores
+#   preset  default: reference
+#
+# The raw logs are kept in navigation_logs/ .
+
+EXE=${MONITOR_EXE:-./Monitor}
+BENCH=${BENCH_EXE:-./NavigationBench}
+NEVT=${1:-200000}
+NTHR=${2:-$(nproc)}
+PRESET=${3:-reference}
+LOGDIR=navigation_logs
+. "$(dirname "$0")/tallies.sh"
+mkdir -p $LOGDIR
+
+run() {
+  # $1 standard|box
+  local mac=$LOGDIR/$1.mac log=$LOGDIR/$1.log
+  {
+    echo "/run/numberOfThreads $NTHR"
+    [ $1 = box ] && echo "/testhadr/det/boxNavigation true"
+    echo "/control/execute presets.mac"
+    echo "/run/beamOn $NEVT"
+  } > $mac
+  $EXE --physics $PRESET $mac > $log 2>&1
+}
+
+run standard
+run box
+
+ref=$LOGDIR/standard.log
+log=$LOGDIR/box.log
+for l in $ref $log; do
+  if ! grep -q "Tally statistics" $l; then echo "run failed, see $l"; exit 1; fi
+done
+
+printf "\nbox versus standard navigation (%s preset, %s events, %s threads)\n" \
+  $PRESET $NEVT $NTHR
+header standard box
+for t in $TALLIES; do compare $ref $log $t; done
+compare_rate $ref $log
+
+if [ -x $BENCH ]; then
+  $BENCH > $LOGDIR/bench.log 2>&1
+  sed -n '/NavigationBench results/,/^-----/p' $LOGDIR/bench.log
+fi
@@ -0,0 +1,50 @@
+#!/bin/bash
+#
+# Validation of the physics presets of Monitor.
+#
+# Runs the same workload (presets.mac, default geometry and source) with
+# each preset and compares every tally of the run summary, and the event
+# rate, to the reference preset (QGSP_BERT_HP) :
+#   ratio = mean/mean_ref
+#   z     = (mean - mean_ref)/sqrt(sigma^2 + sigma_ref^2)
+# A |z| above 3 flags a tally that the preset changes significantly.
+#
+# usage: ./presets.sh [events] [threads] [presets]
+#   events  default: 200000
+#   threads default: number of cores
+#   presets default: "lean fast"
+#
+# The raw logs are kept in presets_logs/ .
+
+EXE=${MONITOR_EXE:-./Monitor}
+NEVT=${1:-200000}
+NTHR=${2:-$(nproc)}
+PRESETS=${3:-"lean fast"}
+LOGDIR=presets_logs
+. "$(dirname "$0")/tallies.sh"
+mkdir -p $LOGDIR
+
+run() {
+  # $1 preset
+  local mac=$LOGDIR/$1.mac log=$LOGDIR/$1.log
+  {
+    echo "/run/numberOfThreads $NTHR"
+    echo "/control/execute presets.mac"
+    echo "/run/beamOn $NEVT"
+  } > $mac
+  $EXE --physics $1 $mac > $log 2>&1
+}
+
+for p in reference $PRESETS; do run $p; done
+
+ref=$LOGDIR/reference.log
+if [ -z "$(rate $ref)" ]; then echo "reference run failed, see $ref"; exit 1; fi
+
+for p in $PRESETS; do
+  log=$LOGDIR/$p.log
+  if [ -z "$(rate $log)" ]; then printf "\n%s: run failed, see %s\n" $p $log; continue; fi
+  printf "\npreset %s versus reference (%s events, %s threads)\n" $p $NEVT $NTHR
+  header ref $p
+  for t in $TALLIES; do compare $ref $log $t; done
+  compare_rate $ref $log
+done
@@ -0,0 +1,81 @@
+#!/bin/bash
+#
+# Thread-scaling harness for Monitor.
+#
+# Runs the identical workload (scaling.mac) at 1, 2, 4 ... N threads, twice:
+#   strong scaling : fixed total number of events
+#   weak scaling   : fixed number of events per thread
+# and tabulates wall time, events/s and efficiency, together with the time
+# spent in Run::Merge, in the analysis Write/CloseFile of the workers and
+# of the master (which contains the ntuple merging when it is enabled).
+#
+# usage: ./scaling.sh [maxThreads] [eventsPerThread] [mergeNtuples]
+#   maxThreads      default: number of cores
+#   eventsPerThread default: 20000 (the strong-scaling total is this x maxThreads)
+#   mergeNtuples    true/false, default false
+#
+# The raw logs are kept in scaling_logs/ .
+
+EXE=${MONITOR_EXE:-./Monitor}
+NMAX=${1:-$(nproc)}
+PERTHREAD=${2:-20000}
+MERGE=${3:-false}
+LOGDIR=scaling_logs
+mkdir -p $LOGDIR
+
+threads=""
+n=1
+while [ $n -lt $NMAX ]; do threads="$threads $n"; n=$((n*2)); done
+threads="$threads $NMAX"
+
+
+run() {
+  # $1 mode, $2 threads, $3 events
+  local mac=$LOGDIR/$1_$2.mac log=$LOGDIR/$1_$2.log
+  {
+    echo "/run/numberOfThreads $2"
+    echo "/testhadr/run/mergeNtuples $MERGE"
+    echo "/control/execute scaling.mac"
+    echo "/run/beamOn $3"
+  } > $mac
+  $EXE $mac > $log 2>&1
+  echo $log
+}
+
+report() {
+  # $1 mode
+  printf "\n%s scaling (ntuple merging: %s)\n" $1 $MERGE
+  printf "%8s %10s %10s %12s %8s %10s %10s %10s %10s %10s\n" \
+    threads events wall[s] events/s eff merge[s] wWrite[s] wClose[s] mWrite[s] mClose[s]
+  local t1=""
+  for n in $threads; do
+    local log=$LOGDIR/$1_$n.log
+    local ev=$(grep "Timing: events " $log | awk '{print $3}')
+    local wall=$(grep "Timing: wall" $log | awk '{print $4}')
+    local rate=$(grep "Timing: events/s" $log | awk '{print $3}')
+    local merge=$(grep "Timing: merge" $log | awk '{print $4}')
+    local ww=$(grep "Timing: workerWrite" $log | awk '{print $4}')
+    local wc=$(grep "Timing: workerClose" $log | awk '{print $4}')
+    local mw=$(grep "Timing: masterWrite" $log | awk '{print $4}')
+    local mc=$(grep "Timing: masterClose" $log | awk '{print $4}')
+    if [ -z "$wall" ]; then printf "%8s  run failed, see %s\n" $n $log; continue; fi
+    [ -z "$t1" ] && t1=$wall
+    # strong: E = T1/(N*TN) ; weak: E = T1/TN
+    local eff
+    if [ $1 == strong ]; then
+      eff=$(awk -v a=$t1 -v b=$wall -v n=$n 'BEGIN{printf "%.3f", a/(n*b)}')
+    else
+      eff=$(awk -v a=$t1 -v b=$wall 'BEGIN{printf "%.3f", a/b}')
+    fi
+    printf "%8s %10s %10s %12s %8s %10s %10s %10s %10s %10s\n" \
+      $n $ev $wall $rate $eff $merge $ww $wc $mw $mc
+  done
+}
+
+for n in $threads; do
+  run strong $n $((PERTHREAD*NMAX)) > /dev/null
+  run weak   $n $((PERTHREAD*n))    > /dev/null
+done
+
+report strong
+report weak
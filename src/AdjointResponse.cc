@@ -0,0 +1,633 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file AdjointResponse.cc
+/// \brief Implementation of the AdjointResponse class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "AdjointResponse.hh"
+#include "ResponseMap.hh"
+#include "DetectorConstruction.hh"
+#include "Run.hh"
+
+#include "G4Navigator.hh"
+#include "G4TransportationManager.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VSolid.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4Neutron.hh"
+#include "G4HadronicProcessStore.hh"
+#include "G4Threading.hh"
+#include "G4Timer.hh"
+#include "G4UnitsTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+#include "CLHEP/Random/MixMaxRng.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <thread>
+
+#ifdef G4MULTITHREADED
+#include "G4WorkerThread.hh"
+#endif
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  const G4double kEmin = 1.e-5*eV;
+  const G4double kEmax = 20.*MeV;
+  const G4int    kPointsPerGroup = 8;
+  // outgoing energies below 4 kT are thermalised
+  const G4double kThermalCut = 4.;
+  // weight window of the roulette and splitting
+  const G4double kWeightLow = 0.25;
+  const G4double kWeightSurvival = 0.5;
+  const G4double kWeightHigh = 2.;
+  const G4int    kMaxSplit = 10;
+  const G4int    kMaxCollisions = 100000;
+  const G4int    kMaxSteps = 10000;
+  const G4int    kBatchSize = 10000;
+
+  G4ThreeVector Isotropic(CLHEP::HepRandomEngine& rng)
+  {
+    G4double cost = 2.*rng.flat() - 1.;
+    G4double sint = std::sqrt(std::max(0., 1. - cost*cost));
+    G4double phi  = twopi*rng.flat();
+    return G4ThreeVector(sint*std::cos(phi), sint*std::sin(phi), cost);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+AdjointResponse* AdjointResponse::Instance()
+{
+  static AdjointResponse instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+AdjointResponse::AdjointResponse()
+: fNbHistories(0), fGroupsPerDecade(10),
+  fNbThreads(G4Threading::G4GetNumberOfCores()),
+  fOutputFile("responseMapAdjoint.csv"),
+  fNbGroups(0), fLogEmin(0.), fLogWidth(0.), fSourceStrength(0.),
+  fWorld(0), fDetectorSolid(0), fNbBins(0), fJobSeed(0)
+{
+  fNbCells[0] = fNbCells[1] = fNbCells[2] = 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AdjointResponse::Print() const
+{
+  G4cout << "\n Adjoint response map: ";
+  if (fNbHistories > 0) G4cout << fNbHistories << " histories at each run";
+  else                  G4cout << "off";
+  G4cout << ", " << fGroupsPerDecade << " groups per decade, " << fNbThreads
+         << " threads, output " << fOutputFile << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int AdjointResponse::Group(G4double e) const
+{
+  G4int g = G4int(std::floor((std::log(e) - fLogEmin)/fLogWidth));
+  return std::min(std::max(g, 0), fNbGroups - 1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AdjointResponse::GroupCrossSections(const G4Material* material,
+                                         G4int element, G4int g,
+                                         G4double* xs) const
+{
+  // flux 1/E within the group: uniform in log(E)
+  G4HadronicProcessStore* store = G4HadronicProcessStore::Instance();
+  const G4ParticleDefinition* neutron = G4Neutron::Neutron();
+  const G4Element* elm = material->GetElement(element);
+  xs[0] = xs[1] = xs[2] = 0.;
+  for (G4int p=0; p<kPointsPerGroup; p++) {
+    G4double e = std::exp(fLogEmin + (g + (p + 0.5)/kPointsPerGroup)*fLogWidth);
+    G4double capture =
+      store->GetCaptureCrossSectionPerAtom(neutron, e, elm, material);
+    xs[0] += store->GetElasticCrossSectionPerAtom(neutron, e, elm, material);
+    xs[1] += capture;
+    xs[2] += capture
+           + store->GetFissionCrossSectionPerAtom(neutron, e, elm, material)
+           + store->GetInelasticCrossSectionPerAtom(neutron, e, elm, material);
+  }
+  for (G4int c=0; c<3; c++) xs[c] /= kPointsPerGroup;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AdjointResponse::BuildTables()
+{
+  fNbGroups = G4int(std::ceil(std::log10(kEmax/kEmin)*fGroupsPerDecade));
+  fLogEmin  = std::log(kEmin);
+  fLogWidth = std::log(kEmax/kEmin)/fNbGroups;
+  fMaterials.assign(G4Material::GetMaterialTable()->size(), Material());
+  for (std::size_t m=0; m<fMaterials.size(); m++) BuildMaterial(m);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AdjointResponse::BuildMaterial(G4int index)
+{
+  const G4Material* material = (*G4Material::GetMaterialTable())[index];
+  Material& table = fMaterials[index];
+  G4int nbGroups = fNbGroups;
+  G4int nbElements = material->GetNumberOfElements();
+  const G4double* atoms = material->GetVecNbOfAtomsPerVolume();
+  G4double kT = k_Boltzmann*material->GetTemperature();
+
+  // the Maxwellian spectrum of the thermalised neutrons, per group:
+  // fraction of x exp(-x) between the bounds, x = E/kT
+  std::vector<G4double> maxwell(nbGroups);
+  G4double norm = 0.;
+  for (G4int g=0; g<nbGroups; g++) {
+    G4double x0 = GroupBound(g)/kT, x1 = GroupBound(g+1)/kT;
+    maxwell[g] = (1. + x0)*std::exp(-x0) - (1. + x1)*std::exp(-x1);
+    norm += maxwell[g];
+  }
+  for (G4int g=0; g<nbGroups; g++) maxwell[g] /= norm;
+
+  table.fMass.resize(nbElements);
+  table.fThermal.assign(nbElements, kThermalCut*kT);
+  table.fTotal.assign(nbGroups, 0.);
+  std::vector<G4double> elastic(nbElements*nbGroups);
+  std::vector<G4double> transfer(nbElements*nbGroups*nbGroups);
+  for (G4int k=0; k<nbElements; k++) {
+    table.fMass[k] = material->GetElement(k)->GetAtomicMassAmu()
+                     *amu_c2/neutron_mass_c2;
+    for (G4int g=0; g<nbGroups; g++) {
+      G4double xs[3];
+      GroupCrossSections(material, k, g, xs);
+      elastic[k*nbGroups + g] = atoms[k]*xs[0];
+      table.fTotal[g] += atoms[k]*(xs[0] + xs[2]);
+      Transfer(table.fMass[k], kT, g, maxwell,
+               &transfer[(k*nbGroups + g)*nbGroups]);
+    }
+  }
+
+  // per arrival group: the (element, departure group) pairs
+  table.fScatter.assign(nbGroups, 0.);
+  table.fCumul.resize(nbGroups*nbElements*nbGroups);
+  for (G4int g=0; g<nbGroups; g++) {
+    G4double sum = 0.;
+    for (G4int k=0; k<nbElements; k++) {
+      for (G4int from=0; from<nbGroups; from++) {
+        sum += elastic[k*nbGroups + from]
+              *transfer[(k*nbGroups + from)*nbGroups + g];
+        table.fCumul[(g*nbElements + k)*nbGroups + from] = sum;
+      }
+    }
+    table.fScatter[g] = sum;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AdjointResponse::Transfer(G4double A, G4double kT, G4int from,
+                               const std::vector<G4double>& maxwell,
+                               G4double* row) const
+{
+  // target at rest: outgoing energy uniform in [alpha E, E], averaged over
+  // the points of the departure group; the part below the cut thermalised
+  std::fill(row, row + fNbGroups, 0.);
+  G4double alpha = ((A - 1.)/(A + 1.))*((A - 1.)/(A + 1.));
+  G4double cut = kThermalCut*kT;
+  for (G4int p=0; p<kPointsPerGroup; p++) {
+    G4double e = std::exp(fLogEmin
+                          + (from + (p + 0.5)/kPointsPerGroup)*fLogWidth);
+    G4double lowest = alpha*e;
+    G4double width = (e - lowest)*kPointsPerGroup;
+    G4double thermal = std::max(0., std::min(e, cut) - lowest)/width;
+    for (G4int g=0; g<fNbGroups; g++) row[g] += thermal*maxwell[g];
+    G4double low = std::max(lowest, cut);
+    if (low >= e) continue;
+    for (G4int g=Group(low); g<=Group(e); g++) {
+      G4double overlap = std::min(e, GroupBound(g+1))
+                       - std::max(low, GroupBound(g));
+      if (overlap > 0.) row[g] += overlap/width;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AdjointResponse::Source(CLHEP::HepRandomEngine& rng,
+                             Particle& particle) const
+{
+  // uniform in the gas of the tube, group by capture, isotropic
+  G4ThreeVector local;
+  do {
+    for (G4int i=0; i<3; i++)
+      local[i] = fDetectorMin[i]
+               + (fDetectorMax[i] - fDetectorMin[i])*rng.flat();
+  } while (fDetectorSolid->Inside(local) == kOutside);
+  particle.fPosition = fDetectorCentre + local;
+  particle.fDirection = Isotropic(rng);
+
+  G4double u = rng.flat()*fSourceCumul.back();
+  G4int g = std::upper_bound(fSourceCumul.begin(), fSourceCumul.end(), u)
+          - fSourceCumul.begin();
+  particle.fGroup  = std::min(g, fNbGroups - 1);
+  particle.fEnergy = GroupBound(particle.fGroup)
+                    *std::exp(rng.flat()*fLogWidth);
+  particle.fWeight = 1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AdjointResponse::Collide(CLHEP::HepRandomEngine& rng, G4int material,
+                              Particle& particle) const
+{
+  const Material& table = fMaterials[material];
+  G4int g = particle.fGroup;
+  G4int nbPairs = table.fMass.size()*fNbGroups;
+  G4double scatter = table.fScatter[g];
+  if (scatter <= 0. || table.fTotal[g] <= 0.) {
+    particle.fWeight = 0.;
+    return;
+  }
+  particle.fWeight *= scatter/table.fTotal[g];
+
+  // the element and the departure group of the forward scattering
+  const G4double* cumul = &table.fCumul[g*nbPairs];
+  G4int j = std::upper_bound(cumul, cumul + nbPairs, rng.flat()*scatter)
+          - cumul;
+  j = std::min(j, nbPairs - 1);
+  G4int k = j/fNbGroups, from = j % fNbGroups;
+
+  // the departure energy, kinematically compatible with the arrival one
+  // when not thermalised; the angle follows from the two energies
+  G4double e = particle.fEnergy;
+  G4double A = table.fMass[k];
+  G4double alpha = ((A - 1.)/(A + 1.))*((A - 1.)/(A + 1.));
+  G4double low = std::max(GroupBound(from), e);
+  G4double high = GroupBound(from+1);
+  if (alpha > 0.) high = std::min(high, e/alpha);
+  if (e >= table.fThermal[k] && low < high) {
+    G4double eNew = low*std::pow(high/low, rng.flat());
+    G4double mu = 0.5*((A + 1.)*std::sqrt(e/eNew)
+                     - (A - 1.)*std::sqrt(eNew/e));
+    mu = std::min(std::max(mu, -1.), 1.);
+    G4double sinTheta = std::sqrt(1. - mu*mu);
+    G4double phi = twopi*rng.flat();
+    G4ThreeVector direction(sinTheta*std::cos(phi), sinTheta*std::sin(phi),
+                            mu);
+    direction.rotateUz(particle.fDirection);
+    particle.fDirection = direction;
+    particle.fEnergy = eNew;
+  } else {
+    particle.fDirection = Isotropic(rng);
+    particle.fEnergy = GroupBound(from)*std::exp(rng.flat()*fLogWidth);
+  }
+  particle.fGroup = from;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AdjointResponse::Score(const G4ThreeVector& from,
+                            const G4ThreeVector& to, G4double weight,
+                            G4int g, std::vector<G4double>& track,
+                            std::vector<G4int>& touched) const
+{
+  // the flight clipped to the box of the map, then walked cell by cell;
+  // t runs from 0 to 1 along the flight
+  G4ThreeVector d = to - from;
+  G4double length = d.mag();
+  if (length <= 0. || weight <= 0.) return;
+  G4double t0 = 0., t1 = 1.;
+  for (G4int i=0; i<3; i++) {
+    if (d[i] == 0.) {
+      if (from[i] < fLow[i] || from[i] > fHigh[i]) return;
+      continue;
+    }
+    G4double ta = (fLow[i] - from[i])/d[i], tb = (fHigh[i] - from[i])/d[i];
+    t0 = std::max(t0, std::min(ta, tb));
+    t1 = std::min(t1, std::max(ta, tb));
+  }
+  if (t0 >= t1) return;
+
+  G4int index[3], step[3];
+  G4double next[3], delta[3];
+  for (G4int i=0; i<3; i++) {
+    G4double size = (fHigh[i] - fLow[i])/fNbCells[i];
+    G4double start = from[i] + t0*d[i];
+    index[i] = std::min(std::max(G4int((start - fLow[i])/size), 0),
+                        fNbCells[i] - 1);
+    if (d[i] > 0.) {
+      step[i]  = 1;
+      next[i]  = (fLow[i] + (index[i] + 1)*size - from[i])/d[i];
+      delta[i] = size/d[i];
+    } else if (d[i] < 0.) {
+      step[i]  = -1;
+      next[i]  = (fLow[i] + index[i]*size - from[i])/d[i];
+      delta[i] = -size/d[i];
+    } else {
+      step[i]  = 0;
+      next[i]  = delta[i] = DBL_MAX;
+    }
+  }
+
+  G4double t = t0;
+  while (t < t1) {
+    G4int axis = 0;
+    if (next[1] < next[axis]) axis = 1;
+    if (next[2] < next[axis]) axis = 2;
+    G4double end = std::min(next[axis], t1);
+    if (end > t) {
+      G4int cell = (index[0]*fNbCells[1] + index[1])*fNbCells[2] + index[2];
+      G4int s = cell*fNbGroups + g;
+      if (track[s] == 0.) touched.push_back(s);
+      track[s] += weight*(end - t)*length;
+      t = end;
+    }
+    if (t >= t1) break;
+    index[axis] += step[axis];
+    if (index[axis] < 0 || index[axis] >= fNbCells[axis]) break;
+    next[axis] += delta[axis];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AdjointResponse::Walk(G4Navigator* navigator,
+                           CLHEP::HepRandomEngine& rng, Particle& particle,
+                           std::vector<Particle>& stack,
+                           std::vector<G4double>& track,
+                           std::vector<G4int>& touched, Scores& scores) const
+{
+  G4ThreeVector& position = particle.fPosition;
+  G4ThreeVector& direction = particle.fDirection;
+  G4VPhysicalVolume* volume =
+    navigator->LocateGlobalPointAndSetup(position, &direction, false, false);
+
+  for (G4int c=0; volume && c<kMaxCollisions; c++) {
+    // the flight to the next collision, across the volumes; the history
+    // ends when the neutron leaves the world
+    G4double tau = -std::log(rng.flat());
+    G4int material = -1;
+    for (G4int i=0; volume && i<kMaxSteps; i++) {
+      G4int m = volume->GetLogicalVolume()->GetMaterial()->GetIndex();
+      G4double sigma = fMaterials[m].fTotal[particle.fGroup];
+      G4double safety;
+      G4double step =
+        navigator->ComputeStep(position, direction, kInfinity, safety);
+      if (sigma*step > tau) {
+        G4ThreeVector end = position + (tau/sigma)*direction;
+        Score(position, end, particle.fWeight, particle.fGroup, track,
+              touched);
+        position = end;
+        navigator->LocateGlobalPointWithinVolume(position);
+        material = m;
+        break;
+      }
+      if (step >= kInfinity) return;
+      G4ThreeVector end = position + step*direction;
+      Score(position, end, particle.fWeight, particle.fGroup, track, touched);
+      position = end;
+      tau -= sigma*step;
+      navigator->SetGeometricallyLimitedStep();
+      volume = navigator->LocateGlobalPointAndSetup(position, &direction,
+                                                    true);
+    }
+    if (material < 0) return;
+
+    Collide(rng, material, particle);
+    scores.fCollisions += 1.;
+
+    // Russian roulette and splitting
+    G4double& weight = particle.fWeight;
+    if (weight < kWeightLow) {
+      if (rng.flat()*kWeightSurvival >= weight) {
+        scores.fKilled += 1.;
+        return;
+      }
+      weight = kWeightSurvival;
+    } else if (weight > kWeightHigh) {
+      G4int n = std::min(G4int(weight), kMaxSplit);
+      weight /= n;
+      for (G4int i=1; i<n; i++) stack.push_back(particle);
+      scores.fSplit += n - 1;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AdjointResponse::TransportRange(G4int firstBatch, G4int lastBatch,
+                                     Scores* scores) const
+{
+#ifdef G4MULTITHREADED
+  // the thread-local parts of the geometry, copied from the master as
+  // for a worker thread
+  G4WorkerThread::BuildGeometryAndPhysicsVector();
+#endif
+  // a private navigator: the geometry is only read
+  G4Navigator* navigator = new G4Navigator();
+  navigator->SetWorldVolume(fWorld);
+
+  G4int nbCells = fNbCells[0]*fNbCells[1]*fNbCells[2];
+  G4double cellVolume = (fHigh[0] - fLow[0])*(fHigh[1] - fLow[1])
+                       *(fHigh[2] - fLow[2])/nbCells;
+  G4double scale = fSourceStrength/cellVolume;
+  std::vector<G4double> track(nbCells*fNbGroups, 0.);
+  std::vector<G4double> history(nbCells*fNbBins, 0.);
+  std::vector<G4int> touched, strata;
+  std::vector<Particle> stack;
+
+  // one engine per batch, seeded from the job seed and the batch number:
+  // the results do not depend on the number of threads
+  for (G4int b=firstBatch; b<lastBatch; b++) {
+    G4int n = std::min(kBatchSize, fNbHistories - b*kBatchSize);
+    CLHEP::MixMaxRng rng(fJobSeed + b);
+    for (G4int h=0; h<n; h++) {
+      Particle particle;
+      Source(rng, particle);
+      stack.push_back(particle);
+      while (!stack.empty()) {
+        particle = stack.back();
+        stack.pop_back();
+        Walk(navigator, rng, particle, stack, track, touched, *scores);
+      }
+
+      // the track lengths of the history folded into the strata
+      for (std::size_t i=0; i<touched.size(); i++) {
+        G4int s = touched[i];
+        G4int cell = s/fNbGroups, g = s % fNbGroups;
+        for (G4int bin=0; bin<fNbBins; bin++) {
+          G4double f = fFold[bin*fNbGroups + g];
+          if (f <= 0.) continue;
+          G4int stratum = cell*fNbBins + bin;
+          if (history[stratum] == 0.) strata.push_back(stratum);
+          history[stratum] += scale*f*track[s];
+        }
+        track[s] = 0.;
+      }
+      touched.clear();
+      for (std::size_t i=0; i<strata.size(); i++) {
+        G4double x = history[strata[i]];
+        scores->fSum[strata[i]]  += x;
+        scores->fSum2[strata[i]] += x*x;
+        history[strata[i]] = 0.;
+      }
+      strata.clear();
+    }
+  }
+  delete navigator;
+#ifdef G4MULTITHREADED
+  G4WorkerThread::DestroyGeometryAndPhysicsVector();
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AdjointResponse::BeginOfRun(DetectorConstruction* det)
+{
+  if (fNbHistories <= 0) return;
+  ResponseMap* map = ResponseMap::Instance();
+  if (map->GetTally() != Run::kCaptureDetector) {
+    G4cout << "\n--> warning from AdjointResponse : the adjoint source is"
+           << " the capture in the He-3 gas, the response tally must be "
+           << Run::TallyName(Run::kCaptureDetector) << "; no adjoint walk"
+           << G4endl;
+    return;
+  }
+  fLow  = map->GetLow();
+  fHigh = map->GetHigh();
+  if ((fHigh - fLow).mag2() == 0.) {
+    G4cout << "\n--> warning from AdjointResponse : no source box; no"
+           << " adjoint walk" << G4endl;
+    return;
+  }
+  for (G4int i=0; i<3; i++) fNbCells[i] = map->GetNbCells(i);
+  fNbBins = map->GetNbEnergies();
+
+  G4Timer timer;
+  timer.Start();
+  fWorld = G4TransportationManager::GetTransportationManager()
+             ->GetNavigatorForTracking()->GetWorldVolume();
+  BuildTables();
+
+  // the adjoint source: capture in the gas of the tube
+  fDetectorSolid  = det->detectorL->GetSolid();
+  fDetectorCentre = det->GetProbePosition();
+  fDetectorSolid->BoundingLimits(fDetectorMin, fDetectorMax);
+  const G4Material* gas = det->detectorL->GetMaterial();
+  const G4double* atoms = gas->GetVecNbOfAtomsPerVolume();
+  fSourceCumul.assign(fNbGroups, 0.);
+  G4double sum = 0.;
+  for (G4int g=0; g<fNbGroups; g++) {
+    for (std::size_t k=0; k<gas->GetNumberOfElements(); k++) {
+      G4double xs[3];
+      GroupCrossSections(gas, k, g, xs);
+      sum += atoms[k]*xs[1];
+    }
+    fSourceCumul[g] = sum;
+  }
+  fSourceStrength = fDetectorSolid->GetCubicVolume()*sum;
+  if (fSourceStrength <= 0.) {
+    G4cout << "\n--> warning from AdjointResponse : no capture in "
+           << gas->GetName() << "; no adjoint walk" << G4endl;
+    return;
+  }
+
+  // the energy bins of the map over the groups, by overlap in log(E); a
+  // bin of zero width is the group of its energy
+  G4double emin = map->GetEmin(), emax = map->GetEmax();
+  fFold.assign(fNbBins*fNbGroups, 0.);
+  for (G4int b=0; b<fNbBins; b++) {
+    G4double e0 = emin*std::pow(emax/emin, G4double(b)/fNbBins);
+    G4double e1 = emin*std::pow(emax/emin, G4double(b+1)/fNbBins);
+    if (e1 <= e0) {
+      fFold[b*fNbGroups + Group(e0)] = 1.;
+      continue;
+    }
+    for (G4int g=0; g<fNbGroups; g++) {
+      G4double overlap = std::min(std::log(e1), fLogEmin + (g+1)*fLogWidth)
+                       - std::max(std::log(e0), fLogEmin + g*fLogWidth);
+      if (overlap > 0.) fFold[b*fNbGroups + g] = overlap/std::log(e1/e0);
+    }
+  }
+  timer.Stop();
+  G4double tableTime = timer.GetRealElapsed();
+
+  // the histories by batches, shared among the threads
+  fJobSeed = G4long(G4UniformRand()*1.e9)*1000000;
+  G4int nbStrata = map->GetNbStrata();
+  G4int nbBatches = (fNbHistories + kBatchSize - 1)/kBatchSize;
+  G4int nbThreads = std::max(1, std::min(fNbThreads, nbBatches));
+  std::vector<Scores> scores(nbThreads);
+  for (G4int t=0; t<nbThreads; t++) {
+    scores[t].fSum.assign(nbStrata, 0.);
+    scores[t].fSum2.assign(nbStrata, 0.);
+    scores[t].fCollisions = scores[t].fSplit = scores[t].fKilled = 0.;
+  }
+  timer.Start();
+  std::vector<std::thread> threads;
+  for (G4int t=0; t<nbThreads; t++) {
+    G4int first = nbBatches*t/nbThreads, last = nbBatches*(t+1)/nbThreads;
+    threads.push_back(std::thread(&AdjointResponse::TransportRange, this,
+                                  first, last, &scores[t]));
+  }
+  for (std::size_t t=0; t<threads.size(); t++) threads[t].join();
+  timer.Stop();
+  for (G4int t=1; t<nbThreads; t++) {
+    for (G4int s=0; s<nbStrata; s++) {
+      scores[0].fSum[s]  += scores[t].fSum[s];
+      scores[0].fSum2[s] += scores[t].fSum2[s];
+    }
+    scores[0].fCollisions += scores[t].fCollisions;
+    scores[0].fSplit      += scores[t].fSplit;
+    scores[0].fKilled     += scores[t].fKilled;
+  }
+
+  G4double n = fNbHistories;
+  G4cout << "\n Adjoint walk: " << fNbHistories << " histories from "
+         << det->detectorL->GetName() << ", " << fNbGroups << " groups ("
+         << tableTime << " s of tables), " << nbThreads << " threads, "
+         << timer.GetRealElapsed() << " s\n  "
+         << scores[0].fCollisions/n << " collisions, "
+         << scores[0].fSplit/n << " splits and " << scores[0].fKilled/n
+         << " roulette kills per history" << G4endl;
+  std::vector<G4double> histories(nbStrata, n);
+  map->Report("adjoint", fOutputFile, histories, scores[0].fSum,
+              scores[0].fSum2);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,223 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file BiasingOperator.cc
+/// \brief Implementation of the BiasingOperator class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "BiasingOperator.hh"
+#include "RegionInformation.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4BiasingProcessInterface.hh"
+#include "G4BOptnChangeCrossSection.hh"
+#include "G4Neutron.hh"
+#include "G4ProcessManager.hh"
+#include "G4ProcessVector.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Track.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BiasingOperator::BiasingOperator(const DetectorConstruction* det)
+: G4VBiasingOperator("NeutronBiasingOperator"),
+  fDetector(det), fNeutron(0)
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BiasingOperator::~BiasingOperator()
+{
+  std::map<const G4BiasingProcessInterface*,G4BOptnChangeCrossSection*>
+    ::iterator it;
+  for (it = fOperations.begin(); it != fOperations.end(); ++it) {
+    delete it->second;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BiasingOperator::StartRun()
+{
+  fNeutron = G4Neutron::Neutron();
+
+  // exponential transforms, resolved for the current geometry
+  fStretches.clear();
+  const std::map<G4String,DetectorConstruction::ExpTransform>& transforms
+    = fDetector->GetExpTransforms();
+  std::map<G4String,DetectorConstruction::ExpTransform>::const_iterator it;
+  for (it = transforms.begin(); it != transforms.end(); ++it) {
+    const G4LogicalVolume* volume =
+      G4LogicalVolumeStore::GetInstance()->GetVolume(it->first, false);
+    if (!volume) {
+      G4cout << "\n--> warning from BiasingOperator : no logical volume "
+             << it->first << " for the exponential transform" << G4endl;
+      continue;
+    }
+    const DetectorConstruction::ExpTransform& transform = it->second;
+    Stretch& stretch = fStretches[volume];
+    stretch.fP = transform.fStretch;
+    stretch.fToPoint = (transform.fTarget != transform.kDirection);
+    stretch.fVector = (transform.fTarget == transform.kProbe)
+                    ? fDetector->GetProbePosition() : transform.fVector;
+    if (!stretch.fToPoint) stretch.fVector = stretch.fVector.unit();
+  }
+
+  // warn if biasing is asked that the physics cannot provide
+  G4bool requested = !fStretches.empty();
+  G4RegionStore* regions = G4RegionStore::GetInstance();
+  for (std::size_t i=0; i<regions->size(); i++) {
+    const RegionInformation* info = static_cast<const RegionInformation*>
+      ((*regions)[i]->GetUserInformation());
+    if (info && info->fImplicitCapture) requested = true;
+  }
+  if (!requested) return;
+
+  G4bool wrapped = false, captureWrapped = false;
+  G4ProcessVector* processes = fNeutron->GetProcessManager()->GetProcessList();
+  for (G4int i=0; i<processes->size(); i++) {
+    const G4BiasingProcessInterface* wrapper =
+      dynamic_cast<const G4BiasingProcessInterface*>((*processes)[i]);
+    if (wrapper && wrapper->GetWrappedProcess()) {
+      wrapped = true;
+      if (wrapper->GetWrappedProcess()->GetProcessName() == "nCapture") {
+        captureWrapped = true;
+      }
+    }
+  }
+  if (!wrapped) {
+    G4cout << "\n--> warning from BiasingOperator : biasing requested"
+           << " but the neutron processes are not wrapped"
+           << " (/testhadr/phys/biasing true)" << G4endl;
+  }
+  else if (!captureWrapped) {
+    G4cout << "\n--> warning from BiasingOperator : nCapture is not wrapped,"
+           << " no implicit capture with the general process" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const G4VProcess* BiasingOperator::PhysicsProcess(const G4VProcess* process)
+{
+  const G4BiasingProcessInterface* wrapper =
+    dynamic_cast<const G4BiasingProcessInterface*>(process);
+  if (wrapper && wrapper->GetWrappedProcess()) {
+    return wrapper->GetWrappedProcess();
+  }
+  return process;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const RegionInformation*
+BiasingOperator::GetRegionInformation(const G4Track* track)
+{
+  const G4VPhysicalVolume* volume = track->GetVolume();
+  if (!volume) return 0;
+  const G4Region* region = volume->GetLogicalVolume()->GetRegion();
+  if (!region) return 0;
+  return static_cast<const RegionInformation*>(region->GetUserInformation());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VBiasingOperation* BiasingOperator::ProposeOccurenceBiasingOperation(
+                               const G4Track* track,
+                               const G4BiasingProcessInterface* callingProcess)
+{
+  if (track->GetDefinition() != fNeutron) return 0;
+
+  // implicit capture: capture never occurs, the weight carries the
+  // survival probability
+  const RegionInformation* info = GetRegionInformation(track);
+  G4bool noCapture = info && info->fImplicitCapture &&
+    callingProcess->GetWrappedProcess()->GetProcessName() == "nCapture";
+
+  std::map<const G4LogicalVolume*,Stretch>::const_iterator it
+    = fStretches.end();
+  if (!noCapture && !fStretches.empty()) {
+    it = fStretches.find(track->GetVolume()->GetLogicalVolume());
+  }
+  if (!noCapture && it == fStretches.end()) return 0;
+
+  G4double biasedXS = 0.;
+  if (!noCapture) {
+    // exponential transform: Sigma* = Sigma (1 - p mu)
+    G4double analogLength =
+      callingProcess->GetWrappedProcess()->GetCurrentInteractionLength();
+    if (analogLength > DBL_MAX/10.) return 0;
+    const Stretch& stretch = it->second;
+    const G4ThreeVector& direction = track->GetMomentumDirection();
+    G4double mu = 0.;
+    if (stretch.fToPoint) {
+      G4ThreeVector toPoint = stretch.fVector - track->GetPosition();
+      if (toPoint.mag2() > 0.) mu = direction.dot(toPoint.unit());
+    }
+    else {
+      mu = direction.dot(stretch.fVector);
+    }
+    biasedXS = (1. - stretch.fP*mu)/analogLength;
+  }
+
+  G4BOptnChangeCrossSection* operation = GetOperation(callingProcess);
+  G4VBiasingOperation* previous =
+    callingProcess->GetPreviousOccurenceBiasingOperation();
+  if (previous == operation && !operation->GetInteractionOccured()) {
+    // account for the past step with the previous cross section, then
+    // update the remaining interaction length to the new one
+    operation->UpdateForStep(callingProcess->GetPreviousStepSize());
+    operation->SetBiasedCrossSection(biasedXS);
+    operation->UpdateForStep(0.);
+  }
+  else {
+    operation->SetBiasedCrossSection(biasedXS);
+    operation->Sample();
+  }
+  return operation;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4BOptnChangeCrossSection*
+BiasingOperator::GetOperation(const G4BiasingProcessInterface* callingProcess)
+{
+  G4BOptnChangeCrossSection*& operation = fOperations[callingProcess];
+  if (!operation) {
+    operation = new G4BOptnChangeCrossSection("Biased-" +
+      callingProcess->GetWrappedProcess()->GetProcessName());
+  }
+  return operation;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,320 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file BoxNavigation.cc
+/// \brief Implementation of the BoxNavigation class
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "BoxNavigation.hh"
+
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4NavigationHistory.hh"
+#include "G4Navigator.hh"
+#include "G4TransportationManager.hh"
+#include "G4GeometryTolerance.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+G4bool BoxNavigation::fEnabled = false;
+
+namespace
+{
+  // as G4NormalNavigation: a track leaving a daughter may re-enter it only
+  // if it is heading back inside
+  const G4double kMinExitingNormalCosine = 1.e-3;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BoxNavigation::BoxNavigation()
+ : G4VExternalNavigation(),
+   fDelta(0.5*G4GeometryTolerance::GetInstance()->GetSurfaceTolerance()),
+   fLastLogical(0), fLastVolume(0)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BoxNavigation::~BoxNavigation()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VExternalNavigation* BoxNavigation::Clone()
+{
+  return new BoxNavigation();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxNavigation::ClearCache()
+{
+  fVolumes.clear();
+  fLastLogical = 0;
+  fLastVolume  = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxNavigation::Install()
+{
+  // one instance per thread; once set, the navigator owns it
+  static G4ThreadLocal BoxNavigation* navigation = 0;
+
+  G4Navigator* navigator = G4TransportationManager::GetTransportationManager()
+                             ->GetNavigatorForTracking();
+  if (!fEnabled) {
+    if (navigation) navigator->SetExternalNavigation(0);
+    return;
+  }
+  if (!navigation) navigation = new BoxNavigation();
+  navigation->ClearCache();
+  navigator->SetExternalNavigation(navigation);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const BoxNavigation::Volume&
+BoxNavigation::GetVolume(const G4LogicalVolume* logical)
+{
+  if (logical == fLastLogical) return *fLastVolume;
+
+  std::map<const G4LogicalVolume*, Volume>::iterator it
+    = fVolumes.find(logical);
+  if (it == fVolumes.end()) {
+    Volume vol;
+    const G4Box* box = dynamic_cast<const G4Box*>(logical->GetSolid());
+    vol.fBoxes = (box != 0);
+    if (box) {
+      vol.fHalf[0] = box->GetXHalfLength();
+      vol.fHalf[1] = box->GetYHalfLength();
+      vol.fHalf[2] = box->GetZHalfLength();
+    }
+    for (std::size_t i = 0; vol.fBoxes && i < logical->GetNoDaughters(); ++i) {
+      G4VPhysicalVolume* daughter = logical->GetDaughter(i);
+      const G4Box* dbox
+        = dynamic_cast<const G4Box*>(daughter->GetLogicalVolume()->GetSolid());
+      const G4RotationMatrix* rot = daughter->GetRotation();
+      if (!dbox || daughter->IsReplicated() || (rot && !rot->isIdentity())) {
+        vol.fBoxes = false;
+        break;
+      }
+      const G4ThreeVector& c = daughter->GetTranslation();
+      vol.fX.push_back(c.x());
+      vol.fY.push_back(c.y());
+      vol.fZ.push_back(c.z());
+      vol.fDx.push_back(dbox->GetXHalfLength());
+      vol.fDy.push_back(dbox->GetYHalfLength());
+      vol.fDz.push_back(dbox->GetZHalfLength());
+      vol.fDaughter.push_back(daughter);
+    }
+    it = fVolumes.insert(std::make_pair(logical, vol)).first;
+  }
+  fLastLogical = logical;
+  fLastVolume  = &(it->second);
+  return *fLastVolume;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double BoxNavigation::ComputeStep(const G4ThreeVector& localPoint,
+                                    const G4ThreeVector& localDirection,
+                                    const G4double currentProposedStepLength,
+                                          G4double& newSafety,
+                                          G4NavigationHistory& history,
+                                          G4bool& validExitNormal,
+                                          G4ThreeVector& exitNormal,
+                                          G4bool& exiting,
+                                          G4bool& entering,
+                                          G4VPhysicalVolume* (*pBlockedPhysical),
+                                          G4int& blockedReplicaNo)
+{
+  G4VPhysicalVolume* motherPhysical = history.GetTopVolume();
+  const Volume& vol = GetVolume(motherPhysical->GetLogicalVolume());
+  if (!vol.fBoxes) {
+    return fNormal.ComputeStep(localPoint, localDirection,
+                               currentProposedStepLength, newSafety, history,
+                               validExitNormal, exitNormal, exiting, entering,
+                               pBlockedPhysical, blockedReplicaNo);
+  }
+
+  const G4double px = localPoint.x(), py = localPoint.y(), pz = localPoint.z();
+  const G4double ux = localDirection.x(), uy = localDirection.y(),
+                 uz = localDirection.z();
+  const G4double hx = vol.fHalf[0], hy = vol.fHalf[1], hz = vol.fHalf[2];
+  const G4double delta = fDelta;
+
+  // safety from the walls of the mother
+  G4double motherSafety = std::min(std::min(hx - std::fabs(px),
+                                            hy - std::fabs(py)),
+                                   hz - std::fabs(pz));
+  motherSafety = std::max(motherSafety, 0.);
+  G4double ourSafety = motherSafety;
+  G4double ourStep = currentProposedStepLength;
+
+  // the daughter just left may not be re-entered, unless heading back in
+  G4VPhysicalVolume* blockedExitedVol = 0;
+  if (exiting && validExitNormal) {
+    if (localDirection.dot(exitNormal) >= kMinExitingNormalCosine) {
+      blockedExitedVol = *pBlockedPhysical;
+      ourSafety = 0;
+    }
+  }
+  exiting  = false;
+  entering = false;
+
+  // daughters, in the order of G4NormalNavigation (last placed first)
+  G4int hit = -1;
+  for (G4int d = G4int(vol.fDaughter.size()) - 1; d >= 0; --d) {
+    if (vol.fDaughter[d] == blockedExitedVol) continue;
+    const G4double sx = px - vol.fX[d], sy = py - vol.fY[d],
+                   sz = pz - vol.fZ[d];
+    const G4double dx = vol.fDx[d], dy = vol.fDy[d], dz = vol.fDz[d];
+    const G4double ax = std::fabs(sx) - dx, ay = std::fabs(sy) - dy,
+                   az = std::fabs(sz) - dz;
+    const G4double safety = std::max(std::max(std::max(ax, ay), az), 0.);
+    ourSafety = std::min(ourSafety, safety);
+    if (safety > ourStep) continue;
+
+    // slab test, as G4Box::DistanceToIn(p,v); no hit when on a face and
+    // moving away from it, or when the ray only touches the box
+    const G4bool away = ((ax >= -delta) & (sx*ux >= 0.))
+                      | ((ay >= -delta) & (sy*uy >= 0.))
+                      | ((az >= -delta) & (sz*uz >= 0.));
+    const G4double invx = (ux == 0.) ? DBL_MAX : -1./ux;
+    const G4double invy = (uy == 0.) ? DBL_MAX : -1./uy;
+    const G4double invz = (uz == 0.) ? DBL_MAX : -1./uz;
+    const G4double cx = std::copysign(dx, invx), cy = std::copysign(dy, invy),
+                   cz = std::copysign(dz, invz);
+    const G4double tmin = std::max(std::max((sx - cx)*invx, (sy - cy)*invy),
+                                   (sz - cz)*invz);
+    const G4double tmax = std::min(std::min((sx + cx)*invx, (sy + cy)*invy),
+                                   (sz + cz)*invz);
+    G4double step = (tmin < delta) ? 0. : tmin;
+    step = (away | (tmax <= tmin + delta)) ? kInfinity : step;
+    if (step <= ourStep) {
+      ourStep = step;
+      hit = d;
+    }
+  }
+  if (hit >= 0) {
+    entering = true;
+    exiting  = false;
+    *pBlockedPhysical = vol.fDaughter[hit];
+    blockedReplicaNo  = -1;
+  }
+
+  if (currentProposedStepLength < ourSafety) {
+    // guaranteed physics limited step
+    entering = false;
+    exiting  = false;
+    *pBlockedPhysical = 0;
+    ourStep = kInfinity;
+  }
+  else if (motherSafety <= ourStep) {
+    // exit of the mother, as G4Box::DistanceToOut(p,v) with its normal:
+    // at once when on a face and moving out through it
+    G4double motherStep;
+    G4int axis;
+    G4double sign;
+    if      ((std::fabs(px) - hx >= -delta) & (px*ux > 0.)) {
+      motherStep = 0.; axis = 0; sign = (px < 0.) ? -1. : 1.;
+    }
+    else if ((std::fabs(py) - hy >= -delta) & (py*uy > 0.)) {
+      motherStep = 0.; axis = 1; sign = (py < 0.) ? -1. : 1.;
+    }
+    else if ((std::fabs(pz) - hz >= -delta) & (pz*uz > 0.)) {
+      motherStep = 0.; axis = 2; sign = (pz < 0.) ? -1. : 1.;
+    }
+    else {
+      const G4double tx = (ux == 0.) ? DBL_MAX : (std::copysign(hx,ux) - px)/ux;
+      const G4double ty = (uy == 0.) ? DBL_MAX : (std::copysign(hy,uy) - py)/uy;
+      const G4double tz = (uz == 0.) ? DBL_MAX : (std::copysign(hz,uz) - pz)/uz;
+      motherStep = std::min(std::min(tx, ty), tz);
+      axis = (tx == motherStep) ? 0 : ((ty == motherStep) ? 1 : 2);
+      sign = (localDirection[axis] < 0.) ? -1. : 1.;
+    }
+    if (motherStep <= ourStep) {
+      ourStep  = motherStep;
+      exiting  = true;
+      entering = false;
+      G4ThreeVector normal(0., 0., 0.);
+      normal[axis] = sign;
+      const G4RotationMatrix* rot = motherPhysical->GetRotation();
+      if (rot) normal *= rot->inverse();
+      exitNormal = normal;
+      validExitNormal = true;
+    }
+    else {
+      validExitNormal = false;
+    }
+  }
+  newSafety = ourSafety;
+  return ourStep;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool BoxNavigation::LevelLocate(G4NavigationHistory& history,
+                                  const G4VPhysicalVolume* blockedVol,
+                                  const G4int blockedNum,
+                                  const G4ThreeVector& globalPoint,
+                                  const G4ThreeVector* globalDirection,
+                                  const G4bool pLocatedOnEdge,
+                                  G4ThreeVector& localPoint)
+{
+  return fNormal.LevelLocate(history, blockedVol, blockedNum, globalPoint,
+                             globalDirection, pLocatedOnEdge, localPoint);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double BoxNavigation::ComputeSafety(const G4ThreeVector& localPoint,
+                                      const G4NavigationHistory& history,
+                                      const G4double pMaxLength)
+{
+  const Volume& vol = GetVolume(history.GetTopVolume()->GetLogicalVolume());
+  if (!vol.fBoxes) return fNormal.ComputeSafety(localPoint, history, pMaxLength);
+
+  const G4double px = localPoint.x(), py = localPoint.y(), pz = localPoint.z();
+  G4double safety = std::min(std::min(vol.fHalf[0] - std::fabs(px),
+                                      vol.fHalf[1] - std::fabs(py)),
+                             vol.fHalf[2] - std::fabs(pz));
+  const std::size_t n = vol.fDaughter.size();
+  for (std::size_t d = 0; d < n; ++d) {
+    const G4double s = std::max(std::max(std::fabs(px - vol.fX[d]) - vol.fDx[d],
+                                         std::fabs(py - vol.fY[d]) - vol.fDy[d]),
+                                std::fabs(pz - vol.fZ[d]) - vol.fDz[d]);
+    safety = std::min(safety, s);
+  }
+  return std::max(safety, 0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
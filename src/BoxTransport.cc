@@ -0,0 +1,741 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file BoxTransport.cc
+/// \brief Implementation of the BoxTransport class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "BoxTransport.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Box.hh"
+#include "G4Sphere.hh"
+#include "G4Tubs.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4Neutron.hh"
+#include "G4HadronicProcessStore.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+#include "G4Timer.hh"
+#include "G4UnitsTable.hh"
+#include "Randomize.hh"
+#include "CLHEP/Random/MixMaxRng.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iomanip>
+#include <thread>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // energy range of the tables; below and above, the end points are used
+  const G4double kEmin = 1.e-5*eV;
+  const G4double kEmax = 20.*MeV;
+
+  // step past a boundary, so that the particle is located in the volume
+  // it enters
+  const G4double kPush = 1.e-6*mm;
+
+  // a neutron still alive after this many collisions is counted as lost
+  const G4int kMaxCollisions = 100000;
+
+  // 1/u, finite for u = 0
+  inline G4double Inverse(G4double u)
+  {
+    return 1./(u != 0. ? u : 1.e-300);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BoxTransport* BoxTransport::Instance()
+{
+  static BoxTransport instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BoxTransport::BoxTransport()
+: fBatchSize(4096), fPointsPerDecade(1000),
+  fNbThreads(G4Threading::G4GetNumberOfCores()), fEnergy(2.5*MeV),
+  fJobSeed(0), fRoom(-1), fSlab(-1), fTank(-1), fPoly(-1), fProbe(-1),
+  fDetector(-1), fNbPoints(0), fTablesPerDecade(0), fLogEmin(0.),
+  fInvDelta(0.), fRefHistories(0), fRefWallTime(0.)
+{
+  for (G4int i=0; i<3; i++) fSource[i] = 0.;
+  for (G4int k=0; k<Run::kNbTally; k++) fRefMean[k] = fRefError[k] = 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransport::Particles::Resize(G4int n)
+{
+  fX.resize(n); fY.resize(n); fZ.resize(n);
+  fU.resize(n); fV.resize(n); fW.resize(n); fE.resize(n);
+  fSigma.resize(n); fRandom.resize(n); fCollision.resize(n);
+  fBoundary.resize(n);
+  fCell.resize(n); fNewCell.resize(n); fMaterial.resize(n);
+  fHistory.resize(n); fCollisions.resize(n);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransport::Particles::Move(G4int i, G4int j)
+{
+  fX[j] = fX[i]; fY[j] = fY[i]; fZ[j] = fZ[i];
+  fU[j] = fU[i]; fV[j] = fV[i]; fW[j] = fW[i]; fE[j] = fE[i];
+  fCell[j] = fCell[i]; fMaterial[j] = fMaterial[i];
+  fHistory[j] = fHistory[i]; fCollisions[j] = fCollisions[i];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransport::SetReference(const Run::Moments* tallies,
+                                G4int nbHistories, G4double wallTime)
+{
+  fRefHistories = nbHistories;
+  fRefWallTime  = wallTime;
+  for (G4int k=0; k<Run::kNbTally; k++) {
+    G4double vov;
+    Run::Statistics(tallies[k], nbHistories, fRefMean[k], fRefError[k], vov);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransport::Print() const
+{
+  G4cout << "\n Box transport engine: batches of " << fBatchSize << ", "
+         << fNbThreads << " threads, " << fPointsPerDecade
+         << " energy points per decade, source "
+         << G4BestUnit(fEnergy, "Energy") << G4endl;
+  if (fVolumes.empty()) {
+    G4cout << "  no geometry model yet (built at the first beamOn)"
+           << G4endl;
+    return;
+  }
+  const char* shapes[3] = { "box", "sphere", "tube" };
+  for (std::size_t v=0; v<fVolumes.size(); v++) {
+    const Volume& vol = fVolumes[v];
+    G4cout << "  " << std::string(2*vol.fDepth, ' ') << vol.fName << " : "
+           << shapes[vol.fShape] << " of "
+           << fMaterials[vol.fMaterial].fMaterial->GetName() << " at ("
+           << vol.fCentre[0]/cm << ", " << vol.fCentre[1]/cm << ", "
+           << vol.fCentre[2]/cm << ") cm" << G4endl;
+  }
+  G4cout << "  " << fMaterials.size() << " materials tabulated on "
+         << fNbPoints << " points" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool BoxTransport::BuildGeometry(DetectorConstruction* det)
+{
+  fVolumes.clear();
+  G4double origin[3] = { 0., 0., 0. };
+  if (!AddVolume(det->GetWorld(), origin, 0)) {
+    fVolumes.clear();
+    return false;
+  }
+
+  // the volumes of the tallies
+  fRoom = fSlab = fTank = fPoly = fProbe = fDetector = -1;
+  for (std::size_t v=0; v<fVolumes.size(); v++) {
+    const G4LogicalVolume* logical = fVolumes[v].fLogical;
+    if (logical == det->roomL)     fRoom     = v;
+    if (logical == det->slabL)     fSlab     = v;
+    if (logical == det->tankL)     fTank     = v;
+    if (logical == det->polyL)     fPoly     = v;
+    if (logical == det->probePeL)  fProbe    = v;
+    if (logical == det->detectorL) fDetector = v;
+  }
+
+  fSource[0] = det->GetSrcX();
+  fSource[1] = det->GetSrcY();
+  fSource[2] = det->GetSrcZ();
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool BoxTransport::AddVolume(const G4VPhysicalVolume* physical,
+                               const G4double* origin, G4int depth)
+{
+  // volumes are kept in the order of a depth-first walk, so that the
+  // last volume containing a point is the deepest one
+  const G4LogicalVolume* logical = physical->GetLogicalVolume();
+  const G4RotationMatrix* rotation = physical->GetRotation();
+  if (physical->IsReplicated() || (rotation && !rotation->isIdentity())) {
+    G4cout << "\n--> warning from BoxTransport : " << physical->GetName()
+           << " is replicated or rotated" << G4endl;
+    return false;
+  }
+
+  Volume volume;
+  volume.fLogical  = logical;
+  volume.fName     = physical->GetName();
+  volume.fDepth    = depth;
+  volume.fMaterial = MaterialIndex(logical->GetMaterial());
+  G4ThreeVector translation = physical->GetTranslation();
+  for (G4int i=0; i<3; i++) volume.fCentre[i] = origin[i] + translation[i];
+  for (G4int i=0; i<3; i++) volume.fHalf[i] = 0.;
+
+  G4VSolid* solid = logical->GetSolid();
+  const G4Box* box = dynamic_cast<const G4Box*>(solid);
+  const G4Sphere* sphere = dynamic_cast<const G4Sphere*>(solid);
+  const G4Tubs* tubs = dynamic_cast<const G4Tubs*>(solid);
+  if (box) {
+    volume.fShape   = kBox;
+    volume.fHalf[0] = box->GetXHalfLength();
+    volume.fHalf[1] = box->GetYHalfLength();
+    volume.fHalf[2] = box->GetZHalfLength();
+  } else if (sphere && sphere->GetInnerRadius() == 0. &&
+             sphere->GetDeltaPhiAngle() >= twopi &&
+             sphere->GetDeltaThetaAngle() >= pi) {
+    volume.fShape   = kSphere;
+    volume.fHalf[0] = sphere->GetOuterRadius();
+  } else if (tubs && tubs->GetInnerRadius() == 0. &&
+             tubs->GetDeltaPhiAngle() >= twopi) {
+    volume.fShape   = kTube;
+    volume.fHalf[0] = tubs->GetOuterRadius();
+    volume.fHalf[2] = tubs->GetZHalfLength();
+  } else {
+    G4cout << "\n--> warning from BoxTransport : the solid of "
+           << physical->GetName() << " is not a box, a full sphere or a"
+           << " full tube" << G4endl;
+    return false;
+  }
+  fVolumes.push_back(volume);
+
+  G4double centre[3] = { volume.fCentre[0], volume.fCentre[1],
+                         volume.fCentre[2] };
+  for (std::size_t d=0; d<logical->GetNoDaughters(); d++) {
+    if (!AddVolume(logical->GetDaughter(d), centre, depth+1)) return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int BoxTransport::MaterialIndex(const G4Material* material)
+{
+  for (std::size_t m=0; m<fMaterials.size(); m++)
+    if (fMaterials[m].fMaterial == material) return m;
+  Material table;
+  table.fMaterial = material;
+  table.fNbPairs  = material->GetNumberOfElements()*kNbChannels;
+  fMaterials.push_back(table);
+  return fMaterials.size() - 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransport::BuildTables()
+{
+  // a new grid: every material is tabulated again
+  if (fTablesPerDecade != fPointsPerDecade) {
+    for (std::size_t m=0; m<fMaterials.size(); m++)
+      fMaterials[m].fCumul.clear();
+    fTablesPerDecade = fPointsPerDecade;
+    fNbPoints = G4int(std::ceil(std::log10(kEmax/kEmin)*fPointsPerDecade)) + 1;
+    fLogEmin  = std::log(kEmin);
+    fInvDelta = (fNbPoints - 1)/std::log(kEmax/kEmin);
+  }
+
+  G4Timer timer;
+  timer.Start();
+  G4int nbBuilt = 0;
+  G4HadronicProcessStore* store = G4HadronicProcessStore::Instance();
+  const G4ParticleDefinition* neutron = G4Neutron::Neutron();
+  for (std::size_t m=0; m<fMaterials.size(); m++) {
+    Material& table = fMaterials[m];
+    if (!table.fCumul.empty()) continue;
+    const G4Material* material = table.fMaterial;
+    const G4double* atoms = material->GetVecNbOfAtomsPerVolume();
+    G4int nbElements = material->GetNumberOfElements();
+    table.fMass.clear();
+    table.fKT.clear();
+    for (G4int k=0; k<nbElements; k++) {
+      table.fMass.push_back(material->GetElement(k)->GetAtomicMassAmu()
+                            *amu_c2/neutron_mass_c2);
+      table.fKT.push_back(k_Boltzmann*material->GetTemperature());
+    }
+    table.fCumul.resize(fNbPoints*table.fNbPairs);
+    for (G4int i=0; i<fNbPoints; i++) {
+      G4double e = std::exp(fLogEmin + i/fInvDelta);
+      G4double sum = 0.;
+      G4double* cumul = &table.fCumul[i*table.fNbPairs];
+      for (G4int k=0; k<nbElements; k++) {
+        const G4Element* element = material->GetElement(k);
+        G4double xs[kNbChannels];
+        xs[kElastic] =
+          store->GetElasticCrossSectionPerAtom(neutron, e, element, material);
+        xs[kCapture] =
+          store->GetCaptureCrossSectionPerAtom(neutron, e, element, material)
+        + store->GetFissionCrossSectionPerAtom(neutron, e, element, material);
+        xs[kInelastic] =
+          store->GetInelasticCrossSectionPerAtom(neutron, e, element,
+                                                 material);
+        for (G4int c=0; c<kNbChannels; c++) {
+          sum += atoms[k]*xs[c];
+          cumul[k*kNbChannels + c] = sum;
+        }
+      }
+    }
+    nbBuilt++;
+  }
+
+  // the total cross sections of all materials in one array
+  fTotal.resize(fMaterials.size()*fNbPoints);
+  for (std::size_t m=0; m<fMaterials.size(); m++) {
+    const Material& table = fMaterials[m];
+    for (G4int i=0; i<fNbPoints; i++)
+      fTotal[m*fNbPoints + i] = table.fCumul[(i+1)*table.fNbPairs - 1];
+  }
+  timer.Stop();
+  if (nbBuilt > 0) {
+    G4cout << "\n Box transport: cross sections of " << nbBuilt
+           << " materials tabulated on " << fNbPoints << " points in "
+           << timer.GetRealElapsed() << " s" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransport::CrossSectionKernel(Particles& p, G4int n) const
+{
+  // linear interpolation in log(E) on the uniform grid
+  const G4double* total = &fTotal[0];
+  const G4double last = fNbPoints - 1.000001;
+  for (G4int i=0; i<n; i++) {
+    G4double x = (std::log(p.fE[i]) - fLogEmin)*fInvDelta;
+    x = std::min(std::max(x, 0.), last);
+    G4int j = G4int(x);
+    G4double f = x - j;
+    const G4double* t = total + p.fMaterial[i]*fNbPoints + j;
+    p.fSigma[i] = (1. - f)*t[0] + f*t[1];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransport::BoundaryKernel(Particles& p, G4int n) const
+{
+  // the volumes are nested or apart: the next surface of any of them
+  // along the flight is the next boundary. Per volume and particle, the
+  // entry and exit distances tNear, tFar of the ray; the next crossing is
+  // tNear if ahead, else tFar if ahead, none if the ray misses.
+  G4double* boundary = &p.fBoundary[0];
+  for (G4int i=0; i<n; i++) boundary[i] = DBL_MAX;
+
+  for (std::size_t v=0; v<fVolumes.size(); v++) {
+    const Volume& vol = fVolumes[v];
+    const G4double cx = vol.fCentre[0], cy = vol.fCentre[1],
+                   cz = vol.fCentre[2];
+    const G4double hx = vol.fHalf[0], hy = vol.fHalf[1], hz = vol.fHalf[2];
+
+    if (vol.fShape == kBox) {
+      for (G4int i=0; i<n; i++) {
+        G4double ix = Inverse(p.fU[i]), iy = Inverse(p.fV[i]),
+                 iz = Inverse(p.fW[i]);
+        G4double dx = cx - p.fX[i], dy = cy - p.fY[i], dz = cz - p.fZ[i];
+        G4double x1 = (dx - hx)*ix, x2 = (dx + hx)*ix;
+        G4double y1 = (dy - hy)*iy, y2 = (dy + hy)*iy;
+        G4double z1 = (dz - hz)*iz, z2 = (dz + hz)*iz;
+        G4double tNear = std::max(std::max(std::min(x1, x2), std::min(y1, y2)),
+                                  std::min(z1, z2));
+        G4double tFar  = std::min(std::min(std::max(x1, x2), std::max(y1, y2)),
+                                  std::max(z1, z2));
+        G4double t = tNear > 0. ? tNear : tFar;
+        t = ((tNear <= tFar) & (t > 0.)) ? t : DBL_MAX;
+        boundary[i] = std::min(boundary[i], t);
+      }
+    } else if (vol.fShape == kSphere) {
+      const G4double r2 = hx*hx;
+      for (G4int i=0; i<n; i++) {
+        G4double dx = p.fX[i] - cx, dy = p.fY[i] - cy, dz = p.fZ[i] - cz;
+        G4double b = dx*p.fU[i] + dy*p.fV[i] + dz*p.fW[i];
+        G4double c = dx*dx + dy*dy + dz*dz - r2;
+        G4double disc = b*b - c;
+        G4double s = std::sqrt(std::max(disc, 0.));
+        G4double tIn = -b - s, tOut = -b + s;
+        G4double t = tIn > 0. ? tIn : tOut;
+        t = ((disc > 0.) & (t > 0.)) ? t : DBL_MAX;
+        boundary[i] = std::min(boundary[i], t);
+      }
+    } else {
+      const G4double r2 = hx*hx;
+      for (G4int i=0; i<n; i++) {
+        G4double dx = p.fX[i] - cx, dy = p.fY[i] - cy, dz = p.fZ[i] - cz;
+        // radial interval; parallel to the axis: all or nothing
+        G4double a = p.fU[i]*p.fU[i] + p.fV[i]*p.fV[i];
+        G4double b = dx*p.fU[i] + dy*p.fV[i];
+        G4double c = dx*dx + dy*dy - r2;
+        G4double disc = b*b - a*c;
+        G4double s = std::sqrt(std::max(disc, 0.));
+        G4double ia = 1./std::max(a, 1.e-300);
+        G4double tIn = (-b - s)*ia, tOut = (-b + s)*ia;
+        G4bool   radial = (a > 1.e-12), hit = (disc > 0.), in = (c < 0.);
+        G4double rIn  = radial ? (hit ? tIn  :  DBL_MAX)
+                               : (in  ? -DBL_MAX :  DBL_MAX);
+        G4double rOut = radial ? (hit ? tOut : -DBL_MAX)
+                               : (in  ?  DBL_MAX : -DBL_MAX);
+        // axial interval
+        G4double iz = Inverse(p.fW[i]);
+        G4double z1 = (-dz - hz)*iz, z2 = (-dz + hz)*iz;
+        G4double tNear = std::max(rIn, std::min(z1, z2));
+        G4double tFar  = std::min(rOut, std::max(z1, z2));
+        G4double t = tNear > 0. ? tNear : tFar;
+        t = ((tNear <= tFar) & (t > 0.)) ? t : DBL_MAX;
+        boundary[i] = std::min(boundary[i], t);
+      }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransport::LocateKernel(Particles& p, G4int n) const
+{
+  // the last volume (in depth-first order) containing the point; -1 if
+  // out of the world
+  G4int* cell = &p.fNewCell[0];
+  for (G4int i=0; i<n; i++) cell[i] = -1;
+
+  for (std::size_t v=0; v<fVolumes.size(); v++) {
+    const Volume& vol = fVolumes[v];
+    const G4int index = v;
+    const G4double cx = vol.fCentre[0], cy = vol.fCentre[1],
+                   cz = vol.fCentre[2];
+    const G4double hx = vol.fHalf[0], hy = vol.fHalf[1], hz = vol.fHalf[2];
+
+    if (vol.fShape == kBox) {
+      for (G4int i=0; i<n; i++) {
+        G4bool inside = (std::fabs(p.fX[i] - cx) <= hx)
+                      & (std::fabs(p.fY[i] - cy) <= hy)
+                      & (std::fabs(p.fZ[i] - cz) <= hz);
+        cell[i] = inside ? index : cell[i];
+      }
+    } else if (vol.fShape == kSphere) {
+      const G4double r2 = hx*hx;
+      for (G4int i=0; i<n; i++) {
+        G4double dx = p.fX[i] - cx, dy = p.fY[i] - cy, dz = p.fZ[i] - cz;
+        G4bool inside = (dx*dx + dy*dy + dz*dz <= r2);
+        cell[i] = inside ? index : cell[i];
+      }
+    } else {
+      const G4double r2 = hx*hx;
+      for (G4int i=0; i<n; i++) {
+        G4double dx = p.fX[i] - cx, dy = p.fY[i] - cy;
+        G4bool inside = (dx*dx + dy*dy <= r2)
+                      & (std::fabs(p.fZ[i] - cz) <= hz);
+        cell[i] = inside ? index : cell[i];
+      }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool BoxTransport::Collide(Particles& p, G4int i,
+                             CLHEP::HepRandomEngine& rng,
+                             G4double* scores) const
+{
+  // element and channel, from the cumulated partial cross sections
+  const Material& table = fMaterials[p.fMaterial[i]];
+  const G4int nbPairs = table.fNbPairs;
+  G4double x = (std::log(p.fE[i]) - fLogEmin)*fInvDelta;
+  x = std::min(std::max(x, 0.), fNbPoints - 1.000001);
+  G4int j = G4int(x);
+  G4double f = x - j;
+  const G4double* c0 = &table.fCumul[j*nbPairs];
+  const G4double* c1 = c0 + nbPairs;
+  G4double target = rng.flat()*p.fSigma[i];
+  G4int pair = nbPairs - 1;
+  for (G4int q=0; q<nbPairs; q++) {
+    if ((1. - f)*c0[q] + f*c1[q] > target) { pair = q; break; }
+  }
+  G4int element = pair/kNbChannels, channel = pair % kNbChannels;
+
+  G4int cell = p.fCell[i];
+  if (channel == kCapture) {
+    if (cell == fDetector) scores[Run::kCaptureDetector] += 1.;
+    if (cell == fTank)     scores[Run::kCaptureTank]     += 1.;
+    if (cell == fPoly)     scores[Run::kCapturePoly]     += 1.;
+    return true;
+  }
+  if (channel == kInelastic) {
+    if (cell == fDetector) scores[Run::kInelasticDetector] += 1.;
+    return true;
+  }
+
+  // elastic scattering, isotropic in the centre of mass; velocities in
+  // units of the square root of the energy of a neutron
+  G4double mass = table.fMass[element], kT = table.fKT[element];
+  G4double energy = p.fE[i];
+  G4ThreeVector direction(p.fU[i], p.fV[i], p.fW[i]);
+  G4ThreeVector vNeutron = std::sqrt(energy)*direction;
+  G4ThreeVector vTarget;
+  if (energy < 400.*kT) {
+    // free-gas target: Maxwellian speed weighted by the relative speed
+    G4double betaN = std::sqrt(mass*energy/kT);
+    G4double alpha = 1./(1. + 0.5*std::sqrt(pi)*betaN);
+    G4double betaT, mu;
+    do {
+      if (rng.flat() < alpha) {
+        betaT = std::sqrt(-std::log(rng.flat()*rng.flat()));
+      } else {
+        G4double c = std::cos(halfpi*rng.flat());
+        betaT = std::sqrt(-std::log(rng.flat()) - std::log(rng.flat())*c*c);
+      }
+      mu = 2.*rng.flat() - 1.;
+    } while (rng.flat()*(betaN + betaT) >
+             std::sqrt(betaN*betaN + betaT*betaT - 2.*betaN*betaT*mu));
+    G4double phi = twopi*rng.flat(), sinTheta = std::sqrt(1. - mu*mu);
+    G4ThreeVector d(sinTheta*std::cos(phi), sinTheta*std::sin(phi), mu);
+    d.rotateUz(direction);
+    vTarget = betaT*std::sqrt(kT/mass)*d;
+  }
+  G4ThreeVector vCM = (vNeutron + mass*vTarget)/(1. + mass);
+  G4double speed = (vNeutron - vCM).mag();
+  G4double cosTheta = 2.*rng.flat() - 1., phi = twopi*rng.flat();
+  G4double sinTheta = std::sqrt(1. - cosTheta*cosTheta);
+  G4ThreeVector vOut = vCM + speed*G4ThreeVector(sinTheta*std::cos(phi),
+                                           sinTheta*std::sin(phi), cosTheta);
+  p.fE[i] = vOut.mag2();
+  vOut = vOut.unit();
+  p.fU[i] = vOut.x(); p.fV[i] = vOut.y(); p.fW[i] = vOut.z();
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransport::TransportBatch(G4int n, CLHEP::HepRandomEngine& rng,
+                                  Counters& counters) const
+{
+  Particles p;
+  p.Resize(n);
+  std::vector<G4double> scores(n*Run::kNbTally, 0.);
+
+  // isotropic source at the DD head
+  for (G4int i=0; i<n; i++) {
+    G4double cosTheta = 2.*rng.flat() - 1., phi = twopi*rng.flat();
+    G4double sinTheta = std::sqrt(1. - cosTheta*cosTheta);
+    p.fX[i] = fSource[0]; p.fY[i] = fSource[1]; p.fZ[i] = fSource[2];
+    p.fU[i] = sinTheta*std::cos(phi);
+    p.fV[i] = sinTheta*std::sin(phi);
+    p.fW[i] = cosTheta;
+    p.fE[i] = fEnergy;
+    p.fHistory[i] = i;
+    p.fCollisions[i] = 0;
+  }
+  LocateKernel(p, n);
+  G4int alive = 0;
+  for (G4int i=0; i<n; i++) {
+    if (p.fNewCell[i] < 0) continue;
+    p.Move(i, alive);
+    p.fCell[alive] = p.fNewCell[i];
+    p.fMaterial[alive] = fVolumes[p.fNewCell[i]].fMaterial;
+    alive++;
+  }
+
+  while (alive > 0) {
+    // distances to the next collision and to the next boundary
+    CrossSectionKernel(p, alive);
+    rng.flatArray(alive, &p.fRandom[0]);
+    for (G4int i=0; i<alive; i++)
+      p.fCollision[i] = -std::log(p.fRandom[i])/std::max(p.fSigma[i], DBL_MIN);
+    BoundaryKernel(p, alive);
+
+    // flight to the collision, or just past the boundary
+    for (G4int i=0; i<alive; i++) {
+      G4bool collide = p.fCollision[i] < p.fBoundary[i];
+      G4double s = collide ? p.fCollision[i] : p.fBoundary[i] + kPush;
+      p.fX[i] += s*p.fU[i];
+      p.fY[i] += s*p.fV[i];
+      p.fZ[i] += s*p.fW[i];
+    }
+    LocateKernel(p, alive);
+    counters.fSteps += alive;
+
+    // collisions and crossings, then compaction of the survivors
+    G4int kept = 0;
+    for (G4int i=0; i<alive; i++) {
+      G4double* score = &scores[p.fHistory[i]*Run::kNbTally];
+      G4bool dead = false;
+      if (p.fCollision[i] < p.fBoundary[i]) {
+        dead = Collide(p, i, rng, score);
+        counters.fCollisions++;
+        if (!dead && ++p.fCollisions[i] > kMaxCollisions) {
+          dead = true;
+          counters.fLost++;
+        }
+      } else {
+        G4int from = p.fCell[i], to = p.fNewCell[i];
+        if (from == fTank && to == fRoom)
+          score[Run::kNeutronTankExit] += 1.;
+        if (from == fSlab && to == fRoom)
+          score[Run::kNeutronSlabExit] += 1.;
+        if (from == fProbe && to == fDetector)
+          score[Run::kNeutronProbe] += 1.;
+        dead = (to < 0);
+        if (!dead) {
+          p.fCell[i] = to;
+          p.fMaterial[i] = fVolumes[to].fMaterial;
+        }
+      }
+      if (!dead) p.Move(i, kept++);
+    }
+    alive = kept;
+  }
+
+  for (G4int h=0; h<n; h++) {
+    for (G4int k=0; k<Run::kNbTally; k++) {
+      G4double score = scores[h*Run::kNbTally + k];
+      if (score != 0.) counters.fTally[k].Add(score);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransport::TransportRange(G4int firstBatch, G4int lastBatch,
+                                  G4int nbHistories, Counters* counters) const
+{
+  // one engine per batch, seeded from the job seed and the batch number:
+  // the results do not depend on the number of threads
+  for (G4int b=firstBatch; b<lastBatch; b++) {
+    G4int first = b*fBatchSize;
+    G4int n = std::min(fBatchSize, nbHistories - first);
+    CLHEP::MixMaxRng rng(fJobSeed + b);
+    TransportBatch(n, rng, *counters);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransport::BeamOn(DetectorConstruction* det, G4int nbHistories)
+{
+  if (nbHistories <= 0 || fBatchSize <= 0) return;
+  if (!BuildGeometry(det)) {
+    G4cout << "\n--> warning from BoxTransport : the geometry cannot be"
+           << " modelled, no transport" << G4endl;
+    return;
+  }
+  BuildTables();
+  fJobSeed = G4long(G4UniformRand()*1.e9)*1000000;
+
+  G4int nbBatches = (nbHistories + fBatchSize - 1)/fBatchSize;
+  G4int nbThreads = std::max(1, std::min(fNbThreads, nbBatches));
+  std::vector<Counters> counters(nbThreads);
+
+  G4Timer timer;
+  timer.Start();
+  std::vector<std::thread> threads;
+  for (G4int t=0; t<nbThreads; t++) {
+    G4int first = nbBatches*t/nbThreads, last = nbBatches*(t+1)/nbThreads;
+    threads.push_back(std::thread(&BoxTransport::TransportRange, this,
+                                  first, last, nbHistories, &counters[t]));
+  }
+  for (std::size_t t=0; t<threads.size(); t++) threads[t].join();
+  timer.Stop();
+
+  for (G4int t=1; t<nbThreads; t++) {
+    counters[0].fSteps      += counters[t].fSteps;
+    counters[0].fCollisions += counters[t].fCollisions;
+    counters[0].fLost       += counters[t].fLost;
+    for (G4int k=0; k<Run::kNbTally; k++)
+      counters[0].fTally[k].Add(counters[t].fTally[k]);
+  }
+  Report(counters[0], nbHistories, timer.GetRealElapsed(), nbThreads);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransport::Report(const Counters& counters, G4int nbHistories,
+                          G4double time, G4int nbThreads) const
+{
+  G4double n = nbHistories;
+  G4cout << "\n Box transport engine: " << nbHistories << " histories in "
+         << time << " s (" << (time > 0. ? n/time : 0.)
+         << " histories/s, " << nbThreads << " threads, batches of "
+         << fBatchSize << ")\n  " << counters.fSteps/n << " flights and "
+         << counters.fCollisions/n << " collisions per history";
+  if (counters.fLost > 0.)
+    G4cout << ", " << counters.fLost << " neutrons lost after "
+           << kMaxCollisions << " collisions";
+  G4cout << G4endl;
+
+  G4bool reference = (fRefHistories > 0);
+  if (reference)
+    G4cout << "  against the last Geant4 run, " << fRefHistories
+           << " histories in " << fRefWallTime << " s" << G4endl;
+  else
+    G4cout << "  (no Geant4 run to compare with)" << G4endl;
+
+  G4cout << "  " << std::setw(13) << "tally"
+         << std::setw(13) << "mean" << std::setw(10) << "R[%]";
+  if (reference)
+    G4cout << std::setw(13) << "Geant4" << std::setw(10) << "R[%]"
+           << std::setw(10) << "diff/sd" << std::setw(12) << "FOM ratio";
+  G4cout << G4endl;
+
+  for (G4int k=0; k<Run::kNbTally; k++) {
+    if (k == Run::kGammaTankExit || k == Run::kGammaSlabExit) {
+      G4cout << "  " << std::setw(13) << Run::TallyName(k)
+             << "  n/a (neutrons only)" << G4endl;
+      continue;
+    }
+    G4double mean, relErr, vov;
+    Run::Statistics(counters.fTally[k], nbHistories, mean, relErr, vov);
+    G4cout << "  " << std::setw(13) << Run::TallyName(k)
+           << std::setw(13) << mean << std::setw(10) << 100*relErr;
+    if (reference) {
+      G4double sd = std::sqrt(mean*relErr*mean*relErr
+                      + fRefMean[k]*fRefError[k]*fRefMean[k]*fRefError[k]);
+      G4double diff = sd > 0. ? (mean - fRefMean[k])/sd : 0.;
+      // (1/R^2 T) of the engine over that of Geant4
+      G4double fom = (relErr > 0. && time > 0. && fRefError[k] > 0.)
+        ? fRefError[k]*fRefError[k]*fRefWallTime/(relErr*relErr*time) : 0.;
+      G4cout << std::setw(13) << fRefMean[k]
+             << std::setw(10) << 100*fRefError[k]
+             << std::setw(10) << diff << std::setw(12) << fom;
+    }
+    G4cout << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,139 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file BoxTransportMessenger.cc
+/// \brief Implementation of the BoxTransportMessenger class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "BoxTransportMessenger.hh"
+
+#include "BoxTransport.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BoxTransportMessenger::BoxTransportMessenger(DetectorConstruction* det)
+:G4UImessenger(), fDetector(det),
+ fBoxDir(0), fBatchCmd(0), fPointsCmd(0), fThreadsCmd(0), fEnergyCmd(0),
+ fBeamOnCmd(0), fPrintCmd(0)
+{ 
+  // the engine runs on the master, so these commands are executed by the
+  // master only
+  fBoxDir = new G4UIdirectory("/testhadr/boxTransport/");
+  fBoxDir->SetGuidance("standalone neutron transport in the box geometry");
+
+  fBatchCmd = new G4UIcmdWithAnInteger("/testhadr/boxTransport/batch",this);
+  fBatchCmd->SetGuidance("number of histories transported together");
+  fBatchCmd->SetParameterName("size",false);
+  fBatchCmd->SetRange("size>0");
+  fBatchCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fBatchCmd->SetToBeBroadcasted(false);
+
+  fPointsCmd =
+    new G4UIcmdWithAnInteger("/testhadr/boxTransport/pointsPerDecade",this);
+  fPointsCmd->SetGuidance("energy points per decade of the cross sections");
+  fPointsCmd->SetParameterName("points",false);
+  fPointsCmd->SetRange("points>0");
+  fPointsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPointsCmd->SetToBeBroadcasted(false);
+
+  fThreadsCmd = new G4UIcmdWithAnInteger("/testhadr/boxTransport/threads",this);
+  fThreadsCmd->SetGuidance("number of threads of the engine");
+  fThreadsCmd->SetParameterName("threads",false);
+  fThreadsCmd->SetRange("threads>0");
+  fThreadsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fThreadsCmd->SetToBeBroadcasted(false);
+
+  fEnergyCmd =
+    new G4UIcmdWithADoubleAndUnit("/testhadr/boxTransport/energy",this);
+  fEnergyCmd->SetGuidance("energy of the isotropic source at the DD head");
+  fEnergyCmd->SetParameterName("energy",false);
+  fEnergyCmd->SetRange("energy>0.");
+  fEnergyCmd->SetUnitCategory("Energy");
+  fEnergyCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fEnergyCmd->SetToBeBroadcasted(false);
+
+  fBeamOnCmd = new G4UIcmdWithAnInteger("/testhadr/boxTransport/beamOn",this);
+  fBeamOnCmd->SetGuidance("transport histories with the engine and compare");
+  fBeamOnCmd->SetGuidance("the tallies to those of the last Geant4 run");
+  fBeamOnCmd->SetParameterName("nbHistories",false);
+  fBeamOnCmd->SetRange("nbHistories>0");
+  fBeamOnCmd->AvailableForStates(G4State_Idle);
+  fBeamOnCmd->SetToBeBroadcasted(false);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/testhadr/boxTransport/print",this);
+  fPrintCmd->SetGuidance("print the settings and the geometry model");
+  fPrintCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPrintCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BoxTransportMessenger::~BoxTransportMessenger()
+{
+  delete fBatchCmd;
+  delete fPointsCmd;
+  delete fThreadsCmd;
+  delete fEnergyCmd;
+  delete fBeamOnCmd;
+  delete fPrintCmd;
+  delete fBoxDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BoxTransportMessenger::SetNewValue(G4UIcommand* command,
+                                        G4String newValue)
+{   
+  BoxTransport* engine = BoxTransport::Instance();
+
+  if (command == fBatchCmd)
+   {engine->SetBatchSize(fBatchCmd->GetNewIntValue(newValue));}
+
+  if (command == fPointsCmd)
+   {engine->SetPointsPerDecade(fPointsCmd->GetNewIntValue(newValue));}
+
+  if (command == fThreadsCmd)
+   {engine->SetNbThreads(fThreadsCmd->GetNewIntValue(newValue));}
+
+  if (command == fEnergyCmd)
+   {engine->SetEnergy(fEnergyCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fBeamOnCmd)
+   {engine->BeamOn(fDetector, fBeamOnCmd->GetNewIntValue(newValue));}
+
+  if (command == fPrintCmd)
+   {engine->Print();}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,119 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CondensedSource.cc
+/// \brief Implementation of the CondensedSource class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "CondensedSource.hh"
+#include "SourceTerm.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CondensedSource* CondensedSource::Instance()
+{
+  static CondensedSource instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CondensedSource::CondensedSource()
+: fSource(0), fUse(false)
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CondensedSource::~CondensedSource()
+{
+  delete fSource;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CondensedSource::SetRecordFile(const G4String& fileName)
+{
+  fRecordFile = (fileName == "none") ? G4String() : fileName;
+  if (IsRecording() && fUse) {
+    G4cout << "\n--> warning from CondensedSource : recording the leakage"
+           << " of the DD source, the condensed source is not used" << G4endl;
+    fUse = false;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool CondensedSource::Load(const G4String& fileName)
+{
+  SourceTerm* source = new SourceTerm();
+  if (!source->Read(fileName)) {
+    delete source;
+    return false;
+  }
+  delete fSource;
+  fSource = source;
+  fLoadedFile = fileName;
+  SetUse(true);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CondensedSource::SetUse(G4bool use)
+{
+  if (use && !fSource) {
+    G4cout << "\n--> warning from CondensedSource : no source term loaded"
+           << G4endl;
+    use = false;
+  }
+  if (use && IsRecording()) {
+    G4cout << "\n--> warning from CondensedSource : the condensed source"
+           << " cannot be used while recording it" << G4endl;
+    use = false;
+  }
+  fUse = use;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CondensedSource::Print() const
+{
+  G4cout << "\n Condensed source term: recording "
+         << (IsRecording() ? fRecordFile : G4String("off"));
+  if (!fSource) {
+    G4cout << ", none loaded" << G4endl;
+    return;
+  }
+  G4cout << ", " << fLoadedFile << (fUse ? " in use" : " not used")
+         << G4endl;
+  fSource->Print();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
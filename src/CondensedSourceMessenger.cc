@@ -0,0 +1,113 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CondensedSourceMessenger.cc
+/// \brief Implementation of the CondensedSourceMessenger class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "CondensedSourceMessenger.hh"
+
+#include "CondensedSource.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CondensedSourceMessenger::CondensedSourceMessenger()
+:G4UImessenger(),
+ fSourceDir(0), fRecordCmd(0), fLoadCmd(0), fUseCmd(0), fPrintCmd(0)
+{ 
+  // the source term is shared by all threads, so these commands are
+  // executed by the master only
+  fSourceDir = new G4UIdirectory("/testhadr/source/");
+  fSourceDir->SetGuidance("condensed source term of the shielded DD source");
+   
+  fRecordCmd = new G4UIcmdWithAString("/testhadr/source/record",this);
+  fRecordCmd->SetGuidance("record the leakage through the B-poly surface");
+  fRecordCmd->SetGuidance("in the next runs and write it to a file,");
+  fRecordCmd->SetGuidance("the leaking particles are stopped there (none: off)");
+  fRecordCmd->SetParameterName("fileName",false);
+  fRecordCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fRecordCmd->SetToBeBroadcasted(false);
+
+  fLoadCmd = new G4UIcmdWithAString("/testhadr/source/load",this);
+  fLoadCmd->SetGuidance("load a recorded source term and use it");
+  fLoadCmd->SetParameterName("fileName",false);
+  fLoadCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fLoadCmd->SetToBeBroadcasted(false);
+
+  fUseCmd = new G4UIcmdWithABool("/testhadr/source/use",this);
+  fUseCmd->SetGuidance("sample the loaded source term instead of the DD head");
+  fUseCmd->SetParameterName("flag",true);
+  fUseCmd->SetDefaultValue(true);
+  fUseCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fUseCmd->SetToBeBroadcasted(false);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/testhadr/source/print",this);
+  fPrintCmd->SetGuidance("print the state and the loaded source term");
+  fPrintCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPrintCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CondensedSourceMessenger::~CondensedSourceMessenger()
+{
+  delete fRecordCmd;
+  delete fLoadCmd;
+  delete fUseCmd;
+  delete fPrintCmd;
+  delete fSourceDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CondensedSourceMessenger::SetNewValue(G4UIcommand* command,
+                                           G4String newValue)
+{   
+  CondensedSource* source = CondensedSource::Instance();
+
+  if (command == fRecordCmd)
+   {source->SetRecordFile(newValue);}
+
+  if (command == fLoadCmd)
+   {source->Load(newValue);}
+
+  if (command == fUseCmd)
+   {source->SetUse(fUseCmd->GetNewBoolValue(newValue));}
+
+  if (command == fPrintCmd)
+   {source->Print();}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
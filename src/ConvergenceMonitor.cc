@@ -0,0 +1,174 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file ConvergenceMonitor.cc
+/// \brief Implementation of the ConvergenceMonitor class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "ConvergenceMonitor.hh"
+
+#include "G4AutoLock.hh"
+#include <cmath>
+#include <iomanip>
+
+namespace { G4Mutex monitorMutex = G4MUTEX_INITIALIZER; }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ConvergenceMonitor* ConvergenceMonitor::Instance()
+{
+  static ConvergenceMonitor instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ConvergenceMonitor::ConvergenceMonitor()
+: fTargetError(0.), fWallClockLimit(0.), fCheckEvery(1000),
+  fStop(false), fReason(kNotStopped), fReasonError(0.)
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double ConvergenceMonitor::RelativeError(G4int n, G4double sum, G4double sum2)
+{
+  // R = s_mean/mean, with s_mean^2 = (<x^2> - <x>^2)/(n-1)
+  if (n < 2 || sum == 0.) return 1.;
+  G4double mean = sum/n;
+  G4double var = (sum2/n - mean*mean)/(n - 1);
+  if (var < 0.) var = 0.;
+  return std::sqrt(var)/std::fabs(mean);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::AddTarget(G4int tally)
+{
+  if (tally < 0 || tally >= Run::kNbTally) return;
+  for (std::size_t i=0; i<fTargets.size(); i++) {
+    if (fTargets[i] == tally) return;
+  }
+  fTargets.push_back(tally);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double ConvergenceMonitor::ElapsedSeconds() const
+{
+  return std::chrono::duration<G4double>(
+           std::chrono::steady_clock::now() - fStart).count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::BeginOfRun()
+{
+  G4AutoLock lock(&monitorMutex);
+  fPartials.clear();
+  fStop = false;
+  fReason = kNotStopped;
+  fReasonError = 0.;
+  fStart = std::chrono::steady_clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::Publish(const Run* run)
+{
+  if (!IsActive() || StopRequested()) return;
+
+  G4AutoLock lock(&monitorMutex);
+
+  // overwrite this thread's slot with its cumulative sums
+  Partial& slot = fPartials[run];
+  slot.fNbHistories = run->GetNbHistories();
+  for (G4int k=0; k<Run::kNbTally; k++) {
+    slot.fSum[k]  = run->GetTallySum(k);
+    slot.fSum2[k] = run->GetTallySum2(k);
+  }
+
+  if (fWallClockLimit > 0. && ElapsedSeconds() >= fWallClockLimit) {
+    fReason = kWallClockSpent;
+    fStop = true;
+    return;
+  }
+  if (fTargets.empty() || fTargetError <= 0.) return;
+
+  // combine the partial sums of all threads
+  Partial total;
+  std::map<const Run*, Partial>::const_iterator it;
+  for (it = fPartials.begin(); it != fPartials.end(); ++it) {
+    total.fNbHistories += it->second.fNbHistories;
+    for (std::size_t i=0; i<fTargets.size(); i++) {
+      G4int k = fTargets[i];
+      total.fSum[k]  += it->second.fSum[k];
+      total.fSum2[k] += it->second.fSum2[k];
+    }
+  }
+
+  G4double worst = 0.;
+  for (std::size_t i=0; i<fTargets.size(); i++) {
+    G4int k = fTargets[i];
+    G4double r = RelativeError(total.fNbHistories, total.fSum[k], total.fSum2[k]);
+    if (r > worst) worst = r;
+  }
+  if (worst <= fTargetError) {
+    fReason = kPrecisionReached;
+    fReasonError = worst;
+    fStop = true;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::Report(G4int nEvents) const
+{
+  if (!IsActive()) return;
+
+  G4cout << "\n Run termination: ";
+  if (fReason == kPrecisionReached) {
+    G4cout << "target precision reached (worst relative error "
+           << 100*fReasonError << " % <= " << 100*fTargetError << " %) ";
+  } else if (fReason == kWallClockSpent) {
+    G4cout << "wall-clock budget of " << fWallClockLimit << " s spent ";
+  } else {
+    G4cout << "requested number of events processed ";
+  }
+  G4cout << "after " << nEvents << " events, "
+         << ElapsedSeconds() << " s" << G4endl;
+
+  if (!fTargets.empty()) {
+    G4cout << " Target tallies:";
+    for (std::size_t i=0; i<fTargets.size(); i++) {
+      G4cout << " " << Run::TallyName(fTargets[i]);
+    }
+    G4cout << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
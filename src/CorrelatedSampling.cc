@@ -0,0 +1,255 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CorrelatedSampling.cc
+/// \brief Implementation of the CorrelatedSampling class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "CorrelatedSampling.hh"
+
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4UIcommand.hh"
+#include "G4UIcommandStatus.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // splitmix64: well-mixed seeds from consecutive event numbers
+  unsigned long long Mix(unsigned long long& state)
+  {
+    unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  G4bool EventOrder(const Run::EventScores& a, const Run::EventScores& b)
+  { return a.fEvent < b.fEvent; }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CorrelatedSampling* CorrelatedSampling::Instance()
+{
+  static CorrelatedSampling instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CorrelatedSampling::CorrelatedSampling()
+: fCurrent(-1), fSeed(0), fJobSeed(0)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CorrelatedSampling::AddVariant(const G4String& name)
+{
+  Variant variant;
+  variant.fName    = name;
+  variant.fNbPairs = 0;
+  fVariants.push_back(variant);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool CorrelatedSampling::AddCommand(const G4String& command)
+{
+  if (fVariants.empty()) {
+    G4cout << "\n--> warning from CorrelatedSampling : no variant for "
+           << command << G4endl;
+    return false;
+  }
+  fVariants.back().fCommands.push_back(command);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CorrelatedSampling::Clear()
+{
+  fVariants.clear();
+  fReference.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CorrelatedSampling::Print() const
+{
+  G4cout << "\n Correlated sampling: " << fVariants.size() << " variants, "
+         << "seed " << (fSeed ? G4UIcommand::ConvertToString(fSeed)
+                              : G4String("from the engine")) << G4endl;
+  for (std::size_t v=0; v<fVariants.size(); v++) {
+    G4cout << "  " << fVariants[v].fName << (v == 0 ? " (reference)" : "")
+           << G4endl;
+    for (std::size_t c=0; c<fVariants[v].fCommands.size(); c++)
+      G4cout << "     " << fVariants[v].fCommands[c] << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CorrelatedSampling::BeamOn(G4int nbEvents)
+{
+  if (fVariants.size() < 2) {
+    G4cout << "\n--> warning from CorrelatedSampling : at least two variants"
+           << " are needed" << G4endl;
+    return;
+  }
+  fJobSeed = fSeed ? fSeed : G4long(G4UniformRand()*2147483647.) + 1;
+
+  // a variant lists all the settings it changes, so that it does not
+  // depend on the variants before it
+  G4UImanager* ui = G4UImanager::GetUIpointer();
+  for (std::size_t v=0; v<fVariants.size(); v++) {
+    G4cout << "\n====== Correlated sampling, variant " << fVariants[v].fName
+           << " ======" << G4endl;
+    for (std::size_t c=0; c<fVariants[v].fCommands.size(); c++) {
+      if (ui->ApplyCommand(fVariants[v].fCommands[c]) != fCommandSucceeded)
+        G4cout << "\n--> warning from CorrelatedSampling : "
+               << fVariants[v].fCommands[c] << " failed" << G4endl;
+    }
+    fCurrent = G4int(v);
+    G4RunManager::GetRunManager()->BeamOn(nbEvents);
+  }
+  fCurrent = -1;
+  fReference.clear();
+  Report();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CorrelatedSampling::SeedEvent(G4int eventID) const
+{
+  unsigned long long state = ((unsigned long long)fJobSeed << 32)
+                           | (unsigned long long)(unsigned int)eventID;
+  long seeds[3];
+  seeds[0] = long(Mix(state) & 0x7fffffff) | 1;
+  seeds[1] = long(Mix(state) & 0x7fffffff) | 1;
+  seeds[2] = 0;
+  G4Random::setTheSeeds(seeds);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CorrelatedSampling::EndOfVariant(std::vector<Run::EventScores>& scores)
+{
+  std::sort(scores.begin(), scores.end(), EventOrder);
+  Variant& variant = fVariants[fCurrent];
+  if (fCurrent == 0) {
+    fReference.swap(scores);
+    scores.clear();
+  }
+
+  // pairs of the same event in the reference and in this variant; events
+  // missing in one of them (e.g. a run stopped by the convergence monitor)
+  // are left out
+  G4double s1[Run::kNbTally], s2[Run::kNbTally];
+  G4double r1[Run::kNbTally], r2[Run::kNbTally];
+  G4double d1[Run::kNbTally], d2[Run::kNbTally];
+  for (G4int k=0; k<Run::kNbTally; k++)
+    s1[k] = s2[k] = r1[k] = r2[k] = d1[k] = d2[k] = 0.;
+  const std::vector<Run::EventScores>& events =
+    (fCurrent == 0) ? fReference : scores;
+  G4int n = 0;
+  std::size_t i = 0, j = 0;
+  while (i < fReference.size() && j < events.size()) {
+    if (fReference[i].fEvent < events[j].fEvent) { i++; continue; }
+    if (events[j].fEvent < fReference[i].fEvent) { j++; continue; }
+    for (G4int k=0; k<Run::kNbTally; k++) {
+      G4double r = fReference[i].fScore[k], s = events[j].fScore[k];
+      s1[k] += s;      s2[k] += s*s;
+      r1[k] += r;      r2[k] += r*r;
+      d1[k] += s - r;  d2[k] += (s - r)*(s - r);
+    }
+    n++;  i++;  j++;
+  }
+  scores.clear();
+
+  variant.fNbPairs = n;
+  for (G4int k=0; k<Run::kNbTally; k++) {
+    G4double mean  = n > 0 ? s1[k]/n : 0.;
+    G4double ref   = n > 0 ? r1[k]/n : 0.;
+    G4double diff  = n > 0 ? d1[k]/n : 0.;
+    // variances of the means: the errors below are standard errors
+    G4double varS  = n > 1 ? (s2[k]/n - mean*mean)/(n - 1.) : 0.;
+    G4double varR  = n > 1 ? (r2[k]/n - ref*ref)/(n - 1.)   : 0.;
+    G4double varD  = n > 1 ? (d2[k]/n - diff*diff)/(n - 1.) : 0.;
+    variant.fMean[k]       = mean;
+    variant.fDiff[k]       = diff;
+    variant.fDiffError[k]  = std::sqrt(std::max(varD, 0.));
+    variant.fIndepError[k] = std::sqrt(std::max(varS, 0.) + std::max(varR, 0.));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CorrelatedSampling::Report() const
+{
+  const Variant& reference = fVariants[0];
+  G4int prec = G4cout.precision(4);
+  G4cout << "\n--------- Correlated sampling, differences to "
+         << reference.fName << " (" << reference.fNbPairs
+         << " histories) ---------" << G4endl;
+  for (std::size_t v=1; v<fVariants.size(); v++) {
+    const Variant& variant = fVariants[v];
+    G4cout << "\n " << variant.fName << " - " << reference.fName << " : "
+           << variant.fNbPairs << " paired histories" << G4endl;
+    G4cout << "  " << std::setw(13) << "tally" << std::setw(12) << "reference"
+           << std::setw(12) << "variant" << std::setw(12) << "difference"
+           << std::setw(12) << "+- paired" << std::setw(12) << "+- indep"
+           << std::setw(10) << "gain" << G4endl;
+    for (G4int k=0; k<Run::kNbTally; k++) {
+      if (reference.fMean[k] == 0. && variant.fMean[k] == 0.) continue;
+      // variance ratio of independent to paired estimates: the cost factor
+      // saved by the common random numbers
+      G4double gain = variant.fDiffError[k] > 0.
+        ? std::pow(variant.fIndepError[k]/variant.fDiffError[k], 2) : 0.;
+      G4cout << "  " << std::setw(13) << Run::TallyName(k)
+             << std::setw(12) << reference.fMean[k]
+             << std::setw(12) << variant.fMean[k]
+             << std::setw(12) << variant.fDiff[k]
+             << std::setw(12) << variant.fDiffError[k]
+             << std::setw(12) << variant.fIndepError[k]
+             << std::setw(10) << gain << G4endl;
+    }
+  }
+  G4cout << "\n Tallies per source history; errors are one standard error."
+         << G4endl;
+  G4cout.precision(prec);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,140 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CorrelatedSamplingMessenger.cc
+/// \brief Implementation of the CorrelatedSamplingMessenger class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "CorrelatedSamplingMessenger.hh"
+
+#include "CorrelatedSampling.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CorrelatedSamplingMessenger::CorrelatedSamplingMessenger()
+:G4UImessenger(),
+ fCorrelatedDir(0), fVariantCmd(0), fAddCmd(0), fSeedCmd(0), fBeamOnCmd(0),
+ fClearCmd(0), fPrintCmd(0)
+{ 
+  // the variants are run by the master, so these commands are executed by
+  // the master only
+  fCorrelatedDir = new G4UIdirectory("/testhadr/correlated/");
+  fCorrelatedDir->SetGuidance("variants compared with common random numbers");
+
+  fVariantCmd = new G4UIcmdWithAString("/testhadr/correlated/variant",this);
+  fVariantCmd->SetGuidance("start a new variant; the first is the reference");
+  fVariantCmd->SetParameterName("name",false);
+  fVariantCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fVariantCmd->SetToBeBroadcasted(false);
+
+  fAddCmd = new G4UIcmdWithAString("/testhadr/correlated/add",this);
+  fAddCmd->SetGuidance("add a UI command (rest of the line) to the last");
+  fAddCmd->SetGuidance("variant, e.g. /testhadr/det/setBoron 0.07");
+  fAddCmd->SetParameterName("command",false);
+  fAddCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fAddCmd->SetToBeBroadcasted(false);
+
+  fSeedCmd = new G4UIcmdWithAnInteger("/testhadr/correlated/seed",this);
+  fSeedCmd->SetGuidance("job seed of the event streams (0: from the engine)");
+  fSeedCmd->SetParameterName("seed",false);
+  fSeedCmd->SetRange("seed>=0");
+  fSeedCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fSeedCmd->SetToBeBroadcasted(false);
+
+  fBeamOnCmd = new G4UIcmdWithAnInteger("/testhadr/correlated/beamOn",this);
+  fBeamOnCmd->SetGuidance("run every variant with the same events");
+  fBeamOnCmd->SetParameterName("nbEvents",false);
+  fBeamOnCmd->SetRange("nbEvents>0");
+  fBeamOnCmd->AvailableForStates(G4State_Idle);
+  fBeamOnCmd->SetToBeBroadcasted(false);
+
+  fClearCmd = new G4UIcmdWithoutParameter("/testhadr/correlated/clear",this);
+  fClearCmd->SetGuidance("remove all variants");
+  fClearCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fClearCmd->SetToBeBroadcasted(false);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/testhadr/correlated/print",this);
+  fPrintCmd->SetGuidance("print the variants");
+  fPrintCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPrintCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CorrelatedSamplingMessenger::~CorrelatedSamplingMessenger()
+{
+  delete fVariantCmd;
+  delete fAddCmd;
+  delete fSeedCmd;
+  delete fBeamOnCmd;
+  delete fClearCmd;
+  delete fPrintCmd;
+  delete fCorrelatedDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CorrelatedSamplingMessenger::SetNewValue(G4UIcommand* command,
+                                              G4String newValue)
+{   
+  CorrelatedSampling* correlated = CorrelatedSampling::Instance();
+
+  if (command == fVariantCmd)
+   {correlated->AddVariant(newValue);}
+
+  if (command == fAddCmd)
+   {
+     // a quoted command is accepted as well
+     G4String line = newValue;
+     if (line.size() > 1 && line[0] == '"' && line[line.size()-1] == '"')
+       line = line.substr(1, line.size() - 2);
+     correlated->AddCommand(line);
+   }
+
+  if (command == fSeedCmd)
+   {correlated->SetSeed(fSeedCmd->GetNewIntValue(newValue));}
+
+  if (command == fBeamOnCmd)
+   {correlated->BeamOn(fBeamOnCmd->GetNewIntValue(newValue));}
+
+  if (command == fClearCmd)
+   {correlated->Clear();}
+
+  if (command == fPrintCmd)
+   {correlated->Print();}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,118 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file CullingMessenger.cc
+/// \brief Implementation of the CullingMessenger class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "CullingMessenger.hh"
+
+#include "CullingRules.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CullingMessenger::CullingMessenger()
+:G4UImessenger(),
+ fCullDir(0), fAddCmd(0), fLoadCmd(0), fClearCmd(0), fListCmd(0)
+{ 
+  // the rules are shared by all threads, so these commands are executed
+  // by the master only
+  fCullDir = new G4UIdirectory("/testhadr/cull/");
+  fCullDir->SetGuidance("track-culling rules, first match applies");
+   
+  fAddCmd = new G4UIcmdWithAString("/testhadr/cull/add",this);
+  fAddCmd->SetGuidance("add a rule :");
+  fAddCmd->SetGuidance("  <name> [particle <name>] [region <name>] [volume <name>]");
+  fAddCmd->SetGuidance("  [emin|emax <value> <unit>] [tmin|tmax <value> <unit>]");
+  fAddCmd->SetGuidance("  [wmin|wmax <value>] [at stack|step|both]");
+  fAddCmd->SetGuidance("  action kill|roulette <survival weight>|defer");
+  fAddCmd->SetGuidance("e.g. slabGammas particle gamma region Slab emax 10 keV action kill");
+  fAddCmd->SetParameterName("rule",false);
+  fAddCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fAddCmd->SetToBeBroadcasted(false);
+
+  fLoadCmd = new G4UIcmdWithAString("/testhadr/cull/load",this);
+  fLoadCmd->SetGuidance("add the rules of a file, one per line ('#' comments)");
+  fLoadCmd->SetParameterName("fileName",false);
+  fLoadCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fLoadCmd->SetToBeBroadcasted(false);
+
+  fClearCmd = new G4UIcmdWithoutParameter("/testhadr/cull/clear",this);
+  fClearCmd->SetGuidance("remove all rules");
+  fClearCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fClearCmd->SetToBeBroadcasted(false);
+
+  fListCmd = new G4UIcmdWithoutParameter("/testhadr/cull/list",this);
+  fListCmd->SetGuidance("print the rules");
+  fListCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fListCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CullingMessenger::~CullingMessenger()
+{
+  delete fAddCmd;
+  delete fLoadCmd;
+  delete fClearCmd;
+  delete fListCmd;
+  delete fCullDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CullingMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{   
+  CullingRules* rules = CullingRules::Instance();
+
+  // a rejected rule fails the command (and stops a macro)
+  if (command == fAddCmd && !rules->AddRule(newValue)) {
+    G4ExceptionDescription description;
+    description << "culling rule rejected: " << newValue;
+    command->CommandFailed(description);
+  }
+
+  if (command == fLoadCmd && !rules->LoadFile(newValue)) {
+    G4ExceptionDescription description;
+    description << "culling rules of " << newValue << " not all loaded";
+    command->CommandFailed(description);
+  }
+
+  if (command == fClearCmd)
+   {rules->Clear();}
+
+  if (command == fListCmd)
+   {rules->List();}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,207 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file CullingRules.cc
+/// \brief Implementation of the CullingRules class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "CullingRules.hh"
+
+#include "G4ParticleDefinition.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Region.hh"
+#include "G4UnitsTable.hh"
+
+#include <fstream>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CullingRules::Rule::Rule()
+: fEmin(0.), fEmax(DBL_MAX), fTmin(0.), fTmax(DBL_MAX),
+  fWmin(0.), fWmax(DBL_MAX), fAtStack(true), fAtStep(true),
+  fAction(kKill), fSurvivalWeight(0.)
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CullingRules* CullingRules::Instance()
+{
+  static CullingRules instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool CullingRules::AddRule(const G4String& spec)
+{
+  std::istringstream is(spec);
+  Rule rule;
+  G4bool hasAction = false, complete = true;
+  G4String key;
+  is >> rule.fName;
+  while (is >> key) {
+    G4double value = 0.;
+    G4String unit;
+    if      (key == "particle") is >> rule.fParticle;
+    else if (key == "region")   is >> rule.fRegion;
+    else if (key == "volume")   is >> rule.fVolume;
+    else if (key == "emin" || key == "emax" || key == "tmin" || key == "tmax") {
+      is >> value >> unit;
+      // an unknown unit, or one of another category, would silently give
+      // a wrong threshold
+      G4String category = (key[0] == 'e') ? "Energy" : "Time";
+      if (!is.fail() && G4UnitDefinition::GetCategory(unit) != category) {
+        G4cout << "\n--> warning from CullingRules : " << unit
+               << " is not a unit of " << category << " (" << key
+               << ") in rule " << rule.fName << G4endl;
+        return false;
+      }
+      value *= G4UnitDefinition::GetValueOf(unit);
+      if      (key == "emin") rule.fEmin = value;
+      else if (key == "emax") rule.fEmax = value;
+      else if (key == "tmin") rule.fTmin = value;
+      else                    rule.fTmax = value;
+    }
+    else if (key == "wmin") is >> rule.fWmin;
+    else if (key == "wmax") is >> rule.fWmax;
+    else if (key == "at") {
+      G4String at;
+      is >> at;
+      rule.fAtStack = (at == "stack" || at == "both");
+      rule.fAtStep  = (at == "step"  || at == "both");
+    }
+    else if (key == "action") {
+      G4String action;
+      is >> action;
+      hasAction = true;
+      if      (action == "kill")  rule.fAction = kKill;
+      else if (action == "defer") rule.fAction = kDefer;
+      else if (action == "roulette") {
+        rule.fAction = kRoulette;
+        is >> rule.fSurvivalWeight;
+      }
+      else hasAction = false;
+    }
+    else {
+      G4cout << "\n--> warning from CullingRules : unknown keyword " << key
+             << " in rule " << rule.fName << G4endl;
+      return false;
+    }
+    // a keyword without its value
+    if (is.fail()) { complete = false; break; }
+  }
+
+  if (rule.fName.empty() || !hasAction || !complete ||
+      (rule.fAction == kRoulette && rule.fSurvivalWeight <= 0.) ||
+      !(rule.fAtStack || rule.fAtStep)) {
+    G4cout << "\n--> warning from CullingRules : invalid rule \""
+           << spec << "\"" << G4endl;
+    return false;
+  }
+  fRules.push_back(rule);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool CullingRules::LoadFile(const G4String& fileName)
+{
+  // one rule per line; blank lines and lines starting with # are skipped
+  std::ifstream file(fileName);
+  if (!file) {
+    G4cout << "\n--> warning from CullingRules : cannot open "
+           << fileName << G4endl;
+    return false;
+  }
+  G4bool ok = true;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::size_t first = line.find_first_not_of(" \t");
+    if (first == std::string::npos || line[first] == '#') continue;
+    ok = AddRule(line.substr(first)) && ok;
+  }
+  return ok;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CullingRules::List() const
+{
+  G4cout << "\n Track-culling rules (first match applies):" << G4endl;
+  if (fRules.empty()) G4cout << "  none" << G4endl;
+  for (std::size_t i=0; i<fRules.size(); i++) {
+    const Rule& rule = fRules[i];
+    G4cout << "  " << rule.fName << " :";
+    if (!rule.fParticle.empty()) G4cout << " particle " << rule.fParticle;
+    if (!rule.fRegion.empty())   G4cout << " region " << rule.fRegion;
+    if (!rule.fVolume.empty())   G4cout << " volume " << rule.fVolume;
+    if (rule.fEmin > 0.)      G4cout << " emin " << G4BestUnit(rule.fEmin,"Energy");
+    if (rule.fEmax < DBL_MAX) G4cout << " emax " << G4BestUnit(rule.fEmax,"Energy");
+    if (rule.fTmin > 0.)      G4cout << " tmin " << G4BestUnit(rule.fTmin,"Time");
+    if (rule.fTmax < DBL_MAX) G4cout << " tmax " << G4BestUnit(rule.fTmax,"Time");
+    if (rule.fWmin > 0.)      G4cout << " wmin " << rule.fWmin;
+    if (rule.fWmax < DBL_MAX) G4cout << " wmax " << rule.fWmax;
+    if (!rule.fAtStep)  G4cout << " at stack";
+    if (!rule.fAtStack) G4cout << " at step";
+    if (rule.fAction == kKill)  G4cout << " -> kill";
+    if (rule.fAction == kDefer) G4cout << " -> defer";
+    if (rule.fAction == kRoulette)
+      G4cout << " -> roulette " << rule.fSurvivalWeight;
+    G4cout << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const CullingRules::Rule*
+CullingRules::Match(const G4ParticleDefinition* particle,
+                    const G4LogicalVolume* volume,
+                    G4double ekin, G4double time, G4double weight,
+                    G4bool atStack) const
+{
+  for (std::size_t i=0; i<fRules.size(); i++) {
+    const Rule& rule = fRules[i];
+    if (atStack ? !rule.fAtStack : !rule.fAtStep) continue;
+    if (ekin < rule.fEmin || ekin >= rule.fEmax) continue;
+    if (time < rule.fTmin || time >= rule.fTmax) continue;
+    if (weight < rule.fWmin || weight >= rule.fWmax) continue;
+    if (!rule.fParticle.empty() &&
+        rule.fParticle != particle->GetParticleName()) continue;
+    if (!rule.fVolume.empty() &&
+        (!volume || rule.fVolume != volume->GetName())) continue;
+    if (!rule.fRegion.empty() &&
+        (!volume || !volume->GetRegion() ||
+         rule.fRegion != volume->GetRegion()->GetName())) continue;
+    return &rule;
+  }
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
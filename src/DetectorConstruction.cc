@@ -33,6 +33,11 @@
 
 #include "DetectorConstruction.hh"
 #include "DetectorMessenger.hh"
+#include "BiasingOperator.hh"
+#include "RegionInformation.hh"
+#include "WoodcockModel.hh"
+#include "TransmissionModel.hh"
+#include "TransmissionKernel.hh"
 #include "G4Material.hh"
 #include "G4NistManager.hh"
 #include "PrimaryGeneratorAction.hh"
@@ -50,17 +55,31 @@
 #include "G4LogicalVolumeStore.hh"
 #include "G4SolidStore.hh"
 #include "G4RunManager.hh"
+#include "PhysicsList.hh"
 
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4UserLimits.hh"
+
+#include "G4UIcommand.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 
 #include "HistoManager.hh"
 
+#include <cmath>
+#include <iomanip>
+#include <set>
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DetectorConstruction::DetectorConstruction()
 :G4VUserDetectorConstruction(),
- worldP(0), worldL(0), fMaterial(0), fDetectorMessenger(0)
+ worldP(0), worldL(0), polyL(0), fMaterial(0), fDetectorMessenger(0),
+ fPolyBoron(5.*perCent),
+ fDxtranRadius(0.), fTankKernel(0), fTankTransmission(false),
+ fTankKernelMargin(10*cm)
 {
   sphereR = 15*cm;
   fTank_x = 7*2.5*9*cm; //water tank size in x
@@ -102,7 +121,8 @@ DetectorConstruction::DetectorConstruction()
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DetectorConstruction::~DetectorConstruction()
-{ delete fDetectorMessenger;}
+{ delete fDetectorMessenger;
+  delete fTankKernel;}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -113,6 +133,44 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void DetectorConstruction::ConstructSDandField()
+{
+  // one biasing operator per thread, kept across geometry rebuilds; it is
+  // attached everywhere but acts only where a region enables it, and only
+  // on processes wrapped by /testhadr/phys/biasing
+  static G4ThreadLocal BiasingOperator* biasingOperator = 0;
+  if (!biasingOperator) biasingOperator = new BiasingOperator(this);
+
+  G4LogicalVolumeStore* store = G4LogicalVolumeStore::GetInstance();
+  for (std::size_t i=0; i<store->size(); i++) {
+    if ((*store)[i] != worldL) biasingOperator->AttachTo((*store)[i]);
+  }
+
+  // Woodcock tracking, one model per region and thread; the regions outlive
+  // geometry rebuilds and keep their model
+  static G4ThreadLocal std::set<G4String>* woodcockRegions = 0;
+  if (!woodcockRegions) woodcockRegions = new std::set<G4String>;
+  std::map<G4String,RegionSettings>::const_iterator it;
+  for (it = fRegionSettings.begin(); it != fRegionSettings.end(); ++it) {
+    if (!it->second.fWoodcock || woodcockRegions->count(it->first)) continue;
+    G4Region* region =
+      G4RegionStore::GetInstance()->GetRegion(it->first, false);
+    if (!region) continue;
+    new WoodcockModel("Woodcock" + it->first, region);
+    woodcockRegions->insert(it->first);
+  }
+
+  // tank-wall transmission, idle until kernels are loaded and enabled
+  static G4ThreadLocal TransmissionModel* transmissionModel = 0;
+  if (!transmissionModel) {
+    G4Region* tank = G4RegionStore::GetInstance()->GetRegion("Tank", false);
+    if (tank)
+      transmissionModel = new TransmissionModel("TankTransmission", tank, this);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void DetectorConstruction::DefineMaterials()
 {
   // specific element name for thermal neutronHP
@@ -364,17 +422,7 @@ G4VPhysicalVolume* DetectorConstruction::ConstructVolumes()
   
 
   //construct the polyethylene shielding here
-  G4double density = 0.94*g/cm3;
-  G4NistManager* manager = G4NistManager::Instance();
-  G4Element* B = manager->FindOrBuildElement("B");
-  G4Element* H = manager->FindOrBuildElement("H");
-  G4Element* O = manager->FindOrBuildElement("O");
-  G4Element* C = manager->FindOrBuildElement("C");
-  G4Material* bpoly = new G4Material("B-Poly",density,4);
-  bpoly->AddElement(B,5.*perCent);
-  bpoly->AddElement(H,11.6*perCent);
-  bpoly->AddElement(O,22.2*perCent);
-  bpoly->AddElement(C,61.2*perCent);
+  G4Material* bpoly = BoratedPoly(fPolyBoron);
 
 
   G4Box* polyS = new G4Box("poly",
@@ -409,6 +457,7 @@ G4VPhysicalVolume* DetectorConstruction::ConstructVolumes()
 			       0,
 			       checkOverlaps);
 			    
+  ConstructRegions();
 
   //always return the root volume
   //
@@ -417,6 +466,340 @@ G4VPhysicalVolume* DetectorConstruction::ConstructVolumes()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+namespace {
+  const G4int nbRegions = 5;
+  const char* regionNames[nbRegions] =
+    { "Probe", "Shield", "Tank", "Slab", "RoomAir" };
+}
+
+const char* DetectorConstruction::RegionNames()
+{
+  return "Probe Shield Tank Slab RoomAir";
+}
+
+G4bool DetectorConstruction::IsRegion(const G4String& name)
+{
+  for (G4int i=0; i<nbRegions; i++) { if (name == regionNames[i]) return true; }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::ConstructRegions()
+{
+  // the region of a volume extends to its daughters down to the next root:
+  // Tank holds the water walls and the chamber air, Shield the B-poly and
+  // the generator, Probe the PE moderator and the He-3 tube
+  G4LogicalVolume* roots[nbRegions] = { probePeL, polyL, tankL, slabL, roomL };
+
+  G4RegionStore* store = G4RegionStore::GetInstance();
+  for (G4int i=0; i<nbRegions; i++) {
+    G4Region* region = store->GetRegion(regionNames[i], false);
+    if (!region) region = new G4Region(regionNames[i]);
+    // after a geometry rebuild, the old root volumes are gone
+    std::vector<G4LogicalVolume*>::iterator first
+      = region->GetRootLogicalVolumeIterator();
+    std::vector<G4LogicalVolume*>
+      oldRoots(first, first + region->GetNumberOfRootVolumes());
+    for (std::size_t j=0; j<oldRoots.size(); j++) {
+      if (oldRoots[j] != roots[i]) region->RemoveRootLogicalVolume(oldRoots[j]);
+    }
+    region->AddRootLogicalVolume(roots[i]);
+    ApplyRegionSettings(regionNames[i]);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::ApplyRegionSettings(const G4String& name)
+{
+  G4Region* region = G4RegionStore::GetInstance()->GetRegion(name, false);
+  if (!region) return;
+  std::map<G4String,RegionSettings>::const_iterator it
+    = fRegionSettings.find(name);
+  if (it == fRegionSettings.end()) return;
+  const RegionSettings& settings = it->second;
+
+  // without explicit cuts the region inherits those of the default region
+  if (!settings.fCuts.empty()) {
+    G4ProductionCuts* cuts = region->GetProductionCuts();
+    if (!cuts) {
+      // the particles without a region cut keep those of the physics list
+      const G4VUserPhysicsList* physics =
+        G4RunManager::GetRunManager()->GetUserPhysicsList();
+      const PhysicsList* presets = dynamic_cast<const PhysicsList*>(physics);
+      const char* particles[] = { "gamma", "e-", "e+", "proton" };
+      cuts = new G4ProductionCuts();
+      for (G4int k=0; k<4; k++) {
+        G4double cut = presets ? presets->GetDefaultCut(particles[k])
+                     : (physics ? physics->GetDefaultCutValue() : 0.7*mm);
+        cuts->SetProductionCut(cut, particles[k]);
+      }
+      region->SetProductionCuts(cuts);
+    }
+    std::map<G4String,G4double>::const_iterator ic;
+    for (ic = settings.fCuts.begin(); ic != settings.fCuts.end(); ++ic) {
+      cuts->SetProductionCut(ic->second, ic->first);
+    }
+  }
+
+  if (settings.fMaxTime < DBL_MAX || settings.fMinEkin > 0. ||
+      settings.fMaxStep < DBL_MAX) {
+    G4UserLimits* limits = region->GetUserLimits();
+    if (!limits) {
+      limits = new G4UserLimits();
+      region->SetUserLimits(limits);
+    }
+    limits->SetMaxAllowedStep(settings.fMaxStep);
+    limits->SetUserMaxTime(settings.fMaxTime);
+    limits->SetUserMinEkine(settings.fMinEkin);
+  }
+
+  if (settings.fImplicitCapture || settings.fWeightLow > 0. ||
+      region->GetUserInformation()) {
+    RegionInformation* info =
+      static_cast<RegionInformation*>(region->GetUserInformation());
+    if (!info) {
+      info = new RegionInformation();
+      region->SetUserInformation(info);
+    }
+    info->fImplicitCapture = settings.fImplicitCapture;
+    info->fWeightLow       = settings.fWeightLow;
+    info->fWeightSurvival  = settings.fWeightSurvival;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DetectorConstruction::SetRegionCut(const G4String& region,
+                                          const G4String& particle,
+                                          G4double cut)
+{
+  if (!IsRegion(region)) return false;
+  fRegionSettings[region].fCuts[particle] = cut;
+  ApplyRegionSettings(region);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DetectorConstruction::SetRegionLimit(const G4String& region,
+                                            const G4String& limit,
+                                            G4double value)
+{
+  if (!IsRegion(region)) return false;
+  RegionSettings& settings = fRegionSettings[region];
+  if      (limit == "maxTime") settings.fMaxTime = value;
+  else if (limit == "minEkin") settings.fMinEkin = value;
+  else if (limit == "maxStep") settings.fMaxStep = value;
+  else return false;
+  ApplyRegionSettings(region);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DetectorConstruction::SetRegionImplicitCapture(const G4String& region,
+                                                      G4bool enable)
+{
+  if (!IsRegion(region)) return false;
+  fRegionSettings[region].fImplicitCapture = enable;
+  ApplyRegionSettings(region);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DetectorConstruction::SetRegionWoodcock(const G4String& region,
+                                               G4bool enable)
+{
+  if (!IsRegion(region)) return false;
+  fRegionSettings[region].fWoodcock = enable;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DetectorConstruction::SetRegionWeightCutoff(const G4String& region,
+                                                   G4double wLow,
+                                                   G4double wSurvival)
+{
+  if (!IsRegion(region)) return false;
+  // the survival weight must exceed the cutoff, else roulette gains nothing
+  if (wLow > 0. && wSurvival <= wLow) {
+    if (wSurvival > 0.) {
+      G4cout << "\n--> warning from SetRegionWeightCutoff : survival weight "
+             << wSurvival << " not above cutoff " << wLow
+             << "; using " << 2*wLow << G4endl;
+    }
+    wSurvival = 2*wLow;
+  }
+  RegionSettings& settings = fRegionSettings[region];
+  settings.fWeightLow      = wLow;
+  settings.fWeightSurvival = wSurvival;
+  ApplyRegionSettings(region);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DetectorConstruction::SetExpTransform(const G4String& volume,
+                                             G4double p,
+                                             ExpTransform::Target target,
+                                             const G4ThreeVector& vector)
+{
+  // the volume is looked up at the start of each run, as it may not be
+  // built yet; p = 0 removes the transform
+  if (p == 0.) {
+    fExpTransforms.erase(volume);
+    return true;
+  }
+  if (p < 0. || p >= 1.) {
+    G4cout << "\n--> warning from SetExpTransform : p=" << p
+           << " must be in [0,1)" << G4endl;
+    return false;
+  }
+  if (target == ExpTransform::kDirection && vector.mag2() == 0.) {
+    G4cout << "\n--> warning from SetExpTransform : null direction" << G4endl;
+    return false;
+  }
+  ExpTransform& transform = fExpTransforms[volume];
+  transform.fStretch = p;
+  transform.fTarget  = target;
+  transform.fVector  = vector;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector DetectorConstruction::GetProbePosition() const
+{
+  // centre of the He-3 tube in the world frame (no rotated placements)
+  return detectorP->GetTranslation() + probePeP->GetTranslation()
+       + chamberP->GetTranslation() + tankP->GetTranslation()
+       + roomP->GetTranslation();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector DetectorConstruction::GetPolyPosition() const
+{
+  // centre of the B-poly housing of the DD source in the world frame
+  return polyP->GetTranslation() + chamberP->GetTranslation()
+       + tankP->GetTranslation() + roomP->GetTranslation();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetDxtranRadius(G4double radius)
+{
+  // the sphere must enclose the PE moderator of the probe
+  if (radius > 0. && radius < sphereR) {
+    G4cout << "\n--> warning from SetDxtranRadius : "
+           << G4BestUnit(radius,"Length") << " does not enclose the probe;"
+           << " using " << G4BestUnit(sphereR,"Length") << G4endl;
+    radius = sphereR;
+  }
+  fDxtranRadius = radius;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DetectorConstruction::LoadTankKernel(const G4String& file)
+{
+  // kept on the master and only read by the worker models
+  TransmissionKernel* kernel = new TransmissionKernel();
+  if (!kernel->Read(file)) {
+    delete kernel;
+    return false;
+  }
+  delete fTankKernel;
+  fTankKernel = kernel;
+  fTankTransmission = true;
+  G4cout << "\n Tank transmission kernels read from " << file << " : "
+         << fTankKernel->GetEntries() << " entries, walls "
+         << G4BestUnit(fTankKernel->GetThickness(0),"Length") << " (side) "
+         << G4BestUnit(fTankKernel->GetThickness(1),"Length") << " (top)"
+         << G4endl;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetTankTransmission(G4bool enable)
+{
+  if (enable && !fTankKernel) {
+    G4cout << "\n--> warning from SetTankTransmission : no kernels loaded"
+           << G4endl;
+    return;
+  }
+  fTankTransmission = enable;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::PrintRegions()
+{
+  G4cout << "\n Regions (cuts not listed are those of the default region):"
+         << G4endl;
+  for (G4int i=0; i<nbRegions; i++) {
+    G4cout << "  " << std::setw(8) << regionNames[i] << " :";
+    std::map<G4String,RegionSettings>::const_iterator it
+      = fRegionSettings.find(regionNames[i]);
+    if (it == fRegionSettings.end()) {
+      G4cout << " defaults" << G4endl;
+      continue;
+    }
+    const RegionSettings& settings = it->second;
+    std::map<G4String,G4double>::const_iterator ic;
+    for (ic = settings.fCuts.begin(); ic != settings.fCuts.end(); ++ic) {
+      G4cout << " cut(" << ic->first << ")=" << G4BestUnit(ic->second,"Length");
+    }
+    if (settings.fMaxTime < DBL_MAX)
+      G4cout << " maxTime=" << G4BestUnit(settings.fMaxTime,"Time");
+    if (settings.fMinEkin > 0.)
+      G4cout << " minEkin=" << G4BestUnit(settings.fMinEkin,"Energy");
+    if (settings.fMaxStep < DBL_MAX)
+      G4cout << " maxStep=" << G4BestUnit(settings.fMaxStep,"Length");
+    if (settings.fImplicitCapture)
+      G4cout << " implicitCapture";
+    if (settings.fWoodcock)
+      G4cout << " woodcock(gamma)";
+    if (settings.fWeightLow > 0.)
+      G4cout << " weightCutoff=" << settings.fWeightLow
+             << "/" << settings.fWeightSurvival;
+    G4cout << G4endl;
+  }
+
+  std::map<G4String,ExpTransform>::const_iterator it;
+  for (it = fExpTransforms.begin(); it != fExpTransforms.end(); ++it) {
+    const ExpTransform& transform = it->second;
+    G4cout << "  exponential transform in " << it->first
+           << " : p=" << transform.fStretch;
+    if (transform.fTarget == ExpTransform::kDirection)
+      G4cout << " along " << transform.fVector;
+    else if (transform.fTarget == ExpTransform::kPoint)
+      G4cout << " toward " << G4BestUnit(transform.fVector,"Length");
+    else
+      G4cout << " toward the probe";
+    G4cout << G4endl;
+  }
+  if (fDxtranRadius > 0.) {
+    G4cout << "  DXTRAN sphere around the probe : radius "
+           << G4BestUnit(fDxtranRadius,"Length") << G4endl;
+  }
+  if (GetTankKernel()) {
+    G4cout << "  tank-wall transmission kernels : edge margin "
+           << G4BestUnit(fTankKernelMargin,"Length") << G4endl;
+  }
+  if (!fTankKernelBuild.empty()) {
+    G4cout << "  tank-wall transmission kernels recorded into "
+           << fTankKernelBuild << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 
 void DetectorConstruction::PrintParameters()
 {
@@ -449,6 +832,51 @@ void DetectorConstruction::SetMaterial(G4String materialChoice)
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4Material* DetectorConstruction::BoratedPoly(G4double boron)
+{
+  // the nominal 5% B-Poly; other boron mass fractions replace part of the
+  // polyethylene, H, O and C keeping their relative proportions
+  G4String name = "B-Poly";
+  if (std::fabs(boron - 5.*perCent) > 1.e-9)
+    name += "_" + G4UIcommand::ConvertToString(boron/perCent) + "%B";
+  G4Material* material = G4Material::GetMaterial(name, false);
+  if (material) return material;
+
+  G4double density = 0.94*g/cm3;
+  G4double scale = (1. - boron)/(1. - 5.*perCent);
+  G4NistManager* manager = G4NistManager::Instance();
+  G4Element* B = manager->FindOrBuildElement("B");
+  G4Element* H = manager->FindOrBuildElement("H");
+  G4Element* O = manager->FindOrBuildElement("O");
+  G4Element* C = manager->FindOrBuildElement("C");
+  material = new G4Material(name,density,4);
+  material->AddElement(B,boron);
+  material->AddElement(H,11.6*perCent*scale);
+  material->AddElement(O,22.2*perCent*scale);
+  material->AddElement(C,61.2*perCent*scale);
+  return material;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetPolyBoron(G4double boron)
+{
+  if (boron < 0. || boron >= 1.) {
+    G4cout << "\n--> warning from DetectorConstruction::SetPolyBoron : "
+           << "boron mass fraction " << boron << " out of [0,1)" << G4endl;
+    return;
+  }
+  fPolyBoron = boron;
+  if (polyL) {
+    polyL->SetMaterial(BoratedPoly(fPolyBoron));
+    G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+  }
+  G4cout << "\n B-Poly boron mass fraction " << fPolyBoron/perCent << " %"
+         << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void DetectorConstruction::SetSize(G4double x, G4double y, G4double z)
 {
   fBoxX = x;
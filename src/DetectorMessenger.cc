@@ -33,10 +33,12 @@
 #include "DetectorMessenger.hh"
 
 #include "DetectorConstruction.hh"
+#include "BoxNavigation.hh"
 #include "G4UIdirectory.hh"
 #include "G4UIcommand.hh"
 #include "G4UIparameter.hh"
 #include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADouble.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
 #include "G4UIcmdWithoutParameter.hh"
 #include "G4UIcmdWithABool.hh"
@@ -46,7 +48,7 @@
 DetectorMessenger::DetectorMessenger(DetectorConstruction * Det)
 :G4UImessenger(), 
  fDetector(Det), fTestemDir(0), fDetDir(0), fMaterCmd(0), fSizeCmd(0),
- fIsotopeCmd(0)
+ fIsotopeCmd(0), fBoronCmd(0), fBoxNavigationCmd(0)
 { 
   fTestemDir = new G4UIdirectory("/testhadr/");
   fTestemDir->SetGuidance("commands specific to this example");
@@ -66,6 +68,20 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction * Det)
   fSizeCmd->SetRange("Size>0.");
   fSizeCmd->SetUnitCategory("Length");
   fSizeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fBoronCmd = new G4UIcmdWithADouble("/testhadr/det/setBoron",this);
+  fBoronCmd->SetGuidance("Set the boron mass fraction of the B-Poly shield");
+  fBoronCmd->SetParameterName("fraction",false);
+  fBoronCmd->SetRange("fraction>=0. && fraction<1.");
+  fBoronCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fBoxNavigationCmd = new G4UIcmdWithABool("/testhadr/det/boxNavigation",this);
+  fBoxNavigationCmd->SetGuidance("Navigate the nested boxes with BoxNavigation");
+  fBoxNavigationCmd->SetGuidance("  other volumes use G4NormalNavigation");
+  fBoxNavigationCmd->SetGuidance("  takes effect at the next run");
+  fBoxNavigationCmd->SetParameterName("flag",true);
+  fBoxNavigationCmd->SetDefaultValue(true);
+  fBoxNavigationCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
        
   fIsotopeCmd = new G4UIcommand("/testhadr/det/setIsotopeMat",this);
   fIsotopeCmd->SetGuidance("Build and select a material with single isotope");
@@ -97,6 +113,201 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction * Det)
   fIsotopeCmd->SetParameter(unitPrm);
   //
   fIsotopeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);  
+
+  fRegionDir = new G4UIdirectory("/testhadr/det/region/",broadcast);
+  fRegionDir->SetGuidance("production cuts and user limits per region");
+  fRegionDir->SetGuidance("  regions: " + G4String(DetectorConstruction::RegionNames()));
+
+  fRegionCutCmd = new G4UIcommand("/testhadr/det/region/setCut",this);
+  fRegionCutCmd->SetGuidance("Set the production cut of a particle in a region");
+  //
+  G4UIparameter* regPrm = new G4UIparameter("region",'s',false);
+  regPrm->SetParameterCandidates(DetectorConstruction::RegionNames());
+  fRegionCutCmd->SetParameter(regPrm);
+  //
+  G4UIparameter* partPrm = new G4UIparameter("particle",'s',false);
+  partPrm->SetParameterCandidates("gamma e- e+ proton");
+  fRegionCutCmd->SetParameter(partPrm);
+  //
+  G4UIparameter* cutPrm = new G4UIparameter("cut",'d',false);
+  cutPrm->SetParameterRange("cut>=0.");
+  fRegionCutCmd->SetParameter(cutPrm);
+  //
+  G4UIparameter* cutUnitPrm = new G4UIparameter("unit",'s',true);
+  cutUnitPrm->SetDefaultValue("mm");
+  cutUnitPrm->SetParameterCandidates(
+    G4UIcommand::UnitsList(G4UIcommand::CategoryOf("mm")));
+  fRegionCutCmd->SetParameter(cutUnitPrm);
+  //
+  fRegionCutCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fMaxTimeCmd = MakeLimitCmd("setMaxTime",
+                             "Kill tracks older than this time in a region","ns");
+  fMinEkinCmd = MakeLimitCmd("setMinEkin",
+                             "Kill tracks below this kinetic energy in a region","MeV");
+  fMaxStepCmd = MakeLimitCmd("setMaxStep",
+                             "Limit the step length in a region","mm");
+
+  fRegionListCmd = new G4UIcmdWithoutParameter("/testhadr/det/region/list",this);
+  fRegionListCmd->SetGuidance("Print the cuts and limits of all regions");
+  fRegionListCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fWoodcockCmd = new G4UIcommand("/testhadr/det/region/woodcock",this);
+  fWoodcockCmd->SetGuidance("Woodcock tracking of gammas in a region envelope");
+  fWoodcockCmd->SetGuidance("  needs /testhadr/phys/fastSimulation gamma");
+  //
+  G4UIparameter* wtRegPrm = new G4UIparameter("region",'s',false);
+  wtRegPrm->SetParameterCandidates(DetectorConstruction::RegionNames());
+  fWoodcockCmd->SetParameter(wtRegPrm);
+  //
+  G4UIparameter* wtFlagPrm = new G4UIparameter("flag",'b',true);
+  wtFlagPrm->SetDefaultValue(true);
+  fWoodcockCmd->SetParameter(wtFlagPrm);
+  //
+  fWoodcockCmd->AvailableForStates(G4State_PreInit);
+
+  fBiasDir = new G4UIdirectory("/testhadr/bias/",broadcast);
+  fBiasDir->SetGuidance("neutron variance reduction per region or volume");
+  fBiasDir->SetGuidance("  needs /testhadr/phys/biasing true (PreInit)");
+
+  fImplicitCaptureCmd = new G4UIcommand("/testhadr/bias/implicitCapture",this);
+  fImplicitCaptureCmd->SetGuidance("Replace neutron capture by a weight reduction");
+  fImplicitCaptureCmd->SetGuidance("  captures are scored as expected values");
+  //
+  G4UIparameter* icRegPrm = new G4UIparameter("region",'s',false);
+  icRegPrm->SetParameterCandidates(DetectorConstruction::RegionNames());
+  fImplicitCaptureCmd->SetParameter(icRegPrm);
+  //
+  G4UIparameter* icFlagPrm = new G4UIparameter("flag",'b',true);
+  icFlagPrm->SetDefaultValue(true);
+  fImplicitCaptureCmd->SetParameter(icFlagPrm);
+  //
+  fImplicitCaptureCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fWeightCutoffCmd = new G4UIcommand("/testhadr/bias/weightCutoff",this);
+  fWeightCutoffCmd->SetGuidance("Russian roulette of neutrons below a weight");
+  fWeightCutoffCmd->SetGuidance("  survivors get the survival weight; wLow=0 disables");
+  //
+  G4UIparameter* wcRegPrm = new G4UIparameter("region",'s',false);
+  wcRegPrm->SetParameterCandidates(DetectorConstruction::RegionNames());
+  fWeightCutoffCmd->SetParameter(wcRegPrm);
+  //
+  G4UIparameter* wLowPrm = new G4UIparameter("wLow",'d',false);
+  wLowPrm->SetParameterRange("wLow>=0.");
+  fWeightCutoffCmd->SetParameter(wLowPrm);
+  //
+  G4UIparameter* wSurvPrm = new G4UIparameter("wSurvival",'d',true);
+  wSurvPrm->SetDefaultValue(0.);
+  wSurvPrm->SetParameterRange("wSurvival>=0.");
+  fWeightCutoffCmd->SetParameter(wSurvPrm);
+  //
+  fWeightCutoffCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fExpTransformCmd = MakeExpTransformCmd("expTransform",
+    "Stretch neutron paths in a volume along a direction");
+  fExpTransformCmd->SetParameter(new G4UIparameter("dx",'d',false));
+  fExpTransformCmd->SetParameter(new G4UIparameter("dy",'d',false));
+  fExpTransformCmd->SetParameter(new G4UIparameter("dz",'d',false));
+
+  fExpPointCmd = MakeExpTransformCmd("expTransformToPoint",
+    "Stretch neutron paths in a volume toward a point (world frame)");
+  fExpPointCmd->SetParameter(new G4UIparameter("x",'d',false));
+  fExpPointCmd->SetParameter(new G4UIparameter("y",'d',false));
+  fExpPointCmd->SetParameter(new G4UIparameter("z",'d',false));
+  G4UIparameter* expUnitPrm = new G4UIparameter("unit",'s',true);
+  expUnitPrm->SetDefaultValue("cm");
+  expUnitPrm->SetParameterCandidates(
+    G4UIcommand::UnitsList(G4UIcommand::CategoryOf("cm")));
+  fExpPointCmd->SetParameter(expUnitPrm);
+
+  fExpProbeCmd = MakeExpTransformCmd("expTransformToProbe",
+    "Stretch neutron paths in a volume toward the He-3 probe");
+
+  fDxtranCmd = new G4UIcmdWithADoubleAndUnit("/testhadr/bias/dxtranRadius",this);
+  fDxtranCmd->SetGuidance("Radius of the DXTRAN sphere around the He-3 probe");
+  fDxtranCmd->SetGuidance("  emissions and collisions outside send pseudo-neutrons onto it;");
+  fDxtranCmd->SetGuidance("  0 disables it (no biasing physics needed)");
+  fDxtranCmd->SetParameterName("radius",false);
+  fDxtranCmd->SetRange("radius>=0.");
+  fDxtranCmd->SetUnitCategory("Length");
+  fDxtranCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fTankDir = new G4UIdirectory("/testhadr/tank/",broadcast);
+  fTankDir->SetGuidance("fast transmission of neutrons through the tank walls");
+  fTankDir->SetGuidance("  needs /testhadr/phys/fastSimulation neutron (PreInit)");
+
+  fKernelBuildCmd = new G4UIcmdWithAString("/testhadr/tank/buildKernel",this);
+  fKernelBuildCmd->SetGuidance("Record the wall transmission kernels of the next");
+  fKernelBuildCmd->SetGuidance("  runs (detailed transport) into a file; none stops");
+  fKernelBuildCmd->SetParameterName("file",false);
+  fKernelBuildCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fKernelLoadCmd = new G4UIcmdWithAString("/testhadr/tank/loadKernel",this);
+  fKernelLoadCmd->SetGuidance("Read wall transmission kernels and use them");
+  fKernelLoadCmd->SetParameterName("file",false);
+  fKernelLoadCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fTransmissionCmd = new G4UIcmdWithABool("/testhadr/tank/transmission",this);
+  fTransmissionCmd->SetGuidance("Sample the loaded kernels instead of transporting");
+  fTransmissionCmd->SetGuidance("  neutrons through the tank walls");
+  fTransmissionCmd->SetParameterName("flag",true);
+  fTransmissionCmd->SetDefaultValue(true);
+  fTransmissionCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fKernelMarginCmd = new G4UIcmdWithADoubleAndUnit("/testhadr/tank/edgeMargin",this);
+  fKernelMarginCmd->SetGuidance("Entries closer to the edge of a wall are transported");
+  fKernelMarginCmd->SetGuidance("  (and not recorded)");
+  fKernelMarginCmd->SetParameterName("margin",false);
+  fKernelMarginCmd->SetRange("margin>=0.");
+  fKernelMarginCmd->SetUnitCategory("Length");
+  fKernelMarginCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4UIcommand* DetectorMessenger::MakeExpTransformCmd(const G4String& name,
+                                                    const G4String& guidance)
+{
+  G4UIcommand* cmd = new G4UIcommand("/testhadr/bias/" + name,this);
+  cmd->SetGuidance(guidance);
+  cmd->SetGuidance("  cross sections scaled by 1 - p*mu; p=0 removes it");
+  //
+  G4UIparameter* volPrm = new G4UIparameter("volume",'s',false);
+  cmd->SetParameter(volPrm);
+  //
+  G4UIparameter* pPrm = new G4UIparameter("p",'d',false);
+  pPrm->SetParameterRange("p>=0. && p<1.");
+  cmd->SetParameter(pPrm);
+  //
+  cmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  return cmd;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4UIcommand* DetectorMessenger::MakeLimitCmd(const G4String& name,
+                                             const G4String& guidance,
+                                             const G4String& unit)
+{
+  G4UIcommand* cmd = new G4UIcommand("/testhadr/det/region/" + name,this);
+  cmd->SetGuidance(guidance);
+  //
+  G4UIparameter* regPrm = new G4UIparameter("region",'s',false);
+  regPrm->SetParameterCandidates(DetectorConstruction::RegionNames());
+  cmd->SetParameter(regPrm);
+  //
+  G4UIparameter* valPrm = new G4UIparameter("value",'d',false);
+  valPrm->SetParameterRange("value>=0.");
+  cmd->SetParameter(valPrm);
+  //
+  G4UIparameter* unitPrm = new G4UIparameter("unit",'s',true);
+  unitPrm->SetDefaultValue(unit);
+  unitPrm->SetParameterCandidates(
+    G4UIcommand::UnitsList(G4UIcommand::CategoryOf(unit)));
+  cmd->SetParameter(unitPrm);
+  //
+  cmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  return cmd;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -106,6 +317,27 @@ DetectorMessenger::~DetectorMessenger()
   delete fMaterCmd;
   delete fSizeCmd;
   delete fIsotopeCmd;
+  delete fBoronCmd;
+  delete fBoxNavigationCmd;
+  delete fRegionCutCmd;
+  delete fMaxTimeCmd;
+  delete fMinEkinCmd;
+  delete fMaxStepCmd;
+  delete fRegionListCmd;
+  delete fWoodcockCmd;
+  delete fRegionDir;
+  delete fImplicitCaptureCmd;
+  delete fWeightCutoffCmd;
+  delete fExpTransformCmd;
+  delete fExpPointCmd;
+  delete fExpProbeCmd;
+  delete fDxtranCmd;
+  delete fKernelBuildCmd;
+  delete fKernelLoadCmd;
+  delete fTransmissionCmd;
+  delete fKernelMarginCmd;
+  delete fTankDir;
+  delete fBiasDir;
   delete fDetDir;
   delete fTestemDir;
 }
@@ -121,6 +353,12 @@ void DetectorMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
   if( command == fSizeCmd )
     { fDetector->SetSize(fSizeCmd->GetNewDoubleValue(newValue), fSizeCmd->GetNewDoubleValue(newValue), fSizeCmd->GetNewDoubleValue(newValue));}
      
+  if( command == fBoronCmd )
+    { fDetector->SetPolyBoron(fBoronCmd->GetNewDoubleValue(newValue));}
+
+  if( command == fBoxNavigationCmd )
+    { BoxNavigation::SetEnabled(fBoxNavigationCmd->GetNewBoolValue(newValue));}
+
   if (command == fIsotopeCmd)
    {
      G4int Z; G4int A; G4double dens;
@@ -131,6 +369,94 @@ void DetectorMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
      fDetector->MaterialWithSingleIsotope (name,name,dens,Z,A);
      fDetector->SetMaterial(name);    
    }   
+
+  if (command == fRegionCutCmd)
+   {
+     G4String region, particle, unt;
+     G4double cut;
+     std::istringstream is(newValue);
+     is >> region >> particle >> cut >> unt;
+     fDetector->SetRegionCut(region, particle, cut*G4UIcommand::ValueOf(unt));
+   }
+
+  if (command == fMaxTimeCmd || command == fMinEkinCmd ||
+      command == fMaxStepCmd)
+   {
+     G4String region, unt;
+     G4double value;
+     std::istringstream is(newValue);
+     is >> region >> value >> unt;
+     G4String limit = (command == fMaxTimeCmd) ? "maxTime"
+                    : (command == fMinEkinCmd) ? "minEkin" : "maxStep";
+     fDetector->SetRegionLimit(region, limit, value*G4UIcommand::ValueOf(unt));
+   }
+
+  if (command == fRegionListCmd)
+   { fDetector->PrintRegions();}
+
+  if (command == fWoodcockCmd)
+   {
+     G4String region, flag;
+     std::istringstream is(newValue);
+     is >> region >> flag;
+     fDetector->SetRegionWoodcock(region, G4UIcommand::ConvertToBool(flag));
+   }
+
+  if (command == fImplicitCaptureCmd)
+   {
+     G4String region, flag;
+     std::istringstream is(newValue);
+     is >> region >> flag;
+     fDetector->SetRegionImplicitCapture(region,
+                                         G4UIcommand::ConvertToBool(flag));
+   }
+
+  if (command == fWeightCutoffCmd)
+   {
+     G4String region;
+     G4double wLow, wSurvival;
+     std::istringstream is(newValue);
+     is >> region >> wLow >> wSurvival;
+     fDetector->SetRegionWeightCutoff(region, wLow, wSurvival);
+   }
+
+  if (command == fExpTransformCmd || command == fExpPointCmd ||
+      command == fExpProbeCmd)
+   {
+     G4String volume, unt;
+     G4double p, x = 0., y = 0., z = 0.;
+     std::istringstream is(newValue);
+     is >> volume >> p;
+     DetectorConstruction::ExpTransform::Target target
+       = DetectorConstruction::ExpTransform::kProbe;
+     if (command == fExpTransformCmd) {
+       is >> x >> y >> z;
+       target = DetectorConstruction::ExpTransform::kDirection;
+     }
+     if (command == fExpPointCmd) {
+       is >> x >> y >> z >> unt;
+       x *= G4UIcommand::ValueOf(unt);
+       y *= G4UIcommand::ValueOf(unt);
+       z *= G4UIcommand::ValueOf(unt);
+       target = DetectorConstruction::ExpTransform::kPoint;
+     }
+     fDetector->SetExpTransform(volume, p, target, G4ThreeVector(x,y,z));
+   }
+
+  if (command == fDxtranCmd)
+   { fDetector->SetDxtranRadius(fDxtranCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fKernelBuildCmd)
+   { fDetector->SetTankKernelBuild(newValue == "none" ? G4String() : newValue);}
+
+  if (command == fKernelLoadCmd)
+   { fDetector->LoadTankKernel(newValue);}
+
+  if (command == fTransmissionCmd)
+   { fDetector->SetTankTransmission(fTransmissionCmd->GetNewBoolValue(newValue));}
+
+  if (command == fKernelMarginCmd)
+   { fDetector->SetTankKernelMargin(fKernelMarginCmd->GetNewDoubleValue(newValue));}
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
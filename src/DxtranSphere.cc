@@ -0,0 +1,267 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file DxtranSphere.cc
+/// \brief Implementation of the DxtranSphere class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "DxtranSphere.hh"
+#include "DetectorConstruction.hh"
+#include "TrackInformation.hh"
+
+#include "G4Navigator.hh"
+#include "G4HadronicProcessStore.hh"
+#include "G4Neutron.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // beyond this optical depth the contribution is dropped (weight < 1e-21 w)
+  const G4double kMaxDepth = 50.;
+  const G4int    kMaxSegments = 10000;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DxtranSphere::DxtranSphere(const DetectorConstruction* det)
+: fDetector(det), fWorld(0), fNavigator(0), fRadius(0.)
+{
+  fNavigator = new G4Navigator();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DxtranSphere::~DxtranSphere()
+{
+  delete fNavigator;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DxtranSphere::IsActive() const
+{
+  return fDetector->GetDxtranRadius() > 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DxtranSphere::Update()
+{
+  fRadius = fDetector->GetDxtranRadius();
+  // the probe moves, and the navigator must follow, on a geometry rebuild
+  if (fWorld != fDetector->GetWorld()) {
+    fWorld = fDetector->GetWorld();
+    fNavigator->SetWorldVolume(const_cast<G4VPhysicalVolume*>(fWorld));
+    fCentre = fDetector->GetProbePosition();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DxtranSphere::Inside(const G4ThreeVector& point) const
+{
+  return (point - fCentre).mag2() < fRadius*fRadius;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DxtranSphere::Enters(const G4ThreeVector& a,
+                            const G4ThreeVector& b) const
+{
+  if (Inside(a)) return false;
+  // closest approach of the segment to the centre
+  G4ThreeVector ab = b - a;
+  G4double length2 = ab.mag2();
+  G4double t = (length2 > 0.) ? (fCentre - a).dot(ab)/length2 : 0.;
+  t = std::min(1., std::max(0., t));
+  return Inside(a + t*ab);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DxtranSphere::SampleDirection(const G4ThreeVector& position,
+                                     G4ThreeVector& direction, G4double& cone,
+                                     G4double& distance) const
+{
+  G4ThreeVector toCentre = fCentre - position;
+  G4double d = toCentre.mag();
+  if (d <= fRadius) return false;
+
+  // direction uniform within the cone subtending the sphere
+  G4double cosMax = std::sqrt(1. - fRadius*fRadius/(d*d));
+  G4double cosTheta = 1. - G4UniformRand()*(1. - cosMax);
+  G4double sinTheta = std::sqrt(std::max(0., 1. - cosTheta*cosTheta));
+  G4double phi = twopi*G4UniformRand();
+  direction.set(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
+  direction.rotateUz(toCentre/d);
+  cone = 1. - cosMax;
+
+  // flight to the sphere
+  distance = d*cosTheta
+    - std::sqrt(std::max(0., fRadius*fRadius - d*d*sinTheta*sinTheta));
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Track* DxtranSphere::Contribution(const G4Step* step, G4double massNumber)
+{
+  const G4StepPoint* pre  = step->GetPreStepPoint();
+  const G4StepPoint* post = step->GetPostStepPoint();
+  const G4ThreeVector& position = post->GetPosition();
+
+  G4ThreeVector direction;
+  G4double cone, distance;
+  if (!SampleDirection(position, direction, cone, distance)) return 0;
+
+  // elastic kinematics on the struck nucleus
+  G4double muCM;
+  G4double density = ElasticDensity(pre->GetMomentumDirection().dot(direction),
+                                    massNumber, muCM);
+  if (density <= 0.) return 0;
+  G4double A = massNumber;
+  G4double ekin = pre->GetKineticEnergy()*(A*A + 2*A*muCM + 1.)/((A+1.)*(A+1.));
+
+  return PseudoNeutron(step->GetTrack(), position, direction, distance, ekin,
+                       step->GetTrack()->GetWeight()*density*cone,
+                       post->GetGlobalTime(),
+                       post->GetProcessDefinedStep());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Track* DxtranSphere::Emission(const G4Track* track,
+                                const G4ThreeVector& position, G4double ekin,
+                                G4double time, G4double weight,
+                                const G4VProcess* creator)
+{
+  G4ThreeVector direction;
+  G4double cone, distance;
+  if (!SampleDirection(position, direction, cone, distance)) return 0;
+
+  // isotropic in the lab: 1/2 per unit mu
+  return PseudoNeutron(track, position, direction, distance, ekin,
+                       weight*0.5*cone, time, creator);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Track* DxtranSphere::PseudoNeutron(const G4Track* track,
+                                     const G4ThreeVector& position,
+                                     const G4ThreeVector& direction,
+                                     G4double distance, G4double ekin,
+                                     G4double weight, G4double time,
+                                     const G4VProcess* creator)
+{
+  G4double tau = OpticalDepth(position, direction, distance, ekin);
+  if (tau >= kMaxDepth) return 0;
+
+  weight *= std::exp(-tau);
+
+  G4DynamicParticle* particle =
+    new G4DynamicParticle(G4Neutron::Neutron(), direction, ekin);
+  G4double mass = particle->GetMass();
+  G4double speed = c_light*std::sqrt(ekin*(ekin + 2*mass))/(ekin + mass);
+  G4Track* pseudo = new G4Track(particle, time + distance/speed,
+                                position + distance*direction);
+  pseudo->SetWeight(weight);
+  pseudo->SetParentID(track->GetTrackID());
+  pseudo->SetCreatorProcess(creator);
+  TrackInformation* info = new TrackInformation();
+  info->fDxtran = true;
+  pseudo->SetUserInformation(info);
+  return pseudo;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DxtranSphere::OpticalDepth(const G4ThreeVector& start,
+                                    const G4ThreeVector& direction,
+                                    G4double length, G4double ekin)
+{
+  G4ThreeVector point = start;
+  G4double tau = 0., travelled = 0.;
+  G4VPhysicalVolume* volume =
+    fNavigator->LocateGlobalPointAndSetup(point, &direction, false, false);
+  for (G4int i=0; i<kMaxSegments && volume && travelled < length; i++) {
+    G4double safety;
+    G4double remaining = length - travelled;
+    G4double segment =
+      fNavigator->ComputeStep(point, direction, remaining, safety);
+    if (segment > remaining) segment = remaining;
+    tau += TotalCrossSection(ekin, volume->GetLogicalVolume()->GetMaterial())
+         * segment;
+    if (tau >= kMaxDepth) break;
+    travelled += segment;
+    point += segment*direction;
+    fNavigator->SetGeometricallyLimitedStep();
+    volume = fNavigator->LocateGlobalPointAndSetup(point, &direction, true);
+  }
+  return tau;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DxtranSphere::TotalCrossSection(G4double ekin,
+                                         const G4Material* material) const
+{
+  G4HadronicProcessStore* store = G4HadronicProcessStore::Instance();
+  const G4ParticleDefinition* neutron = G4Neutron::Neutron();
+  return store->GetElasticCrossSectionPerVolume(neutron, ekin, material)
+       + store->GetInelasticCrossSectionPerVolume(neutron, ekin, material)
+       + store->GetCaptureCrossSectionPerVolume(neutron, ekin, material)
+       + store->GetFissionCrossSectionPerVolume(neutron, ekin, material);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DxtranSphere::ElasticDensity(G4double muLab, G4double A,
+                                      G4double& muCM)
+{
+  // hydrogen: forward hemisphere only, theta_CM = 2 theta_lab
+  if (A <= 1.) {
+    muCM = 2*muLab*muLab - 1.;
+    return (muLab > 0.) ? 2*muLab : 0.;
+  }
+  G4double s = std::sqrt(1. - (1. - muLab*muLab)/(A*A));
+  muCM = (muLab*muLab - 1.)/A + muLab*s;
+  return 0.5*(2*muLab/A + s + muLab*muLab/(A*A*s));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -36,6 +36,11 @@
 
 #include "Run.hh"
 #include "HistoManager.hh"
+#include "ConvergenceMonitor.hh"
+#include "ResponseMap.hh"
+#include "ResponseMatrix.hh"
+#include "CorrelatedSampling.hh"
+#include "TrackInformation.hh"
 
 #include "G4Event.hh"
 #include "G4RunManager.hh"
@@ -50,6 +55,7 @@ EventAction::EventAction(RunAction* run)
   :G4UserEventAction()
 {  
   fRun = run;            
+  fPerturbed = false;
 } 
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -76,6 +82,47 @@ void EventAction::BeginOfEventAction(const G4Event*)
 
   fCount_gamma_leaveLab=0;
   fCount_gamma_leaveShield=0;
+
+  for (G4int k=0; k<Run::kNbTally; k++) fTally[k] = 0.;
+  fBinScores.clear();
+
+  fPerturbed = Perturbation::Instance()->IsActive();
+  if (fPerturbed) {
+    for (G4int p=0; p<Perturbation::kNbParameters; p++)
+      for (G4int k=0; k<Run::kNbTally; k++) fSensitivity[p][k] = 0.;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventAction::AddSensitivity(G4int id, G4double weight,
+                                 const G4Track* track)
+{
+  // no track information: nothing perturbed along the history so far
+  const TrackInformation* info =
+    static_cast<const TrackInformation*>(track->GetUserInformation());
+  if (!info) return;
+  for (G4int p=0; p<Perturbation::kNbParameters; p++)
+    fSensitivity[p][id] += weight*info->fDerivative[p];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventAction::ScoreH1(G4int ih, G4double value, G4double weight)
+{
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+  analysisManager->FillH1(ih, value, weight);
+  if (!analysisManager->GetH1Activation(ih)) return;
+
+  // bin of the histogram axis itself, fixed or variable (log scheme)
+  // width; 0 is the underflow, nbins+1 the overflow
+  const tools::histo::axis<double,unsigned int>& axis
+    = analysisManager->GetH1(ih)->axis();
+  unsigned int bin = 0;
+  axis.coord_to_absolute_index(value/analysisManager->GetH1Unit(ih), bin);
+
+  fBinScores[Run::BinKey(ih, bin)] += weight;
+  fBinScores[Run::BinKey(ih, Run::kTotalBin)] += weight;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -90,7 +137,43 @@ void EventAction::EndOfEventAction(const G4Event* evt)
      (G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction());
   const G4ParticleGun* particleGun = generator->GetParticleGun();
   neutronEnergy_gen = particleGun->GetParticleEnergy();
-  G4AnalysisManager::Instance()->FillH1(0,neutronEnergy_gen);
+  ScoreH1(0,neutronEnergy_gen);
+
+  // collapse the history scores into the run sums
+  G4RunManager* runManager = G4RunManager::GetRunManager();
+  Run* run = static_cast<Run*>(runManager->GetNonConstCurrentRun());
+  run->AddEventTallies(fTally);
+  run->AddEventBins(std::vector<std::pair<Run::BinKey,G4double> >(
+                      fBinScores.begin(), fBinScores.end()));
+
+  // response map: the score of the stratum of this history
+  const ResponseMap* map = ResponseMap::Instance();
+  if (map->IsActive()) {
+    run->AddResponse(map->Stratum(evt->GetEventID()),
+                     fTally[map->GetTally()]);
+  }
+  // response matrix: the score of the beam of this history
+  const ResponseMatrix* matrix = ResponseMatrix::Instance();
+  if (matrix->IsActive()) {
+    run->AddResponse(matrix->Point(evt->GetEventID()),
+                     fTally[matrix->GetTally()]);
+  }
+  // perturbation tallies: the derivatives of the scores of this history
+  if (fPerturbed) run->AddEventSensitivities(fSensitivity);
+
+  // correlated sampling: the tallies of this history, to be paired with
+  // the same history of the reference variant
+  if (CorrelatedSampling::Instance()->IsRunning())
+    run->AddEventScores(evt->GetEventID(), fTally);
+
+  // precision / wall-clock targeted termination
+  ConvergenceMonitor* monitor = ConvergenceMonitor::Instance();
+  if (monitor->IsActive()) {
+    if (run->GetNbHistories() % monitor->GetCheckEvery() == 0) {
+      monitor->Publish(run);
+    }
+    if (monitor->StopRequested()) runManager->AbortRun(true);
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
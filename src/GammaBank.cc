@@ -0,0 +1,250 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file GammaBank.cc
+/// \brief Implementation of the GammaBank class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "GammaBank.hh"
+
+#include "G4Track.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  const char kMagic[8] = {'M','O','N','G','B','0','0','1'};
+
+  G4bool EarlierHistory(const GammaBank::Record& a, const GammaBank::Record& b)
+  {
+    return a.fEvent < b.fEvent;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GammaBank::Writer::Writer(const G4String& fileName)
+: fOut(fileName, std::ios::binary)
+{
+  if (!fOut) {
+    G4cout << "\n--> warning from GammaBank : cannot write "
+           << fileName << G4endl;
+    return;
+  }
+  fOut.write(kMagic, sizeof(kMagic));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GammaBank::Writer::~Writer()
+{
+  Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GammaBank::Writer::Write(G4int event, const G4Track* track)
+{
+  if (!fOut.is_open()) return;
+  const G4ThreeVector& position  = track->GetPosition();
+  const G4ThreeVector& direction = track->GetMomentumDirection();
+  Record record;
+  record.fEvent = event;
+  for (G4int i=0; i<3; i++) {
+    record.fPosition[i]  = position[i];
+    record.fDirection[i] = direction[i];
+  }
+  record.fEkin   = track->GetKineticEnergy();
+  record.fTime   = track->GetGlobalTime();
+  record.fWeight = track->GetWeight();
+  fOut.write(reinterpret_cast<const char*>(&record), sizeof(record));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GammaBank::Writer::Close()
+{
+  if (fOut.is_open()) fOut.close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GammaBank* GammaBank::Instance()
+{
+  static GammaBank instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GammaBank::GammaBank()
+: fNbHistories(0), fSplit(1)
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String GammaBank::PartName(const G4String& fileName, G4int part)
+{
+  std::ostringstream name;
+  name << fileName << ".part" << part;
+  return name.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GammaBank::SetWriteFile(const G4String& fileName)
+{
+  fWriteFile = (fileName == "none") ? G4String() : fileName;
+  if (IsWriting() && IsLoaded()) {
+    G4cout << "\n--> warning from GammaBank : writing a neutron pass, "
+           << fLoadedFile << " is unloaded" << G4endl;
+    Load("none");
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool GammaBank::WriteIndex(G4int histories, G4int nbParts) const
+{
+  std::ofstream out(fWriteFile);
+  if (!out) {
+    G4cout << "\n--> warning from GammaBank : cannot write "
+           << fWriteFile << G4endl;
+    return false;
+  }
+  out << G4String(kMagic, sizeof(kMagic)) << "\n"
+      << "histories " << histories << "\n";
+  for (G4int part=0; part<nbParts; part++)
+    out << "part " << PartName(fWriteFile, part) << "\n";
+  return out.good();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool GammaBank::Load(const G4String& fileName)
+{
+  fRecords.clear();
+  fFirst.clear();
+  fNbHistories = 0;
+  fLoadedFile = "";
+  if (fileName == "none") return true;
+  if (IsWriting()) {
+    G4cout << "\n--> warning from GammaBank : writing a neutron pass to "
+           << fWriteFile << ", " << fileName << " is not loaded" << G4endl;
+    return false;
+  }
+
+  std::ifstream index(fileName);
+  G4String magic, key, part;
+  G4int histories = 0;
+  index >> magic >> key >> histories;
+  if (!index || magic != G4String(kMagic, sizeof(kMagic)) ||
+      key != "histories" || histories <= 0) {
+    G4cout << "\n--> warning from GammaBank : " << fileName
+           << " is not a gamma bank index" << G4endl;
+    return false;
+  }
+
+  // the parts of the threads without events may be missing
+  while (index >> key >> part) {
+    std::ifstream in(part, std::ios::binary);
+    if (!in) continue;
+    char partMagic[8];
+    in.read(partMagic, sizeof(partMagic));
+    if (!in || std::memcmp(partMagic, kMagic, sizeof(kMagic)) != 0) {
+      G4cout << "\n--> warning from GammaBank : " << part
+             << " is not a gamma bank part, skipped" << G4endl;
+      continue;
+    }
+    Record record;
+    while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+      if (record.fEvent >= 0 && record.fEvent < histories)
+        fRecords.push_back(record);
+    }
+  }
+  std::stable_sort(fRecords.begin(), fRecords.end(), EarlierHistory);
+
+  fFirst.assign(histories+1, 0);
+  std::size_t r = 0;
+  for (G4int h=0; h<histories; h++) {
+    fFirst[h] = r;
+    while (r < fRecords.size() && fRecords[r].fEvent == h) r++;
+  }
+  fFirst[histories] = r;
+  fNbHistories = histories;
+  fLoadedFile = fileName;
+  Print();
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const GammaBank::Record* GammaBank::GetHistory(G4int history,
+                                               G4int& nbGammas) const
+{
+  nbGammas = 0;
+  if (history < 0 || history >= fNbHistories) return 0;
+  nbGammas = fFirst[history+1] - fFirst[history];
+  return nbGammas > 0 ? &fRecords[fFirst[history]] : 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GammaBank::CheckRun(G4int nbEvents) const
+{
+  if (!IsLoaded() || nbEvents == fNbHistories) return;
+  G4cout << "\n--> warning from GammaBank : " << nbEvents << " events for "
+         << fNbHistories << " histories in " << fLoadedFile
+         << (nbEvents > fNbHistories ? ", the extra events are empty"
+                                     : ", the last histories are skipped")
+         << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GammaBank::Print() const
+{
+  G4cout << "\n Gamma bank: writing "
+         << (IsWriting() ? fWriteFile : G4String("off"));
+  if (!IsLoaded()) {
+    G4cout << ", none loaded" << G4endl;
+    return;
+  }
+  G4double weight = 0.;
+  for (std::size_t r=0; r<fRecords.size(); r++) weight += fRecords[r].fWeight;
+  G4cout << ", " << fLoadedFile << " : " << fRecords.size() << " gammas of "
+         << fNbHistories << " histories (" << weight/fNbHistories
+         << " per history), split " << fSplit << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,112 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file GammaBankMessenger.cc
+/// \brief Implementation of the GammaBankMessenger class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "GammaBankMessenger.hh"
+
+#include "GammaBank.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GammaBankMessenger::GammaBankMessenger()
+:G4UImessenger(),
+ fTwoPassDir(0), fWriteCmd(0), fReadCmd(0), fSplitCmd(0), fPrintCmd(0)
+{ 
+  // the bank is shared by all threads, so these commands are executed
+  // by the master only
+  fTwoPassDir = new G4UIdirectory("/testhadr/twoPass/");
+  fTwoPassDir->SetGuidance("two-pass simulation: neutrons, then banked gammas");
+   
+  fWriteCmd = new G4UIcmdWithAString("/testhadr/twoPass/write",this);
+  fWriteCmd->SetGuidance("pass one: bank the secondary gammas of the next runs");
+  fWriteCmd->SetGuidance("to a file instead of tracking them (none: off)");
+  fWriteCmd->SetParameterName("fileName",false);
+  fWriteCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fWriteCmd->SetToBeBroadcasted(false);
+
+  fReadCmd = new G4UIcmdWithAString("/testhadr/twoPass/read",this);
+  fReadCmd->SetGuidance("pass two: replay the banked gammas, event i the");
+  fReadCmd->SetGuidance("gammas of history i of pass one (none: unload)");
+  fReadCmd->SetParameterName("fileName",false);
+  fReadCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fReadCmd->SetToBeBroadcasted(false);
+
+  fSplitCmd = new G4UIcmdWithAnInteger("/testhadr/twoPass/split",this);
+  fSplitCmd->SetGuidance("pass two: replay each gamma n times, 1/n of its weight");
+  fSplitCmd->SetParameterName("n",false);
+  fSplitCmd->SetRange("n>0");
+  fSplitCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fSplitCmd->SetToBeBroadcasted(false);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/testhadr/twoPass/print",this);
+  fPrintCmd->SetGuidance("print the state and the loaded bank");
+  fPrintCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPrintCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GammaBankMessenger::~GammaBankMessenger()
+{
+  delete fWriteCmd;
+  delete fReadCmd;
+  delete fSplitCmd;
+  delete fPrintCmd;
+  delete fTwoPassDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GammaBankMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{   
+  GammaBank* bank = GammaBank::Instance();
+
+  if (command == fWriteCmd)
+   {bank->SetWriteFile(newValue);}
+
+  if (command == fReadCmd)
+   {bank->Load(newValue);}
+
+  if (command == fSplitCmd)
+   {bank->SetSplit(fSplitCmd->GetNewIntValue(newValue));}
+
+  if (command == fPrintCmd)
+   {bank->Print();}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,137 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file GammaSites.cc
+/// \brief Implementation of the GammaSites class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "GammaSites.hh"
+
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  const G4double kEmin = 10*keV;
+  const G4double kEmax = 20*MeV;
+  const G4int    kPerDecade = 40;
+  const G4int    kNbGroups =
+    G4int(std::ceil(kPerDecade*std::log10(kEmax/kEmin)));
+
+  // cell indices, offset to be positive, on 20 bits each
+  const G4long   kOffset = 1 << 19;
+
+  G4long CellIndex(G4double x, G4double size)
+  {
+    G4long i = G4long(std::floor(x/size)) + kOffset;
+    return std::min(std::max(i, G4long(0)), 2*kOffset - 1);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GammaSites::GammaSites(G4double cellSize)
+: fCellSize(cellSize)
+{
+  fSites = new std::map<G4long,Site>[kNbGroups];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GammaSites::~GammaSites()
+{
+  delete [] fSites;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int GammaSites::NbGroups()
+{
+  return kNbGroups;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int GammaSites::Group(G4double ekin)
+{
+  if (ekin < kEmin) return -1;
+  return std::min(G4int(kPerDecade*std::log10(ekin/kEmin)), kNbGroups-1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double GammaSites::GroupEnergy(G4int group)
+{
+  // log centre of the group
+  return kEmin*std::pow(10., (group + 0.5)/kPerDecade);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GammaSites::Fill(const G4ThreeVector& position, G4double ekin,
+                      G4double weight)
+{
+  G4int group = Group(ekin);
+  if (group < 0) return;
+  G4long cell = (CellIndex(position.x(), fCellSize) << 40)
+              | (CellIndex(position.y(), fCellSize) << 20)
+              |  CellIndex(position.z(), fCellSize);
+  Site& site = fSites[group][cell];
+  site.fWeight += weight;
+  site.fMoment += weight*position;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GammaSites::Add(const GammaSites& other)
+{
+  for (G4int g=0; g<kNbGroups; g++) {
+    std::map<G4long,Site>::const_iterator it;
+    for (it = other.fSites[g].begin(); it != other.fSites[g].end(); it++) {
+      Site& site = fSites[g][it->first];
+      site.fWeight += it->second.fWeight;
+      site.fMoment += it->second.fMoment;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int GammaSites::GetNbSites() const
+{
+  G4int n = 0;
+  for (G4int g=0; g<kNbGroups; g++) n += fSites[g].size();
+  return n;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
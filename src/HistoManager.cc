@@ -61,8 +61,8 @@ void HistoManager::Book()
   analysisManager->SetActivation(true);     //enable inactivation of histograms
   
   // Define histograms start values
-  const G4int kMaxHisto = 16;
-  const G4String id[] = {"0","1", "2", "3", "4", "5", "6", "7", "8","9", "10", "11", "12","13","14","15"};
+  const G4int kMaxHisto = 17;
+  const G4String id[] = {"0","1", "2", "3", "4", "5", "6", "7", "8","9", "10", "11", "12","13","14","15","16"};
   const G4String title[] = 
                 { "dummy",                                           //0
                   "KE of Neutrons Hitting Detector",                      //1
@@ -79,7 +79,8 @@ void HistoManager::Book()
 		  "KE of Gammas - Side",
 		  "KE of Neutrons - Side",
 		  "KE of Gammas - Top",
-		  "KE of Neutrons - Top"
+		  "KE of Neutrons - Top",
+		  "E of capture gammas born (neutron preset)"
                  };  
 
   // Default values (to be reset via /analysis/h1/set command)               
@@ -129,6 +130,16 @@ void HistoManager::Book()
   analysisManager->CreateNtuple("detector", "inelestic scatter in detector");
   analysisManager->CreateNtupleDColumn("E");
   analysisManager->CreateNtupleDColumn("t");
+  analysisManager->FinishNtuple();
+
+  //ID = 5, capture gammas born, not transported (neutron preset)
+  analysisManager->CreateNtuple("gammaBirth", "Capture gammas born");
+  analysisManager->CreateNtupleDColumn("x");
+  analysisManager->CreateNtupleDColumn("y");
+  analysisManager->CreateNtupleDColumn("z");
+  analysisManager->CreateNtupleDColumn("E");
+  analysisManager->CreateNtupleDColumn("w");
+  analysisManager->FinishNtuple();
 
 }
 
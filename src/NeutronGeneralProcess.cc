@@ -0,0 +1,487 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file NeutronGeneralProcess.cc
+/// \brief Implementation of the NeutronGeneralProcess class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "NeutronGeneralProcess.hh"
+#include "TrackInformation.hh"
+
+#include "RegionInformation.hh"
+#include "BiasingOperator.hh"
+
+#include "G4HadronicProcess.hh"
+#include "G4CrossSectionDataStore.hh"
+#include "G4ProcessManager.hh"
+#include "G4ProcessVector.hh"
+#include "G4RegionStore.hh"
+#include "G4Region.hh"
+#include "G4Threading.hh"
+#include "G4UnitsTable.hh"
+#include "G4Neutron.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4ParticleHPManager.hh"
+#include "G4AutoLock.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+G4double NeutronGeneralProcess::fTolerance = 1.e-3;
+G4bool   NeutronGeneralProcess::fCoarseGrid = false;
+std::vector<NeutronGeneralProcess::Table> NeutronGeneralProcess::fTables;
+
+namespace {
+  G4Mutex generalMutex = G4MUTEX_INITIALIZER;
+
+  const G4int nbChecks = 2000;
+  // 100 points per decade: the smooth parts only
+  const G4int coarsePerDecade = 100;
+  // refined grids: start, and limits of the halving
+  const G4int startPerDecade = 50;
+  const G4int minDepth  = 1;
+  const G4int maxDepth  = 14;
+  const G4int maxPoints = 400000;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NeutronGeneralProcess::NeutronGeneralProcess(const G4String& name)
+: G4VDiscreteProcess(name, fHadronic),
+  fEmin(1.e-5*eV), fEmax(20.*MeV)
+{
+  for (G4int c=0; c<kNbChannel; c++) fProcess[c] = 0;
+  fLogEmin = std::log(fEmin);
+  fLogEmax = std::log(fEmax);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NeutronGeneralProcess::~NeutronGeneralProcess()
+{
+  for (G4int c=0; c<kNbChannel; c++) delete fProcess[c];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronGeneralProcess::SetProcess(Channel c, G4HadronicProcess* process)
+{
+  fProcess[c] = process;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NeutronGeneralProcess::IsApplicable(const G4ParticleDefinition& part)
+{
+  return (&part == G4Neutron::Neutron());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronGeneralProcess::PreparePhysicsTable(const G4ParticleDefinition& part)
+{
+  for (G4int c=0; c<kNbChannel; c++) {
+    if (fProcess[c]) fProcess[c]->PreparePhysicsTable(part);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronGeneralProcess::BuildPhysicsTable(const G4ParticleDefinition& part)
+{
+  // the data sets of the sub-processes are loaded first
+  for (G4int c=0; c<kNbChannel; c++) {
+    if (fProcess[c]) fProcess[c]->BuildPhysicsTable(part);
+  }
+
+  // the tables are the same on every thread: built by the master
+  G4AutoLock lock(&generalMutex);
+  if (!G4Threading::IsMasterThread()) return;
+
+  // the HP data sets Doppler-broaden by sampling the thermal motion of the
+  // target, which draws random numbers and leaves noise of the order of a
+  // percent: the tables are built from the unbroadened data, as the union
+  // grid, so that they are reproducible and the refinement converges
+  G4ParticleHPManager* hpManager = G4ParticleHPManager::GetInstance();
+  G4bool neglectDoppler = hpManager->GetNeglectDoppler();
+  hpManager->SetNeglectDoppler(true);
+
+  const G4MaterialTable* materials = G4Material::GetMaterialTable();
+  std::size_t nMat = materials->size();
+  fTables.assign(nMat, Table());
+  std::size_t nbPoints = 0;
+  for (std::size_t im=0; im<nMat; im++) {
+    BuildTable((*materials)[im], fTables[im]);
+    nbPoints += fTables[im].fLogE.size();
+  }
+
+  if (verboseLevel > 0) {
+    G4cout << "\n " << GetProcessName() << ": neutron cross sections of "
+           << nMat << " materials tabulated from " << fEmin/eV << " eV to "
+           << fEmax/MeV << " MeV, ";
+    if (fCoarseGrid) G4cout << coarsePerDecade << " points per decade";
+    else G4cout << nbPoints << " points in all (tolerance " << fTolerance
+                << ")";
+    G4cout << G4endl;
+  }
+  for (std::size_t im=0; im<nMat; im++) CheckAccuracy((*materials)[im]);
+  hpManager->SetNeglectDoppler(neglectDoppler);
+
+  for (std::size_t im=0; im<nMat; im++) {
+    if (!fTables[im].fTruncated) continue;
+    G4ExceptionDescription description;
+    description << GetProcessName() << ": the grid of "
+                << (*materials)[im]->GetName() << " reached " << maxPoints
+                << " points before the tolerance " << fTolerance
+                << " was met; raise /testhadr/phys/generalProcessTolerance";
+    G4Exception("NeutronGeneralProcess::BuildPhysicsTable()", "Monitor002",
+                FatalException, description);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronGeneralProcess::ComputeChannels(const G4Material* material,
+                                            G4double logE,
+                                            std::vector<G4double>& xs) const
+{
+  G4double ekin = std::exp(logE);
+  xs.assign(kNbChannel+1, 0.);
+  for (G4int c=0; c<kNbChannel; c++) {
+    xs[c] = ComputeCrossSection(c, material, ekin);
+    xs[kNbChannel] += xs[c];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronGeneralProcess::BuildTable(const G4Material* material,
+                                       Table& table) const
+{
+  // channels and total at each point of fLogE
+  std::vector< std::vector<G4double> > points;
+  table.fLogE.clear();
+  table.fTruncated = false;
+
+  G4int perDecade = fCoarseGrid ? coarsePerDecade : startPerDecade;
+  G4int nStart = G4int(perDecade*(fLogEmax - fLogEmin)/std::log(10.));
+  G4double delta = (fLogEmax - fLogEmin)/nStart;
+
+  std::vector<G4double> xs0, xs1;
+  ComputeChannels(material, fLogEmin, xs0);
+  table.fLogE.push_back(fLogEmin);
+  points.push_back(xs0);
+  for (G4int i=1; i<=nStart; i++) {
+    G4double logE0 = fLogEmin + (i-1)*delta;
+    G4double logE1 = (i == nStart) ? fLogEmax : fLogEmin + i*delta;
+    ComputeChannels(material, logE1, xs1);
+    if (!fCoarseGrid)
+      Refine(material, table, points, logE0, xs0, logE1, xs1, 0);
+    table.fLogE.push_back(logE1);
+    points.push_back(xs1);
+    xs0 = xs1;
+  }
+
+  // channel-major storage
+  std::size_t n = table.fLogE.size();
+  table.fXS.assign((kNbChannel+1)*n, 0.);
+  for (std::size_t i=0; i<n; i++) {
+    for (G4int c=0; c<=kNbChannel; c++) table.fXS[c*n + i] = points[i][c];
+  }
+
+  // hash bins uniform in log E, about one grid point per bin
+  G4int nHash = n;
+  table.fHashInvDelta = nHash/(fLogEmax - fLogEmin);
+  table.fHash.resize(nHash);
+  std::size_t i = 0;
+  for (G4int h=0; h<nHash; h++) {
+    G4double edge = fLogEmin + h/table.fHashInvDelta;
+    while (i+2 < n && table.fLogE[i+1] <= edge) i++;
+    table.fHash[h] = i;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronGeneralProcess::Refine(const G4Material* material, Table& table,
+                                   std::vector< std::vector<G4double> >& points,
+                                   G4double logE0,
+                                   const std::vector<G4double>& xs0,
+                                   G4double logE1,
+                                   const std::vector<G4double>& xs1,
+                                   G4int depth) const
+{
+  if (depth >= maxDepth) return;
+  if (G4int(table.fLogE.size()) >= maxPoints) {
+    table.fTruncated = true;
+    return;
+  }
+
+  // the midpoint against linear interpolation, for the total and the
+  // channels, relative to the total: the channels are sampled from it
+  G4double logEm = 0.5*(logE0 + logE1);
+  std::vector<G4double> xsm;
+  ComputeChannels(material, logEm, xsm);
+  G4bool converged = (depth >= minDepth);
+  G4double scale = std::max(xsm[kNbChannel], 1.e-10/cm);
+  for (G4int c=0; c<=kNbChannel && converged; c++) {
+    G4double interp = 0.5*(xs0[c] + xs1[c]);
+    if (std::fabs(interp - xsm[c]) > fTolerance*scale) converged = false;
+  }
+  if (converged) return;
+
+  Refine(material, table, points, logE0, xs0, logEm, xsm, depth+1);
+  table.fLogE.push_back(logEm);
+  points.push_back(xsm);
+  Refine(material, table, points, logEm, xsm, logE1, xs1, depth+1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronGeneralProcess::CheckAccuracy(const G4Material* material) const
+{
+  // tabulated total against the sum of the processes, unbroadened as the
+  // tables, at energies spread over the whole range (a fixed sequence,
+  // not random)
+  G4double maxErr = 0., sumErr2 = 0., eMax = 0.;
+  G4int nChecked = 0;
+  for (G4int j=0; j<nbChecks; j++) {
+    G4double u = std::fmod((j + 0.5)*0.6180339887, 1.);
+    G4double ekin = std::exp(fLogEmin + u*(fLogEmax - fLogEmin));
+    G4double sum = 0.;
+    for (G4int c=0; c<kNbChannel; c++)
+      sum += ComputeCrossSection(c, material, ekin);
+    if (sum <= 0.) continue;
+    G4double tabulated = GetCrossSection(kNbChannel, material, ekin);
+    G4double err = std::fabs(tabulated - sum)/sum;
+    if (err > maxErr) { maxErr = err; eMax = ekin; }
+    sumErr2 += err*err;
+    nChecked++;
+  }
+
+  if (verboseLevel > 0) {
+    G4cout << " " << GetProcessName() << ": " << std::setw(16)
+           << material->GetName()
+           << "   rms error " << std::setw(10)
+           << (nChecked ? 100*std::sqrt(sumErr2/nChecked) : 0.) << " %"
+           << "   max error " << std::setw(10) << 100*maxErr << " % at "
+           << G4BestUnit(eMax, "Energy") << G4endl;
+  }
+  if (maxErr > fTolerance) {
+    G4cout << "\n--> warning from NeutronGeneralProcess : total cross section"
+           << " of " << material->GetName() << " off by " << 100*maxErr
+           << " % at " << G4BestUnit(eMax, "Energy") << " (tolerance "
+           << 100*fTolerance << " %)";
+    if (fCoarseGrid)
+      G4cout << "; the coarse grid does not resolve the resonances, set"
+             << " /testhadr/phys/generalProcessCoarseGrid false";
+    G4cout << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const NeutronGeneralProcess* NeutronGeneralProcess::Registered()
+{
+  G4ProcessManager* pManager = G4Neutron::Neutron()->GetProcessManager();
+  if (!pManager) return 0;
+  G4ProcessVector* processes = pManager->GetProcessList();
+  for (std::size_t i=0; i<processes->size(); i++) {
+    const NeutronGeneralProcess* general =
+      dynamic_cast<const NeutronGeneralProcess*>(
+        BiasingOperator::PhysicsProcess((*processes)[i]));
+    if (general) return general;
+  }
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronGeneralProcess::CheckCompatibility()
+{
+  if (!Registered()) return;
+
+  // implicit capture removes nCapture from the sampling (BiasingOperator)
+  // and scores the expected captures instead: with the merged process the
+  // captures would still occur, and be counted twice
+  G4RegionStore* regions = G4RegionStore::GetInstance();
+  for (std::size_t i=0; i<regions->size(); i++) {
+    const RegionInformation* info = static_cast<const RegionInformation*>
+      ((*regions)[i]->GetUserInformation());
+    if (info && info->fImplicitCapture) {
+      G4ExceptionDescription description;
+      description << "implicit capture in region " << (*regions)[i]->GetName()
+                  << " needs the nCapture process, merged into nGeneral;"
+                  << " set /testhadr/phys/generalProcess false";
+      G4Exception("NeutronGeneralProcess::CheckCompatibility()", "Monitor001",
+                  FatalException, description);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronGeneralProcess::StartTracking(G4Track* track)
+{
+  G4VDiscreteProcess::StartTracking(track);
+  for (G4int c=0; c<kNbChannel; c++) {
+    if (fProcess[c]) fProcess[c]->StartTracking(track);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NeutronGeneralProcess::ComputeCrossSection(G4int c,
+                                                    const G4Material* material,
+                                                    G4double ekin) const
+{
+  if (!fProcess[c]) return 0.;
+  G4DynamicParticle neutron(G4Neutron::Neutron(), G4ThreeVector(0,0,1), ekin);
+  const G4ElementVector* elements = material->GetElementVector();
+  const G4double* nbAtoms = material->GetVecNbOfAtomsPerVolume();
+  G4double xs = 0.;
+  for (std::size_t i=0; i<material->GetNumberOfElements(); i++) {
+    xs += nbAtoms[i]*fProcess[c]->GetElementCrossSection(&neutron,
+                                                 (*elements)[i], material);
+  }
+  return xs;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NeutronGeneralProcess::GetCrossSection(G4int c,
+                                                const G4Material* material,
+                                                G4double ekin) const
+{
+  // outside of the grid, evaluate the data sets directly
+  if (ekin < fEmin || ekin >= fEmax) {
+    if (c < kNbChannel) return ComputeCrossSection(c, material, ekin);
+    G4double total = 0.;
+    for (G4int k=0; k<kNbChannel; k++) {
+      total += ComputeCrossSection(k, material, ekin);
+    }
+    return total;
+  }
+
+  // hashed search of the grid of the material, then linear interpolation
+  // in log(E)
+  const Table& table = fTables[material->GetIndex()];
+  G4double logE = std::log(ekin);
+  G4int nHash = table.fHash.size();
+  G4int h = std::min(G4int((logE - fLogEmin)*table.fHashInvDelta), nHash-1);
+  G4int n = table.fLogE.size();
+  G4int lo = table.fHash[h];
+  G4int hi = (h+1 < nHash) ? table.fHash[h+1] : n - 2;
+  const G4double* logGrid = &table.fLogE[0];
+  G4int i = std::upper_bound(logGrid + lo + 1, logGrid + hi + 1, logE)
+            - logGrid - 1;
+  const G4double* xs = &table.fXS[c*n];
+  G4double f = (logE - logGrid[i])/(logGrid[i+1] - logGrid[i]);
+  return xs[i] + f*(xs[i+1] - xs[i]);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NeutronGeneralProcess::GetMeanFreePath(const G4Track& track, G4double,
+                                                G4ForceCondition* condition)
+{
+  *condition = NotForced;
+  G4double xs = GetCrossSection(kNbChannel, track.GetMaterial(),
+                                track.GetKineticEnergy());
+  return (xs > 0.) ? 1./xs : DBL_MAX;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VParticleChange* NeutronGeneralProcess::PostStepDoIt(const G4Track& track,
+                                                       const G4Step& step)
+{
+  // sample the channel from the tabulated partial cross sections
+  const G4Material* material = track.GetMaterial();
+  G4double ekin = track.GetKineticEnergy();
+  G4double xs[kNbChannel], total = 0.;
+  for (G4int c=0; c<kNbChannel; c++) {
+    xs[c] = GetCrossSection(c, material, ekin);
+    total += xs[c];
+  }
+  G4int channel = kElastic;
+  G4double r = total*G4UniformRand();
+  for (G4int c=0; c<kNbChannel; c++) {
+    if (xs[c] <= 0.) continue;
+    channel = c;
+    if (r < xs[c]) break;
+    r -= xs[c];
+  }
+
+  // the hadronic process samples the target element from the per-element
+  // cross sections of the last evaluation of its data store: refresh them
+  // (without touching its interaction length; the HP data sets draw random
+  // numbers for the Doppler broadening, as in the stock processes)
+  const G4DynamicParticle* particle = track.GetDynamicParticle();
+  G4HadronicProcess* process = fProcess[channel];
+  G4double xsChannel = process->GetCrossSectionDataStore()
+                         ->GetCrossSection(particle, material);
+  if (xsChannel <= 0. && channel != kElastic) {
+    // interpolation across a threshold
+    channel = kElastic;
+    process = fProcess[kElastic];
+    process->GetCrossSectionDataStore()->GetCrossSection(particle, material);
+  }
+
+  // the step is reported as limited by the selected process, so that the
+  // user actions keep seeing hadElastic, neutronInelastic, nCapture ...
+  step.GetPostStepPoint()->SetProcessDefinedStep(process);
+
+  ClearNumberOfInteractionLengthLeft();
+  G4VParticleChange* change = process->PostStepDoIt(track, step);
+
+  // the stepping manager makes nGeneral the creator of the secondaries:
+  // keep the channel for the user actions (capture gammas ...)
+  for (G4int i=0; i<change->GetNumberOfSecondaries(); i++) {
+    G4Track* secondary = change->GetSecondary(i);
+    TrackInformation* info =
+      static_cast<TrackInformation*>(secondary->GetUserInformation());
+    if (!info) {
+      info = new TrackInformation();
+      secondary->SetUserInformation(info);
+    }
+    info->fGeneralChannel = channel;
+  }
+  return change;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
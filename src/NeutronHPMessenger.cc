@@ -33,15 +33,19 @@
 #include "NeutronHPMessenger.hh"
 
 #include "NeutronHPphysics.hh"
+#include "UnionGridCrossSection.hh"
+#include "NeutronGeneralProcess.hh"
 
 #include "G4UIdirectory.hh"
 #include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 NeutronHPMessenger::NeutronHPMessenger(NeutronHPphysics* phys)
 :G4UImessenger(),fNeutronPhysics(phys),
- fPhysDir(0), fThermalCmd(0)
+ fPhysDir(0), fThermalCmd(0), fGeneralCmd(0),
+ fUnionGridCmd(0), fUnionTolCmd(0), fGeneralTolCmd(0), fGeneralCoarseCmd(0)
 { 
   fPhysDir = new G4UIdirectory("/testhadr/phys/");
   fPhysDir->SetGuidance("physics list commands");
@@ -50,6 +54,39 @@ NeutronHPMessenger::NeutronHPMessenger(NeutronHPphysics* phys)
   fThermalCmd->SetGuidance("set thermal scattering model");
   fThermalCmd->SetParameterName("thermal",false);
   fThermalCmd->AvailableForStates(G4State_PreInit);  
+
+  fGeneralCmd = new G4UIcmdWithABool("/testhadr/phys/generalProcess",this);
+  fGeneralCmd->SetGuidance("merge the neutron processes into a single one");
+  fGeneralCmd->SetGuidance("with tabulated per-material cross sections");
+  fGeneralCmd->SetParameterName("general",false);
+  fGeneralCmd->AvailableForStates(G4State_PreInit);  
+
+  fGeneralTolCmd = new G4UIcmdWithADouble("/testhadr/phys/generalProcessTolerance",this);
+  fGeneralTolCmd->SetGuidance("relative tolerance of the tabulated cross sections");
+  fGeneralTolCmd->SetGuidance("of the general process: refinement of the grids and");
+  fGeneralTolCmd->SetGuidance("check at initialisation");
+  fGeneralTolCmd->SetParameterName("tolerance",false);
+  fGeneralTolCmd->SetRange("tolerance>0.");
+  fGeneralTolCmd->AvailableForStates(G4State_PreInit);  
+
+  fGeneralCoarseCmd = new G4UIcmdWithABool("/testhadr/phys/generalProcessCoarseGrid",this);
+  fGeneralCoarseCmd->SetGuidance("fixed grid of 100 points per decade for the general");
+  fGeneralCoarseCmd->SetGuidance("process instead of the refined grids (resonances not");
+  fGeneralCoarseCmd->SetGuidance("resolved)");
+  fGeneralCoarseCmd->SetParameterName("coarse",false);
+  fGeneralCoarseCmd->AvailableForStates(G4State_PreInit);  
+
+  fUnionGridCmd = new G4UIcmdWithABool("/testhadr/phys/unionGrid",this);
+  fUnionGridCmd->SetGuidance("tabulate the neutron cross sections per material");
+  fUnionGridCmd->SetGuidance("on a union energy grid with hashed lookup");
+  fUnionGridCmd->SetParameterName("union",false);
+  fUnionGridCmd->AvailableForStates(G4State_PreInit);  
+
+  fUnionTolCmd = new G4UIcmdWithADouble("/testhadr/phys/unionGridTolerance",this);
+  fUnionTolCmd->SetGuidance("relative interpolation tolerance of the union grid");
+  fUnionTolCmd->SetParameterName("tolerance",false);
+  fUnionTolCmd->SetRange("tolerance>0.");
+  fUnionTolCmd->AvailableForStates(G4State_PreInit);  
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -57,6 +94,11 @@ NeutronHPMessenger::NeutronHPMessenger(NeutronHPphysics* phys)
 NeutronHPMessenger::~NeutronHPMessenger()
 {
   delete fThermalCmd;
+  delete fGeneralCmd;
+  delete fGeneralTolCmd;
+  delete fGeneralCoarseCmd;
+  delete fUnionGridCmd;
+  delete fUnionTolCmd;
   delete fPhysDir;
 }
 
@@ -66,6 +108,21 @@ void NeutronHPMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
 {   
   if (command == fThermalCmd)
    {fNeutronPhysics->SetThermalPhysics(fThermalCmd->GetNewBoolValue(newValue));}
+
+  if (command == fGeneralCmd)
+   {fNeutronPhysics->SetGeneralProcess(fGeneralCmd->GetNewBoolValue(newValue));}
+
+  if (command == fGeneralTolCmd)
+   {NeutronGeneralProcess::SetTolerance(fGeneralTolCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fGeneralCoarseCmd)
+   {NeutronGeneralProcess::SetCoarseGrid(fGeneralCoarseCmd->GetNewBoolValue(newValue));}
+
+  if (command == fUnionGridCmd)
+   {fNeutronPhysics->SetUnionGrid(fUnionGridCmd->GetNewBoolValue(newValue));}
+
+  if (command == fUnionTolCmd)
+   {UnionGridCrossSection::SetTolerance(fUnionTolCmd->GetNewDoubleValue(newValue));}
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -33,6 +33,8 @@
 #include "NeutronHPphysics.hh"
 
 #include "NeutronHPMessenger.hh"
+#include "NeutronGeneralProcess.hh"
+#include "UnionGridCrossSection.hh"
 
 #include "G4ParticleDefinition.hh"
 #include "G4ProcessManager.hh"
@@ -63,7 +65,9 @@
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 NeutronHPphysics::NeutronHPphysics(const G4String& name)
-:  G4VPhysicsConstructor(name), fThermal(true), fNeutronMessenger(0)
+:  G4VPhysicsConstructor(name), fThermal(true), fGeneral(false),
+   fUnionGrid(false),
+   fNeutronMessenger(0)
 {
   fNeutronMessenger = new NeutronHPMessenger(this);
 }
@@ -96,33 +100,63 @@ void NeutronHPphysics::ConstructProcess()
   //
   process = pManager->GetProcess("nFission");      
   if (process) pManager->RemoveProcess(process);      
+  //
+  process = pManager->GetProcess("nGeneral");
+  if (process) pManager->RemoveProcess(process);
+
+  // with the general process, the four processes below are owned by it
+  // instead of being registered to the process manager
+  //
+  NeutronGeneralProcess* general = 0;
+  if (fGeneral) {
+    general = new NeutronGeneralProcess();
+    pManager->AddDiscreteProcess(general);
+  }
          
   // (re) create process: elastic
   //
   G4HadronElasticProcess* process1 = new G4HadronElasticProcess();
-  pManager->AddDiscreteProcess(process1);
+  if (general) general->SetProcess(NeutronGeneralProcess::kElastic, process1);
+  else pManager->AddDiscreteProcess(process1);
   //
   // model1a
   G4ParticleHPElastic*  model1a = new G4ParticleHPElastic();
   process1->RegisterMe(model1a);
-  process1->AddDataSet(new G4ParticleHPElasticData());
+  //
+  // optionally, the data sets of each process are tabulated per material
+  // on a union energy grid (see UnionGridCrossSection)
+  UnionGridCrossSection* union1 = 0;
+  if (fUnionGrid) {
+    union1 = new UnionGridCrossSection(fThermal ? "unionElasticThermal"
+                                                : "unionElastic");
+    union1->AddDataSet(new G4ParticleHPElasticData());
+  }
+  else process1->AddDataSet(new G4ParticleHPElasticData());
   //
   // model1b
   if (fThermal) {
     model1a->SetMinEnergy(4*eV);   
    G4ParticleHPThermalScattering* model1b = new G4ParticleHPThermalScattering();
     process1->RegisterMe(model1b);
-    process1->AddDataSet(new G4ParticleHPThermalScatteringData());
+    if (union1) union1->AddDataSet(new G4ParticleHPThermalScatteringData());
+    else process1->AddDataSet(new G4ParticleHPThermalScatteringData());
   }
+  if (union1) process1->AddDataSet(union1);
    
   // (re) create process: inelastic
   //
   G4NeutronInelasticProcess* process2 = new G4NeutronInelasticProcess();
-  pManager->AddDiscreteProcess(process2);   
+  if (general) general->SetProcess(NeutronGeneralProcess::kInelastic, process2);
+  else pManager->AddDiscreteProcess(process2);   
   //
   // cross section data set
   G4ParticleHPInelasticData* dataSet2 = new G4ParticleHPInelasticData();
-  process2->AddDataSet(dataSet2);                               
+  if (fUnionGrid) {
+    UnionGridCrossSection* union2 = new UnionGridCrossSection("unionInelastic");
+    union2->AddDataSet(dataSet2);
+    process2->AddDataSet(union2);
+  }
+  else process2->AddDataSet(dataSet2);                               
   //
   // models
   G4ParticleHPInelastic* model2 = new G4ParticleHPInelastic();
@@ -131,11 +165,17 @@ void NeutronHPphysics::ConstructProcess()
   // (re) create process: nCapture   
   //
   G4HadronCaptureProcess* process3 = new G4HadronCaptureProcess();
-  pManager->AddDiscreteProcess(process3);    
+  if (general) general->SetProcess(NeutronGeneralProcess::kCapture, process3);
+  else pManager->AddDiscreteProcess(process3);    
   //
   // cross section data set
   G4ParticleHPCaptureData* dataSet3 = new G4ParticleHPCaptureData();
-  process3->AddDataSet(dataSet3);
+  if (fUnionGrid) {
+    UnionGridCrossSection* union3 = new UnionGridCrossSection("unionCapture");
+    union3->AddDataSet(dataSet3);
+    process3->AddDataSet(union3);
+  }
+  else process3->AddDataSet(dataSet3);
   //
   // models
   G4ParticleHPCapture* model3 = new G4ParticleHPCapture();
@@ -144,11 +184,17 @@ void NeutronHPphysics::ConstructProcess()
   // (re) create process: nFission   
   //
   G4HadronFissionProcess* process4 = new G4HadronFissionProcess();
-  pManager->AddDiscreteProcess(process4);
+  if (general) general->SetProcess(NeutronGeneralProcess::kFission, process4);
+  else pManager->AddDiscreteProcess(process4);
   //
   // cross section data set
   G4ParticleHPFissionData* dataSet4 = new G4ParticleHPFissionData();
-  process4->AddDataSet(dataSet4);                               
+  if (fUnionGrid) {
+    UnionGridCrossSection* union4 = new UnionGridCrossSection("unionFission");
+    union4->AddDataSet(dataSet4);
+    process4->AddDataSet(union4);
+  }
+  else process4->AddDataSet(dataSet4);                               
   //
   // models
   G4ParticleHPFission* model4 = new G4ParticleHPFission();
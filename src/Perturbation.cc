@@ -0,0 +1,215 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Perturbation.cc
+/// \brief Implementation of the Perturbation class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "Perturbation.hh"
+#include "DetectorConstruction.hh"
+#include "BiasingOperator.hh"
+
+#include "G4Step.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4Neutron.hh"
+#include "G4HadronicProcess.hh"
+#include "G4HadronicProcessStore.hh"
+#include "G4Nucleus.hh"
+#include "G4LogicalVolume.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  const G4int kMaxElements = 16;
+
+  // per thread: element cross sections of the last material and energy,
+  // reused while a neutron flies through a material at the same energy
+  G4ThreadLocal const G4Material* gMaterial = 0;
+  G4ThreadLocal G4double          gEkin = -1.;
+  G4ThreadLocal G4double          gSigma[kMaxElements];
+
+  const char* parameterNames[Perturbation::kNbParameters] =
+    { "boron mass fraction of B-Poly", "hydrogen mass fraction of B-Poly",
+      "density of the tank water" };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Perturbation* Perturbation::Instance()
+{
+  static Perturbation instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Perturbation::Perturbation()
+: fActive(false)
+{
+  for (G4int p=0; p<kNbParameters; p++) fValue[p] = 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const char* Perturbation::ParameterName(G4int p)
+{
+  return (p >= 0 && p < kNbParameters) ? parameterNames[p] : "unknown";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Perturbation::Print() const
+{
+  G4cout << "\n Perturbation tallies: " << (fActive ? "on" : "off")
+         << G4endl;
+  for (std::size_t t=0; t<fTargets.size(); t++) {
+    G4int p = fTargets[t].fParameter;
+    G4cout << "  " << ParameterName(p) << " ("
+           << fTargets[t].fMaterial->GetName() << ") : "
+           << (p == kWaterDensity ? fValue[p]/(g/cm3) : fValue[p])
+           << (p == kWaterDensity ? " g/cm3" : "") << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Perturbation::BeginOfRun(const DetectorConstruction* det)
+{
+  fTargets.clear();
+  for (G4int p=0; p<kNbParameters; p++) fValue[p] = 0.;
+  if (!fActive) return;
+
+  const G4Material* poly = det->polyL->GetMaterial();
+  AddTarget(poly, kBoron, 5);
+  AddTarget(poly, kHydrogen, 1);
+  AddTarget(det->tankL->GetMaterial(), kWaterDensity, 0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Perturbation::AddTarget(const G4Material* material, G4int parameter,
+                             G4int Z)
+{
+  G4int nbElements = material->GetNumberOfElements();
+  if (nbElements > kMaxElements) {
+    G4cout << "\n--> warning from Perturbation : " << material->GetName()
+           << " has too many elements" << G4endl;
+    return;
+  }
+  Target target;
+  target.fMaterial  = material;
+  target.fParameter = parameter;
+
+  // density: every element scales with it
+  if (Z == 0) {
+    fValue[parameter] = material->GetDensity();
+    target.fCoefficient.assign(nbElements, 1./material->GetDensity());
+    fTargets.push_back(target);
+    return;
+  }
+
+  // mass fraction w of element Z, the others scaled by (1 - w)
+  G4int index = -1;
+  for (G4int i=0; i<nbElements; i++)
+    if (material->GetElement(i)->GetZasInt() == Z) index = i;
+  G4double w = index >= 0 ? material->GetFractionVector()[index] : 0.;
+  if (w <= 0. || w >= 1.) {
+    G4cout << "\n--> warning from Perturbation : no element Z = " << Z
+           << " to perturb in " << material->GetName() << G4endl;
+    return;
+  }
+  fValue[parameter] = w;
+  for (G4int i=0; i<nbElements; i++)
+    target.fCoefficient.push_back(i == index ? 1./w : -1./(1. - w));
+  fTargets.push_back(target);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Perturbation::AddStep(const G4Step* step, G4double* derivative) const
+{
+  // most steps are in materials that are not perturbed
+  const G4StepPoint* pre = step->GetPreStepPoint();
+  const G4Material* material = pre->GetMaterial();
+  std::size_t first = 0;
+  while (first < fTargets.size() && fTargets[first].fMaterial != material)
+    first++;
+  if (first == fTargets.size()) return;
+
+  // macroscopic total cross section of each element
+  G4int nbElements = material->GetNumberOfElements();
+  G4double ekin = pre->GetKineticEnergy();
+  if (material != gMaterial || ekin != gEkin) {
+    G4HadronicProcessStore* store = G4HadronicProcessStore::Instance();
+    const G4ParticleDefinition* neutron = G4Neutron::Neutron();
+    const G4double* atoms = material->GetVecNbOfAtomsPerVolume();
+    for (G4int i=0; i<nbElements; i++) {
+      const G4Element* element = material->GetElement(i);
+      G4double sigma =
+        store->GetElasticCrossSectionPerAtom(neutron, ekin, element, material)
+      + store->GetInelasticCrossSectionPerAtom(neutron, ekin, element,
+                                               material)
+      + store->GetCaptureCrossSectionPerAtom(neutron, ekin, element, material)
+      + store->GetFissionCrossSectionPerAtom(neutron, ekin, element, material);
+      gSigma[i] = atoms[i]*sigma;
+    }
+    gMaterial = material;
+    gEkin     = ekin;
+  }
+
+  // element of the collision ending the step, if any; with the general
+  // process the step is reported as limited by the selected sub-process
+  G4int hit = -1;
+  const G4StepPoint* post = step->GetPostStepPoint();
+  if (post->GetStepStatus() == fPostStepDoItProc) {
+    const G4HadronicProcess* process = dynamic_cast<const G4HadronicProcess*>
+      (BiasingOperator::PhysicsProcess(post->GetProcessDefinedStep()));
+    if (process && process->GetTargetNucleus()) {
+      G4int Z = process->GetTargetNucleus()->GetZ_asInt();
+      for (G4int i=0; i<nbElements; i++)
+        if (material->GetElement(i)->GetZasInt() == Z) hit = i;
+    }
+  }
+
+  G4double length = step->GetStepLength();
+  for (std::size_t t=first; t<fTargets.size(); t++) {
+    const Target& target = fTargets[t];
+    if (target.fMaterial != material) continue;
+    G4double dSigma = 0.;
+    for (G4int i=0; i<nbElements; i++)
+      dSigma += target.fCoefficient[i]*gSigma[i];
+    derivative[target.fParameter] -= dSigma*length;
+    if (hit >= 0) derivative[target.fParameter] += target.fCoefficient[hit];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
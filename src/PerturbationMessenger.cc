@@ -0,0 +1,91 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PerturbationMessenger.cc
+/// \brief Implementation of the PerturbationMessenger class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "PerturbationMessenger.hh"
+
+#include "Perturbation.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PerturbationMessenger::PerturbationMessenger()
+:G4UImessenger(),
+ fPerturbationDir(0), fActiveCmd(0), fPrintCmd(0)
+{ 
+  // the settings are shared by all threads, so these commands are
+  // executed by the master only
+  fPerturbationDir = new G4UIdirectory("/testhadr/perturbation/");
+  fPerturbationDir->SetGuidance("first-order sensitivities of the tallies");
+
+  fActiveCmd = new G4UIcmdWithABool("/testhadr/perturbation/active",this);
+  fActiveCmd->SetGuidance("sensitivities to the boron and hydrogen fractions");
+  fActiveCmd->SetGuidance("of B-Poly and to the water density");
+  fActiveCmd->SetParameterName("flag",true);
+  fActiveCmd->SetDefaultValue(true);
+  fActiveCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fActiveCmd->SetToBeBroadcasted(false);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/testhadr/perturbation/print",this);
+  fPrintCmd->SetGuidance("print the perturbed parameters of the last run");
+  fPrintCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPrintCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PerturbationMessenger::~PerturbationMessenger()
+{
+  delete fActiveCmd;
+  delete fPrintCmd;
+  delete fPerturbationDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PerturbationMessenger::SetNewValue(G4UIcommand* command,
+                                        G4String newValue)
+{   
+  Perturbation* perturbation = Perturbation::Instance();
+
+  if (command == fActiveCmd)
+   {perturbation->SetActive(fActiveCmd->GetNewBoolValue(newValue));}
+
+  if (command == fPrintCmd)
+   {perturbation->Print();}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -30,16 +30,26 @@
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 #include "PhysicsList.hh"
+#include "PhysicsListMessenger.hh"
 
 #include "G4SystemOfUnits.hh"
 #include "G4UnitsTable.hh"
+#include "G4Version.hh"
 
 #include "NeutronHPphysics.hh"
 #include "G4EmStandardPhysics.hh"
+#include "G4EmStandardPhysics_option1.hh"
+#include "G4EmExtraPhysics.hh"
+#include "G4EmParameters.hh"
+#include "G4StepLimiterPhysics.hh"
+#include "G4GenericBiasingPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
 #include "G4DecayPhysics.hh"
 #include "G4RadioactiveDecayPhysics.hh"
+#include "G4StoppingPhysics.hh"
 
 #include "G4HadronElasticPhysicsHP.hh"
+#include "G4HadronPhysicsQGSP_BERT_HP.hh"
 #include "G4HadronPhysicsFTFP_BERT_HP.hh"
 #include "G4HadronPhysicsQGSP_BIC_HP.hh"
 #include "G4HadronInelasticQBBC.hh"
@@ -62,8 +72,9 @@
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-PhysicsList::PhysicsList()
-:G4VModularPhysicsList()
+PhysicsList::PhysicsList(const G4String& preset)
+:G4VModularPhysicsList(), fBiasingPhysics(0), fFastSimPhysics(0),
+ fMessenger(0)
 {
   SetVerboseLevel(1);
   
@@ -72,19 +83,142 @@ PhysicsList::PhysicsList()
   new G4UnitDefinition( "millielectronVolt", "meV", "Energy", 1.e-3*eV);   
   new G4UnitDefinition( "mm2/g",  "mm2/g", "Surface/Mass", mm2/g);
   new G4UnitDefinition( "um2/mg", "um2/mg","Surface/Mass", um*um/mg);  
-    
-  // Neutron Physics
-  RegisterPhysics( new NeutronHPphysics("neutronHP"));
 
-  //EM physics
-  RegisterPhysics(new G4EmStandardPhysics());
+  if (!SetPreset(preset)) SetPreset("reference");
 
+  fMessenger = new PhysicsListMessenger(this);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 PhysicsList::~PhysicsList()
-{ }
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsList::AddPhysics(G4VPhysicsConstructor* physics)
+{
+  RegisterPhysics(physics);
+  fPresetPhysics.push_back(physics);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhysicsList::IsPreset(const G4String& preset)
+{
+  return (preset == "reference" || preset == "lean" || preset == "fast" ||
+          preset == "neutron");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhysicsList::SetPreset(const G4String& preset)
+{
+  if (!IsPreset(preset)) {
+    G4cout << "\n--> warning from PhysicsList::SetPreset : "
+           << preset << " unknown (" << PresetNames() << ")" << G4endl;
+    return false;
+  }
+  if (preset == fPreset) return true;
+
+  // drop the constructors of the previous preset
+  for (std::size_t i=0; i<fPresetPhysics.size(); i++) {
+    RemovePhysics(fPresetPhysics[i]);
+    delete fPresetPhysics[i];
+  }
+  fPresetPhysics.clear();
+  fPreset = preset;
+
+  G4int ver = GetVerboseLevel();
+  if (preset == "reference") {
+    // same constructors and cuts as QGSP_BERT_HP
+    AddPhysics(new G4EmStandardPhysics(ver));
+    AddPhysics(new G4EmExtraPhysics(ver));
+    AddPhysics(new G4DecayPhysics(ver));
+    AddPhysics(new G4RadioactiveDecayPhysics(ver));
+    AddPhysics(new G4HadronElasticPhysicsHP(ver));
+    AddPhysics(new G4HadronPhysicsQGSP_BERT_HP(ver));
+    AddPhysics(new G4StoppingPhysics(ver));
+    AddPhysics(new G4IonPhysics(ver));
+    SetDefaultCutValue(0.7*mm);
+  }
+  else if (preset == "lean") {
+    AddPhysics(new NeutronHPphysics("neutronHP"));
+    AddPhysics(new G4EmStandardPhysics(ver));
+    SetDefaultCutValue(1.*mm);
+  }
+  else if (preset == "neutron") {
+    // no EM nor photonuclear physics at all
+    AddPhysics(new NeutronHPphysics("neutronHP"));
+    SetDefaultCutValue(1.*mm);
+  }
+  else {
+    // gammas see a single process with cached total cross sections;
+    // option1 drops the fine multiple-scattering tuning of the electrons
+    AddPhysics(new NeutronHPphysics("neutronHP"));
+    AddPhysics(new G4EmStandardPhysics_option1(ver));
+    SetDefaultCutValue(1.*mm);
+  }
+
+  // region user limits (max step, max time, min kinetic energy), for every
+  // preset; with no G4UserLimits set, the processes never limit a step, so
+  // the reference behaves as the stock list
+  AddPhysics(new G4StepLimiterPhysics());
+
+  // the biasing wrappers must be built after the processes they wrap
+  if (fBiasingPhysics) {
+    RemovePhysics(fBiasingPhysics);
+    RegisterPhysics(fBiasingPhysics);
+  }
+  if (fFastSimPhysics) {
+    RemovePhysics(fFastSimPhysics);
+    RegisterPhysics(fFastSimPhysics);
+  }
+
+#if G4VERSION_NUMBER >= 1060
+  G4EmParameters::Instance()->SetGeneralProcessActive(preset == "fast");
+#else
+  if (preset == "fast") {
+    G4cout << "\n--> warning from PhysicsList::SetPreset : "
+           << "G4GammaGeneralProcess needs Geant4 10.6 or later" << G4endl;
+  }
+#endif
+
+  G4cout << "\n Physics preset: " << fPreset << G4endl;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsList::SetBiasing(G4bool flag)
+{
+  if (flag == (fBiasingPhysics != 0)) return;
+  if (flag) {
+    G4GenericBiasingPhysics* biasing = new G4GenericBiasingPhysics();
+    biasing->PhysicsBias("neutron");
+    fBiasingPhysics = biasing;
+    RegisterPhysics(fBiasingPhysics);
+  }
+  else {
+    RemovePhysics(fBiasingPhysics);
+    delete fBiasingPhysics;
+    fBiasingPhysics = 0;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsList::SetFastSimulation(const G4String& particle)
+{
+  // a single constructor, registered last, collects the particles
+  if (!fFastSimPhysics) {
+    fFastSimPhysics = new G4FastSimulationPhysics();
+    RegisterPhysics(fFastSimPhysics);
+  }
+  fFastSimPhysics->ActivateFastSimulation(particle);
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -112,8 +246,19 @@ void PhysicsList::ConstructParticle()
 
 void PhysicsList::SetCuts()
 {
-  SetCutValue(0*mm, "proton");
-  SetCutValue(1.*mm, "gamma");
+  // default region; Probe, Shield, Tank, Slab and RoomAir may override
+  // these with /testhadr/det/region/setCut
+  G4VUserPhysicsList::SetCuts();
+  SetCutValue(GetDefaultCut("proton"), "proton");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double PhysicsList::GetDefaultCut(const G4String& particle) const
+{
+  // every recoil proton is produced, except in the stock reference list
+  if (particle == "proton" && fPreset != "reference") return 0.;
+  return GetDefaultCutValue();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,105 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file PhysicsListMessenger.cc
+/// \brief Implementation of the PhysicsListMessenger class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "PhysicsListMessenger.hh"
+
+#include "PhysicsList.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhysicsListMessenger::PhysicsListMessenger(PhysicsList* phys)
+:G4UImessenger(),fPhysicsList(phys),
+ fPhysDir(0), fPresetCmd(0), fBiasingCmd(0), fFastSimCmd(0)
+{ 
+  fPhysDir = new G4UIdirectory("/testhadr/phys/");
+  fPhysDir->SetGuidance("physics list commands");
+   
+  fPresetCmd = new G4UIcmdWithAString("/testhadr/phys/preset",this);
+  fPresetCmd->SetGuidance("select the physics preset");
+  fPresetCmd->SetGuidance("  reference : QGSP_BERT_HP");
+  fPresetCmd->SetGuidance("  lean      : NeutronHP + standard EM");
+  fPresetCmd->SetGuidance("  fast      : NeutronHP + EM option1 with"
+                          " G4GammaGeneralProcess, no photonuclear");
+  fPresetCmd->SetGuidance("  neutron   : NeutronHP only, capture gammas"
+                          " tallied at birth");
+  fPresetCmd->SetParameterName("preset",false);
+  fPresetCmd->SetCandidates(PhysicsList::PresetNames());
+  fPresetCmd->AvailableForStates(G4State_PreInit);  
+  fPresetCmd->SetToBeBroadcasted(false);
+
+  fBiasingCmd = new G4UIcmdWithABool("/testhadr/phys/biasing",this);
+  fBiasingCmd->SetGuidance("wrap the neutron processes for the variance");
+  fBiasingCmd->SetGuidance("reduction of /testhadr/bias/");
+  fBiasingCmd->SetParameterName("flag",true);
+  fBiasingCmd->SetDefaultValue(true);
+  fBiasingCmd->AvailableForStates(G4State_PreInit);
+  fBiasingCmd->SetToBeBroadcasted(false);
+
+  fFastSimCmd = new G4UIcmdWithAString("/testhadr/phys/fastSimulation",this);
+  fFastSimCmd->SetGuidance("let the fast simulation models of the regions");
+  fFastSimCmd->SetGuidance("act on a particle (see /testhadr/det/region/woodcock)");
+  fFastSimCmd->SetParameterName("particle",true);
+  fFastSimCmd->SetDefaultValue("gamma");
+  fFastSimCmd->AvailableForStates(G4State_PreInit);
+  fFastSimCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhysicsListMessenger::~PhysicsListMessenger()
+{
+  delete fPresetCmd;
+  delete fBiasingCmd;
+  delete fFastSimCmd;
+  delete fPhysDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsListMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{   
+  if (command == fPresetCmd)
+   {fPhysicsList->SetPreset(newValue);}
+
+  if (command == fBiasingCmd)
+   {fPhysicsList->SetBiasing(fBiasingCmd->GetNewBoolValue(newValue));}
+
+  if (command == fFastSimCmd)
+   {fPhysicsList->SetFastSimulation(newValue);}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
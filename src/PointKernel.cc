@@ -0,0 +1,449 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PointKernel.cc
+/// \brief Implementation of the PointKernel class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "PointKernel.hh"
+#include "GammaSites.hh"
+
+#include "G4Navigator.hh"
+#include "G4TransportationManager.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4SandiaTable.hh"
+#include "G4Gamma.hh"
+#include "G4KleinNishinaCompton.hh"
+#include "G4BetheHeitlerModel.hh"
+#include "G4Threading.hh"
+#include "G4Timer.hh"
+#include "G4UnitsTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#ifdef G4MULTITHREADED
+#include "G4WorkerThread.hh"
+#endif
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // mass energy-absorption coefficient of dry air (NIST), MeV and cm2/g
+  const G4int    kNbAir = 28;
+  const G4double kAirEnergy[kNbAir] =
+    { 0.01, 0.015, 0.02, 0.03, 0.04, 0.05, 0.06, 0.08, 0.1, 0.15, 0.2, 0.3,
+      0.4, 0.5, 0.6, 0.8, 1., 1.25, 1.5, 2., 3., 4., 5., 6., 8., 10., 15.,
+      20. };
+  const G4double kAirMuen[kNbAir] =
+    { 4.742, 1.334, 0.5389, 0.1537, 0.06833, 0.04098, 0.03041, 0.02407,
+      0.02325, 0.02496, 0.02672, 0.02872, 0.02949, 0.02966, 0.02953,
+      0.02882, 0.02789, 0.02666, 0.02547, 0.02345, 0.02057, 0.01870,
+      0.01740, 0.01647, 0.01525, 0.01450, 0.01353, 0.01311 };
+
+  G4double AirMuen(G4double ekin)
+  {
+    // log-log interpolation, clamped at the ends
+    G4double e = std::min(std::max(ekin/MeV, kAirEnergy[0]),
+                          kAirEnergy[kNbAir-1]);
+    G4int i = std::upper_bound(kAirEnergy, kAirEnergy + kNbAir, e)
+            - kAirEnergy - 1;
+    i = std::min(std::max(i, 0), kNbAir-2);
+    G4double f = std::log(e/kAirEnergy[i])
+               / std::log(kAirEnergy[i+1]/kAirEnergy[i]);
+    return kAirMuen[i]*std::pow(kAirMuen[i+1]/kAirMuen[i], f)*cm2/g;
+  }
+
+  const G4int kMaxSteps = 1000;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PointKernel* PointKernel::Instance()
+{
+  static PointKernel instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PointKernel::PointKernel()
+: fSiteCell(2*cm), fNbThreads(G4Threading::G4GetNumberOfCores()),
+  fBuildupFile("buildup.dat"), fOutputFile("pointKernel.csv"),
+  fWorld(0), fNbMaterials(0)
+{
+  fModels[0] = fModels[1] = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PointKernel::~PointKernel()
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PointKernel::AddPoint(const G4ThreeVector& point)
+{
+  fPoints.push_back(point);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PointKernel::AddMesh(G4int nx, G4int ny, G4int nz,
+                          const G4ThreeVector& low, const G4ThreeVector& high)
+{
+  G4ThreeVector step = high - low;
+  step.set(step.x()/nx, step.y()/ny, step.z()/nz);
+  for (G4int i=0; i<nx; i++) {
+    for (G4int j=0; j<ny; j++) {
+      for (G4int k=0; k<nz; k++) {
+        fPoints.push_back(low + G4ThreeVector((i+0.5)*step.x(),
+                                              (j+0.5)*step.y(),
+                                              (k+0.5)*step.z()));
+      }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PointKernel::List() const
+{
+  G4cout << "\n Point-kernel gamma dose: " << fPoints.size() << " points,"
+         << " site cells of " << G4BestUnit(fSiteCell, "Length") << ", "
+         << fNbThreads << " threads, buildup " << fBuildupFile
+         << ", output " << fOutputFile << G4endl;
+  for (std::size_t i=0; i<fPoints.size() && i<20; i++)
+    G4cout << "  " << std::setw(4) << i << "  "
+           << G4BestUnit(fPoints[i], "Length") << G4endl;
+  if (fPoints.size() > 20) G4cout << "  ..." << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PointKernel::ReadBuildup()
+{
+  fBuildup.clear();
+  if (fBuildupFile == "none") return true;
+  std::ifstream in(fBuildupFile);
+  if (!in) {
+    G4cout << "\n--> warning from PointKernel : cannot open "
+           << fBuildupFile << ", no buildup" << G4endl;
+    return false;
+  }
+  // material, energy [MeV], a, b per line, '#' comments
+  G4String line;
+  while (std::getline(in, line)) {
+    std::size_t hash = line.find('#');
+    if (hash != std::string::npos) line.erase(hash);
+    std::istringstream is(line);
+    G4String material;
+    Berger berger;
+    if (!(is >> material)) continue;
+    if (!(is >> berger.fEnergy >> berger.fA >> berger.fB)) {
+      G4cout << "\n--> warning from PointKernel : bad line in "
+             << fBuildupFile << " : " << line << G4endl;
+      continue;
+    }
+    berger.fEnergy *= MeV;
+    fBuildup[material].push_back(berger);
+  }
+  std::map<G4String, std::vector<Berger> >::iterator it;
+  for (it = fBuildup.begin(); it != fBuildup.end(); it++) {
+    std::vector<Berger>& table = it->second;
+    for (std::size_t i=1; i<table.size(); i++) {
+      for (std::size_t j=i; j>0 && table[j].fEnergy < table[j-1].fEnergy; j--)
+        std::swap(table[j], table[j-1]);
+    }
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PointKernel::PrepareTables()
+{
+  // the Compton and pair models, for their cross sections per atom only;
+  // the photoelectric effect from the Sandia parameterization
+  if (!fModels[0]) {
+    fModels[0] = new G4KleinNishinaCompton();
+    fModels[1] = new G4BetheHeitlerModel();
+  }
+  ReadBuildup();
+
+  const G4MaterialTable* materials = G4Material::GetMaterialTable();
+  const G4ParticleDefinition* gamma = G4Gamma::Gamma();
+  G4int nbGroups = GammaSites::NbGroups();
+  fNbMaterials = materials->size();
+  fMu.assign(nbGroups*fNbMaterials, 0.);
+  fBuildupA.assign(nbGroups*fNbMaterials, 0.);
+  fBuildupB.assign(nbGroups*fNbMaterials, 0.);
+  fDensity.assign(fNbMaterials, 0.);
+  fKermaFactor.assign(nbGroups, 0.);
+  for (G4int g=0; g<nbGroups; g++) {
+    G4double energy = GammaSites::GroupEnergy(g);
+    fKermaFactor[g] = energy*AirMuen(energy);
+  }
+
+  G4String missing;
+  for (G4int m=0; m<fNbMaterials; m++) {
+    const G4Material* material = (*materials)[m];
+    fDensity[m] = material->GetDensity();
+    const G4ElementVector* elements = material->GetElementVector();
+    const G4double* atoms = material->GetVecNbOfAtomsPerVolume();
+    std::map<G4String, std::vector<Berger> >::const_iterator it
+      = fBuildup.find(material->GetName());
+    if (it == fBuildup.end() && fBuildupFile != "none" &&
+        material->GetState() != kStateGas)
+      missing += " " + material->GetName();
+
+    for (G4int g=0; g<nbGroups; g++) {
+      G4double energy = GammaSites::GroupEnergy(g);
+      const G4double* sandia =
+        material->GetSandiaTable()->GetSandiaCofForMaterial(energy);
+      G4double mu = sandia[0]/energy + sandia[1]/(energy*energy)
+                  + sandia[2]/(energy*energy*energy)
+                  + sandia[3]/(energy*energy*energy*energy);
+      for (std::size_t e=0; e<elements->size(); e++) {
+        G4double Z = (*elements)[e]->GetZ();
+        for (G4int k=0; k<2; k++)
+          mu += atoms[e]*fModels[k]->ComputeCrossSectionPerAtom(gamma,
+                                                                energy, Z);
+      }
+      fMu[g*fNbMaterials + m] = mu;
+      if (it == fBuildup.end()) continue;
+
+      // Berger coefficients: linear in log energy, constant beyond the table
+      const std::vector<Berger>& table = it->second;
+      std::size_t i = 0;
+      while (i+1 < table.size() && table[i+1].fEnergy < energy) i++;
+      G4double a = table[i].fA, b = table[i].fB;
+      if (i+1 < table.size() && energy > table[i].fEnergy) {
+        G4double f = std::log(energy/table[i].fEnergy)
+                   / std::log(table[i+1].fEnergy/table[i].fEnergy);
+        a += f*(table[i+1].fA - a);
+        b += f*(table[i+1].fB - b);
+      }
+      fBuildupA[g*fNbMaterials + m] = a;
+      fBuildupB[g*fNbMaterials + m] = b;
+    }
+  }
+  if (!missing.empty())
+    G4cout << "\n--> warning from PointKernel : no buildup factors for"
+           << missing << " (uncollided only when dominant)" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PointKernel::Trace(G4Navigator* navigator, const G4ThreeVector& from,
+                        const G4ThreeVector& to, G4double* path) const
+{
+  G4ThreeVector direction = to - from;
+  G4double remaining = direction.mag();
+  if (remaining <= 0.) return;
+  direction /= remaining;
+
+  G4ThreeVector position = from;
+  G4VPhysicalVolume* volume =
+    navigator->LocateGlobalPointAndSetup(position, &direction, false, false);
+  for (G4int i=0; volume && remaining > 0. && i<kMaxSteps; i++) {
+    G4double safety;
+    G4double step = std::min(
+      navigator->ComputeStep(position, direction, remaining, safety),
+      remaining);
+    path[volume->GetLogicalVolume()->GetMaterial()->GetIndex()] += step;
+    remaining -= step;
+    position  += step*direction;
+    navigator->SetGeometricallyLimitedStep();
+    volume = navigator->LocateGlobalPointAndSetup(position, &direction, true);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PointKernel::ComputeRange(std::size_t begin, std::size_t end,
+                               G4double* results) const
+{
+#ifdef G4MULTITHREADED
+  // the thread-local parts of the geometry, copied from the master as
+  // for a worker thread
+  G4WorkerThread::BuildGeometryAndPhysicsVector();
+#endif
+  // a private navigator: the geometry is only read
+  G4Navigator* navigator = new G4Navigator();
+  navigator->SetWorldVolume(fWorld);
+
+  std::size_t n = end - begin;
+  std::vector<G4double> path(fNbMaterials);
+  std::vector<G4double> mfp(n), a(n), b(n), geometric(n), kerma(n);
+  std::vector<G4double> uncollided(n), collided(n);
+  G4double rmin2 = 0.25*fSiteCell*fSiteCell;
+
+  for (std::size_t p=0; p<fPoints.size(); p++) {
+    const G4ThreeVector& point = fPoints[p];
+
+    // ray casting, one ray per site
+    for (std::size_t i=begin; i<end; i++) {
+      G4ThreeVector site(fX[i], fY[i], fZ[i]);
+      std::fill(path.begin(), path.end(), 0.);
+      Trace(navigator, site, point, &path[0]);
+      G4int g = fGroup[i];
+      const G4double* mu = &fMu[g*fNbMaterials];
+      G4double opt = 0., areal = 0.;
+      G4int dominant = 0;
+      for (G4int m=0; m<fNbMaterials; m++) {
+        opt += mu[m]*path[m];
+        if (path[m]*fDensity[m] > areal) {
+          areal = path[m]*fDensity[m];
+          dominant = m;
+        }
+      }
+      std::size_t k = i - begin;
+      mfp[k] = opt;
+      a[k] = fBuildupA[g*fNbMaterials + dominant];
+      b[k] = fBuildupB[g*fNbMaterials + dominant];
+      geometric[k] = fWeight[i]
+                   / (4*pi*std::max((point - site).mag2(), rmin2));
+      kerma[k] = fKermaFactor[g];
+    }
+
+    // the kernel over the sites of the batch, apart from the ray casting
+    // that dominates the cost; std::exp stays a scalar libm call (it is
+    // vectorised only with -ffast-math, which would reorder the sums)
+    for (std::size_t k=0; k<n; k++) {
+      uncollided[k] = geometric[k]*std::exp(-mfp[k]);
+      collided[k]   = uncollided[k]*(1. + a[k]*mfp[k]*std::exp(b[k]*mfp[k]));
+    }
+    G4double* result = results + p*kNbResults;
+    for (std::size_t k=0; k<n; k++) {
+      result[kFluence]         += collided[k];
+      result[kUncollided]      += uncollided[k];
+      result[kKerma]           += collided[k]*kerma[k];
+      result[kUncollidedKerma] += uncollided[k]*kerma[k];
+    }
+  }
+  delete navigator;
+#ifdef G4MULTITHREADED
+  G4WorkerThread::DestroyGeometryAndPhysicsVector();
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PointKernel::Compute(const GammaSites& sites, G4double histories)
+{
+  if (fPoints.empty() || histories <= 0.) return;
+  G4Timer timer;
+  timer.Start();
+
+  fWorld = G4TransportationManager::GetTransportationManager()
+             ->GetNavigatorForTracking()->GetWorldVolume();
+  PrepareTables();
+
+  // the sites, per history, in structure-of-arrays form
+  fX.clear(); fY.clear(); fZ.clear(); fWeight.clear(); fGroup.clear();
+  for (G4int g=0; g<GammaSites::NbGroups(); g++) {
+    const std::map<G4long,GammaSites::Site>& group = sites.GetSites(g);
+    std::map<G4long,GammaSites::Site>::const_iterator it;
+    for (it = group.begin(); it != group.end(); it++) {
+      if (it->second.fWeight <= 0.) continue;
+      G4ThreeVector centroid = it->second.fMoment/it->second.fWeight;
+      fX.push_back(centroid.x());
+      fY.push_back(centroid.y());
+      fZ.push_back(centroid.z());
+      fWeight.push_back(it->second.fWeight/histories);
+      fGroup.push_back(g);
+    }
+  }
+
+  // the sites split among the threads, each with its own results
+  std::size_t nbSites = fX.size();
+  G4int nbThreads = std::max(1, std::min(fNbThreads, G4int(nbSites)));
+  std::size_t nbResults = fPoints.size()*kNbResults;
+  std::vector<std::vector<G4double> > results(nbThreads,
+                                     std::vector<G4double>(nbResults, 0.));
+  std::vector<std::thread> threads;
+  for (G4int t=0; t<nbThreads; t++) {
+    std::size_t begin = nbSites*t/nbThreads, end = nbSites*(t+1)/nbThreads;
+    threads.push_back(std::thread(&PointKernel::ComputeRange, this,
+                                  begin, end, &results[t][0]));
+  }
+  for (std::size_t t=0; t<threads.size(); t++) threads[t].join();
+  for (G4int t=1; t<nbThreads; t++) {
+    for (std::size_t i=0; i<nbResults; i++) results[0][i] += results[t][i];
+  }
+  const std::vector<G4double>& total = results[0];
+  timer.Stop();
+
+  G4int prec = G4cout.precision(4);
+  G4cout << "\n Point-kernel gamma dose per source history: "
+         << nbSites << " condensed sites, " << fPoints.size() << " points, "
+         << nbThreads << " threads, " << timer.GetRealElapsed() << " s"
+         << G4endl;
+  for (std::size_t p=0; p<fPoints.size() && p<20; p++) {
+    const G4double* r = &total[p*kNbResults];
+    G4cout << "  " << std::setw(4) << p << "  "
+           << G4BestUnit(fPoints[p], "Length") << " fluence "
+           << std::setw(10) << r[kFluence]*cm2 << " /cm2 (uncollided "
+           << std::setw(10) << r[kUncollided]*cm2 << "), air kerma "
+           << std::setw(10) << G4BestUnit(r[kKerma], "Dose") << G4endl;
+  }
+  if (fPoints.size() > 20)
+    G4cout << "  ... (all points in " << fOutputFile << ")" << G4endl;
+  G4cout.precision(prec);
+
+  if (fOutputFile == "none") return;
+  std::ofstream out(fOutputFile);
+  if (!out) {
+    G4cout << "\n--> warning from PointKernel : cannot write "
+           << fOutputFile << G4endl;
+    return;
+  }
+  out << "x_cm,y_cm,z_cm,fluence_cm-2,uncollided_cm-2,"
+         "kerma_Gy,uncollided_kerma_Gy\n";
+  out << std::setprecision(6);
+  for (std::size_t p=0; p<fPoints.size(); p++) {
+    const G4double* r = &total[p*kNbResults];
+    out << fPoints[p].x()/cm << "," << fPoints[p].y()/cm << ","
+        << fPoints[p].z()/cm << "," << r[kFluence]*cm2 << ","
+        << r[kUncollided]*cm2 << "," << r[kKerma]/gray << ","
+        << r[kUncollidedKerma]/gray << "\n";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
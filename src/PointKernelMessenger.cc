@@ -0,0 +1,184 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PointKernelMessenger.cc
+/// \brief Implementation of the PointKernelMessenger class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "PointKernelMessenger.hh"
+
+#include "PointKernel.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWith3VectorAndUnit.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PointKernelMessenger::PointKernelMessenger()
+:G4UImessenger(),
+ fKernelDir(0), fPointCmd(0), fMeshCmd(0), fClearCmd(0), fCellCmd(0),
+ fThreadsCmd(0), fBuildupCmd(0), fOutputCmd(0), fListCmd(0)
+{ 
+  // the engine runs on the master at the end of the run, so these
+  // commands are executed by the master only
+  fKernelDir = new G4UIdirectory("/testhadr/pointKernel/");
+  fKernelDir->SetGuidance("point-kernel gamma dose from the recorded gamma sites");
+   
+  fPointCmd = new G4UIcmdWith3VectorAndUnit("/testhadr/pointKernel/addPoint",this);
+  fPointCmd->SetGuidance("add a dose point (world frame); any point turns on");
+  fPointCmd->SetGuidance("the recording of the gamma sites");
+  fPointCmd->SetParameterName("x","y","z",false);
+  fPointCmd->SetUnitCategory("Length");
+  fPointCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPointCmd->SetToBeBroadcasted(false);
+
+  fMeshCmd = new G4UIcommand("/testhadr/pointKernel/addMesh",this);
+  fMeshCmd->SetGuidance("add the cell centres of a regular mesh as dose points");
+  fMeshCmd->SetGuidance("  nx ny nz xmin ymin zmin xmax ymax zmax unit");
+  const char* meshPrms[6] = { "xmin", "ymin", "zmin", "xmax", "ymax", "zmax" };
+  const char* nbPrms[3]   = { "nx", "ny", "nz" };
+  for (G4int i=0; i<3; i++) {
+    G4UIparameter* nPrm = new G4UIparameter(nbPrms[i],'i',false);
+    nPrm->SetParameterRange(G4String(nbPrms[i]) + ">0");
+    fMeshCmd->SetParameter(nPrm);
+  }
+  for (G4int i=0; i<6; i++)
+    fMeshCmd->SetParameter(new G4UIparameter(meshPrms[i],'d',false));
+  G4UIparameter* unitPrm = new G4UIparameter("unit",'s',true);
+  unitPrm->SetDefaultValue("cm");
+  unitPrm->SetParameterCandidates(
+    G4UIcommand::UnitsList(G4UIcommand::CategoryOf("cm")));
+  fMeshCmd->SetParameter(unitPrm);
+  fMeshCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fMeshCmd->SetToBeBroadcasted(false);
+
+  fClearCmd = new G4UIcmdWithoutParameter("/testhadr/pointKernel/clear",this);
+  fClearCmd->SetGuidance("remove all dose points (engine off)");
+  fClearCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fClearCmd->SetToBeBroadcasted(false);
+
+  fCellCmd = new G4UIcmdWithADoubleAndUnit("/testhadr/pointKernel/siteCell",this);
+  fCellCmd->SetGuidance("size of the cells the gamma sites are condensed into");
+  fCellCmd->SetParameterName("size",false);
+  fCellCmd->SetRange("size>0.");
+  fCellCmd->SetUnitCategory("Length");
+  fCellCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fCellCmd->SetToBeBroadcasted(false);
+
+  fThreadsCmd = new G4UIcmdWithAnInteger("/testhadr/pointKernel/threads",this);
+  fThreadsCmd->SetGuidance("number of threads casting the rays");
+  fThreadsCmd->SetParameterName("n",false);
+  fThreadsCmd->SetRange("n>0");
+  fThreadsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fThreadsCmd->SetToBeBroadcasted(false);
+
+  fBuildupCmd = new G4UIcmdWithAString("/testhadr/pointKernel/buildup",this);
+  fBuildupCmd->SetGuidance("file of Berger buildup coefficients per material:");
+  fBuildupCmd->SetGuidance("  material energy[MeV] a b   (none: uncollided only)");
+  fBuildupCmd->SetParameterName("fileName",false);
+  fBuildupCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fBuildupCmd->SetToBeBroadcasted(false);
+
+  fOutputCmd = new G4UIcmdWithAString("/testhadr/pointKernel/output",this);
+  fOutputCmd->SetGuidance("csv file of the results at all points (none: off)");
+  fOutputCmd->SetParameterName("fileName",false);
+  fOutputCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fOutputCmd->SetToBeBroadcasted(false);
+
+  fListCmd = new G4UIcmdWithoutParameter("/testhadr/pointKernel/list",this);
+  fListCmd->SetGuidance("print the settings and the dose points");
+  fListCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fListCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PointKernelMessenger::~PointKernelMessenger()
+{
+  delete fPointCmd;
+  delete fMeshCmd;
+  delete fClearCmd;
+  delete fCellCmd;
+  delete fThreadsCmd;
+  delete fBuildupCmd;
+  delete fOutputCmd;
+  delete fListCmd;
+  delete fKernelDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PointKernelMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{   
+  PointKernel* kernel = PointKernel::Instance();
+
+  if (command == fPointCmd)
+   {kernel->AddPoint(fPointCmd->GetNew3VectorValue(newValue));}
+
+  if (command == fMeshCmd)
+   {
+     G4int nx, ny, nz;
+     G4double x0, y0, z0, x1, y1, z1;
+     G4String unt;
+     std::istringstream is(newValue);
+     is >> nx >> ny >> nz >> x0 >> y0 >> z0 >> x1 >> y1 >> z1 >> unt;
+     G4double unit = G4UIcommand::ValueOf(unt);
+     kernel->AddMesh(nx, ny, nz, G4ThreeVector(x0, y0, z0)*unit,
+                     G4ThreeVector(x1, y1, z1)*unit);
+   }
+
+  if (command == fClearCmd)
+   {kernel->ClearPoints();}
+
+  if (command == fCellCmd)
+   {kernel->SetSiteCell(fCellCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fThreadsCmd)
+   {kernel->SetNbThreads(fThreadsCmd->GetNewIntValue(newValue));}
+
+  if (command == fBuildupCmd)
+   {kernel->SetBuildupFile(newValue);}
+
+  if (command == fOutputCmd)
+   {kernel->SetOutputFile(newValue);}
+
+  if (command == fListCmd)
+   {kernel->List();}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
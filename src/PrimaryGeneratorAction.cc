@@ -36,20 +36,31 @@
 #include "PrimaryGeneratorAction.hh"
 
 #include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4Gamma.hh"
+#include "G4Neutron.hh"
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4PhysicalConstants.hh"
 #include "G4SystemOfUnits.hh"
 #include "Randomize.hh"
 #include "DetectorConstruction.hh"
+#include "CondensedSource.hh"
+#include "SourceTerm.hh"
+#include "GammaBank.hh"
+#include "ResponseMap.hh"
+#include "ResponseMatrix.hh"
+#include "CorrelatedSampling.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 PrimaryGeneratorAction::PrimaryGeneratorAction()
-: G4VUserPrimaryGeneratorAction(),fParticleGun(0)
+: G4VUserPrimaryGeneratorAction(),fParticleGun(0),fSourceGun(0)
 {
   G4int n_particle = 1;
   fParticleGun  = new G4ParticleGun(n_particle);
+  fSourceGun    = new G4ParticleGun(n_particle);
   
   // default particle kinematic
 
@@ -74,6 +85,7 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
   delete fParticleGun;
+  delete fSourceGun;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -82,6 +94,94 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
   //this function is called at the begining of event
   //
+  //correlated sampling: the random stream of the event is the same in
+  //every variant
+  //
+  const CorrelatedSampling* correlated = CorrelatedSampling::Instance();
+  if (correlated->IsRunning()) correlated->SeedEvent(anEvent->GetEventID());
+
+  //two-pass simulation, pass two: the gammas banked in history i of the
+  //neutron pass, each split into n copies
+  //
+  const GammaBank* bank = GammaBank::Instance();
+  if (bank->IsLoaded()) {
+    G4int nbGammas, split = bank->GetSplit();
+    const GammaBank::Record* gammas =
+      bank->GetHistory(anEvent->GetEventID(), nbGammas);
+    for (G4int i=0; i<nbGammas; i++) {
+      const GammaBank::Record& gamma = gammas[i];
+      for (G4int s=0; s<split; s++) {
+        G4PrimaryVertex* vertex = new G4PrimaryVertex(
+          G4ThreeVector(gamma.fPosition[0], gamma.fPosition[1],
+                        gamma.fPosition[2]), gamma.fTime);
+        G4PrimaryParticle* particle = new G4PrimaryParticle(G4Gamma::Gamma());
+        particle->SetMomentumDirection(G4ThreeVector(gamma.fDirection[0],
+                                                     gamma.fDirection[1],
+                                                     gamma.fDirection[2]));
+        particle->SetKineticEnergy(gamma.fEkin);
+        particle->SetWeight(gamma.fWeight/split);
+        vertex->SetPrimary(particle);
+        anEvent->AddPrimaryVertex(vertex);
+      }
+    }
+    return;
+  }
+
+  //response matrix: a neutron of the parallel beam of the event
+  //
+  const ResponseMatrix* matrix = ResponseMatrix::Instance();
+  if (matrix->IsActive()) {
+    G4ThreeVector position, direction;
+    G4double ekin;
+    matrix->Sample(matrix->Point(anEvent->GetEventID()), position,
+                   direction, ekin);
+    fSourceGun->SetParticleDefinition(G4Neutron::Neutron());
+    fSourceGun->SetParticlePosition(position);
+    fSourceGun->SetParticleMomentumDirection(direction);
+    fSourceGun->SetParticleEnergy(ekin);
+    fSourceGun->SetParticleTime(0.);
+    fSourceGun->GeneratePrimaryVertex(anEvent);
+    return;
+  }
+
+  //response map: an isotropic neutron in the stratum of the event
+  //
+  const ResponseMap* map = ResponseMap::Instance();
+  if (map->IsActive()) {
+    G4ThreeVector position;
+    G4double ekin;
+    map->Sample(map->Stratum(anEvent->GetEventID()), position, ekin);
+    G4double cosTheta = 2*G4UniformRand() - 1., phi = twopi*G4UniformRand();
+    G4double sinTheta = std::sqrt(1. - cosTheta*cosTheta);
+    fSourceGun->SetParticleDefinition(G4Neutron::Neutron());
+    fSourceGun->SetParticlePosition(position);
+    fSourceGun->SetParticleMomentumDirection(
+      G4ThreeVector(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta));
+    fSourceGun->SetParticleEnergy(ekin);
+    fSourceGun->SetParticleTime(0.);
+    fSourceGun->GeneratePrimaryVertex(anEvent);
+    return;
+  }
+
+  //condensed source term: one particle leaving the B-poly surface, its
+  //weight the whole leakage of a source history
+  //
+  const SourceTerm* source = CondensedSource::Instance()->GetSource();
+  if (source) {
+    G4int particle;
+    G4ThreeVector position, direction;
+    G4double ekin, time;
+    source->Sample(particle, position, direction, ekin, time);
+    fSourceGun->SetParticleDefinition(SourceTerm::Definition(particle));
+    fSourceGun->SetParticlePosition(position);
+    fSourceGun->SetParticleMomentumDirection(direction);
+    fSourceGun->SetParticleEnergy(ekin);
+    fSourceGun->SetParticleTime(time);
+    fSourceGun->GeneratePrimaryVertex(anEvent);
+    anEvent->GetPrimaryVertex()->SetWeight(source->GetLeakage());
+    return;
+  }
+
   //distribution uniform in solid angle
   //
   G4double cosTheta = 2*G4UniformRand() - 1., phi = twopi*G4UniformRand();
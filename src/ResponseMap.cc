@@ -0,0 +1,218 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ResponseMap.cc
+/// \brief Implementation of the ResponseMap class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "ResponseMap.hh"
+#include "ResponseMatrix.hh"
+#include "Run.hh"
+
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ResponseMap* ResponseMap::Instance()
+{
+  static ResponseMap instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ResponseMap::ResponseMap()
+: fNbE(1), fEmin(2.5*MeV), fEmax(2.5*MeV),
+  fTally(Run::kCaptureDetector), fOutputFile("responseMap.csv"),
+  fActive(false)
+{
+  fNb[0] = fNb[1] = fNb[2] = 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMap::SetBox(const G4ThreeVector& low, const G4ThreeVector& high)
+{
+  fLow  = G4ThreeVector(std::min(low.x(), high.x()),
+                        std::min(low.y(), high.y()),
+                        std::min(low.z(), high.z()));
+  fHigh = G4ThreeVector(std::max(low.x(), high.x()),
+                        std::max(low.y(), high.y()),
+                        std::max(low.z(), high.z()));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMap::SetCells(G4int nx, G4int ny, G4int nz)
+{
+  fNb[0] = nx;
+  fNb[1] = ny;
+  fNb[2] = nz;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMap::SetEnergies(G4int n, G4double emin, G4double emax)
+{
+  fNbE  = n;
+  fEmin = std::min(emin, emax);
+  fEmax = std::max(emin, emax);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool ResponseMap::SetTally(const G4String& name)
+{
+  G4int tally = Run::TallyIndex(name);
+  if (tally < 0) {
+    G4cout << "\n--> warning from ResponseMap : no tally " << name << G4endl;
+    return false;
+  }
+  fTally = tally;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool ResponseMap::SetActive(G4bool active)
+{
+  if (active && (fHigh - fLow).mag2() == 0.) {
+    G4cout << "\n--> warning from ResponseMap : no source box" << G4endl;
+    active = false;
+  }
+  if (active && ResponseMatrix::Instance()->IsActive()) {
+    G4cout << "\n--> warning from ResponseMap : the response matrix is on"
+           << G4endl;
+    active = false;
+  }
+  fActive = active;
+  return fActive;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMap::Sample(G4int stratum, G4ThreeVector& position,
+                         G4double& ekin) const
+{
+  G4int e = stratum % fNbE, cell = stratum / fNbE;
+  G4int index[3];
+  index[2] = cell % fNb[2];  cell /= fNb[2];
+  index[1] = cell % fNb[1];
+  index[0] = cell / fNb[1];
+  for (G4int i=0; i<3; i++) {
+    position[i] = fLow[i] + (fHigh[i] - fLow[i])
+                  *(index[i] + G4UniformRand())/fNb[i];
+  }
+  ekin = fEmin*std::pow(fEmax/fEmin, (e + G4UniformRand())/fNbE);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMap::Print() const
+{
+  G4cout << "\n Response map: " << (fActive ? "on" : "off") << ", source box "
+         << G4BestUnit(fLow, "Length") << " to "
+         << G4BestUnit(fHigh, "Length") << ", cells " << fNb[0] << " x "
+         << fNb[1] << " x " << fNb[2] << ", " << fNbE << " energy bins "
+         << G4BestUnit(fEmin, "Energy") << " to "
+         << G4BestUnit(fEmax, "Energy") << ", tally "
+         << Run::TallyName(fTally) << ", output " << fOutputFile << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMap::Report(const G4String& method, const G4String& outputFile,
+                         const std::vector<G4double>& histories,
+                         const std::vector<G4double>& sum,
+                         const std::vector<G4double>& sum2) const
+{
+  // per energy bin: response averaged over the cells, and the best cell
+  G4int nbCells = fNb[0]*fNb[1]*fNb[2];
+  G4int prec = G4cout.precision(4);
+  G4cout << "\n Response map (" << method << "), " << Run::TallyName(fTally)
+         << " per source neutron, " << nbCells << " cells:" << G4endl;
+  for (G4int e=0; e<fNbE; e++) {
+    G4double mean = 0., best = -1.;
+    G4int bestCell = 0;
+    for (G4int c=0; c<nbCells; c++) {
+      G4int s = c*fNbE + e;
+      G4double r = histories[s] > 0. ? sum[s]/histories[s] : 0.;
+      mean += r/nbCells;
+      if (r > best) { best = r; bestCell = c; }
+    }
+    G4ThreeVector centre;
+    G4int index[3] = { bestCell/(fNb[1]*fNb[2]),
+                       (bestCell/fNb[2]) % fNb[1], bestCell % fNb[2] };
+    for (G4int i=0; i<3; i++)
+      centre[i] = fLow[i] + (fHigh[i] - fLow[i])*(index[i] + 0.5)/fNb[i];
+    G4double e0 = fEmin*std::pow(fEmax/fEmin, G4double(e)/fNbE);
+    G4double e1 = fEmin*std::pow(fEmax/fEmin, G4double(e+1)/fNbE);
+    G4cout << "  " << std::setw(10) << G4BestUnit(e0, "Energy") << " - "
+           << std::setw(10) << G4BestUnit(e1, "Energy") << ": mean "
+           << std::setw(10) << mean << ", max " << std::setw(10) << best
+           << " at " << G4BestUnit(centre, "Length") << G4endl;
+  }
+  G4cout.precision(prec);
+
+  if (outputFile == "none") return;
+  std::ofstream out(outputFile);
+  if (!out) {
+    G4cout << "\n--> warning from ResponseMap : cannot write "
+           << outputFile << G4endl;
+    return;
+  }
+  out << "ix,iy,iz,x_cm,y_cm,z_cm,emin_MeV,emax_MeV,histories,"
+      << Run::TallyName(fTally) << ",rel_err\n";
+  out << std::setprecision(6);
+  for (G4int s=0; s<GetNbStrata(); s++) {
+    G4int e = s % fNbE, c = s / fNbE;
+    G4int index[3] = { c/(fNb[1]*fNb[2]), (c/fNb[2]) % fNb[1], c % fNb[2] };
+    G4double n = histories[s];
+    G4double mean = n > 0. ? sum[s]/n : 0.;
+    G4double var  = n > 1. ? (sum2[s]/n - mean*mean)/(n - 1.) : 0.;
+    out << index[0] << "," << index[1] << "," << index[2];
+    for (G4int i=0; i<3; i++)
+      out << "," << (fLow[i] + (fHigh[i] - fLow[i])*(index[i] + 0.5)/fNb[i])/cm;
+    out << "," << fEmin*std::pow(fEmax/fEmin, G4double(e)/fNbE)/MeV
+        << "," << fEmin*std::pow(fEmax/fEmin, G4double(e+1)/fNbE)/MeV
+        << "," << n << "," << mean << ","
+        << (mean > 0. ? std::sqrt(std::max(var, 0.))/mean : 0.) << "\n";
+  }
+  G4cout << " Response map written to " << outputFile << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
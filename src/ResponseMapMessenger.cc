@@ -0,0 +1,238 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ResponseMapMessenger.cc
+/// \brief Implementation of the ResponseMapMessenger class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "ResponseMapMessenger.hh"
+
+#include "ResponseMap.hh"
+#include "AdjointResponse.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ResponseMapMessenger::ResponseMapMessenger()
+:G4UImessenger(),
+ fMapDir(0), fBoxCmd(0), fCellsCmd(0), fEnergiesCmd(0), fTallyCmd(0),
+ fOutputCmd(0), fActiveCmd(0), fAdjointCmd(0), fGroupsCmd(0),
+ fThreadsCmd(0), fAdjointOutputCmd(0), fPrintCmd(0)
+{ 
+  // the map is shared by all threads, so these commands are executed by
+  // the master only
+  fMapDir = new G4UIdirectory("/testhadr/responseMap/");
+  fMapDir->SetGuidance("probe response versus source position and energy");
+   
+  fBoxCmd = new G4UIcommand("/testhadr/responseMap/box",this);
+  fBoxCmd->SetGuidance("source box, two corners in the world frame");
+  const char* boxPrms[6] = { "x0", "y0", "z0", "x1", "y1", "z1" };
+  for (G4int i=0; i<6; i++)
+    fBoxCmd->SetParameter(new G4UIparameter(boxPrms[i],'d',false));
+  G4UIparameter* unitPrm = new G4UIparameter("unit",'s',true);
+  unitPrm->SetDefaultValue("cm");
+  unitPrm->SetParameterCandidates(
+    G4UIcommand::UnitsList(G4UIcommand::CategoryOf("cm")));
+  fBoxCmd->SetParameter(unitPrm);
+  fBoxCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fBoxCmd->SetToBeBroadcasted(false);
+
+  fCellsCmd = new G4UIcommand("/testhadr/responseMap/cells",this);
+  fCellsCmd->SetGuidance("number of cells of the source box along x, y, z");
+  const char* cellPrms[3] = { "nx", "ny", "nz" };
+  for (G4int i=0; i<3; i++) {
+    G4UIparameter* nPrm = new G4UIparameter(cellPrms[i],'i',false);
+    nPrm->SetParameterRange(G4String(cellPrms[i]) + ">0");
+    fCellsCmd->SetParameter(nPrm);
+  }
+  fCellsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fCellsCmd->SetToBeBroadcasted(false);
+
+  fEnergiesCmd = new G4UIcommand("/testhadr/responseMap/energies",this);
+  fEnergiesCmd->SetGuidance("source energy: number of log bins, range");
+  G4UIparameter* nbPrm = new G4UIparameter("n",'i',false);
+  nbPrm->SetParameterRange("n>0");
+  fEnergiesCmd->SetParameter(nbPrm);
+  G4UIparameter* eminPrm = new G4UIparameter("emin",'d',false);
+  eminPrm->SetParameterRange("emin>0.");
+  fEnergiesCmd->SetParameter(eminPrm);
+  G4UIparameter* emaxPrm = new G4UIparameter("emax",'d',false);
+  emaxPrm->SetParameterRange("emax>0.");
+  fEnergiesCmd->SetParameter(emaxPrm);
+  G4UIparameter* eUnitPrm = new G4UIparameter("unit",'s',true);
+  eUnitPrm->SetDefaultValue("MeV");
+  eUnitPrm->SetParameterCandidates(
+    G4UIcommand::UnitsList(G4UIcommand::CategoryOf("MeV")));
+  fEnergiesCmd->SetParameter(eUnitPrm);
+  fEnergiesCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fEnergiesCmd->SetToBeBroadcasted(false);
+
+  fTallyCmd = new G4UIcmdWithAString("/testhadr/responseMap/tally",this);
+  fTallyCmd->SetGuidance("response tally (run summary name), default capDetector");
+  fTallyCmd->SetParameterName("tally",false);
+  fTallyCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fTallyCmd->SetToBeBroadcasted(false);
+
+  fOutputCmd = new G4UIcmdWithAString("/testhadr/responseMap/output",this);
+  fOutputCmd->SetGuidance("csv file of the response per stratum (none: off)");
+  fOutputCmd->SetParameterName("fileName",false);
+  fOutputCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fOutputCmd->SetToBeBroadcasted(false);
+
+  fActiveCmd = new G4UIcmdWithABool("/testhadr/responseMap/active",this);
+  fActiveCmd->SetGuidance("sample the source from the map strata");
+  fActiveCmd->SetParameterName("flag",true);
+  fActiveCmd->SetDefaultValue(true);
+  fActiveCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fActiveCmd->SetToBeBroadcasted(false);
+
+  fAdjointCmd = new G4UIcmdWithAnInteger("/testhadr/responseMap/adjoint",this);
+  fAdjointCmd->SetGuidance("histories of the adjoint walk from the He-3 tube");
+  fAdjointCmd->SetGuidance("at the start of every run (0: off)");
+  fAdjointCmd->SetParameterName("n",false);
+  fAdjointCmd->SetRange("n>=0");
+  fAdjointCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fAdjointCmd->SetToBeBroadcasted(false);
+
+  fGroupsCmd = new G4UIcmdWithAnInteger("/testhadr/responseMap/adjointGroups",this);
+  fGroupsCmd->SetGuidance("energy groups per decade of the adjoint walk");
+  fGroupsCmd->SetParameterName("n",false);
+  fGroupsCmd->SetRange("n>0");
+  fGroupsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fGroupsCmd->SetToBeBroadcasted(false);
+
+  fThreadsCmd = new G4UIcmdWithAnInteger("/testhadr/responseMap/adjointThreads",this);
+  fThreadsCmd->SetGuidance("number of threads of the adjoint walk");
+  fThreadsCmd->SetParameterName("n",false);
+  fThreadsCmd->SetRange("n>0");
+  fThreadsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fThreadsCmd->SetToBeBroadcasted(false);
+
+  fAdjointOutputCmd =
+    new G4UIcmdWithAString("/testhadr/responseMap/adjointOutput",this);
+  fAdjointOutputCmd->SetGuidance("csv file of the adjoint map (none: off)");
+  fAdjointOutputCmd->SetParameterName("fileName",false);
+  fAdjointOutputCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fAdjointOutputCmd->SetToBeBroadcasted(false);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/testhadr/responseMap/print",this);
+  fPrintCmd->SetGuidance("print the settings");
+  fPrintCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPrintCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ResponseMapMessenger::~ResponseMapMessenger()
+{
+  delete fBoxCmd;
+  delete fCellsCmd;
+  delete fEnergiesCmd;
+  delete fTallyCmd;
+  delete fOutputCmd;
+  delete fActiveCmd;
+  delete fAdjointCmd;
+  delete fGroupsCmd;
+  delete fThreadsCmd;
+  delete fAdjointOutputCmd;
+  delete fPrintCmd;
+  delete fMapDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMapMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{   
+  ResponseMap* map = ResponseMap::Instance();
+  AdjointResponse* adjoint = AdjointResponse::Instance();
+  std::istringstream is(newValue);
+
+  if (command == fBoxCmd)
+   {
+     G4double x0, y0, z0, x1, y1, z1;
+     G4String unt;
+     is >> x0 >> y0 >> z0 >> x1 >> y1 >> z1 >> unt;
+     G4double unit = G4UIcommand::ValueOf(unt);
+     map->SetBox(G4ThreeVector(x0, y0, z0)*unit,
+                 G4ThreeVector(x1, y1, z1)*unit);
+   }
+
+  if (command == fCellsCmd)
+   {
+     G4int nx, ny, nz;
+     is >> nx >> ny >> nz;
+     map->SetCells(nx, ny, nz);
+   }
+
+  if (command == fEnergiesCmd)
+   {
+     G4int n;
+     G4double emin, emax;
+     G4String unt;
+     is >> n >> emin >> emax >> unt;
+     G4double unit = G4UIcommand::ValueOf(unt);
+     map->SetEnergies(n, emin*unit, emax*unit);
+   }
+
+  if (command == fTallyCmd)
+   {map->SetTally(newValue);}
+
+  if (command == fOutputCmd)
+   {map->SetOutputFile(newValue);}
+
+  if (command == fActiveCmd)
+   {map->SetActive(fActiveCmd->GetNewBoolValue(newValue));}
+
+  if (command == fAdjointCmd)
+   {adjoint->SetNbHistories(fAdjointCmd->GetNewIntValue(newValue));}
+
+  if (command == fGroupsCmd)
+   {adjoint->SetGroupsPerDecade(fGroupsCmd->GetNewIntValue(newValue));}
+
+  if (command == fThreadsCmd)
+   {adjoint->SetNbThreads(fThreadsCmd->GetNewIntValue(newValue));}
+
+  if (command == fAdjointOutputCmd)
+   {adjoint->SetOutputFile(newValue);}
+
+  if (command == fPrintCmd)
+   {map->Print(); adjoint->Print();}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
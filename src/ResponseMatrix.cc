@@ -0,0 +1,261 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ResponseMatrix.cc
+/// \brief Implementation of the ResponseMatrix class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "ResponseMatrix.hh"
+#include "ResponseMap.hh"
+#include "DetectorConstruction.hh"
+#include "Run.hh"
+
+#include "G4Sphere.hh"
+#include "G4UnitsTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  const char kMagic[8] = { 'M','O','N','R','M','0','0','1' };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ResponseMatrix* ResponseMatrix::Instance()
+{
+  static ResponseMatrix instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ResponseMatrix::ResponseMatrix()
+: fNbE(1), fNbCos(1), fNbPhi(1), fEmin(2.5*MeV), fEmax(2.5*MeV),
+  fTally(Run::kCaptureDetector), fOutputFile("responseMatrix.bin"),
+  fActive(false), fRadius(0.)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::SetEnergies(G4int n, G4double emin, G4double emax)
+{
+  fNbE  = n;
+  fEmin = std::min(emin, emax);
+  fEmax = std::max(emin, emax);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::SetDirections(G4int nCos, G4int nPhi)
+{
+  fNbCos = nCos;
+  fNbPhi = nPhi;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool ResponseMatrix::SetTally(const G4String& name)
+{
+  G4int tally = Run::TallyIndex(name);
+  if (tally < 0) {
+    G4cout << "\n--> warning from ResponseMatrix : no tally " << name
+           << G4endl;
+    return false;
+  }
+  fTally = tally;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool ResponseMatrix::SetActive(G4bool active)
+{
+  // both own the source and the per-stratum scores of Run
+  if (active && ResponseMap::Instance()->IsActive()) {
+    G4cout << "\n--> warning from ResponseMatrix : the response map is on"
+           << G4endl;
+    active = false;
+  }
+  fActive = active;
+  return fActive;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::BeginOfRun(const DetectorConstruction* det,
+                                G4int nbEvents)
+{
+  if (!fActive) return;
+  fCentre = det->GetProbePosition();
+  fRadius = static_cast<const G4Sphere*>(det->probePeL->GetSolid())
+              ->GetOuterRadius();
+  if (nbEvents % GetNbPoints() != 0) {
+    G4cout << "\n--> warning from ResponseMatrix : " << nbEvents
+           << " events are not a multiple of the " << GetNbPoints()
+           << " grid points; the last points get fewer histories" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double ResponseMatrix::Energy(G4int e) const
+{
+  if (fNbE == 1) return fEmin;
+  return fEmin*std::pow(fEmax/fEmin, G4double(e)/(fNbE - 1));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double ResponseMatrix::Phi(G4int p) const
+{
+  return twopi*(p + 0.5)/fNbPhi;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::Sample(G4int point, G4ThreeVector& position,
+                            G4ThreeVector& direction, G4double& ekin) const
+{
+  G4int p = point % fNbPhi, c = (point / fNbPhi) % fNbCos,
+        e = point / (fNbPhi*fNbCos);
+  G4double cosTheta = CosTheta(c), phi = Phi(p);
+  G4double sinTheta = std::sqrt(1. - cosTheta*cosTheta);
+  direction = G4ThreeVector(sinTheta*std::cos(phi), sinTheta*std::sin(phi),
+                            cosTheta);
+  ekin = Energy(e);
+
+  // uniform over the disk facing the moderator, 1 mm upstream of it
+  G4ThreeVector a = direction.orthogonal().unit();
+  G4ThreeVector b = direction.cross(a);
+  G4double rho = fRadius*std::sqrt(G4UniformRand()),
+           psi = twopi*G4UniformRand();
+  position = fCentre - (fRadius + 1*mm)*direction
+           + rho*(std::cos(psi)*a + std::sin(psi)*b);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::Print() const
+{
+  G4cout << "\n Response matrix: " << (fActive ? "on" : "off") << ", "
+         << fNbE << " energies " << G4BestUnit(fEmin, "Energy") << " to "
+         << G4BestUnit(fEmax, "Energy") << ", " << fNbCos << " x " << fNbPhi
+         << " directions, tally " << Run::TallyName(fTally) << ", output "
+         << fOutputFile << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::Report(const std::vector<G4double>& histories,
+                            const std::vector<G4double>& sum,
+                            const std::vector<G4double>& sum2) const
+{
+  // response per unit fluence and its standard error, per grid point
+  G4double area = pi*fRadius*fRadius;
+  G4int nbPoints = GetNbPoints(), nbDirections = fNbCos*fNbPhi;
+  std::vector<G4double> response(nbPoints, 0.), error(nbPoints, 0.);
+  for (G4int i=0; i<nbPoints; i++) {
+    G4double n = histories[i];
+    if (n <= 0.) continue;
+    G4double mean = sum[i]/n;
+    G4double var  = n > 1. ? (sum2[i]/n - mean*mean)/(n - 1.) : 0.;
+    response[i] = mean*area;
+    error[i]    = std::sqrt(std::max(var, 0.))*area;
+  }
+
+  // per energy: isotropic response, and its spread over the directions
+  G4int prec = G4cout.precision(4);
+  G4cout << "\n Response matrix, " << Run::TallyName(fTally)
+         << " per unit fluence (cm2), " << nbDirections << " directions:"
+         << G4endl;
+  for (G4int e=0; e<fNbE; e++) {
+    G4double mean = 0., var = 0., low = DBL_MAX, high = 0.;
+    for (G4int d=0; d<nbDirections; d++) {
+      G4int i = e*nbDirections + d;
+      mean += response[i]/nbDirections;
+      var  += error[i]*error[i]/(nbDirections*nbDirections);
+      low   = std::min(low, response[i]);
+      high  = std::max(high, response[i]);
+    }
+    G4cout << "  " << std::setw(10) << G4BestUnit(Energy(e), "Energy")
+           << ": isotropic " << std::setw(10) << mean << " +- "
+           << std::setw(10) << std::sqrt(var) << ", directions "
+           << std::setw(10) << low << " to " << std::setw(10) << high
+           << G4endl;
+  }
+  G4cout.precision(prec);
+
+  if (fOutputFile == "none") return;
+  std::ofstream out(fOutputFile, std::ios::binary);
+  if (!out) {
+    G4cout << "\n--> warning from ResponseMatrix : cannot write "
+           << fOutputFile << G4endl;
+    return;
+  }
+  G4int dims[3] = { fNbE, fNbCos, fNbPhi };
+  char tally[16];
+  std::memset(tally, 0, sizeof(tally));
+  std::strncpy(tally, Run::TallyName(fTally), sizeof(tally) - 1);
+  G4double radius = fRadius/cm;
+  out.write(kMagic, sizeof(kMagic));
+  out.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+  out.write(tally, sizeof(tally));
+  out.write(reinterpret_cast<const char*>(&radius), sizeof(radius));
+  for (G4int e=0; e<fNbE; e++) {
+    G4double energy = Energy(e)/MeV;
+    out.write(reinterpret_cast<const char*>(&energy), sizeof(energy));
+  }
+  for (G4int c=0; c<fNbCos; c++) {
+    G4double cosTheta = CosTheta(c);
+    out.write(reinterpret_cast<const char*>(&cosTheta), sizeof(cosTheta));
+  }
+  for (G4int p=0; p<fNbPhi; p++) {
+    G4double phi = Phi(p)/deg;
+    out.write(reinterpret_cast<const char*>(&phi), sizeof(phi));
+  }
+  for (G4int i=0; i<nbPoints; i++) {
+    G4double values[3] = { histories[i], response[i]/cm2, error[i]/cm2 };
+    out.write(reinterpret_cast<const char*>(values), sizeof(values));
+  }
+  if (out.good())
+    G4cout << " Response matrix written to " << fOutputFile << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,167 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ResponseMatrixMessenger.cc
+/// \brief Implementation of the ResponseMatrixMessenger class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "ResponseMatrixMessenger.hh"
+
+#include "ResponseMatrix.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ResponseMatrixMessenger::ResponseMatrixMessenger()
+:G4UImessenger(),
+ fMatrixDir(0), fEnergiesCmd(0), fDirectionsCmd(0), fTallyCmd(0),
+ fOutputCmd(0), fActiveCmd(0), fPrintCmd(0)
+{ 
+  // the matrix is shared by all threads, so these commands are executed by
+  // the master only
+  fMatrixDir = new G4UIdirectory("/testhadr/responseMatrix/");
+  fMatrixDir->SetGuidance("probe response to monoenergetic, parallel beams");
+
+  fEnergiesCmd = new G4UIcommand("/testhadr/responseMatrix/energies",this);
+  fEnergiesCmd->SetGuidance("beam energies: number of log-spaced points, range");
+  G4UIparameter* nbPrm = new G4UIparameter("n",'i',false);
+  nbPrm->SetParameterRange("n>0");
+  fEnergiesCmd->SetParameter(nbPrm);
+  G4UIparameter* eminPrm = new G4UIparameter("emin",'d',false);
+  eminPrm->SetParameterRange("emin>0.");
+  fEnergiesCmd->SetParameter(eminPrm);
+  G4UIparameter* emaxPrm = new G4UIparameter("emax",'d',false);
+  emaxPrm->SetParameterRange("emax>0.");
+  fEnergiesCmd->SetParameter(emaxPrm);
+  G4UIparameter* eUnitPrm = new G4UIparameter("unit",'s',true);
+  eUnitPrm->SetDefaultValue("MeV");
+  eUnitPrm->SetParameterCandidates(
+    G4UIcommand::UnitsList(G4UIcommand::CategoryOf("MeV")));
+  fEnergiesCmd->SetParameter(eUnitPrm);
+  fEnergiesCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fEnergiesCmd->SetToBeBroadcasted(false);
+
+  fDirectionsCmd = new G4UIcommand("/testhadr/responseMatrix/directions",this);
+  fDirectionsCmd->SetGuidance("beam directions: bins in cos(theta) to the");
+  fDirectionsCmd->SetGuidance("tube axis and in phi, one beam per bin centre");
+  const char* dirPrms[2] = { "nCos", "nPhi" };
+  for (G4int i=0; i<2; i++) {
+    G4UIparameter* nPrm = new G4UIparameter(dirPrms[i],'i',false);
+    nPrm->SetParameterRange(G4String(dirPrms[i]) + ">0");
+    fDirectionsCmd->SetParameter(nPrm);
+  }
+  fDirectionsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fDirectionsCmd->SetToBeBroadcasted(false);
+
+  fTallyCmd = new G4UIcmdWithAString("/testhadr/responseMatrix/tally",this);
+  fTallyCmd->SetGuidance("response tally (run summary name), default capDetector");
+  fTallyCmd->SetParameterName("tally",false);
+  fTallyCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fTallyCmd->SetToBeBroadcasted(false);
+
+  fOutputCmd = new G4UIcmdWithAString("/testhadr/responseMatrix/output",this);
+  fOutputCmd->SetGuidance("binary file of the matrix (none: off)");
+  fOutputCmd->SetParameterName("fileName",false);
+  fOutputCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fOutputCmd->SetToBeBroadcasted(false);
+
+  fActiveCmd = new G4UIcmdWithABool("/testhadr/responseMatrix/active",this);
+  fActiveCmd->SetGuidance("sample the source from the grid of beams");
+  fActiveCmd->SetParameterName("flag",true);
+  fActiveCmd->SetDefaultValue(true);
+  fActiveCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fActiveCmd->SetToBeBroadcasted(false);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/testhadr/responseMatrix/print",this);
+  fPrintCmd->SetGuidance("print the settings");
+  fPrintCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPrintCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ResponseMatrixMessenger::~ResponseMatrixMessenger()
+{
+  delete fEnergiesCmd;
+  delete fDirectionsCmd;
+  delete fTallyCmd;
+  delete fOutputCmd;
+  delete fActiveCmd;
+  delete fPrintCmd;
+  delete fMatrixDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrixMessenger::SetNewValue(G4UIcommand* command,
+                                          G4String newValue)
+{   
+  ResponseMatrix* matrix = ResponseMatrix::Instance();
+  std::istringstream is(newValue);
+
+  if (command == fEnergiesCmd)
+   {
+     G4int n;
+     G4double emin, emax;
+     G4String unt;
+     is >> n >> emin >> emax >> unt;
+     G4double unit = G4UIcommand::ValueOf(unt);
+     matrix->SetEnergies(n, emin*unit, emax*unit);
+   }
+
+  if (command == fDirectionsCmd)
+   {
+     G4int nCos, nPhi;
+     is >> nCos >> nPhi;
+     matrix->SetDirections(nCos, nPhi);
+   }
+
+  if (command == fTallyCmd)
+   {matrix->SetTally(newValue);}
+
+  if (command == fOutputCmd)
+   {matrix->SetOutputFile(newValue);}
+
+  if (command == fActiveCmd)
+   {matrix->SetActive(fActiveCmd->GetNewBoolValue(newValue));}
+
+  if (command == fPrintCmd)
+   {matrix->Print();}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
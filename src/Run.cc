@@ -34,9 +34,31 @@
 #include "DetectorConstruction.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "HistoManager.hh"
+#include "ConvergenceMonitor.hh"
+#include "StackingAction.hh"
+#include "TransmissionKernel.hh"
+#include "CondensedSource.hh"
+#include "SourceTerm.hh"
+#include "PointKernel.hh"
+#include "GammaSites.hh"
+#include "ResponseMap.hh"
+#include "ResponseMatrix.hh"
+#include "CorrelatedSampling.hh"
+#include "BoxTransport.hh"
+
+#include "G4Box.hh"
+#include "G4RunManager.hh"
+#include "G4Threading.hh"
 
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4Timer.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -45,12 +67,158 @@ Run::Run(DetectorConstruction* det)
   fDetector(det), fParticle(0), fEkin(0.),
   fNbStep1(0), fNbStep2(0),
   fTrackLen1(0.), fTrackLen2(0.),
-  fTime1(0.),fTime2(0.)
-{ }
+  fTime1(0.),fTime2(0.),
+  fNbHistories(0), fWallTime(0.), fSnapEvery(100),
+  fMergeTime(0.), fNbMerged(0), fTankKernel(0), fSourceTerm(0),
+  fGammaSites(0), fGammaWriter(0)
+{
+  if (!det->GetTankKernelBuild().empty() &&
+      fTankWalls.Set(det->tankL, det->GetTankKernelMargin())) {
+    fTankKernel = new TransmissionKernel();
+    for (G4int k=0; k<TankWalls::kNbKinds; k++)
+      fTankKernel->SetThickness(k, fTankWalls.Thickness(k));
+  }
+  if (CondensedSource::Instance()->IsRecording()) {
+    const G4Box* poly = static_cast<const G4Box*>(det->polyL->GetSolid());
+    fSourceTerm = new SourceTerm();
+    fSourceTerm->SetBox(G4ThreeVector(poly->GetXHalfLength(),
+                                      poly->GetYHalfLength(),
+                                      poly->GetZHalfLength()),
+                        det->GetPolyPosition());
+  }
+  if (PointKernel::Instance()->IsActive())
+    fGammaSites = new GammaSites(PointKernel::Instance()->GetSiteCell());
+
+  // one part file per thread with events, none on a master of threads
+  const GammaBank* bank = GammaBank::Instance();
+  if (bank->IsWriting() && !(G4Threading::IsMultithreadedApplication() &&
+                             G4Threading::IsMasterThread())) {
+    G4int part = std::max(G4Threading::G4GetThreadId(), 0);
+    fGammaWriter = new GammaBank::Writer(
+                         GammaBank::PartName(bank->GetWriteFile(), part));
+  }
+
+  // strata of the response map, or grid points of the response matrix
+  G4int nbStrata = 0;
+  if (ResponseMap::Instance()->IsActive())
+    nbStrata = ResponseMap::Instance()->GetNbStrata();
+  if (ResponseMatrix::Instance()->IsActive())
+    nbStrata = ResponseMatrix::Instance()->GetNbPoints();
+  if (nbStrata > 0) {
+    fMapHistories.assign(nbStrata, 0.);
+    fMapSum.assign(nbStrata, 0.);
+    fMapSum2.assign(nbStrata, 0.);
+  }
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 Run::~Run()
-{ }
+{
+  delete fTankKernel;
+  delete fSourceTerm;
+  delete fGammaSites;
+  delete fGammaWriter;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  const char* tallyNames[Run::kNbTally] =
+    { "nTank", "gTank", "nSlab", "gSlab", "probe",
+      "capDetector", "capTank", "capPoly", "inelDetector" };
+}
+
+const char* Run::TallyName(G4int id)
+{
+  return (id >= 0 && id < kNbTally) ? tallyNames[id] : "unknown";
+}
+
+G4int Run::TallyIndex(const G4String& name)
+{
+  for (G4int k=0; k<kNbTally; k++) { if (name == tallyNames[k]) return k; }
+  return -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::AddEventScores(G4int eventID, const G4double* scores)
+{
+  EventScores event;
+  event.fEvent = eventID;
+  for (G4int k=0; k<kNbTally; k++) event.fScore[k] = scores[k];
+  fEventScores.push_back(event);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::AddEventSensitivities(
+            const G4double scores[Perturbation::kNbParameters][kNbTally])
+{
+  for (G4int p=0; p<Perturbation::kNbParameters; p++) {
+    for (G4int k=0; k<kNbTally; k++) {
+      if (scores[p][k] != 0.) fSensitivity[p][k].Add(scores[p][k]);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::AddEventTallies(const G4double* scores)
+{
+  fNbHistories++;
+  for (G4int k=0; k<kNbTally; k++) {
+    if (scores[k] != 0.) fTally[k].Add(scores[k]);
+  }
+
+  // keep at most 64 snapshots, halving their density when full
+  if (fNbHistories % fSnapEvery == 0) {
+    Snapshot snap;
+    snap.fNbHistories = fNbHistories;
+    for (G4int k=0; k<kNbTally; k++) {
+      snap.fS1[k] = fTally[k].fS1;
+      snap.fS2[k] = fTally[k].fS2;
+    }
+    fSnapshots.push_back(snap);
+    if (fSnapshots.size() >= 64) {
+      std::vector<Snapshot> thin;
+      for (std::size_t i=1; i<fSnapshots.size(); i+=2) {
+        thin.push_back(fSnapshots[i]);
+      }
+      fSnapshots.swap(thin);
+      fSnapEvery *= 2;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::AddEventBins(const std::vector<std::pair<BinKey,G4double> >& bins)
+{
+  for (std::size_t i=0; i<bins.size(); i++) {
+    fBinMoments[bins[i].first].Add(bins[i].second);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::Statistics(const Moments& m, G4int nHist,
+                     G4double& mean, G4double& relErr, G4double& vov)
+{
+  mean = relErr = vov = 0.;
+  if (nHist < 2) return;
+  G4double n = nHist;
+  mean = m.fS1/n;
+  relErr = ConvergenceMonitor::RelativeError(nHist, m.fS1, m.fS2);
+
+  // VOV = sum((x-mean)^4) / (sum((x-mean)^2))^2 - 1/N
+  G4double s1 = m.fS1;
+  G4double var = m.fS2 - s1*s1/n;
+  if (var <= 0.) return;
+  G4double fourth = m.fS4 - 4.*m.fS3*s1/n + 6.*m.fS2*s1*s1/(n*n)
+                  - 3.*s1*s1*s1*s1/(n*n*n);
+  vov = fourth/(var*var) - 1./n;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -96,6 +264,29 @@ void Run::ParticleCount(G4String name, G4double Ekin)
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void Run::AddGammaBirth(const G4String& region, G4double energy,
+                        G4double weight)
+{
+  GammaBirths& births = fGammaBirths[region];
+  births.fCount++;
+  births.fWeight += weight;
+  births.fEnergy += weight*energy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::AddWoodcockFlight(const G4String& region, G4int tentative,
+                            G4int real, G4int violations)
+{
+  WoodcockFlights& flights = fWoodcock[region];
+  flights.fFlights++;
+  flights.fTentative  += tentative;
+  flights.fReal       += real;
+  flights.fViolations += violations;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void Run::SumTrackLength(G4int nstep1, G4int nstep2, 
                          G4double trackl1, G4double trackl2,
                          G4double time1, G4double time2)
@@ -109,6 +300,9 @@ void Run::SumTrackLength(G4int nstep1, G4int nstep2,
 
 void Run::Merge(const G4Run* run)
 {
+  G4Timer timer;
+  timer.Start();
+
   const Run* localRun = static_cast<const Run*>(run);
   
   //primary particle info
@@ -124,6 +318,21 @@ void Run::Merge(const G4Run* run)
   fTrackLen2 += localRun->fTrackLen2;
   fTime1     += localRun->fTime1;  
   fTime2     += localRun->fTime2;
+
+  fNbHistories += localRun->fNbHistories;
+  for (G4int k=0; k<kNbTally; k++) fTally[k].Add(localRun->fTally[k]);
+  for (G4int p=0; p<Perturbation::kNbParameters; p++) {
+    for (G4int k=0; k<kNbTally; k++)
+      fSensitivity[p][k].Add(localRun->fSensitivity[p][k]);
+  }
+
+  std::map<BinKey,Moments>::const_iterator itb;
+  for (itb = localRun->fBinMoments.begin();
+       itb != localRun->fBinMoments.end(); ++itb) {
+    fBinMoments[itb->first].Add(itb->second);
+  }
+  fWorkerSnapshots.push_back(
+    std::make_pair(localRun->fSnapEvery, localRun->fSnapshots));
   
   //map: processes count
   std::map<G4String,G4int>::const_iterator itp;
@@ -165,7 +374,84 @@ void Run::Merge(const G4Run* run)
     }   
   }
 
+  //map: capture gammas born
+  std::map<G4String,GammaBirths>::const_iterator itg;
+  for (itg = localRun->fGammaBirths.begin();
+       itg != localRun->fGammaBirths.end(); ++itg) {
+    GammaBirths& births = fGammaBirths[itg->first];
+    births.fCount  += itg->second.fCount;
+    births.fWeight += itg->second.fWeight;
+    births.fEnergy += itg->second.fEnergy;
+  }
+
+  //map: local energy deposits
+  std::map<G4String,G4double>::const_iterator ite;
+  for (ite = localRun->fLocalEdep.begin();
+       ite != localRun->fLocalEdep.end(); ++ite) {
+    fLocalEdep[ite->first] += ite->second;
+  }
+
+  //map: variance reduction
+  std::map<G4String,std::pair<G4int,G4double> >::const_iterator itv;
+  for (itv = localRun->fVarianceReduction.begin();
+       itv != localRun->fVarianceReduction.end(); ++itv) {
+    std::pair<G4int,G4double>& vr = fVarianceReduction[itv->first];
+    vr.first  += itv->second.first;
+    vr.second += itv->second.second;
+  }
+
+  //map: culled tracks
+  for (itv = localRun->fCulling.begin();
+       itv != localRun->fCulling.end(); ++itv) {
+    std::pair<G4int,G4double>& c = fCulling[itv->first];
+    c.first  += itv->second.first;
+    c.second += itv->second.second;
+  }
+
+  //map: Woodcock flights
+  std::map<G4String,WoodcockFlights>::const_iterator itw;
+  for (itw = localRun->fWoodcock.begin();
+       itw != localRun->fWoodcock.end(); ++itw) {
+    WoodcockFlights& flights = fWoodcock[itw->first];
+    flights.fFlights    += itw->second.fFlights;
+    flights.fTentative  += itw->second.fTentative;
+    flights.fReal       += itw->second.fReal;
+    flights.fViolations += itw->second.fViolations;
+  }
+
+  //tank-wall transmission kernels
+  if (fTankKernel && localRun->fTankKernel)
+    fTankKernel->Add(*localRun->fTankKernel);
+
+  //leakage of the shielded source
+  if (fSourceTerm && localRun->fSourceTerm)
+    fSourceTerm->Add(*localRun->fSourceTerm);
+
+  //gamma sites for the point-kernel engine
+  if (fGammaSites && localRun->fGammaSites)
+    fGammaSites->Add(*localRun->fGammaSites);
+
+  //response map
+  if (fMapSum.size() == localRun->fMapSum.size()) {
+    for (std::size_t s=0; s<fMapSum.size(); s++) {
+      fMapHistories[s] += localRun->fMapHistories[s];
+      fMapSum[s]       += localRun->fMapSum[s];
+      fMapSum2[s]      += localRun->fMapSum2[s];
+    }
+  }
+
+  //per-event tallies of a variant of a correlated comparison
+  fEventScores.insert(fEventScores.end(), localRun->fEventScores.begin(),
+                      localRun->fEventScores.end());
+
+  //gamma bank: the part of the thread is complete
+  if (localRun->fGammaWriter) localRun->fGammaWriter->Close();
+
   G4Run::Merge(run); 
+
+  timer.Stop();
+  fMergeTime += timer.GetRealElapsed();
+  fNbMerged++;
 } 
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -258,6 +544,148 @@ void Run::EndOfRun()
            << ")" << G4endl;           
  }
  
+ //capture gammas tallied at birth
+ //
+ if (!fGammaBirths.empty()) {
+   G4cout << "\n Gammas born per source history (not transported):" << G4endl;
+   std::map<G4String,GammaBirths>::const_iterator itg;
+   for (itg = fGammaBirths.begin(); itg != fGammaBirths.end(); ++itg) {
+     const GammaBirths& births = itg->second;
+     G4cout << "  " << std::setw(13) << itg->first << ": "
+            << std::setw(wid) << births.fWeight/numberOfEvent
+            << "  energy = " << std::setw(wid)
+            << G4BestUnit(births.fEnergy/numberOfEvent, "Energy")
+            << "  (" << births.fCount << " gammas)" << G4endl;
+   }
+ }
+
+ //charged secondaries not tracked
+ //
+ if (!fLocalEdep.empty()) {
+   G4cout << "\n Energy of charged secondaries deposited at birth,"
+          << " per source history:" << G4endl;
+   std::map<G4String,G4double>::const_iterator ite;
+   for (ite = fLocalEdep.begin(); ite != fLocalEdep.end(); ++ite) {
+     G4cout << "  " << std::setw(13) << ite->first << ": "
+            << std::setw(wid) << G4BestUnit(ite->second/numberOfEvent, "Energy")
+            << G4endl;
+   }
+ }
+
+ //variance reduction
+ //
+ if (!fVarianceReduction.empty()) {
+   G4cout << "\n Variance reduction, weight per source history:" << G4endl;
+   std::map<G4String,std::pair<G4int,G4double> >::const_iterator itv;
+   for (itv = fVarianceReduction.begin();
+        itv != fVarianceReduction.end(); ++itv) {
+     G4cout << "  " << std::setw(16) << itv->first << ": "
+            << std::setw(wid) << itv->second.second/numberOfEvent
+            << "  (" << itv->second.first << " tracks)" << G4endl;
+   }
+ }
+
+ //track culling
+ //
+ if (!fCulling.empty()) {
+   G4cout << "\n Culled tracks (rule action), weight per source history:"
+          << G4endl;
+   std::map<G4String,std::pair<G4int,G4double> >::const_iterator itc;
+   for (itc = fCulling.begin(); itc != fCulling.end(); ++itc) {
+     G4cout << "  " << std::setw(24) << itc->first << ": "
+            << std::setw(wid) << itc->second.second/numberOfEvent
+            << "  (" << itc->second.first << " tracks)" << G4endl;
+   }
+ }
+
+ //Woodcock tracking of gammas
+ //
+ if (!fWoodcock.empty()) {
+   G4cout << "\n Woodcock tracking of gammas:" << G4endl;
+   std::map<G4String,WoodcockFlights>::const_iterator itw;
+   for (itw = fWoodcock.begin(); itw != fWoodcock.end(); ++itw) {
+     const WoodcockFlights& flights = itw->second;
+     G4double ratio = flights.fTentative > 0 ?
+                      G4double(flights.fReal)/flights.fTentative : 0.;
+     G4cout << "  " << std::setw(13) << itw->first << ": "
+            << flights.fFlights << " flights, "
+            << flights.fReal << " real collisions out of "
+            << flights.fTentative << " tentative ("
+            << std::setprecision(3) << 100*ratio
+            << std::setprecision(prec) << " %)";
+     if (flights.fViolations > 0)
+       G4cout << ", " << flights.fViolations << " majorant violations";
+     G4cout << G4endl;
+   }
+ }
+
+ //tallies per source history
+ //
+ PrintTallyStatistics();
+ WriteBinStatistics();
+ BoxTransport::Instance()->SetReference(fTally, fNbHistories, fWallTime);
+ if (Perturbation::Instance()->IsActive()) PrintSensitivities();
+
+ ConvergenceMonitor::Instance()->Report(numberOfEvent);
+
+ //tank-wall transmission kernels recorded in this run
+ //
+ if (fTankKernel) {
+   const G4String& file = fDetector->GetTankKernelBuild();
+   G4double entries = fTankKernel->GetEntries();
+   G4double excluded = fTankKernel->GetExcluded();
+   if (fTankKernel->Write(file)) {
+     G4cout << "\n Tank transmission kernels written to " << file << " : "
+            << entries << " entries, " << excluded
+            << " excluded (exit off the plain part of the wall)" << G4endl;
+   }
+ }
+
+ //condensed source term recorded in this run
+ //
+ if (fSourceTerm) {
+   const G4String& file = CondensedSource::Instance()->GetRecordFile();
+   fSourceTerm->SetHistories(numberOfEvent);
+   if (fSourceTerm->Write(file)) {
+     G4cout << "\n Condensed source term written to " << file << " :"
+            << G4endl;
+     fSourceTerm->Print();
+   }
+ }
+
+ //point-kernel gamma dose from the gamma sites of this run
+ //
+ if (fGammaSites) PointKernel::Instance()->Compute(*fGammaSites, numberOfEvent);
+
+ //probe response per source position and energy, or per beam
+ //
+ if (!fMapSum.empty()) {
+   if (ResponseMatrix::Instance()->IsActive())
+     ResponseMatrix::Instance()->Report(fMapHistories, fMapSum, fMapSum2);
+   else
+     ResponseMap::Instance()->Report("forward",
+                                     ResponseMap::Instance()->GetOutputFile(),
+                                     fMapHistories, fMapSum, fMapSum2);
+ }
+
+ //difference to the reference variant of a correlated comparison
+ //
+ CorrelatedSampling* correlated = CorrelatedSampling::Instance();
+ if (correlated->IsRunning()) correlated->EndOfVariant(fEventScores);
+
+ //index of the gamma bank of this neutron pass
+ //
+ const GammaBank* bank = GammaBank::Instance();
+ if (bank->IsWriting()) {
+   if (fGammaWriter) fGammaWriter->Close();
+   G4int nbParts = G4RunManager::GetRunManager()->GetNumberOfThreads();
+   if (bank->WriteIndex(numberOfEvent, nbParts)) {
+     G4cout << "\n Gamma bank written to " << bank->GetWriteFile() << " : "
+            << numberOfEvent << " histories, " << nbParts << " parts"
+            << G4endl;
+   }
+ }
+
   //normalize histograms      
   ////G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
   ////G4double factor = 1./numberOfEvent;
@@ -266,9 +694,219 @@ void Run::EndOfRun()
   //remove all contents in fProcCounter, fCount 
   fProcCounter.clear();
   fParticleDataMap.clear();
+  fGammaBirths.clear();
+  fLocalEdep.clear();
+  fVarianceReduction.clear();
+  fCulling.clear();
+  fWoodcock.clear();
+  fEventScores.clear();
                           
   //restore default format         
   G4cout.precision(dfprec);   
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<Run::Snapshot> Run::CombineSnapshots() const
+{
+  // align the snapshots of all threads on the coarsest common spacing
+  std::vector<std::pair<G4int, std::vector<Snapshot> > > sources
+    = fWorkerSnapshots;
+  if (sources.empty()) sources.push_back(std::make_pair(fSnapEvery, fSnapshots));
+
+  G4int spacing = 0, nCheck = 0;
+  for (std::size_t i=0; i<sources.size(); i++) {
+    if (sources[i].first > spacing) spacing = sources[i].first;
+  }
+  for (std::size_t i=0; i<sources.size(); i++) {
+    G4int n = sources[i].second.size()*sources[i].first/spacing;
+    if (n > nCheck) nCheck = n;
+  }
+
+  std::vector<Snapshot> combined;
+  for (G4int j=1; j<=nCheck; j++) {
+    Snapshot snap;
+    snap.fNbHistories = 0;
+    for (G4int k=0; k<kNbTally; k++) snap.fS1[k] = snap.fS2[k] = 0.;
+    for (std::size_t i=0; i<sources.size(); i++) {
+      const std::vector<Snapshot>& list = sources[i].second;
+      if (list.empty()) continue;
+      std::size_t idx = j*spacing/sources[i].first - 1;
+      if (idx >= list.size()) idx = list.size() - 1;
+      snap.fNbHistories += list[idx].fNbHistories;
+      for (G4int k=0; k<kNbTally; k++) {
+        snap.fS1[k] += list[idx].fS1[k];
+        snap.fS2[k] += list[idx].fS2[k];
+      }
+    }
+    combined.push_back(snap);
+  }
+
+  // the final state is the last point of the chart
+  Snapshot last;
+  last.fNbHistories = fNbHistories;
+  for (G4int k=0; k<kNbTally; k++) {
+    last.fS1[k] = fTally[k].fS1;
+    last.fS2[k] = fTally[k].fS2;
+  }
+  combined.push_back(last);
+  return combined;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::PrintTallyStatistics()
+{
+  // MCNP-like quality checks: R < 0.1, VOV < 0.1, and R falling as
+  // 1/sqrt(N) over the second half of the fluctuation chart
+  std::vector<Snapshot> chart = CombineSnapshots();
+
+  // without photon (and charged particle) transport, the tallies that
+  // need them are not available, which is not the same as zero
+  G4bool photons = StackingAction::PhotonTransport();
+  const G4String notAvailable = "n/a (no photon transport)";
+
+  G4cout << "\n Tally statistics per source history (wall time "
+         << fWallTime << " s, " << chart.size() << " chart points):"
+         << "\n  " << std::setw(13) << "tally"
+         << std::setw(13) << "mean" << std::setw(10) << "R[%]"
+         << std::setw(11) << "VOV" << std::setw(13) << "FOM[1/s]"
+         << std::setw(9) << "slope" << "  checks" << G4endl;
+
+  for (G4int k=0; k<kNbTally; k++) {
+    if (!photons && (k == kGammaTankExit || k == kGammaSlabExit)) {
+      G4cout << "  " << std::setw(13) << TallyName(k) << "  "
+             << notAvailable << G4endl;
+      continue;
+    }
+    G4double mean, relErr, vov;
+    Statistics(fTally[k], fNbHistories, mean, relErr, vov);
+    G4double fom = (relErr > 0. && fWallTime > 0.)
+                 ? 1./(relErr*relErr*fWallTime) : 0.;
+
+    // slope of ln R versus ln N over the second half of the chart
+    G4double sx = 0., sy = 0., sxx = 0., sxy = 0.;
+    G4int np = 0;
+    for (std::size_t j=chart.size()/2; j<chart.size(); j++) {
+      G4double r = ConvergenceMonitor::RelativeError(chart[j].fNbHistories,
+                                          chart[j].fS1[k], chart[j].fS2[k]);
+      if (chart[j].fS1[k] <= 0. || r <= 0.) continue;
+      G4double x = std::log((G4double)chart[j].fNbHistories), y = std::log(r);
+      sx += x; sy += y; sxx += x*x; sxy += x*y; np++;
+    }
+    G4double slope = 0.;
+    G4bool trendOk = false;
+    if (np > 2 && (np*sxx - sx*sx) > 0.) {
+      slope = (np*sxy - sx*sy)/(np*sxx - sx*sx);
+      trendOk = (slope > -0.75 && slope < -0.25);
+    }
+
+    G4String checks;
+    if (mean == 0.)    checks = "no score";
+    else {
+      if (relErr >= 0.1) checks += "R ";
+      if (vov >= 0.1)    checks += "VOV ";
+      if (!trendOk)      checks += "trend ";
+      if (checks.empty()) checks = "passed";
+      else checks = "failed: " + checks;
+    }
+
+    G4cout << "  " << std::setw(13) << TallyName(k)
+           << std::setw(13) << mean << std::setw(10) << 100*relErr
+           << std::setw(11) << vov << std::setw(13) << fom
+           << std::setw(9) << slope << "  " << checks << G4endl;
+  }
+
+  // integrals of the histograms
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+  for (G4int ih=0; ih<analysisManager->GetNofH1s(); ih++) {
+    std::map<BinKey,Moments>::const_iterator it
+      = fBinMoments.find(BinKey(ih, kTotalBin));
+    std::ostringstream name;
+    name << "H1 " << ih;
+    if (!photons && ih == 6) {
+      // protons of 3He(n,p)t are not transported
+      G4cout << "  " << std::setw(13) << name.str() << "  "
+             << "n/a (no charged particle transport)" << G4endl;
+      continue;
+    }
+    if (it == fBinMoments.end()) continue;
+    G4double mean, relErr, vov;
+    Statistics(it->second, fNbHistories, mean, relErr, vov);
+    G4double fom = (relErr > 0. && fWallTime > 0.)
+                 ? 1./(relErr*relErr*fWallTime) : 0.;
+    G4cout << "  " << std::setw(13) << name.str()
+           << std::setw(13) << mean << std::setw(10) << 100*relErr
+           << std::setw(11) << vov << std::setw(13) << fom << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::PrintSensitivities()
+{
+  // dR/dp per source history, and the relative sensitivity (p/R) dR/dp:
+  // the % change of the tally for a 1% change of the parameter
+  const Perturbation* perturbation = Perturbation::Instance();
+  G4cout << "\n Sensitivities of the tallies (differential operator,"
+         << " first order):" << G4endl;
+
+  for (G4int p=0; p<Perturbation::kNbParameters; p++) {
+    G4double value = perturbation->GetValue(p);
+    if (value <= 0.) continue;
+    G4bool density = (p == Perturbation::kWaterDensity);
+    G4double unit = density ? g/cm3 : 1.;
+    G4cout << "\n  " << Perturbation::ParameterName(p) << " = "
+           << value/unit << (density ? " g/cm3" : "")
+           << "\n  " << std::setw(13) << "tally"
+           << std::setw(13) << "mean" << std::setw(13)
+           << (density ? "dR/drho" : "dR/dw") << std::setw(10) << "R[%]"
+           << std::setw(13) << "(p/R)dR/dp";
+    if (!density) G4cout << std::setw(15) << "dR/R per +1%";
+    G4cout << G4endl;
+
+    for (G4int k=0; k<kNbTally; k++) {
+      G4double mean, relErr, vov;
+      Statistics(fTally[k], fNbHistories, mean, relErr, vov);
+      if (mean == 0.) continue;
+      G4double slope, slopeErr, slopeVov;
+      Statistics(fSensitivity[p][k], fNbHistories, slope, slopeErr, slopeVov);
+      // per g/cm3 for the density, per unit mass fraction otherwise
+      slope *= unit;
+      G4cout << "  " << std::setw(13) << TallyName(k)
+             << std::setw(13) << mean << std::setw(13) << slope
+             << std::setw(10) << 100*slopeErr
+             << std::setw(13) << (value/unit)*slope/mean;
+      // relative change for a change of the mass fraction by 0.01
+      if (!density) G4cout << std::setw(14) << 100*0.01*slope/mean << "%";
+      G4cout << G4endl;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::WriteBinStatistics()
+{
+  // per-bin statistics of every H1, next to the analysis file
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+  G4String fileName = analysisManager->GetFileName() + "_tallies.csv";
+  std::ofstream out(fileName);
+  if (!out) return;
+  out << "histo,bin,mean,relErr,vov,fom\n";
+
+  std::map<BinKey,Moments>::const_iterator it;
+  for (it = fBinMoments.begin(); it != fBinMoments.end(); ++it) {
+    G4int ih = it->first.first, bin = it->first.second;
+    G4double mean, relErr, vov;
+    Statistics(it->second, fNbHistories, mean, relErr, vov);
+    G4double fom = (relErr > 0. && fWallTime > 0.)
+                 ? 1./(relErr*relErr*fWallTime) : 0.;
+    out << ih << ",";
+    if (bin == kTotalBin) out << "total"; else out << bin;
+    out << "," << mean << "," << relErr << "," << vov << "," << fom << "\n";
+  }
+  G4cout << "\n Per-bin tally statistics written to " << fileName << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
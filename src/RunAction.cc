@@ -35,28 +35,87 @@
 #include "DetectorConstruction.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "HistoManager.hh"
+#include "RunMessenger.hh"
+#include "CullingMessenger.hh"
+#include "CondensedSourceMessenger.hh"
+#include "PointKernelMessenger.hh"
+#include "GammaBankMessenger.hh"
+#include "ResponseMapMessenger.hh"
+#include "ResponseMatrixMessenger.hh"
+#include "CorrelatedSamplingMessenger.hh"
+#include "PerturbationMessenger.hh"
+#include "BoxTransportMessenger.hh"
+#include "ResponseMatrix.hh"
+#include "AdjointResponse.hh"
+#include "GammaBank.hh"
+#include "Perturbation.hh"
+#include "ConvergenceMonitor.hh"
+#include "BoxNavigation.hh"
+#include "NeutronGeneralProcess.hh"
 
 #include "G4Run.hh"
+#include "G4RunManager.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4Timer.hh"
+#include "G4AutoLock.hh"
+
+#ifdef G4MULTITHREADED
+#include "G4MTRunManager.hh"
+#endif
 
 #include "Randomize.hh"
 #include <iomanip>
 
+namespace { G4Mutex timingMutex = G4MUTEX_INITIALIZER; }
+
+G4double RunAction::fWorkerWriteMax = 0.;
+G4double RunAction::fWorkerCloseMax = 0.;
+G4double RunAction::fWorkerWriteSum = 0.;
+G4double RunAction::fWorkerCloseSum = 0.;
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 RunAction::RunAction(DetectorConstruction* det, PrimaryGeneratorAction* prim)
   : G4UserRunAction(),
-    fDetector(det), fPrimary(prim), fRun(0), fHistoManager(0)
+    fDetector(det), fPrimary(prim), fRun(0), fHistoManager(0),
+    fRunMessenger(0), fCullingMessenger(0), fSourceMessenger(0),
+    fKernelMessenger(0), fBankMessenger(0),
+    fMapMessenger(0), fMatrixMessenger(0),
+    fCorrelatedMessenger(0), fPerturbationMessenger(0), fBoxMessenger(0),
+    fTimer(0), fNtupleMerging(false),
+    fMasterWrite(0.), fMasterClose(0.)
 {
  // Book predefined histograms
  fHistoManager = new HistoManager(); 
+ fRunMessenger = new RunMessenger(this);
+ fCullingMessenger = new CullingMessenger();
+ fSourceMessenger = new CondensedSourceMessenger();
+ fKernelMessenger = new PointKernelMessenger();
+ fBankMessenger = new GammaBankMessenger();
+ fMapMessenger = new ResponseMapMessenger();
+ fMatrixMessenger = new ResponseMatrixMessenger();
+ fCorrelatedMessenger = new CorrelatedSamplingMessenger();
+ fPerturbationMessenger = new PerturbationMessenger();
+ fBoxMessenger = new BoxTransportMessenger(fDetector);
+ fTimer = new G4Timer;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 RunAction::~RunAction()
 {
+ delete fTimer;
+ delete fRunMessenger;
+ delete fCullingMessenger;
+ delete fSourceMessenger;
+ delete fKernelMessenger;
+ delete fBankMessenger;
+ delete fMapMessenger;
+ delete fMatrixMessenger;
+ delete fCorrelatedMessenger;
+ delete fPerturbationMessenger;
+ delete fBoxMessenger;
  delete fHistoManager;
 }
 
@@ -70,10 +129,28 @@ G4Run* RunAction::GenerateRun()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void RunAction::BeginOfRunAction(const G4Run*)
+void RunAction::BeginOfRunAction(const G4Run* run)
 {    
   // show Rndm status
   if (isMaster) G4Random::showEngineStatus();
+
+  // reset timers; the wall clock of the master covers the whole event loop
+  if (isMaster) {
+    G4AutoLock lock(&timingMutex);
+    fWorkerWriteMax = fWorkerCloseMax = 0.;
+    fWorkerWriteSum = fWorkerCloseSum = 0.;
+    NeutronGeneralProcess::CheckCompatibility();
+    ConvergenceMonitor::Instance()->BeginOfRun();
+    GammaBank::Instance()->CheckRun(run->GetNumberOfEventToBeProcessed());
+    ResponseMatrix::Instance()->BeginOfRun(fDetector,
+                                 run->GetNumberOfEventToBeProcessed());
+    Perturbation::Instance()->BeginOfRun(fDetector);
+    AdjointResponse::Instance()->BeginOfRun(fDetector);
+  }
+  fTimer->Start();
+
+  // box navigation of this thread, as set by /testhadr/det/boxNavigation
+  BoxNavigation::Install();
   
   // keep run condition
   if (fPrimary) { 
@@ -87,21 +164,46 @@ void RunAction::BeginOfRunAction(const G4Run*)
   //
   G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
   if ( analysisManager->IsActive() ) {
+    if (isMaster) analysisManager->SetNtupleMerging(fNtupleMerging);
     analysisManager->OpenFile();
   }  
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void RunAction::EndOfRunAction(const G4Run*)
+void RunAction::EndOfRunAction(const G4Run* run)
 {
-  if (isMaster) fRun->EndOfRun();    
+  fTimer->Stop();
+
+  if (isMaster) {
+    fRun->SetWallTime(fTimer->GetRealElapsed());
+    fRun->EndOfRun();
+  }    
   
-  //save histograms      
+  //save histograms; on the master this includes the ntuple merging
+  G4Timer writeTimer, closeTimer;
   G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
   if ( analysisManager->IsActive() ) {
+    writeTimer.Start();
     analysisManager->Write();
+    writeTimer.Stop();
+    closeTimer.Start();
     analysisManager->CloseFile();
+    closeTimer.Stop();
+  }
+
+  if (!isMaster) {
+    G4AutoLock lock(&timingMutex);
+    G4double write = writeTimer.GetRealElapsed();
+    G4double close = closeTimer.GetRealElapsed();
+    fWorkerWriteSum += write;
+    fWorkerCloseSum += close;
+    if (write > fWorkerWriteMax) fWorkerWriteMax = write;
+    if (close > fWorkerCloseMax) fWorkerCloseMax = close;
+  } else {
+    fMasterWrite = writeTimer.GetRealElapsed();
+    fMasterClose = closeTimer.GetRealElapsed();
+    PrintTiming(run);
   }
       
   // show Rndm status
@@ -109,3 +211,37 @@ void RunAction::EndOfRunAction(const G4Run*)
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::PrintTiming(const G4Run* run)
+{
+  // one "Timing:" line per quantity, so that scaling.sh can grep them
+  G4int nThreads = 1;
+#ifdef G4MULTITHREADED
+  G4MTRunManager* mtManager = G4MTRunManager::GetMasterRunManager();
+  if (mtManager) nThreads = mtManager->GetNumberOfThreads();
+#endif
+  G4int nEvents = run->GetNumberOfEvent();
+  G4double wall = fTimer->GetRealElapsed();
+  G4double rate = (wall > 0.) ? nEvents/wall : 0.;
+
+  G4int dfprec = G4cout.precision(6);
+  G4cout << "\n--------------------- Timing summary ---------------------"
+         << "\n Timing: threads         " << nThreads
+         << "\n Timing: events          " << nEvents
+         << "\n Timing: wall [s]        " << wall
+         << "\n Timing: events/s        " << rate
+         << "\n Timing: merge [s]       " << fRun->GetMergeTime()
+         << "   (" << fRun->GetNbMerged() << " runs merged)"
+         << "\n Timing: workerWrite [s] " << fWorkerWriteMax
+         << "   (sum " << fWorkerWriteSum << ")"
+         << "\n Timing: workerClose [s] " << fWorkerCloseMax
+         << "   (sum " << fWorkerCloseSum << ")"
+         << "\n Timing: masterWrite [s] " << fMasterWrite
+         << "\n Timing: masterClose [s] " << fMasterClose
+         << "\n Timing: ntupleMerging   " << fNtupleMerging
+         << "\n----------------------------------------------------------"
+         << G4endl;
+  G4cout.precision(dfprec);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
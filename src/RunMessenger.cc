@@ -0,0 +1,156 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file RunMessenger.cc
+/// \brief Implementation of the RunMessenger class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "RunMessenger.hh"
+
+#include "RunAction.hh"
+#include "Run.hh"
+#include "ConvergenceMonitor.hh"
+
+#include "G4RunManager.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunMessenger::RunMessenger(RunAction* run)
+:G4UImessenger(),fRunAction(run),
+ fRunDir(0), fMergeCmd(0),
+ fTargetErrCmd(0), fWallTimeCmd(0), fCheckCmd(0), fAddTargetCmd(0),
+ fClearTargetCmd(0), fUntilCmd(0)
+{ 
+  fRunDir = new G4UIdirectory("/testhadr/run/");
+  fRunDir->SetGuidance("run control commands");
+   
+  fMergeCmd = new G4UIcmdWithABool("/testhadr/run/mergeNtuples",this);
+  fMergeCmd->SetGuidance("merge the worker ntuples into the master file");
+  fMergeCmd->SetParameterName("merge",false);
+  fMergeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);  
+
+  // targeted termination: the ConvergenceMonitor is shared by all threads,
+  // so these commands are executed by the master only
+  fTargetErrCmd = new G4UIcmdWithADouble("/testhadr/run/targetError",this);
+  fTargetErrCmd->SetGuidance("stop when every target tally reaches this");
+  fTargetErrCmd->SetGuidance("relative error (0 disables)");
+  fTargetErrCmd->SetParameterName("relErr",false);
+  fTargetErrCmd->SetRange("relErr>=0.");
+  fTargetErrCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fTargetErrCmd->SetToBeBroadcasted(false);
+
+  fWallTimeCmd = new G4UIcmdWithADouble("/testhadr/run/maxWallTime",this);
+  fWallTimeCmd->SetGuidance("stop the run after this many seconds of");
+  fWallTimeCmd->SetGuidance("wall-clock time (0 disables)");
+  fWallTimeCmd->SetParameterName("seconds",false);
+  fWallTimeCmd->SetRange("seconds>=0.");
+  fWallTimeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fWallTimeCmd->SetToBeBroadcasted(false);
+
+  fCheckCmd = new G4UIcmdWithAnInteger("/testhadr/run/checkEvery",this);
+  fCheckCmd->SetGuidance("events per thread between two convergence checks");
+  fCheckCmd->SetParameterName("nEvents",false);
+  fCheckCmd->SetRange("nEvents>0");
+  fCheckCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fCheckCmd->SetToBeBroadcasted(false);
+
+  fAddTargetCmd = new G4UIcmdWithAString("/testhadr/run/addTarget",this);
+  fAddTargetCmd->SetGuidance("flag a tally as a precision target");
+  fAddTargetCmd->SetParameterName("tally",false);
+  G4String candidates;
+  for (G4int k=0; k<Run::kNbTally; k++) {
+    candidates += G4String(Run::TallyName(k)) + " ";
+  }
+  fAddTargetCmd->SetCandidates(candidates);
+  fAddTargetCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fAddTargetCmd->SetToBeBroadcasted(false);
+
+  fClearTargetCmd = new G4UIcmdWithoutParameter("/testhadr/run/clearTargets",this);
+  fClearTargetCmd->SetGuidance("remove all precision targets");
+  fClearTargetCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fClearTargetCmd->SetToBeBroadcasted(false);
+
+  fUntilCmd = new G4UIcmdWithAnInteger("/testhadr/run/beamOnUntil",this);
+  fUntilCmd->SetGuidance("start a run that ends when the targets are met,");
+  fUntilCmd->SetGuidance("the wall-clock budget is spent, or after nEvents");
+  fUntilCmd->SetParameterName("nEvents",true);
+  fUntilCmd->SetDefaultValue(2000000000);
+  fUntilCmd->SetRange("nEvents>0");
+  fUntilCmd->AvailableForStates(G4State_Idle);
+  fUntilCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunMessenger::~RunMessenger()
+{
+  delete fMergeCmd;
+  delete fTargetErrCmd;
+  delete fWallTimeCmd;
+  delete fCheckCmd;
+  delete fAddTargetCmd;
+  delete fClearTargetCmd;
+  delete fUntilCmd;
+  delete fRunDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{   
+  if (command == fMergeCmd)
+   {fRunAction->SetNtupleMerging(fMergeCmd->GetNewBoolValue(newValue));}
+
+  ConvergenceMonitor* monitor = ConvergenceMonitor::Instance();
+
+  if (command == fTargetErrCmd)
+   {monitor->SetTargetError(fTargetErrCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fWallTimeCmd)
+   {monitor->SetWallClockLimit(fWallTimeCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fCheckCmd)
+   {monitor->SetCheckEvery(fCheckCmd->GetNewIntValue(newValue));}
+
+  if (command == fAddTargetCmd)
+   {monitor->AddTarget(Run::TallyIndex(newValue));}
+
+  if (command == fClearTargetCmd)
+   {monitor->ClearTargets();}
+
+  if (command == fUntilCmd)
+   {G4RunManager::GetRunManager()->BeamOn(fUntilCmd->GetNewIntValue(newValue));}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
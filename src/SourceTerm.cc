@@ -0,0 +1,405 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SourceTerm.cc
+/// \brief Implementation of the SourceTerm class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "SourceTerm.hh"
+
+#include "G4Neutron.hh"
+#include "G4Gamma.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  const char     kMagic[8] = {'M','O','N','C','S','0','0','1'};
+
+  // the outer box: 6 faces, face = axis + 3*(outward along +axis)
+  const G4int    kNbFaces = 6;
+  const G4double kTolerance = 1*um;
+  const G4double kPushOut   = 1*nm;
+  // position on the face, along its two other axes
+  const G4int    kNbU   = 5;
+  const G4int    kNbV   = 5;
+  // cosine to the outward normal, and azimuth around it
+  const G4int    kNbMu  = 5;
+  const G4int    kNbPhi = 4;
+  // energy: log bins per particle, neutron then gamma
+  const G4int    kNbE[SourceTerm::kNbParticles]  = { 50, 120 };
+  const G4double kEmin[SourceTerm::kNbParticles] = { 1.e-5*eV, 10*keV };
+  const G4double kEmax[SourceTerm::kNbParticles] = { 20*MeV, 12*MeV };
+  // time: log bins, the first and last collecting the under/overflow
+  const G4int    kNbT   = 14;
+  const G4double kTmin  = 0.1*ns;
+  const G4double kTmax  = 1*ms;
+
+  G4int Bin(G4double x, G4int n)
+  {
+    return std::min(std::max(G4int(x*n), 0), n-1);
+  }
+
+  G4int LogBin(G4double x, G4double xmin, G4double xmax, G4int n)
+  {
+    if (x <= xmin) return 0;
+    return Bin(std::log(x/xmin)/std::log(xmax/xmin), n);
+  }
+
+  G4double LogUniform(G4int bin, G4double xmin, G4double xmax, G4int n)
+  {
+    return xmin*std::exp((bin + G4UniformRand())*std::log(xmax/xmin)/n);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SourceTerm::SourceTerm()
+: fHistories(0.), fLeakage(0.)
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SourceTerm::~SourceTerm()
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int SourceTerm::Particle(const G4ParticleDefinition* particle)
+{
+  if (particle == G4Neutron::Neutron()) return 0;
+  if (particle == G4Gamma::Gamma())     return 1;
+  return -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ParticleDefinition* SourceTerm::Definition(G4int particle)
+{
+  if (particle == 0) return G4Neutron::Neutron();
+  return G4Gamma::Gamma();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SourceTerm::SetBox(const G4ThreeVector& halfSizes,
+                        const G4ThreeVector& centre)
+{
+  fHalfSizes = halfSizes;
+  fCentre    = centre;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int SourceTerm::Face(const G4ThreeVector& position,
+                       const G4ThreeVector& direction) const
+{
+  // on an edge, the face the particle leaves the most directly
+  G4int face = -1;
+  G4double best = 0.;
+  for (G4int axis=0; axis<3; axis++) {
+    if (fHalfSizes[axis] - std::fabs(position[axis]) > kTolerance) continue;
+    G4double outward = (position[axis] > 0.) ? direction[axis]
+                                             : -direction[axis];
+    if (outward > best) {
+      best = outward;
+      face = axis + 3*(position[axis] > 0.);
+    }
+  }
+  return face;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SourceTerm::Fill(G4int particle, G4int face,
+                      const G4ThreeVector& position,
+                      const G4ThreeVector& direction,
+                      G4double ekin, G4double time, G4double weight)
+{
+  G4int axis = face%3, uAxis = (axis+1)%3, vAxis = (axis+2)%3;
+  G4double sign = (face < 3) ? -1. : 1.;
+  G4double mu  = sign*direction[axis];
+  G4double phi = std::atan2(direction[vAxis], direction[uAxis]);
+  if (phi < 0.) phi += twopi;
+
+  G4int bin = face;
+  bin = bin*kNbU
+      + Bin(0.5*(position[uAxis]/fHalfSizes[uAxis] + 1.), kNbU);
+  bin = bin*kNbV
+      + Bin(0.5*(position[vAxis]/fHalfSizes[vAxis] + 1.), kNbV);
+  bin = bin*kNbMu  + Bin(mu, kNbMu);
+  bin = bin*kNbPhi + Bin(phi/twopi, kNbPhi);
+  bin = bin*kNbE[particle]
+      + LogBin(ekin, kEmin[particle], kEmax[particle], kNbE[particle]);
+  bin = bin*kNbT   + LogBin(time, kTmin, kTmax, kNbT);
+  fBins[particle][bin] += weight;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SourceTerm::Add(const SourceTerm& other)
+{
+  for (G4int p=0; p<kNbParticles; p++) {
+    std::map<G4int,G4double>::const_iterator it;
+    for (it = other.fBins[p].begin(); it != other.fBins[p].end(); it++)
+      fBins[p][it->first] += it->second;
+  }
+  fHistories += other.fHistories;
+  if (fHalfSizes.mag2() == 0.) SetBox(other.fHalfSizes, other.fCentre);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SourceTerm::BuildAliasTable()
+{
+  // Vose's construction: each column holds its own bin with probability
+  // fProbability and its alias otherwise
+  fKeys.clear();
+  fProbability.clear();
+  fAlias.clear();
+  G4double total = 0.;
+  for (G4int p=0; p<kNbParticles; p++) {
+    std::map<G4int,G4double>::const_iterator it;
+    for (it = fBins[p].begin(); it != fBins[p].end(); it++) {
+      if (it->second <= 0.) continue;
+      fKeys.push_back(p + kNbParticles*it->first);
+      fProbability.push_back(it->second);
+      total += it->second;
+    }
+  }
+  G4int n = fKeys.size();
+  fLeakage = total/fHistories;
+  fAlias.assign(n, 0);
+  std::vector<G4int> small, large;
+  for (G4int i=0; i<n; i++) {
+    fAlias[i] = i;
+    fProbability[i] *= n/total;
+    if (fProbability[i] < 1.) small.push_back(i);
+    else                      large.push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    G4int s = small.back(), l = large.back();
+    small.pop_back();
+    fAlias[s] = l;
+    fProbability[l] -= 1. - fProbability[s];
+    if (fProbability[l] < 1.) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // what is left differs from 1 by rounding only
+  for (std::size_t i=0; i<small.size(); i++) fProbability[small[i]] = 1.;
+  for (std::size_t i=0; i<large.size(); i++) fProbability[large[i]] = 1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SourceTerm::Sample(G4int& particle, G4ThreeVector& position,
+                        G4ThreeVector& direction, G4double& ekin,
+                        G4double& time) const
+{
+  // the bin: a column and its alias from a single random number
+  G4int n = fKeys.size();
+  G4double u = G4UniformRand()*n;
+  G4int column = std::min(G4int(u), n-1);
+  G4int key = (u - column < fProbability[column]) ? fKeys[column]
+                                                  : fKeys[fAlias[column]];
+  particle = key%kNbParticles;
+  G4int bin = key/kNbParticles;
+  G4int tBin   = bin%kNbT;            bin /= kNbT;
+  G4int eBin   = bin%kNbE[particle];  bin /= kNbE[particle];
+  G4int phiBin = bin%kNbPhi;          bin /= kNbPhi;
+  G4int muBin  = bin%kNbMu;           bin /= kNbMu;
+  G4int vBin   = bin%kNbV;            bin /= kNbV;
+  G4int uBin   = bin%kNbU;
+  G4int face   = bin/kNbU;
+
+  // uniform within the bin, in log for energy and time
+  G4int axis = face%3, uAxis = (axis+1)%3, vAxis = (axis+2)%3;
+  G4double sign = (face < 3) ? -1. : 1.;
+  G4ThreeVector normal, uDir, vDir, local;
+  normal[axis] = sign;
+  uDir[uAxis] = 1.;
+  vDir[vAxis] = 1.;
+  local[axis]  = sign*(fHalfSizes[axis] + kPushOut);
+  local[uAxis] = fHalfSizes[uAxis]*(2.*(uBin + G4UniformRand())/kNbU - 1.);
+  local[vAxis] = fHalfSizes[vAxis]*(2.*(vBin + G4UniformRand())/kNbV - 1.);
+  position = fCentre + local;
+
+  G4double mu  = (muBin + G4UniformRand())/kNbMu;
+  G4double phi = twopi*(phiBin + G4UniformRand())/kNbPhi;
+  G4double sinTheta = std::sqrt(std::max(0., 1. - mu*mu));
+  direction = mu*normal
+            + sinTheta*(std::cos(phi)*uDir + std::sin(phi)*vDir);
+
+  ekin = LogUniform(eBin, kEmin[particle], kEmax[particle], kNbE[particle]);
+  time = LogUniform(tBin, kTmin, kTmax, kNbT);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool SourceTerm::Write(const G4String& fileName) const
+{
+  std::ofstream out(fileName, std::ios::binary);
+  if (!out) {
+    G4cout << "\n--> warning from SourceTerm : cannot write "
+           << fileName << G4endl;
+    return false;
+  }
+  G4int    dims[7]   = { kNbFaces, kNbU, kNbV, kNbMu, kNbPhi, kNbT,
+                         kNbParticles };
+  G4double ranges[2] = { kTmin, kTmax };
+  G4double box[6]    = { fHalfSizes.x(), fHalfSizes.y(), fHalfSizes.z(),
+                         fCentre.x(), fCentre.y(), fCentre.z() };
+  out.write(kMagic, sizeof(kMagic));
+  out.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+  out.write(reinterpret_cast<const char*>(kNbE), sizeof(kNbE));
+  out.write(reinterpret_cast<const char*>(kEmin), sizeof(kEmin));
+  out.write(reinterpret_cast<const char*>(kEmax), sizeof(kEmax));
+  out.write(reinterpret_cast<const char*>(ranges), sizeof(ranges));
+  out.write(reinterpret_cast<const char*>(box), sizeof(box));
+  out.write(reinterpret_cast<const char*>(&fHistories), sizeof(fHistories));
+
+  // the non-empty bins only, as (bin, weight) pairs
+  for (G4int p=0; p<kNbParticles; p++) {
+    G4int count = fBins[p].size();
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    std::map<G4int,G4double>::const_iterator it;
+    for (it = fBins[p].begin(); it != fBins[p].end(); it++) {
+      float weight = it->second;
+      out.write(reinterpret_cast<const char*>(&it->first), sizeof(G4int));
+      out.write(reinterpret_cast<const char*>(&weight), sizeof(weight));
+    }
+  }
+  return out.good();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool SourceTerm::Read(const G4String& fileName)
+{
+  std::ifstream in(fileName, std::ios::binary);
+  if (!in) {
+    G4cout << "\n--> warning from SourceTerm : cannot open "
+           << fileName << G4endl;
+    return false;
+  }
+  char     magic[8];
+  G4int    dims[7], nbE[kNbParticles];
+  G4double emin[kNbParticles], emax[kNbParticles], ranges[2], box[6];
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char*>(dims), sizeof(dims));
+  in.read(reinterpret_cast<char*>(nbE), sizeof(nbE));
+  in.read(reinterpret_cast<char*>(emin), sizeof(emin));
+  in.read(reinterpret_cast<char*>(emax), sizeof(emax));
+  in.read(reinterpret_cast<char*>(ranges), sizeof(ranges));
+  G4int    expDims[7]   = { kNbFaces, kNbU, kNbV, kNbMu, kNbPhi, kNbT,
+                            kNbParticles };
+  G4double expRanges[2] = { kTmin, kTmax };
+  if (!in || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      std::memcmp(dims, expDims, sizeof(dims)) != 0 ||
+      std::memcmp(nbE, kNbE, sizeof(nbE)) != 0 ||
+      std::memcmp(emin, kEmin, sizeof(emin)) != 0 ||
+      std::memcmp(emax, kEmax, sizeof(emax)) != 0 ||
+      std::memcmp(ranges, expRanges, sizeof(ranges)) != 0) {
+    G4cout << "\n--> warning from SourceTerm : " << fileName
+           << " is not a source-term file of this binning" << G4endl;
+    return false;
+  }
+  in.read(reinterpret_cast<char*>(box), sizeof(box));
+  in.read(reinterpret_cast<char*>(&fHistories), sizeof(fHistories));
+  SetBox(G4ThreeVector(box[0], box[1], box[2]),
+         G4ThreeVector(box[3], box[4], box[5]));
+
+  for (G4int p=0; p<kNbParticles && in; p++) {
+    fBins[p].clear();
+    G4int count = 0;
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    for (G4int i=0; i<count && in; i++) {
+      G4int bin;
+      float weight;
+      in.read(reinterpret_cast<char*>(&bin), sizeof(bin));
+      in.read(reinterpret_cast<char*>(&weight), sizeof(weight));
+      fBins[p][bin] = weight;
+    }
+  }
+  if (!in || fHistories <= 0.) {
+    G4cout << "\n--> warning from SourceTerm : " << fileName
+           << " is truncated or empty" << G4endl;
+    for (G4int p=0; p<kNbParticles; p++) fBins[p].clear();
+    return false;
+  }
+  BuildAliasTable();
+  if (fKeys.empty()) {
+    G4cout << "\n--> warning from SourceTerm : " << fileName
+           << " records no leakage" << G4endl;
+    return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SourceTerm::Print() const
+{
+  G4int prec = G4cout.precision(4);
+  G4cout << "  " << fHistories << " histories, box half sizes "
+         << G4BestUnit(fHalfSizes, "Length") << " centred at "
+         << G4BestUnit(fCentre, "Length") << G4endl;
+  for (G4int p=0; p<kNbParticles; p++) {
+    G4double total = 0., energy = 0.;
+    std::map<G4int,G4double>::const_iterator it;
+    for (it = fBins[p].begin(); it != fBins[p].end(); it++) {
+      // energy at the log centre of the bin
+      G4int eBin = (it->first/kNbT)%kNbE[p];
+      G4double eMean = kEmin[p]*std::exp((eBin + 0.5)
+                       *std::log(kEmax[p]/kEmin[p])/kNbE[p]);
+      total  += it->second;
+      energy += it->second*eMean;
+    }
+    G4cout << "  " << std::setw(13) << Definition(p)->GetParticleName()
+           << ": " << std::setw(10)
+           << (fHistories > 0. ? total/fHistories : 0.) << " per history, "
+           << std::setw(7) << fBins[p].size() << " bins, mean energy "
+           << G4BestUnit(total > 0. ? energy/total : 0., "Energy") << G4endl;
+  }
+  G4cout.precision(prec);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
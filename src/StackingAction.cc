@@ -31,27 +31,63 @@
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 #include "StackingAction.hh"
+#include "StackingMessenger.hh"
+#include "DetectorConstruction.hh"
 #include "Run.hh"
+#include "CullingRules.hh"
+#include "TrackInformation.hh"
+#include "BiasingOperator.hh"
+#include "GammaSites.hh"
+#include "GammaBank.hh"
+#include "EventAction.hh"
+#include "NeutronGeneralProcess.hh"
+
+#include "HistoManager.hh"
 
 #include "G4RunManager.hh"
 #include "G4Track.hh"
+#include "G4Gamma.hh"
+#include "G4ProcessManager.hh"
+#include "G4ProcessVector.hh"
+#include "G4VProcess.hh"
+#include "G4HadronicProcessType.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Region.hh"
+#include "G4EventManager.hh"
+#include "G4Event.hh"
+#include "G4StackManager.hh"
+#include "Randomize.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 StackingAction::StackingAction()
-:G4UserStackingAction()
-{ }
+:G4UserStackingAction(), fPhotonTransport(true),
+ fLocalDeposit(false), fTrackInDetector(true), fDetector(0), fStackMessenger(0)
+{
+  fDetector = static_cast<const DetectorConstruction*>
+    (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  fStackMessenger = new StackingMessenger(this);
+
+  // low-priority stack of the tracks deferred by a culling rule
+  G4EventManager::GetEventManager()->GetStackManager()
+    ->SetNumberOfAdditionalWaitingStacks(1);
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 StackingAction::~StackingAction()
-{ }
+{
+  delete fStackMessenger;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4ClassificationOfNewTrack
 StackingAction::ClassifyNewTrack(const G4Track* aTrack)
 {
+  //tracks deferred by a culling rule in SteppingAction
+  if (aTrack->GetTrackStatus() == fSuspend) return fWaiting_1;
+
   //keep primary particle
   if (aTrack->GetParentID() == 0) return fUrgent;
 
@@ -63,14 +99,150 @@ StackingAction::ClassifyNewTrack(const G4Track* aTrack)
         G4RunManager::GetRunManager()->GetNonConstCurrentRun());    
   run->ParticleCount(name,energy);
 
+  //capture and inelastic gamma sites for the point-kernel engine
+  if (run->GetGammaSites() && name == "gamma" && aTrack->GetCreatorProcess() &&
+      (BiasingOperator::PhysicsProcess(aTrack->GetCreatorProcess())
+         ->GetProcessType() == fHadronic || FromCapture(aTrack)))
+    run->GetGammaSites()->Fill(aTrack->GetPosition(), energy,
+                               aTrack->GetWeight());
+
+  //two-pass simulation, pass one: gammas banked instead of tracked
+  if (run->GetGammaWriter() && name == "gamma") {
+    run->GetGammaWriter()->Write(G4EventManager::GetEventManager()
+                                   ->GetConstCurrentEvent()->GetEventID(),
+                                 aTrack);
+    run->AddCulling("twoPass", "banked", aTrack->GetWeight());
+    return fKill;
+  }
+
+  //user culling rules (/testhadr/cull/)
+  if (!CullingRules::Instance()->IsEmpty()) {
+    G4ClassificationOfNewTrack culled = Cull(aTrack, run);
+    if (culled != fUrgent) return culled;
+  }
+
   if(name =="neutron") return fUrgent; //neutrons are tracked first in the urgent stack
+
+  //charged secondaries: kinetic energy deposited at the creation point
+  if (fLocalDeposit && aTrack->GetDefinition()->GetPDGCharge() != 0.) {
+    const G4VPhysicalVolume* volume = aTrack->GetVolume();
+    const G4LogicalVolume* logical = volume ? volume->GetLogicalVolume() : 0;
+    if (!(fTrackInDetector && logical == fDetector->detectorL)) {
+      run->AddLocalEdep(logical ? logical->GetName() : G4String("none"),
+                        energy*aTrack->GetWeight());
+      return fKill;
+    }
+  }
+
+  //neutron-only mode: capture gammas are tallied where they are born;
+  //the other gammas and charged secondaries are not transported
+  if (!fPhotonTransport) {
+    if (name == "gamma" && FromCapture(aTrack)) {
+      G4double weight = aTrack->GetWeight();
+      const G4ThreeVector& pos = aTrack->GetPosition();
+      const G4VPhysicalVolume* volume = aTrack->GetVolume();
+      G4String region = volume ?
+        volume->GetLogicalVolume()->GetRegion()->GetName() : G4String("none");
+      run->AddGammaBirth(region, energy, weight);
+
+      EventAction* eventAction = static_cast<EventAction*>(
+        G4EventManager::GetEventManager()->GetUserEventAction());
+      eventAction->ScoreH1(16, energy, weight);
+
+      G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+      analysisManager->FillNtupleDColumn(5,0, pos.x());
+      analysisManager->FillNtupleDColumn(5,1, pos.y());
+      analysisManager->FillNtupleDColumn(5,2, pos.z());
+      analysisManager->FillNtupleDColumn(5,3, energy);
+      analysisManager->FillNtupleDColumn(5,4, weight);
+      analysisManager->AddNtupleRow(5);
+    }
+    return fKill;
+  }
   if(name == "gamma") return fWaiting; //gamma particles will be tracked in the waiting
                                        //stack, after the neutrons are tracked
   if(name == "proton") return fWaiting;
   if(name == "H3") return fWaiting;
 
-  //kill all secondaries  
+  //kill all other secondaries (electrons ...), reported in the run summary
+  run->AddCulling("default", "killed", aTrack->GetWeight());
   return fKill;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ClassificationOfNewTrack StackingAction::Cull(const G4Track* aTrack, Run* run)
+{
+  const G4VPhysicalVolume* volume = aTrack->GetVolume();
+  const CullingRules::Rule* rule = CullingRules::Instance()->Match(
+    aTrack->GetDefinition(), volume ? volume->GetLogicalVolume() : 0,
+    aTrack->GetKineticEnergy(), aTrack->GetGlobalTime(), aTrack->GetWeight(),
+    true);
+  if (!rule) return fUrgent;
+
+  // the new track is not tracked yet: its weight and information may change
+  G4Track* track = const_cast<G4Track*>(aTrack);
+  G4double weight = track->GetWeight();
+  if (rule->fAction == CullingRules::kKill) {
+    run->AddCulling(rule->fName, "killed", weight);
+    return fKill;
+  }
+  if (rule->fAction == CullingRules::kRoulette) {
+    if (weight >= rule->fSurvivalWeight) return fUrgent;
+    if (G4UniformRand()*rule->fSurvivalWeight < weight) {
+      track->SetWeight(rule->fSurvivalWeight);
+      run->AddCulling(rule->fName, "survived", rule->fSurvivalWeight);
+      return fUrgent;
+    }
+    run->AddCulling(rule->fName, "killed", weight);
+    return fKill;
+  }
+  // defer
+  TrackInformation* info =
+    static_cast<TrackInformation*>(track->GetUserInformation());
+  if (info && info->fDeferred) return fUrgent;
+  if (!info) {
+    info = new TrackInformation();
+    track->SetUserInformation(info);
+  }
+  info->fDeferred = true;
+  run->AddCulling(rule->fName, "deferred", weight);
+  return fWaiting_1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StackingAction::PrepareNewEvent()
+{
+  fPhotonTransport = PhotonTransport();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool StackingAction::PhotonTransport()
+{
+  G4ProcessManager* pManager = G4Gamma::Gamma()->GetProcessManager();
+  if (!pManager) return false;
+  G4ProcessVector* processes = pManager->GetProcessList();
+  for (G4int i=0; i<processes->size(); i++) {
+    if ((*processes)[i]->GetProcessType() == fElectromagnetic) return true;
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool StackingAction::FromCapture(const G4Track* track)
+{
+  const G4VProcess* creator = track->GetCreatorProcess();
+  if (!creator) return false;
+  if (BiasingOperator::PhysicsProcess(creator)->GetProcessSubType()
+      == fCapture) return true;
+
+  const TrackInformation* info =
+    static_cast<const TrackInformation*>(track->GetUserInformation());
+  return (info && (info->fGeneralChannel == NeutronGeneralProcess::kCapture ||
+                   info->fTankCapture));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
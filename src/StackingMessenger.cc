@@ -0,0 +1,85 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file StackingMessenger.cc
+/// \brief Implementation of the StackingMessenger class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "StackingMessenger.hh"
+
+#include "StackingAction.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingMessenger::StackingMessenger(StackingAction* stack)
+:G4UImessenger(),fStackingAction(stack),
+ fStackDir(0), fLocalDepositCmd(0), fTrackInDetectorCmd(0)
+{ 
+  fStackDir = new G4UIdirectory("/testhadr/stack/");
+  fStackDir->SetGuidance("secondary particle handling");
+   
+  fLocalDepositCmd = new G4UIcmdWithABool("/testhadr/stack/localDeposit",this);
+  fLocalDepositCmd->SetGuidance("deposit the kinetic energy of charged");
+  fLocalDepositCmd->SetGuidance("secondaries at their creation point");
+  fLocalDepositCmd->SetParameterName("local",false);
+  fLocalDepositCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fTrackInDetectorCmd =
+    new G4UIcmdWithABool("/testhadr/stack/trackInDetector",this);
+  fTrackInDetectorCmd->SetGuidance("keep tracking charged secondaries born");
+  fTrackInDetectorCmd->SetGuidance("in the He-3 tube (wall effect)");
+  fTrackInDetectorCmd->SetParameterName("track",false);
+  fTrackInDetectorCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingMessenger::~StackingMessenger()
+{
+  delete fLocalDepositCmd;
+  delete fTrackInDetectorCmd;
+  delete fStackDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StackingMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{   
+  if (command == fLocalDepositCmd)
+   {fStackingAction->SetLocalDeposit(fLocalDepositCmd->GetNewBoolValue(newValue));}
+
+  if (command == fTrackInDetectorCmd)
+   {fStackingAction->SetTrackInDetector(
+                        fTrackInDetectorCmd->GetNewBoolValue(newValue));}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -34,32 +34,56 @@
 #include "Run.hh"
 #include "TrackingAction.hh"
 #include "HistoManager.hh"
+#include "BiasingOperator.hh"
+#include "RegionInformation.hh"
+#include "TrackInformation.hh"
+#include "DxtranSphere.hh"
+#include "CullingRules.hh"
+#include "TransmissionKernel.hh"
+#include "SourceTerm.hh"
+#include "Perturbation.hh"
+#include "NeutronGeneralProcess.hh"
+#include "ResponseMatrix.hh"
+#include "CondensedSource.hh"
 
 #include "G4RunManager.hh"
+#include "G4HadronicProcessStore.hh"
+#include "G4HadronicProcess.hh"
+#include "G4HadronicProcessType.hh"
+#include "G4Nucleus.hh"
+#include "G4SteppingManager.hh"
+#include "G4NavigationHistory.hh"
+#include "G4Neutron.hh"
+#include "Randomize.hh"
                            
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 SteppingAction::SteppingAction(EventAction* evt, TrackingAction* TrAct)
-  : G4UserSteppingAction(),fEventAction(evt),fTrackingAction(TrAct)
+  : G4UserSteppingAction(),fEventAction(evt),fTrackingAction(TrAct),
+    fDxtran(0)
 {
   //get the dedector
   fDetector = static_cast<const DetectorConstruction*> (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
 
+  fDxtran = new DxtranSphere(fDetector);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 SteppingAction::~SteppingAction()
-{ }
+{
+  delete fDxtran;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void SteppingAction::UserSteppingAction(const G4Step* step)
 {
 
-  //Get process information
+  //Get process information (the physics process behind a biasing wrapper)
   const G4StepPoint* endPoint = step->GetPostStepPoint();
-  const G4VProcess* process = endPoint->GetProcessDefinedStep();
+  const G4VProcess* process =
+    BiasingOperator::PhysicsProcess(endPoint->GetProcessDefinedStep());
   G4String processName = process->GetProcessName();
   
   // count processes
@@ -78,10 +102,23 @@ void SteppingAction::UserSteppingAction(const G4Step* step)
   G4double ekin  = endPoint->GetKineticEnergy();
   G4double trackl = step->GetTrack()->GetTrackLength();
   G4double time   = step->GetTrack()->GetLocalTime();
+  G4double weight = track->GetWeight();
 
   // Sanity checks
   if(prePhysical == 0 || postPhysical == 0) return;  // The track does not exist  
-  if(prePhysical->GetCopyNo() == -1 && postPhysical->GetCopyNo() == -1) return; // Both steps are in the World
+
+  // derivatives of the history, before any scoring of the step
+  if (Perturbation::Instance()->IsActive()) PerturbationStep(step);
+
+  // user culling rules (/testhadr/cull/); the step itself is still scored
+  if (!CullingRules::Instance()->IsEmpty() &&
+      track->GetTrackStatus() == fAlive) Cull(step);
+  if(prePhysical->GetCopyNo() == -1 && postPhysical->GetCopyNo() == -1) { // Both steps are in the World
+    // DXTRAN follows the neutrons in the world too
+    if (fDxtran->IsActive() && track->GetDefinition() == G4Neutron::Neutron())
+      DxtranStep(step, process);
+    return;
+  }
   
   // Get logical volume
   const G4LogicalVolume* preLogical = pre->GetTouchableHandle()->GetVolume()->GetLogicalVolume();
@@ -90,16 +127,33 @@ void SteppingAction::UserSteppingAction(const G4Step* step)
   // Get particle name
   G4String particleName = step->GetTrack()->GetDefinition()->GetParticleName();
 
+  // leakage of the shielded source, when recording its condensed term
+  if (run->GetSourceTerm() && preLogical == fDetector->polyL &&
+      post->GetStepStatus() == fGeomBoundary) RecordSourceLeakage(step, run);
+
+  // neutron variance reduction of the region of the step
+  if (particleName == "neutron") {
+    if (run->GetTankKernel()) RecordTankWalls(step, run);
+    const RegionInformation* info = static_cast<const RegionInformation*>
+      (preLogical->GetRegion()->GetUserInformation());
+    if (info) SurvivalBiasing(step, preLogical, info);
+    if (fDxtran->IsActive() && DxtranStep(step, process)) return;
+  }
+
   //Protons in detector
+  //(with the merged neutron process the creator is nGeneral; in the He-3
+  // gas protons only come from 3He(n,p)t, an inelastic channel)
   if(particleName == "proton"){
-    if(preLogical == fDetector->detectorL && step->GetTrack()->GetCreatorProcess()->GetProcessName() == "neutronInelastic"){
-      G4AnalysisManager::Instance()->FillH1(6,ekin);
+    const G4String& creator = BiasingOperator::PhysicsProcess(
+      step->GetTrack()->GetCreatorProcess())->GetProcessName();
+    if(preLogical == fDetector->detectorL && (creator == "neutronInelastic" || creator == "nGeneral")){
+      fEventAction->ScoreH1(6,ekin,weight);
     }
   }
 
   //Neutron Inelastic in detector
   if(step->GetTrack()->GetParentID() > 0){
-    if(step->GetTrack()->GetCreatorProcess()->GetProcessName() == "neutronInelastic" && preLogical == fDetector->detectorL){
+    if(BiasingOperator::PhysicsProcess(step->GetTrack()->GetCreatorProcess())->GetProcessName() == "neutronInelastic" && preLogical == fDetector->detectorL){
       //std::cout << particleName << " created via neutron inelastic in detector found" << std::endl;
     }
   }
@@ -116,6 +170,7 @@ void SteppingAction::UserSteppingAction(const G4Step* step)
       G4AnalysisManager::Instance()->FillNtupleDColumn(0,2,z/1000); //ID, column,value
       G4AnalysisManager::Instance()->FillNtupleDColumn(0,3,ekin); 
       G4AnalysisManager::Instance()->AddNtupleRow(0);
+      fEventAction->AddTally(Run::kNeutronTankExit, weight, track);
     }
     //neurons leaving concrete
     if(preLogical == fDetector->slabL && postLogical == fDetector->roomL){
@@ -124,31 +179,37 @@ void SteppingAction::UserSteppingAction(const G4Step* step)
       G4AnalysisManager::Instance()->FillNtupleDColumn(2,2,z/1000); //ID, column,value
       G4AnalysisManager::Instance()->FillNtupleDColumn(2,3,ekin); 
       G4AnalysisManager::Instance()->AddNtupleRow(2);
+      fEventAction->AddTally(Run::kNeutronSlabExit, weight, track);
     }
 
     if(preLogical == fDetector->probePeL && postLogical == fDetector->detectorL){
-      G4AnalysisManager::Instance()->FillH1(1,ekin);
+      fEventAction->ScoreH1(1,ekin,weight);
+      fEventAction->AddTally(Run::kNeutronProbe, weight, track);
     }
     
   }
 
   //neutron capture
-  if(particleName == "neutron" && post->GetProcessDefinedStep()->GetProcessName() == "nCapture"){
+  if(particleName == "neutron" && processName == "nCapture"){
     if(postLogical == fDetector->detectorL){
-      G4AnalysisManager::Instance()->FillH1(2,ekin);
+      fEventAction->ScoreH1(2,ekin,weight);
+      fEventAction->AddTally(Run::kCaptureDetector, weight, track);
     }
     if(postLogical == fDetector->tankL){
-      G4AnalysisManager::Instance()->FillH1(3,ekin);
+      fEventAction->ScoreH1(3,ekin,weight);
+      fEventAction->AddTally(Run::kCaptureTank, weight, track);
     }
     if(postLogical == fDetector->polyL){
-      G4AnalysisManager::Instance()->FillH1(4,ekin);
+      fEventAction->ScoreH1(4,ekin,weight);
+      fEventAction->AddTally(Run::kCapturePoly, weight, track);
     }
   }
 
   //neutron inelastic
-  if(particleName == "neutron" && post->GetProcessDefinedStep()->GetProcessName() == "neutronInelastic"){
+  if(particleName == "neutron" && processName == "neutronInelastic"){
     if(postLogical == fDetector->detectorL){
-      G4AnalysisManager::Instance()->FillH1(5,ekin);
+      fEventAction->ScoreH1(5,ekin,weight);
+      fEventAction->AddTally(Run::kInelasticDetector, weight, track);
       G4AnalysisManager::Instance()->FillNtupleDColumn(4,0,ekin);
       G4AnalysisManager::Instance()->FillNtupleDColumn(4,1,time);
       G4AnalysisManager::Instance()->AddNtupleRow(4);
@@ -168,6 +229,7 @@ void SteppingAction::UserSteppingAction(const G4Step* step)
       G4AnalysisManager::Instance()->FillNtupleDColumn(1,2,z/1000); //ID, column,value
       G4AnalysisManager::Instance()->FillNtupleDColumn(1,3,ekin); 
       G4AnalysisManager::Instance()->AddNtupleRow(1);
+      fEventAction->AddTally(Run::kGammaTankExit, weight, track);
     }
     //gammas leaving concrete
     if(preLogical == fDetector->slabL && postLogical == fDetector->roomL){
@@ -176,10 +238,349 @@ void SteppingAction::UserSteppingAction(const G4Step* step)
       G4AnalysisManager::Instance()->FillNtupleDColumn(3,2,z/1000); //ID, column,value
       G4AnalysisManager::Instance()->FillNtupleDColumn(3,3,ekin); 
       G4AnalysisManager::Instance()->AddNtupleRow(3);
+      fEventAction->AddTally(Run::kGammaSlabExit, weight, track);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingAction::SurvivalBiasing(const G4Step* step,
+                                     const G4LogicalVolume* volume,
+                                     const RegionInformation* info)
+{
+  G4Track* track = step->GetTrack();
+  const G4StepPoint* pre = step->GetPreStepPoint();
+
+  // with implicit capture no neutron is captured here (BiasingOperator):
+  // score instead the expected captures w(1 - exp(-Sigma_c l)) of the step,
+  // which is the weight the wrapper removes along it
+  if (info->fImplicitCapture) {
+    G4double ekinPre = pre->GetKineticEnergy();
+    G4double sigma = G4HadronicProcessStore::Instance()
+      ->GetCaptureCrossSectionPerVolume(G4Neutron::Neutron(), ekinPre,
+                                        pre->GetMaterial());
+    G4double wCapture =
+      pre->GetWeight()*(1. - std::exp(-sigma*step->GetStepLength()));
+    if (wCapture > 0.) {
+      if (volume == fDetector->detectorL) {
+        fEventAction->ScoreH1(2,ekinPre,wCapture);
+        fEventAction->AddTally(Run::kCaptureDetector, wCapture, track);
+      }
+      if (volume == fDetector->tankL) {
+        fEventAction->ScoreH1(3,ekinPre,wCapture);
+        fEventAction->AddTally(Run::kCaptureTank, wCapture, track);
+      }
+      if (volume == fDetector->polyL) {
+        fEventAction->ScoreH1(4,ekinPre,wCapture);
+        fEventAction->AddTally(Run::kCapturePoly, wCapture, track);
+      }
+    }
+  }
+
+  // weight cutoff: Russian roulette keeps the expected weight unchanged
+  if (info->fWeightLow > 0. && track->GetTrackStatus() == fAlive &&
+      track->GetWeight() < info->fWeightLow) {
+    if (G4UniformRand()*info->fWeightSurvival < track->GetWeight()) {
+      track->SetWeight(info->fWeightSurvival);
+    }
+    else {
+      Run* run = static_cast<Run*>(G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+      run->AddVarianceReduction("rouletteKilled", track->GetWeight());
+      track->SetTrackStatus(fStopAndKill);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool SteppingAction::DxtranStep(const G4Step* step, const G4VProcess* process)
+{
+  G4Track* track = step->GetTrack();
+  const G4StepPoint* pre = step->GetPreStepPoint();
+  const G4StepPoint* post = step->GetPostStepPoint();
+  const G4ThreeVector& start = pre->GetPosition();
+  const G4ThreeVector& end = post->GetPosition();
+  Run* run = static_cast<Run*>(G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+  fDxtran->Update();
+
+  // a pseudo-neutron becomes an ordinary one once out of the sphere
+  TrackInformation* info =
+    static_cast<TrackInformation*>(track->GetUserInformation());
+  if (info && info->fDxtran) {
+    if (track->GetCurrentStepNumber() > 1 && !fDxtran->Inside(end)) {
+      info->fDxtran = false;
+    }
+    return false;
+  }
+
+  if (!info) {
+    info = new TrackInformation();
+    track->SetUserInformation(info);
+  }
+
+  // emission of the neutron: sources and channels emitting isotropically
+  // in the lab send their pseudo-neutron, the others (beams, condensed
+  // source term) enter the sphere analogue
+  if (track->GetCurrentStepNumber() == 1) {
+    info->fDxtranCovered = IsotropicEmission(track) && !fDxtran->Inside(start);
+    if (info->fDxtranCovered) {
+      PushPseudoNeutron(fDxtran->Emission(track, start, pre->GetKineticEnergy(),
+                                          pre->GetGlobalTime(), pre->GetWeight(),
+                                          track->GetCreatorProcess()),
+                        info, run);
+    }
+  }
+
+  // inside the sphere, the pseudo-neutron stands for the real one
+  if (info->fDxtranCovered && fDxtran->Enters(start, end)) {
+    run->AddVarianceReduction("dxtranKilled", track->GetWeight());
+    track->SetTrackStatus(fStopAndKill);
+    return true;
+  }
+  if (track->GetTrackStatus() != fAlive) return false;
+
+  const G4HadronicProcess* hadronic = (post->GetStepStatus() == fPostStepDoItProc)
+    ? dynamic_cast<const G4HadronicProcess*>(process) : 0;
+  if (!hadronic) {
+    // any other change of direction or energy (fast simulation ...) has
+    // no pseudo-neutron: the neutron enters the sphere analogue
+    if (post->GetMomentumDirection() != pre->GetMomentumDirection() ||
+        post->GetKineticEnergy() != pre->GetKineticEnergy())
+      info->fDxtranCovered = false;
+    return false;
+  }
+
+  // collision ending the step (with the general process, the selected
+  // channel); the neutrons emitted as secondaries send theirs at birth
+  info->fDxtranCovered = !fDxtran->Inside(end);
+  if (!info->fDxtranCovered) return false;
+  const G4Nucleus* target = hadronic->GetTargetNucleus();
+  if (process->GetProcessName() == "hadElastic" && target) {
+    PushPseudoNeutron(fDxtran->Contribution(step, target->GetA_asInt()),
+                      info, run);
+  }
+  else {
+    // the neutron leaving an inelastic channel, isotropic in the lab
+    PushPseudoNeutron(fDxtran->Emission(track, end, post->GetKineticEnergy(),
+                                        post->GetGlobalTime(), track->GetWeight(),
+                                        post->GetProcessDefinedStep()),
+                      info, run);
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool SteppingAction::IsotropicEmission(const G4Track* track) const
+{
+  // neutrons of the hadronic channels (inelastic, fission ...), created by
+  // the process itself or by the general process
+  if (track->GetParentID() > 0) {
+    const G4VProcess* creator =
+      BiasingOperator::PhysicsProcess(track->GetCreatorProcess());
+    return dynamic_cast<const G4HadronicProcess*>(creator) != 0 ||
+           dynamic_cast<const NeutronGeneralProcess*>(creator) != 0;
+  }
+
+  // primaries: the isotropic sources, not the beams of the response matrix
+  // nor the condensed source term
+  return !ResponseMatrix::Instance()->IsActive() &&
+         !CondensedSource::Instance()->GetSource();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingAction::PushPseudoNeutron(G4Track* pseudo,
+                                       const TrackInformation* info, Run* run)
+{
+  if (!pseudo) return;
+  TrackInformation* pseudoInfo =
+    static_cast<TrackInformation*>(pseudo->GetUserInformation());
+  for (G4int p=0; p<Perturbation::kNbParameters; p++)
+    pseudoInfo->fDerivative[p] = info->fDerivative[p];
+  fpSteppingManager->GetfSecondary()->push_back(pseudo);
+  run->AddVarianceReduction("dxtranCreated", pseudo->GetWeight());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingAction::PerturbationStep(const G4Step* step)
+{
+  G4Track* track = step->GetTrack();
+  TrackInformation* info =
+    static_cast<TrackInformation*>(track->GetUserInformation());
+
+  G4double derivative[Perturbation::kNbParameters];
+  G4bool nonZero = false;
+  for (G4int p=0; p<Perturbation::kNbParameters; p++)
+    derivative[p] = info ? info->fDerivative[p] : 0.;
+  if (track->GetDefinition() == G4Neutron::Neutron())
+    Perturbation::Instance()->AddStep(step, derivative);
+  for (G4int p=0; p<Perturbation::kNbParameters; p++)
+    if (derivative[p] != 0.) nonZero = true;
+  if (!nonZero) return;
+
+  if (!info) {
+    info = new TrackInformation();
+    track->SetUserInformation(info);
+  }
+  for (G4int p=0; p<Perturbation::kNbParameters; p++)
+    info->fDerivative[p] = derivative[p];
+
+  // secondaries are tracked after their parent: they carry its D of now
+  const std::vector<const G4Track*>* secondaries =
+    step->GetSecondaryInCurrentStep();
+  for (std::size_t i=0; i<secondaries->size(); i++) {
+    G4Track* secondary = const_cast<G4Track*>((*secondaries)[i]);
+    TrackInformation* secondaryInfo =
+      static_cast<TrackInformation*>(secondary->GetUserInformation());
+    if (!secondaryInfo) {
+      secondaryInfo = new TrackInformation();
+      secondary->SetUserInformation(secondaryInfo);
     }
+    for (G4int p=0; p<Perturbation::kNbParameters; p++)
+      secondaryInfo->fDerivative[p] = derivative[p];
   }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void SteppingAction::Cull(const G4Step* step)
+{
+  G4Track* track = step->GetTrack();
+  const G4StepPoint* post = step->GetPostStepPoint();
+  const CullingRules::Rule* rule = CullingRules::Instance()->Match(
+    track->GetDefinition(), post->GetPhysicalVolume()->GetLogicalVolume(),
+    post->GetKineticEnergy(), post->GetGlobalTime(), track->GetWeight(),
+    false);
+  if (!rule) return;
 
+  Run* run = static_cast<Run*>(G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+  G4double weight = track->GetWeight();
+  if (rule->fAction == CullingRules::kKill) {
+    run->AddCulling(rule->fName, "killed", weight);
+    track->SetTrackStatus(fStopAndKill);
+  }
+  else if (rule->fAction == CullingRules::kRoulette) {
+    if (weight >= rule->fSurvivalWeight) return;
+    if (G4UniformRand()*rule->fSurvivalWeight < weight) {
+      track->SetWeight(rule->fSurvivalWeight);
+      run->AddCulling(rule->fName, "survived", rule->fSurvivalWeight);
+    }
+    else {
+      run->AddCulling(rule->fName, "killed", weight);
+      track->SetTrackStatus(fStopAndKill);
+    }
+  }
+  else {
+    // back to the stack once, then to the low-priority one (StackingAction)
+    TrackInformation* info =
+      static_cast<TrackInformation*>(track->GetUserInformation());
+    if (info && info->fDeferred) return;
+    if (!info) {
+      info = new TrackInformation();
+      track->SetUserInformation(info);
+    }
+    info->fDeferred = true;
+    run->AddCulling(rule->fName, "deferred", weight);
+    track->SetTrackStatus(fSuspend);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingAction::RecordTankWalls(const G4Step* step, Run* run)
+{
+  G4Track* track = step->GetTrack();
+  const G4StepPoint* pre  = step->GetPreStepPoint();
+  const G4StepPoint* post = step->GetPostStepPoint();
+  const G4LogicalVolume* tank = fDetector->tankL;
+  const G4LogicalVolume* preLogical  = pre->GetTouchable()->GetVolume()->GetLogicalVolume();
+  const G4LogicalVolume* postLogical = post->GetTouchable()->GetVolume()->GetLogicalVolume();
+  const TankWalls& walls = run->GetTankWalls();
+  TransmissionKernel* kernel = run->GetTankKernel();
+  TrackInformation* info =
+    static_cast<TrackInformation*>(track->GetUserInformation());
+
+  // a pending entry ends when the neutron leaves the water or dies in it
+  if (info && info->fTankFace >= 0 && preLogical == tank) {
+    G4double delay = post->GetGlobalTime() - info->fTankTime;
+    if (post->GetStepStatus() == fGeomBoundary && postLogical != tank) {
+      const G4AffineTransform& toTank = pre->GetTouchable()->GetHistory()->GetTopTransform();
+      G4double rho, mu;
+      G4int exit = walls.Exit(info->fTankFace, info->fTankEntry,
+                              toTank.TransformPoint(post->GetPosition()),
+                              toTank.TransformAxis(post->GetMomentumDirection()),
+                              rho, mu);
+      if (exit) {
+        kernel->Fill(info->fTankInput, info->fTankWeight,
+                     exit == 1 ? TransmissionKernel::kReflected
+                               : TransmissionKernel::kTransmitted,
+                     post->GetKineticEnergy(), mu, rho, delay,
+                     track->GetWeight());
+      }
+      else kernel->Exclude(info->fTankWeight);
+      info->fTankFace = -1;
+    }
+    else if (track->GetTrackStatus() == fStopAndKill ||
+             track->GetTrackStatus() == fKillTrackAndSecondaries) {
+      // a capture keeps its site, where TransmissionModel emits its gamma
+      G4bool capture = (BiasingOperator::PhysicsProcess(
+        post->GetProcessDefinedStep())->GetProcessSubType() == fCapture);
+      const G4AffineTransform& toTank = pre->GetTouchable()->GetHistory()->GetTopTransform();
+      G4double depth, rho;
+      walls.Inside(info->fTankFace, info->fTankEntry,
+                   toTank.TransformPoint(post->GetPosition()), depth, rho);
+      kernel->FillAbsorbed(info->fTankInput, info->fTankWeight, capture,
+                           depth, rho, delay, pre->GetWeight());
+      info->fTankFace = -1;
+    }
+  }
+
+  // a new entry through the plain part of a wall
+  if (post->GetStepStatus() == fGeomBoundary && postLogical == tank &&
+      preLogical != tank && track->GetTrackStatus() == fAlive) {
+    const G4AffineTransform& toTank = post->GetTouchable()->GetHistory()->GetTopTransform();
+    G4ThreeVector position = toTank.TransformPoint(post->GetPosition());
+    TankWalls::Crossing entry;
+    if (!walls.Entry(position,
+                     toTank.TransformAxis(post->GetMomentumDirection()),
+                     entry)) return;
+    if (!info) {
+      info = new TrackInformation();
+      track->SetUserInformation(info);
+    }
+    info->fTankFace   = entry.fFace;
+    info->fTankInput  = kernel->Input(entry.fWall, post->GetKineticEnergy(),
+                                      entry.fMu);
+    info->fTankEntry  = position;
+    info->fTankTime   = post->GetGlobalTime();
+    info->fTankWeight = track->GetWeight();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingAction::RecordSourceLeakage(const G4Step* step, Run* run)
+{
+  G4Track* track = step->GetTrack();
+  G4int particle = SourceTerm::Particle(track->GetDefinition());
+  if (particle < 0 || track->GetTrackStatus() != fAlive) return;
+
+  // into a daughter of the poly (the source head) is not a leakage
+  const G4StepPoint* pre  = step->GetPreStepPoint();
+  const G4StepPoint* post = step->GetPostStepPoint();
+  const G4AffineTransform& toPoly = pre->GetTouchable()->GetHistory()->GetTopTransform();
+  G4ThreeVector position  = toPoly.TransformPoint(post->GetPosition());
+  G4ThreeVector direction = toPoly.TransformAxis(post->GetMomentumDirection());
+  SourceTerm* source = run->GetSourceTerm();
+  G4int face = source->Face(position, direction);
+  if (face < 0) return;
+
+  source->Fill(particle, face, position, direction, post->GetKineticEnergy(),
+               post->GetGlobalTime(), track->GetWeight());
+  track->SetTrackStatus(fStopAndKill);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
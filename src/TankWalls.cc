@@ -0,0 +1,239 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TankWalls.cc
+/// \brief Implementation of the TankWalls class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "TankWalls.hh"
+
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Box.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // a point closer than this to a face is on it
+  const G4double kOnFace = 1*um;
+  // exit points are put this far inside the water, so that transportation
+  // makes (and scores) the crossing
+  const G4double kPushBack = 1*nm;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TankWalls::TankWalls()
+: fValid(false), fMargin(0.)
+{
+  for (G4int i=0; i<3; i++) fOuter[i] = fInner[i] = fCentre[i] = 0.;
+  for (G4int k=0; k<kNbKinds; k++) fThickness[k] = 0.;
+  for (G4int f=0; f<12; f++) fSlab[f] = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TankWalls::~TankWalls()
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TankWalls::Set(const G4LogicalVolume* tank, G4double margin)
+{
+  fValid = false;
+  if (!tank || tank->GetNoDaughters() == 0) return false;
+  const G4VPhysicalVolume* chamber = tank->GetDaughter(0);
+  const G4Box* outer = dynamic_cast<const G4Box*>(tank->GetSolid());
+  const G4Box* inner =
+    dynamic_cast<const G4Box*>(chamber->GetLogicalVolume()->GetSolid());
+  if (!outer || !inner || chamber->GetRotation()) return false;
+
+  fOuter[0] = outer->GetXHalfLength();
+  fOuter[1] = outer->GetYHalfLength();
+  fOuter[2] = outer->GetZHalfLength();
+  fInner[0] = inner->GetXHalfLength();
+  fInner[1] = inner->GetYHalfLength();
+  fInner[2] = inner->GetZHalfLength();
+  for (G4int i=0; i<3; i++) fCentre[i] = chamber->GetTranslation()[i];
+  fMargin = margin;
+
+  // a kind of wall is a slab of one thickness, that of its first face;
+  // faces of another thickness are left to detailed transport
+  for (G4int k=0; k<kNbKinds; k++) fThickness[k] = 0.;
+  for (G4int f=0; f<6; f++) {
+    G4int kind = (Axis(f) == 2) ? 1 : 0;
+    G4double thickness = std::fabs(Plane(f) - Plane(Opposite(f)));
+    if (fThickness[kind] == 0.) fThickness[kind] = thickness;
+    fSlab[f] = (thickness > kOnFace &&
+                std::fabs(thickness - fThickness[kind]) < kOnFace);
+    fSlab[Opposite(f)] = fSlab[f];
+  }
+  fValid = true;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TankWalls::Plane(G4int face) const
+{
+  G4int a = Axis(face);
+  return (Layer(face) == 0) ? Sign(face)*fOuter[a]
+                            : fCentre[a] + Sign(face)*fInner[a];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector TankWalls::Normal(G4int face) const
+{
+  G4ThreeVector normal;
+  normal[Axis(face)] = (Layer(face) == 0) ? -Sign(face) : Sign(face);
+  return normal;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TankWalls::Lateral(G4int face, const G4ThreeVector& position,
+                          G4double margin) const
+{
+  for (G4int b=0; b<3; b++) {
+    if (b == Axis(face)) continue;
+    if (std::fabs(position[b] - fCentre[b]) > fInner[b] - margin) return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TankWalls::Entry(const G4ThreeVector& position,
+                        const G4ThreeVector& direction, Crossing& entry) const
+{
+  if (!fValid) return false;
+  for (G4int f=0; f<12; f++) {
+    if (!fSlab[f]) continue;
+    if (std::fabs(position[Axis(f)] - Plane(f)) > kOnFace) continue;
+    G4double mu = direction.dot(Normal(f));
+    if (mu <= 0. || !Lateral(f, position, fMargin)) return false;
+    entry.fFace = f;
+    entry.fWall = ((Axis(f) == 2) ? 1 : 0) + kNbKinds*Layer(f);
+    entry.fMu   = mu;
+    return true;
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int TankWalls::Exit(G4int face, const G4ThreeVector& entry,
+                      const G4ThreeVector& position,
+                      const G4ThreeVector& direction,
+                      G4double& rho, G4double& mu) const
+{
+  G4int exitFace = -1, exit = 0;
+  if (std::fabs(position[Axis(face)] - Plane(face)) < kOnFace) {
+    exitFace = face;
+    exit = 1;
+  } else if (std::fabs(position[Axis(face)] - Plane(Opposite(face))) < kOnFace) {
+    exitFace = Opposite(face);
+    exit = 2;
+  }
+  if (exit == 0 || !Lateral(exitFace, position, 0.)) return 0;
+
+  G4ThreeVector shift = position - entry;
+  shift[Axis(face)] = 0.;
+  rho = shift.mag();
+  mu  = -direction.dot(Normal(exitFace));
+  return exit;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TankWalls::ExitState(G4int face, const G4ThreeVector& entry, G4int exit,
+                            G4double rho, G4double mu,
+                            G4ThreeVector& position,
+                            G4ThreeVector& direction) const
+{
+  G4int exitFace = (exit == 1) ? face : Opposite(face);
+  G4int a = Axis(face), b = (a+1)%3, c = (a+2)%3;
+
+  G4double phi = twopi*G4UniformRand();
+  position    = entry;
+  position[b] += rho*std::cos(phi);
+  position[c] += rho*std::sin(phi);
+  if (!Lateral(exitFace, position, 0.)) return false;
+  G4ThreeVector inward = Normal(exitFace);
+  position[a] = Plane(exitFace) + kPushBack*inward[a];
+
+  G4double psi = twopi*G4UniformRand();
+  G4double sinTheta = std::sqrt(std::max(0., 1. - mu*mu));
+  direction = -mu*inward;
+  direction[b] = sinTheta*std::cos(psi);
+  direction[c] = sinTheta*std::sin(psi);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TankWalls::Inside(G4int face, const G4ThreeVector& entry,
+                       const G4ThreeVector& position,
+                       G4double& depth, G4double& rho) const
+{
+  G4int a = Axis(face);
+  depth = (position[a] - Plane(face))*Normal(face)[a];
+  G4ThreeVector shift = position - entry;
+  shift[a] = 0.;
+  rho = shift.mag();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TankWalls::InsideState(G4int face, const G4ThreeVector& entry,
+                              G4double depth, G4double rho,
+                              G4ThreeVector& position) const
+{
+  G4int a = Axis(face), b = (a+1)%3, c = (a+2)%3;
+
+  G4double phi = twopi*G4UniformRand();
+  position    = entry;
+  position[b] += rho*std::cos(phi);
+  position[c] += rho*std::sin(phi);
+  if (!Lateral(face, position, 0.)) return false;
+  G4double thickness = std::fabs(Plane(face) - Plane(Opposite(face)));
+  depth = std::min(std::max(depth, kPushBack), thickness - kPushBack);
+  position[a] = Plane(face) + depth*Normal(face)[a];
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,386 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TransmissionKernel.cc
+/// \brief Implementation of the TransmissionKernel class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "TransmissionKernel.hh"
+#include "TankWalls.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  const char     kMagic[8] = {'M','O','N','T','K','0','0','2'};
+
+  // entry and exit energy: log bins
+  const G4int    kNbE   = 25;
+  const G4double kEmin  = 1.e-5*eV;
+  const G4double kEmax  = 20*MeV;
+  // entry and exit cosine to the wall normal
+  const G4int    kNbMu  = 5;
+  // lateral displacement, the last bin collecting the overflow
+  const G4int    kNbRho = 20;
+  const G4double kRhoMax = 1*m;
+  // time delay: log bins, the first and last collecting the under/overflow
+  const G4int    kNbT   = 14;
+  const G4double kTmin  = 1*ns;
+  const G4double kTmax  = 10*ms;
+  // depth of a capture: fraction of the wall thickness
+  const G4int    kNbDepth = 10;
+
+  const G4int    kEMuSize  = kNbE*kNbMu;
+  const G4int    kExitSize = kEMuSize + kNbE*(kNbRho + kNbT);
+  // capture weight, then depth, displacement and delay of the captures
+  const G4int    kCaptureSize = 1 + kNbDepth + kNbRho + kNbT;
+
+  G4int Bin(G4double x, G4int n)
+  {
+    return std::min(std::max(G4int(x*n), 0), n-1);
+  }
+
+  G4int EnergyBin(G4double ekin)
+  {
+    return Bin(std::log(ekin/kEmin)/std::log(kEmax/kEmin), kNbE);
+  }
+
+  G4int TimeBin(G4double delay)
+  {
+    if (delay <= kTmin) return 0;
+    return Bin(std::log(delay/kTmin)/std::log(kTmax/kTmin), kNbT);
+  }
+
+  // a bin of a cumulative segment, by inversion
+  G4int SampleBin(const G4double* cumulative, G4int n)
+  {
+    G4double total = cumulative[n-1];
+    if (total <= 0.) return 0;
+    G4double u = G4UniformRand()*total;
+    return std::min(G4int(std::upper_bound(cumulative, cumulative+n, u)
+                          - cumulative), n-1);
+  }
+
+  G4double Uniform(G4double a, G4double b)
+  {
+    return a + (b - a)*G4UniformRand();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TransmissionKernel::TransmissionKernel()
+: fBlockSize(kNbOutcomes + 2*kExitSize + kCaptureSize), fExcluded(0.)
+{
+  fThickness[0] = fThickness[1] = 0.;
+  G4int nbInputs = TankWalls::kNbWalls*kNbE*kNbMu;
+  fEntryWeight.assign(nbInputs, 0.);
+  fData.assign(nbInputs*fBlockSize, 0.);
+  fMaxRho.assign(nbInputs, 0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TransmissionKernel::~TransmissionKernel()
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int TransmissionKernel::Input(G4int wall, G4double ekin, G4double mu) const
+{
+  return (wall*kNbE + EnergyBin(ekin))*kNbMu + Bin(mu, kNbMu);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int TransmissionKernel::ExitOffset(Outcome outcome) const
+{
+  return kNbOutcomes + (outcome == kReflected ? 0 : kExitSize);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int TransmissionKernel::CaptureOffset() const
+{
+  return kNbOutcomes + 2*kExitSize;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TransmissionKernel::Thickness(G4int input) const
+{
+  return fThickness[(input/(kNbE*kNbMu))%TankWalls::kNbKinds];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TransmissionKernel::Fill(G4int input, G4double entryWeight,
+                              Outcome outcome, G4double ekin, G4double mu,
+                              G4double rho, G4double delay, G4double weight)
+{
+  fEntryWeight[input] += entryWeight;
+  G4double* block = &fData[Block(input)];
+  block[outcome] += weight;
+  if (outcome == kAbsorbed) return;
+
+  G4double* exit = block + ExitOffset(outcome);
+  G4int eBin = EnergyBin(ekin);
+  exit[eBin*kNbMu + Bin(mu, kNbMu)] += weight;
+  G4double* given = exit + kEMuSize + eBin*(kNbRho + kNbT);
+  given[Bin(rho/kRhoMax, kNbRho)] += weight;
+  given[kNbRho + TimeBin(delay)]  += weight;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TransmissionKernel::FillAbsorbed(G4int input, G4double entryWeight,
+                                      G4bool capture, G4double depth,
+                                      G4double rho, G4double delay,
+                                      G4double weight)
+{
+  fEntryWeight[input] += entryWeight;
+  G4double* block = &fData[Block(input)];
+  block[kAbsorbed] += weight;
+  if (!capture) return;
+
+  G4double* site = block + CaptureOffset();
+  site[0] += weight;
+  G4double thickness = Thickness(input);
+  G4double fraction = (thickness > 0.) ? depth/thickness : 0.;
+  site[1 + Bin(fraction, kNbDepth)] += weight;
+  G4double* given = site + 1 + kNbDepth;
+  given[Bin(rho/kRhoMax, kNbRho)] += weight;
+  given[kNbRho + TimeBin(delay)]  += weight;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TransmissionKernel::Add(const TransmissionKernel& other)
+{
+  for (std::size_t i=0; i<fEntryWeight.size(); i++)
+    fEntryWeight[i] += other.fEntryWeight[i];
+  for (std::size_t i=0; i<fData.size(); i++) fData[i] += other.fData[i];
+  fExcluded += other.fExcluded;
+  for (G4int k=0; k<2; k++) {
+    if (fThickness[k] == 0.) fThickness[k] = other.fThickness[k];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TransmissionKernel::Clear()
+{
+  std::fill(fEntryWeight.begin(), fEntryWeight.end(), 0.);
+  std::fill(fData.begin(), fData.end(), 0.);
+  fCumulative.clear();
+  std::fill(fMaxRho.begin(), fMaxRho.end(), 0.);
+  fExcluded = 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TransmissionKernel::GetEntries() const
+{
+  G4double entries = 0.;
+  for (std::size_t i=0; i<fEntryWeight.size(); i++) entries += fEntryWeight[i];
+  return entries;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TransmissionKernel::Prepare()
+{
+  // running sums within each distribution of each block, and the upper
+  // edge of the last displacement bin with data, exits and captures
+  fCumulative = fData;
+  for (std::size_t input=0; input<fEntryWeight.size(); input++) {
+    G4double* block = &fCumulative[Block(input)];
+    G4int lastRho = -1;
+    for (G4int r=0; r<2; r++) {
+      G4double* exit = block + kNbOutcomes + r*kExitSize;
+      std::partial_sum(exit, exit + kEMuSize, exit);
+      for (G4int e=0; e<kNbE; e++) {
+        G4double* given = exit + kEMuSize + e*(kNbRho + kNbT);
+        for (G4int i=lastRho+1; i<kNbRho; i++) if (given[i] > 0.) lastRho = i;
+        std::partial_sum(given, given + kNbRho, given);
+        std::partial_sum(given + kNbRho, given + kNbRho + kNbT, given + kNbRho);
+      }
+    }
+    G4double* site = block + CaptureOffset() + 1;
+    std::partial_sum(site, site + kNbDepth, site);
+    G4double* given = site + kNbDepth;
+    for (G4int i=lastRho+1; i<kNbRho; i++) if (given[i] > 0.) lastRho = i;
+    std::partial_sum(given, given + kNbRho, given);
+    std::partial_sum(given + kNbRho, given + kNbRho + kNbT, given + kNbRho);
+    fMaxRho[input] = (lastRho + 1)*kRhoMax/kNbRho;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TransmissionKernel::Sample(G4int input, Exit& result) const
+{
+  if (fCumulative.empty() || fEntryWeight[input] <= 0.) return false;
+  const G4double* block = &fData[Block(input)];
+  G4double total = block[kAbsorbed] + block[kReflected] + block[kTransmitted];
+  if (total <= 0.) return false;
+
+  // the outcome by its weight; the entry weight is scaled by the ratio of
+  // outcome to entry weights (1 for kernels of analog runs)
+  result.fWeight = total/fEntryWeight[input];
+  G4double u = G4UniformRand()*total;
+  result.fOutcome = (u < block[kAbsorbed]) ? kAbsorbed
+                  : (u < block[kAbsorbed] + block[kReflected]) ? kReflected
+                  : kTransmitted;
+  result.fEkin = result.fMu = result.fRho = result.fDelay = 0.;
+  result.fCapture = false;
+  result.fDepth = 0.;
+  G4double dlogT = std::log(kTmax/kTmin)/kNbT;
+  if (result.fOutcome == kAbsorbed) {
+    // a capture by the weight of the captures among the absorptions
+    const G4double* site = &fCumulative[Block(input) + CaptureOffset()];
+    result.fCapture = (G4UniformRand()*block[kAbsorbed] < site[0]);
+    if (!result.fCapture) return true;
+    G4int depthBin = SampleBin(site + 1, kNbDepth);
+    const G4double* given = site + 1 + kNbDepth;
+    G4int rhoBin = SampleBin(given, kNbRho);
+    G4int tBin   = SampleBin(given + kNbRho, kNbT);
+    result.fDepth = Uniform(depthBin, depthBin+1)*Thickness(input)/kNbDepth;
+    result.fRho   = Uniform(rhoBin, rhoBin+1)*kRhoMax/kNbRho;
+    result.fDelay = kTmin*std::exp(Uniform(tBin, tBin+1)*dlogT);
+    return true;
+  }
+
+  const G4double* exit =
+    &fCumulative[Block(input) + ExitOffset(result.fOutcome)];
+  G4int cell = SampleBin(exit, kEMuSize);
+  G4int eBin = cell/kNbMu, muBin = cell%kNbMu;
+  const G4double* given = exit + kEMuSize + eBin*(kNbRho + kNbT);
+  G4int rhoBin = SampleBin(given, kNbRho);
+  G4int tBin   = SampleBin(given + kNbRho, kNbT);
+
+  // uniform within the bins, in log for energy and time
+  G4double dlogE = std::log(kEmax/kEmin)/kNbE;
+  result.fEkin  = kEmin*std::exp(Uniform(eBin, eBin+1)*dlogE);
+  result.fMu    = Uniform(muBin, muBin+1)/kNbMu;
+  result.fRho   = Uniform(rhoBin, rhoBin+1)*kRhoMax/kNbRho;
+  result.fDelay = kTmin*std::exp(Uniform(tBin, tBin+1)*dlogT);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TransmissionKernel::Write(const G4String& fileName) const
+{
+  std::ofstream out(fileName, std::ios::binary);
+  if (!out) {
+    G4cout << "\n--> warning from TransmissionKernel : cannot write "
+           << fileName << G4endl;
+    return false;
+  }
+  G4int    dims[6]   = { TankWalls::kNbWalls, kNbE, kNbMu, kNbRho, kNbT,
+                         kNbDepth };
+  G4double ranges[5] = { kEmin, kEmax, kRhoMax, kTmin, kTmax };
+  out.write(kMagic, sizeof(kMagic));
+  out.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+  out.write(reinterpret_cast<const char*>(ranges), sizeof(ranges));
+  out.write(reinterpret_cast<const char*>(fThickness), sizeof(fThickness));
+  out.write(reinterpret_cast<const char*>(&fExcluded), sizeof(fExcluded));
+
+  // the blocks of the entry bins never reached are skipped
+  std::vector<float> block(fBlockSize);
+  for (std::size_t input=0; input<fEntryWeight.size(); input++) {
+    out.write(reinterpret_cast<const char*>(&fEntryWeight[input]),
+              sizeof(G4double));
+    if (fEntryWeight[input] <= 0.) continue;
+    std::copy(fData.begin() + Block(input),
+              fData.begin() + Block(input) + fBlockSize, block.begin());
+    out.write(reinterpret_cast<const char*>(&block[0]),
+              fBlockSize*sizeof(float));
+  }
+  return out.good();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TransmissionKernel::Read(const G4String& fileName)
+{
+  std::ifstream in(fileName, std::ios::binary);
+  if (!in) {
+    G4cout << "\n--> warning from TransmissionKernel : cannot open "
+           << fileName << G4endl;
+    return false;
+  }
+  char     magic[8];
+  G4int    dims[6];
+  G4double ranges[5];
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char*>(dims), sizeof(dims));
+  in.read(reinterpret_cast<char*>(ranges), sizeof(ranges));
+  G4int    expDims[6]   = { TankWalls::kNbWalls, kNbE, kNbMu, kNbRho, kNbT,
+                             kNbDepth };
+  G4double expRanges[5] = { kEmin, kEmax, kRhoMax, kTmin, kTmax };
+  if (!in || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      std::memcmp(dims, expDims, sizeof(dims)) != 0 ||
+      std::memcmp(ranges, expRanges, sizeof(ranges)) != 0) {
+    G4cout << "\n--> warning from TransmissionKernel : " << fileName
+           << " is not a kernel file of this binning" << G4endl;
+    return false;
+  }
+  Clear();
+  in.read(reinterpret_cast<char*>(fThickness), sizeof(fThickness));
+  in.read(reinterpret_cast<char*>(&fExcluded), sizeof(fExcluded));
+
+  std::vector<float> block(fBlockSize);
+  for (std::size_t input=0; input<fEntryWeight.size() && in; input++) {
+    in.read(reinterpret_cast<char*>(&fEntryWeight[input]), sizeof(G4double));
+    if (fEntryWeight[input] <= 0.) continue;
+    in.read(reinterpret_cast<char*>(&block[0]), fBlockSize*sizeof(float));
+    std::copy(block.begin(), block.end(), fData.begin() + Block(input));
+  }
+  if (!in) {
+    G4cout << "\n--> warning from TransmissionKernel : " << fileName
+           << " is truncated" << G4endl;
+    Clear();
+    return false;
+  }
+  Prepare();
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,199 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TransmissionModel.cc
+/// \brief Implementation of the TransmissionModel class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "TransmissionModel.hh"
+#include "DetectorConstruction.hh"
+#include "EventAction.hh"
+#include "Run.hh"
+#include "TrackInformation.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Neutron.hh"
+#include "G4Gamma.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4EventManager.hh"
+#include "G4RunManager.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4RandomDirection.hh"
+
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // kernel and geometry walls of different thickness are not used
+  const G4double kThicknessTolerance = 1*mm;
+  // gamma of a capture on hydrogen; those on oxygen are some 3000 times
+  // fewer in water
+  const G4double kCaptureGamma = 2.2246*MeV;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TransmissionModel::TransmissionModel(const G4String& name, G4Region* envelope,
+                                     const DetectorConstruction* det)
+: G4VFastSimulationModel(name, envelope),
+  fDetector(det), fKernel(0), fRunID(-1)
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TransmissionModel::~TransmissionModel()
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TransmissionModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+  return &particle == G4Neutron::Neutron();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TransmissionModel::Initialize(const G4FastTrack& fastTrack)
+{
+  fKernel = fDetector->GetTankKernel();
+  if (!fKernel) return;
+  if (!fWalls.Set(fastTrack.GetEnvelopeLogicalVolume(),
+                  fDetector->GetTankKernelMargin())) {
+    G4cout << "\n--> warning from TransmissionModel : the tank and its"
+           << " chamber are not aligned boxes; model disabled" << G4endl;
+    fKernel = 0;
+    return;
+  }
+  for (G4int k=0; k<TankWalls::kNbKinds; k++) {
+    if (std::fabs(fWalls.Thickness(k) - fKernel->GetThickness(k))
+        > kThicknessTolerance) {
+      G4cout << "\n--> warning from TransmissionModel : kernels built for a "
+             << G4BestUnit(fKernel->GetThickness(k),"Length")
+             << " wall, the geometry has "
+             << G4BestUnit(fWalls.Thickness(k),"Length")
+             << "; model disabled" << G4endl;
+      fKernel = 0;
+      return;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TransmissionModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+  const G4Run* run = G4RunManager::GetRunManager()->GetCurrentRun();
+  if (run && run->GetRunID() != fRunID) {
+    fRunID = run->GetRunID();
+    Initialize(fastTrack);
+  }
+  if (!fKernel) return false;
+
+  // only a neutron that has just entered the water through a boundary
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  const G4Step* step = track->GetStep();
+  if (!step || step->GetPreStepPoint()->GetStepStatus() != fGeomBoundary ||
+      track->GetVolume()->GetLogicalVolume()
+        != fastTrack.GetEnvelopeLogicalVolume()) return false;
+
+  TankWalls::Crossing entry;
+  const G4ThreeVector& position = fastTrack.GetPrimaryTrackLocalPosition();
+  if (!fWalls.Entry(position, fastTrack.GetPrimaryTrackLocalDirection(),
+                    entry)) return false;
+
+  // entries closer to the edge of the wall than the largest displacement
+  // of their bin are left to detailed transport: the choice depends on the
+  // entry only, and the one outcome sampled always exits on the plain part
+  G4int input = fKernel->Input(entry.fWall, track->GetKineticEnergy(),
+                               entry.fMu);
+  if (!fWalls.Plain(entry.fFace, position, fKernel->MaxDisplacement(input)))
+    return false;
+
+  // the outcome is sampled here and applied by DoIt
+  if (!fKernel->Sample(input, fExit)) return false;
+  if (fExit.fOutcome == TransmissionKernel::kAbsorbed) {
+    return !fExit.fCapture ||
+           fWalls.InsideState(entry.fFace, position, fExit.fDepth, fExit.fRho,
+                              fPosition);
+  }
+  G4int exit = (fExit.fOutcome == TransmissionKernel::kReflected) ? 1 : 2;
+  return fWalls.ExitState(entry.fFace, position, exit, fExit.fRho, fExit.fMu,
+                          fPosition, fDirection);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TransmissionModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  G4double weight = track->GetWeight()*fExit.fWeight;
+  Run* run = static_cast<Run*>(
+             G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+
+  if (fExit.fOutcome == TransmissionKernel::kAbsorbed) {
+    run->AddVarianceReduction("tankAbsorbed", weight);
+    fastStep.KillPrimaryTrack();
+    if (!fExit.fCapture) return;
+
+    // a capture is scored as in detailed transport, at the energy of the
+    // killed neutron, and emits its gamma at the sampled site
+    EventAction* eventAction = static_cast<EventAction*>(
+      G4EventManager::GetEventManager()->GetUserEventAction());
+    eventAction->ScoreH1(3, fastStep.GetPrimaryTrackFinalKineticEnergy(),
+                         weight);
+    eventAction->AddTally(Run::kCaptureTank, weight, track);
+
+    fastStep.SetNumberOfSecondaryTracks(1);
+    G4DynamicParticle gamma(G4Gamma::Gamma(), G4RandomDirection(),
+                            kCaptureGamma);
+    G4Track* secondary = fastStep.CreateSecondaryTrack(gamma, fPosition,
+                           track->GetGlobalTime() + fExit.fDelay);
+    secondary->SetWeight(weight);
+    TrackInformation* info = new TrackInformation();
+    info->fTankCapture = true;
+    secondary->SetUserInformation(info);
+    return;
+  }
+
+  run->AddVarianceReduction(fExit.fOutcome == TransmissionKernel::kReflected ?
+                            "tankReflected" : "tankTransmitted", weight);
+  fastStep.ProposePrimaryTrackFinalPosition(fPosition);
+  fastStep.ProposePrimaryTrackFinalMomentumDirection(fDirection);
+  fastStep.ProposePrimaryTrackFinalKineticEnergy(fExit.fEkin);
+  fastStep.ProposePrimaryTrackFinalTime(track->GetGlobalTime() + fExit.fDelay);
+  fastStep.ProposePrimaryTrackFinalEventBiasingWeight(weight);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,350 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file UnionGridCrossSection.cc
+/// \brief Implementation of the UnionGridCrossSection class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "UnionGridCrossSection.hh"
+
+#include "G4CrossSectionDataStore.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Neutron.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4NistManager.hh"
+#include "G4ParticleHPManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include "G4AutoLock.hh"
+#include "G4Threading.hh"
+
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  G4Mutex unionGridMutex = G4MUTEX_INITIALIZER;
+
+  const G4int    coarsePerDecade = 50;
+  const G4int    minDepth  = 1;
+  const G4int    maxDepth  = 14;
+  const G4int    maxPoints = 400000;
+  const G4int    nbChecks  = 2000;
+}
+
+G4double UnionGridCrossSection::fTolerance = 1.e-3;
+std::map<G4String, UnionGridCrossSection::Tables*>
+  UnionGridCrossSection::fSharedTables;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+UnionGridCrossSection::UnionGridCrossSection(const G4String& name)
+: G4VCrossSectionDataSet(name),
+  fStore(0), fTables(0),
+  fLastTable(0), fLastLogE(0.), fLastBin(0)
+{
+  fStore = new G4CrossSectionDataStore();
+  fLogEmin = std::log(1.e-5*eV);
+  fLogEmax = std::log(20.*MeV);
+  SetMinKinEnergy(1.e-5*eV);
+  SetMaxKinEnergy(20.*MeV);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+UnionGridCrossSection::~UnionGridCrossSection()
+{
+  delete fStore;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void UnionGridCrossSection::AddDataSet(G4VCrossSectionDataSet* dataSet)
+{
+  fStore->AddDataSet(dataSet);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool UnionGridCrossSection::IsElementApplicable(const G4DynamicParticle*,
+                                                  G4int, const G4Material*)
+{
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void UnionGridCrossSection::BuildPhysicsTable(const G4ParticleDefinition& part)
+{
+  fStore->BuildPhysicsTable(part);
+  fLastTable = 0;
+
+  G4AutoLock lock(&unionGridMutex);
+  Tables*& tables = fSharedTables[GetName()];
+  if (!tables) tables = new Tables();
+  fTables = tables;
+
+  // materials created since the last build are appended by the master
+  const G4MaterialTable* materials = G4Material::GetMaterialTable();
+  if (!G4Threading::IsMasterThread() && !fTables->empty()) return;
+
+  // the HP data sets Doppler-broaden by sampling the thermal motion of the
+  // target, which draws random numbers and leaves noise of the order of a
+  // percent: the tables are built from the unbroadened data, so that they
+  // are reproducible and the refinement converges
+  G4ParticleHPManager* hpManager = G4ParticleHPManager::GetInstance();
+  G4bool neglectDoppler = hpManager->GetNeglectDoppler();
+  hpManager->SetNeglectDoppler(true);
+  for (std::size_t im=fTables->size(); im<materials->size(); im++) {
+    fTables->push_back(MaterialTable());
+    BuildMaterial((*materials)[im], fTables->back());
+    CheckAccuracy((*materials)[im], fTables->back());
+    if (fTables->back().fTruncated) {
+      hpManager->SetNeglectDoppler(neglectDoppler);
+      G4ExceptionDescription description;
+      description << GetName() << ": the union grid of "
+                  << (*materials)[im]->GetName() << " reached " << maxPoints
+                  << " points before the tolerance " << fTolerance
+                  << " was met; raise /testhadr/phys/unionGridTolerance";
+      G4Exception("UnionGridCrossSection::BuildPhysicsTable()", "Monitor002",
+                  FatalException, description);
+      return;
+    }
+  }
+  hpManager->SetNeglectDoppler(neglectDoppler);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void UnionGridCrossSection::ComputeElements(const G4Material* material,
+                                            G4double logE,
+                                            std::vector<G4double>& xs)
+{
+  G4DynamicParticle neutron(G4Neutron::Neutron(), G4ThreeVector(0,0,1),
+                            std::exp(logE));
+  const G4ElementVector* elements = material->GetElementVector();
+  xs.resize(elements->size());
+  for (std::size_t k=0; k<elements->size(); k++) {
+    xs[k] = fStore->GetCrossSection(&neutron, (*elements)[k], material);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void UnionGridCrossSection::BuildMaterial(const G4Material* material,
+                                          MaterialTable& table)
+{
+  // cross sections of all the elements at each point of fLogE
+  std::vector< std::vector<G4double> > points;
+  table.fLogE.clear();
+  table.fTruncated = false;
+
+  G4int nCoarse =
+    G4int(coarsePerDecade*(fLogEmax - fLogEmin)/std::log(10.)) + 1;
+  G4double delta = (fLogEmax - fLogEmin)/nCoarse;
+
+  std::vector<G4double> xs0, xs1;
+  ComputeElements(material, fLogEmin, xs0);
+  table.fLogE.push_back(fLogEmin);
+  points.push_back(xs0);
+  for (G4int i=1; i<=nCoarse; i++) {
+    G4double logE0 = fLogEmin + (i-1)*delta;
+    G4double logE1 = (i == nCoarse) ? fLogEmax : fLogEmin + i*delta;
+    ComputeElements(material, logE1, xs1);
+    Refine(material, table, points, logE0, xs0, logE1, xs1, 0);
+    table.fLogE.push_back(logE1);
+    points.push_back(xs1);
+    xs0 = xs1;
+  }
+
+  // element-major storage
+  std::size_t n = table.fLogE.size();
+  std::size_t nElm = material->GetNumberOfElements();
+  table.fXS.assign(nElm*n, 0.);
+  for (std::size_t i=0; i<n; i++) {
+    for (std::size_t k=0; k<nElm; k++) table.fXS[k*n + i] = points[i][k];
+  }
+  table.fZ.resize(nElm);
+  for (std::size_t k=0; k<nElm; k++) {
+    table.fZ[k] = G4lrint((*material->GetElementVector())[k]->GetZ());
+  }
+
+  // hash bins uniform in log E, about one grid point per bin
+  G4int nHash = n;
+  table.fHashInvDelta = nHash/(fLogEmax - fLogEmin);
+  table.fHash.resize(nHash);
+  std::size_t i = 0;
+  for (G4int h=0; h<nHash; h++) {
+    G4double edge = fLogEmin + h/table.fHashInvDelta;
+    while (i+2 < n && table.fLogE[i+1] <= edge) i++;
+    table.fHash[h] = i;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void UnionGridCrossSection::Refine(const G4Material* material,
+                                   MaterialTable& table,
+                                   std::vector< std::vector<G4double> >& points,
+                                   G4double logE0,
+                                   const std::vector<G4double>& xs0,
+                                   G4double logE1,
+                                   const std::vector<G4double>& xs1,
+                                   G4int depth)
+{
+  if (depth >= maxDepth) return;
+  if (G4int(table.fLogE.size()) >= maxPoints) {
+    table.fTruncated = true;
+    return;
+  }
+
+  // test the midpoint against linear interpolation, for all elements
+  G4double logEm = 0.5*(logE0 + logE1);
+  std::vector<G4double> xsm;
+  ComputeElements(material, logEm, xsm);
+  G4bool converged = (depth >= minDepth);
+  for (std::size_t k=0; k<xsm.size() && converged; k++) {
+    G4double interp = 0.5*(xs0[k] + xs1[k]);
+    G4double scale = std::max(xsm[k], 1.e-6*barn);
+    if (std::fabs(interp - xsm[k]) > fTolerance*scale) converged = false;
+  }
+  if (converged) return;
+
+  Refine(material, table, points, logE0, xs0, logEm, xsm, depth+1);
+  table.fLogE.push_back(logEm);
+  points.push_back(xsm);
+  Refine(material, table, points, logEm, xsm, logE1, xs1, depth+1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double UnionGridCrossSection::Interpolate(const MaterialTable& table,
+                                            G4int k, G4double logE)
+{
+  // one hashed search per material and energy, shared by its elements
+  if (&table != fLastTable || logE != fLastLogE) {
+    G4int h = G4int((logE - fLogEmin)*table.fHashInvDelta);
+    if (h >= G4int(table.fHash.size())) h = table.fHash.size() - 1;
+    // binary search among the grid points of the hash bin, which can be
+    // many where the refinement followed the resonances
+    G4int last = table.fLogE.size() - 2;
+    G4int lo = table.fHash[h];
+    G4int hi = (h+1 < G4int(table.fHash.size())) ? table.fHash[h+1] : last;
+    const G4double* logGrid = &table.fLogE[0];
+    G4int i = std::upper_bound(logGrid + lo + 1, logGrid + hi + 1, logE)
+              - logGrid - 1;
+    fLastTable = &table;
+    fLastLogE = logE;
+    fLastBin = i;
+  }
+  G4int n = table.fLogE.size();
+  G4int i = fLastBin;
+  const G4double* xs = &table.fXS[k*n];
+  G4double f = (logE - table.fLogE[i])/(table.fLogE[i+1] - table.fLogE[i]);
+  return xs[i] + f*(xs[i+1] - xs[i]);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double UnionGridCrossSection::GetElementCrossSection(
+                                  const G4DynamicParticle* particle, G4int Z,
+                                  const G4Material* material)
+{
+  G4double ekin = particle->GetKineticEnergy();
+  if (material && ekin >= 1.e-5*eV && ekin < 20.*MeV &&
+      material->GetIndex() < fTables->size()) {
+    const MaterialTable& table = (*fTables)[material->GetIndex()];
+    for (std::size_t k=0; k<table.fZ.size(); k++) {
+      if (table.fZ[k] == Z) return Interpolate(table, k, std::log(ekin));
+    }
+  }
+
+  // not tabulated: the wrapped data sets
+  const G4Element* element = 0;
+  if (material) {
+    const G4ElementVector* elements = material->GetElementVector();
+    for (std::size_t k=0; k<elements->size(); k++) {
+      if (G4lrint((*elements)[k]->GetZ()) == Z) element = (*elements)[k];
+    }
+  }
+  if (!element) element = G4NistManager::Instance()->FindOrBuildElement(Z);
+  return fStore->GetCrossSection(particle, element, material);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void UnionGridCrossSection::CheckAccuracy(const G4Material* material,
+                                          const MaterialTable& table)
+{
+  // macroscopic cross section of the table against the wrapped data sets,
+  // unbroadened as the table, at energies spread over the whole range
+  // (a fixed sequence, not random)
+  const G4double* nbAtoms = material->GetVecNbOfAtomsPerVolume();
+  G4double maxErr = 0., sumErr2 = 0., eMax = 0.;
+  G4int nChecked = 0;
+  std::vector<G4double> xs;
+  for (G4int j=0; j<nbChecks; j++) {
+    G4double u = std::fmod((j + 0.5)*0.6180339887, 1.);
+    G4double logE = fLogEmin + u*(fLogEmax - fLogEmin);
+    ComputeElements(material, logE, xs);
+    G4double stock = 0., tabulated = 0.;
+    for (std::size_t k=0; k<xs.size(); k++) {
+      stock     += nbAtoms[k]*xs[k];
+      tabulated += nbAtoms[k]*Interpolate(table, k, logE);
+    }
+    if (stock <= 0.) continue;
+    G4double err = std::fabs(tabulated - stock)/stock;
+    if (err > maxErr) { maxErr = err; eMax = std::exp(logE); }
+    sumErr2 += err*err;
+    nChecked++;
+  }
+  fLastTable = 0;
+
+  G4cout << " " << GetName() << ": " << std::setw(16) << material->GetName()
+         << std::setw(8) << table.fLogE.size() << " points"
+         << (table.fTruncated ? " (maximum reached)" : "")
+         << "   rms error " << std::setw(10)
+         << (nChecked ? 100*std::sqrt(sumErr2/nChecked) : 0.) << " %"
+         << "   max error " << std::setw(10) << 100*maxErr << " % at "
+         << G4BestUnit(eMax, "Energy") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void UnionGridCrossSection::CrossSectionDescription(std::ostream& out) const
+{
+  out << GetName() << ": stock data sets, without Doppler broadening,"
+      << " tabulated per material on a union log-energy grid (relative"
+      << " tolerance " << fTolerance << ")\n";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,368 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file WoodcockModel.cc
+/// \brief Implementation of the WoodcockModel class
+//
+//
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "WoodcockModel.hh"
+#include "Run.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Gamma.hh"
+#include "G4ProcessManager.hh"
+#include "G4ProcessVector.hh"
+#include "G4VEmProcess.hh"
+#include "G4HadronicProcess.hh"
+#include "G4HadronicProcessStore.hh"
+#include "G4VParticleChange.hh"
+#include "G4ParticleChange.hh"
+#include "G4ParticleChangeForGamma.hh"
+#include "G4Navigator.hh"
+#include "G4TransportationManager.hh"
+#include "G4TouchableHistory.hh"
+#include "G4Region.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4MaterialCutsCouple.hh"
+#include "G4RunManager.hh"
+#include "G4Run.hh"
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4DynamicParticle.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // log grid of the majorant table; gammas outside it are tracked normally
+  const G4double kEmin = 1*keV;
+  const G4double kEmax = 100*MeV;
+  const G4int    kBinsPerDecade = 100;
+  // safety factor on the tabulated maximum
+  const G4double kMargin = 1.05;
+  // a gamma leaving the region is stopped this far before its boundary,
+  // so that the crossing itself is made (and scored) by transportation
+  const G4double kPushBack = 1*nm;
+
+  G4int NbBins()
+  {
+    return G4int(std::log10(kEmax/kEmin)*kBinsPerDecade + 0.5);
+  }
+
+  G4double Energy(G4int i)
+  {
+    return kEmin*std::pow(10., G4double(i)/kBinsPerDecade);
+  }
+
+  void CollectCouples(const G4LogicalVolume* lv,
+                      std::set<const G4MaterialCutsCouple*>& couples)
+  {
+    if (lv->GetMaterialCutsCouple()) couples.insert(lv->GetMaterialCutsCouple());
+    for (G4int i=0; i<lv->GetNoDaughters(); i++)
+      CollectCouples(lv->GetDaughter(i)->GetLogicalVolume(), couples);
+  }
+
+  struct Secondary {
+    G4DynamicParticle fParticle;
+    G4ThreeVector     fPosition;
+    G4double          fTime;
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WoodcockModel::WoodcockModel(const G4String& name, G4Region* envelope)
+: G4VFastSimulationModel(name, envelope),
+  fRegion(envelope), fNavigator(0), fRunID(-1), fViolations(0)
+{
+  fNavigator = new G4Navigator();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WoodcockModel::~WoodcockModel()
+{
+  delete fNavigator;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool WoodcockModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+  return &particle == G4Gamma::Gamma();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool WoodcockModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+  const G4Run* run = G4RunManager::GetRunManager()->GetCurrentRun();
+  if (run && run->GetRunID() != fRunID) {
+    fRunID = run->GetRunID();
+    Initialize();
+  }
+  G4double ekin = fastTrack.GetPrimaryTrack()->GetKineticEnergy();
+  if (fProcesses.empty() || ekin < kEmin || ekin >= kEmax) return false;
+
+  // not on the way out, which is left to transportation
+  G4double toExit = fastTrack.GetEnvelopeSolid()->DistanceToOut(
+                      fastTrack.GetPrimaryTrackLocalPosition(),
+                      fastTrack.GetPrimaryTrackLocalDirection());
+  return toExit > 2*kPushBack;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WoodcockModel::Initialize()
+{
+  fViolations = 0;
+
+  // discrete gamma processes; the general gamma process of some presets
+  // hides its components and is not supported
+  fProcesses.clear();
+  G4ProcessVector* list = G4Gamma::Gamma()->GetProcessManager()->GetProcessList();
+  for (G4int i=0; i<list->size(); i++) {
+    G4VProcess* process = (*list)[i];
+    if (process->GetProcessName() == "GammaGeneralProc") {
+      G4cout << "\n--> warning from WoodcockModel : general gamma process "
+             << "in use; Woodcock tracking disabled" << G4endl;
+      fProcesses.clear();
+      break;
+    }
+    if (dynamic_cast<G4VEmProcess*>(process) ||
+        dynamic_cast<G4HadronicProcess*>(process))
+      fProcesses.push_back(process);
+  }
+
+  // majorant over every material of the region; the maximum over a bin is
+  // taken at its edges, the margin covering the curvature in between
+  std::set<const G4MaterialCutsCouple*> couples;
+  std::vector<G4LogicalVolume*>::iterator it = fRegion->GetRootLogicalVolumeIterator();
+  for (std::size_t i=0; i<fRegion->GetNumberOfRootVolumes(); i++, ++it)
+    CollectCouples(*it, couples);
+
+  G4int nbBins = NbBins();
+  std::vector<G4double> edges(nbBins+1, 0.);
+  for (G4int i=0; i<=nbBins; i++) {
+    std::set<const G4MaterialCutsCouple*>::const_iterator ic;
+    for (ic = couples.begin(); ic != couples.end(); ++ic)
+      edges[i] = std::max(edges[i], CrossSection(Energy(i), *ic, 0));
+  }
+  fMajorant.resize(nbBins);
+  for (G4int i=0; i<nbBins; i++)
+    fMajorant[i] = kMargin*std::max(edges[i], edges[i+1]);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double WoodcockModel::Majorant(G4double ekin) const
+{
+  G4int bin = G4int(std::log10(ekin/kEmin)*kBinsPerDecade);
+  bin = std::min(std::max(bin, 0), G4int(fMajorant.size())-1);
+  return fMajorant[bin];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double WoodcockModel::CrossSection(G4double ekin,
+                                     const G4MaterialCutsCouple* couple,
+                                     std::vector<G4double>* partial) const
+{
+  G4HadronicProcessStore* store = G4HadronicProcessStore::Instance();
+  G4double sigma = 0.;
+  for (std::size_t i=0; i<fProcesses.size(); i++) {
+    G4double s = 0.;
+    G4VEmProcess* em = dynamic_cast<G4VEmProcess*>(fProcesses[i]);
+    if (em) {
+      s = em->CrossSectionPerVolume(ekin, couple);
+    } else {
+      s = store->GetCrossSectionPerVolume(G4Gamma::Gamma(), ekin,
+                                          fProcesses[i],
+                                          couple->GetMaterial());
+    }
+    s = std::max(s, 0.);
+    if (partial) (*partial)[i] = s;
+    sigma += s;
+  }
+  return sigma;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const G4MaterialCutsCouple*
+WoodcockModel::Locate(const G4ThreeVector& position,
+                      const G4ThreeVector& direction, G4bool relative)
+{
+  G4VPhysicalVolume* volume =
+    fNavigator->LocateGlobalPointAndSetup(position, &direction, relative);
+  return volume ? volume->GetLogicalVolume()->GetMaterialCutsCouple() : 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WoodcockModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+  G4VPhysicalVolume* world = G4TransportationManager::GetTransportationManager()
+                             ->GetNavigatorForTracking()->GetWorldVolume();
+  if (fNavigator->GetWorldVolume() != world) fNavigator->SetWorldVolume(world);
+
+  const G4Track* primary = fastTrack.GetPrimaryTrack();
+  G4ThreeVector position     = primary->GetPosition();
+  G4ThreeVector direction    = primary->GetMomentumDirection();
+  G4ThreeVector polarization = primary->GetPolarization();
+  G4double ekin   = primary->GetKineticEnergy();
+  G4double time   = primary->GetGlobalTime();
+  G4double weight = primary->GetWeight();
+  G4double path = 0., edep = 0.;
+  G4bool   alive = true, relative = false;
+  G4int    tentative = 0, real = 0, violations = 0;
+
+  const G4AffineTransform* toLocal = fastTrack.GetAffineTransformation();
+  const G4VSolid* envelope = fastTrack.GetEnvelopeSolid();
+  std::vector<G4double> partial(fProcesses.size(), 0.);
+  std::vector<Secondary> secondaries;
+
+  while (alive && ekin >= kEmin && ekin < kEmax) {
+    G4double toExit = envelope->DistanceToOut(toLocal->TransformPoint(position),
+                                              toLocal->TransformAxis(direction));
+    G4double sigmaMax = Majorant(ekin);
+    G4double flight = (sigmaMax > 0.) ? -std::log(1. - G4UniformRand())/sigmaMax
+                                      : DBL_MAX;
+    G4bool leaving = (flight >= toExit);
+    if (leaving) flight = std::max(toExit - kPushBack, 0.5*toExit);
+    position += flight*direction;
+    path     += flight;
+    time     += flight/c_light;
+    if (leaving) break;
+
+    // tentative collision: real with probability sigma/sigmaMax
+    tentative++;
+    const G4MaterialCutsCouple* couple = Locate(position, direction, relative);
+    relative = true;
+    if (!couple) break;
+    G4double sigma = CrossSection(ekin, couple, &partial);
+    if (sigma > sigmaMax) {
+      violations++;
+      if (fViolations++ == 0) {
+        G4cout << "\n--> warning from WoodcockModel : sigma exceeds the"
+               << " majorant by " << sigma/sigmaMax - 1. << " at "
+               << G4BestUnit(ekin,"Energy") << " in "
+               << couple->GetMaterial()->GetName() << G4endl;
+      }
+    }
+    if (G4UniformRand()*sigmaMax >= sigma) continue;
+    real++;
+
+    // real collision: the process chosen by its partial cross section acts
+    // on a track set at the collision point
+    G4double x = G4UniformRand()*sigma;
+    std::size_t k = 0;
+    while (k+1 < fProcesses.size() && x >= partial[k]) x -= partial[k++];
+    G4VProcess* process = fProcesses[k];
+
+    fTouchable = fNavigator->CreateTouchableHistory();
+    G4Track track(new G4DynamicParticle(G4Gamma::Gamma(), direction, ekin),
+                  time, position);
+    track.SetPolarization(polarization);
+    track.SetWeight(weight);
+    track.SetTouchableHandle(fTouchable);
+    track.SetNextTouchableHandle(fTouchable);
+    track.SetTrackID(primary->GetTrackID());
+    track.SetParentID(primary->GetParentID());
+    G4Step step;
+    step.InitializeStep(&track);
+    track.SetStep(&step);
+
+    G4ForceCondition condition;
+    process->PostStepGetPhysicalInteractionLength(track, 0., &condition);
+    G4VParticleChange* change = process->PostStepDoIt(track, step);
+
+    G4ParticleChangeForGamma* gammaChange =
+      dynamic_cast<G4ParticleChangeForGamma*>(change);
+    G4ParticleChange* hadChange = dynamic_cast<G4ParticleChange*>(change);
+    if (gammaChange) {
+      ekin         = gammaChange->GetProposedKineticEnergy();
+      direction    = gammaChange->GetProposedMomentumDirection();
+      polarization = gammaChange->GetProposedPolarization();
+    } else if (hadChange) {
+      ekin         = hadChange->GetEnergy();
+      direction    = *hadChange->GetMomentumDirection();
+      polarization = *hadChange->GetPolarization();
+    }
+    edep += change->GetLocalEnergyDeposit();
+    alive = (change->GetTrackStatus() == fAlive ||
+             change->GetTrackStatus() == fStopButAlive) && ekin > 0.;
+
+    for (G4int i=0; i<change->GetNumberOfSecondaries(); i++) {
+      G4Track* secondary = change->GetSecondary(i);
+      Secondary s = { *secondary->GetDynamicParticle(),
+                      secondary->GetPosition(), secondary->GetGlobalTime() };
+      secondaries.push_back(s);
+      delete secondary;
+    }
+    change->Clear();
+  }
+
+  fastStep.SetNumberOfSecondaryTracks(secondaries.size());
+  for (std::size_t i=0; i<secondaries.size(); i++) {
+    G4Track* track = fastStep.CreateSecondaryTrack(secondaries[i].fParticle,
+                                                   secondaries[i].fPosition,
+                                                   secondaries[i].fTime,
+                                                   false);
+    if (track) track->SetWeight(weight);
+  }
+
+  Run* run = static_cast<Run*>(
+             G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+  run->AddWoodcockFlight(fRegion->GetName(), tentative, real, violations);
+
+  fastStep.ProposePrimaryTrackPathLength(path);
+  fastStep.ProposeTotalEnergyDeposited(edep);
+  if (!alive) {
+    fastStep.KillPrimaryTrack();
+    return;
+  }
+  fastStep.ProposePrimaryTrackFinalPosition(position, false);
+  fastStep.ProposePrimaryTrackFinalTime(time);
+  fastStep.ProposePrimaryTrackFinalKineticEnergy(ekin);
+  fastStep.ProposePrimaryTrackFinalMomentumDirection(direction, false);
+  fastStep.ProposePrimaryTrackFinalPolarization(polarization, false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,56 @@
+#!/bin/bash
+#
+# Shared helpers of the comparison scripts of Monitor (presets.sh,
+# biasing.sh, dxtran.sh, woodcock.sh, transmission.sh, condensed.sh, twopass.sh,
+# navigation.sh ...), to be sourced :
+#   . "$(dirname "$0")/tallies.sh"
+#
+# tally   <log> <tally>          mean, relative error [%] and FOM of a tally
+#                                from the "Tally statistics" of a run summary
+# rate    <log>                  events/s of a run
+# header  <ref> <label> [col]    column titles of a comparison
+# compare <ref log> <log> <tally> [fom]
+#                                one comparison line :
+#   ratio = mean/mean_ref (FOM/FOM_ref with "fom")
+#   z     = (mean - mean_ref)/sqrt(sigma^2 + sigma_ref^2)
+#   a |z| above 3 is flagged; a tally n/a in either run is shown as such
+# compare_rate <ref log> <log>   events/s of both runs and their ratio
+
+TALLIES="nTank gTank nSlab gSlab probe capDetector capTank capPoly inelDetector"
+
+tally() {
+  awk -v t=$2 '/Tally statistics/ {on=1; next}
+               on && $1==t {print $2, $3, $5; exit}' $1
+}
+
+rate() {
+  grep "Timing: events/s" $1 | awk '{print $3}'
+}
+
+header() {
+  printf "%13s %12s %7s %12s %7s %10s %7s\n" \
+    tally "$1" "R[%]" "$2" "R[%]" "${3:-ratio}" z
+}
+
+compare() {
+  local m0 r0 f0 m1 r1 f1
+  read m0 r0 f0 <<< "$(tally $1 $3)"
+  read m1 r1 f1 <<< "$(tally $2 $3)"
+  awk -v t=$3 -v m0=$m0 -v r0=$r0 -v f0=$f0 -v m1=$m1 -v r1=$r1 -v f1=$f1 \
+      -v fom=${4:-} 'BEGIN{
+    if (m0 == "n/a" || m1 == "n/a") {
+      printf "%13s %12s %7s %12s %7s %10s %7s\n", t, m0, (m0 == "n/a") ? "" : r0,
+             m1, (m1 == "n/a") ? "" : r1, "n/a", "n/a"
+      exit}
+    s0 = m0*r0/100; s1 = m1*r1/100; s = sqrt(s0*s0 + s1*s1);
+    if (fom != "") ratio = (f0+0 > 0 && f1+0 > 0) ? sprintf("%.2f", f1/f0) : "n/a";
+    else           ratio = (m0 != 0) ? sprintf("%.4f", m1/m0) : "n/a";
+    z = (s > 0) ? sprintf("%.2f", (m1-m0)/s) : "n/a";
+    flag = (z != "n/a" && (z > 3 || z < -3)) ? "  <--" : "";
+    printf "%13s %12s %7s %12s %7s %10s %7s%s\n", t, m0, r0, m1, r1, ratio, z, flag}'
+}
+
+compare_rate() {
+  awk -v a=$(rate $1) -v b=$(rate $2) 'BEGIN{
+    printf "%13s %12s %7s %12s %7s %10.3f\n", "events/s", a, "", b, "", b/a}'
+}
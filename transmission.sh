@@ -0,0 +1,70 @@
+#!/bin/bash
+#
+# Accuracy and speed of the tank-wall transmission kernels of Monitor.
+#
+# 1. records the kernels in a detailed run of the presets.mac workload
+#    (kernel_logs/tank.kernel),
+# 2. runs the workload again with detailed transport (other seeds),
+# 3. runs it with the neutrons sampled through the walls from the kernels,
+# then compares every tally of the run summary and the event rate :
+#   z = (mean - mean_detailed)/sqrt(sigma^2 + sigma_detailed^2)
+# A |z| above 3 flags a tally that the kernels change significantly. Wall
+# captures emit the 2.2 MeV gamma of hydrogen at a sampled site, so the
+# gamma tallies are compared too.
+#
+# usage: ./transmission.sh [events] [threads] [build events] [preset]
+#   events       default: 200000
+#   threads      default: number of cores
+#   build events default: 5 x events
+#   preset       default: lean
+#
+# The raw logs and the kernel file are kept in kernel_logs/ .
+
+EXE=${MONITOR_EXE:-./Monitor}
+NEVT=${1:-200000}
+NTHR=${2:-$(nproc)}
+NBUILD=${3:-$((5*NEVT))}
+PRESET=${4:-lean}
+LOGDIR=kernel_logs
+KERNEL=$LOGDIR/tank.kernel
+. "$(dirname "$0")/tallies.sh"
+mkdir -p $LOGDIR
+
+run() {
+  # $1 build|detailed|kernel
+  local mac=$LOGDIR/$1.mac log=$LOGDIR/$1.log
+  {
+    echo "/run/numberOfThreads $NTHR"
+    echo "/testhadr/phys/fastSimulation neutron"
+    echo "/control/execute presets.mac"
+    case $1 in
+      build)    echo "/testhadr/tank/buildKernel $KERNEL"
+                echo "/random/setSeeds 1234 5678"
+                echo "/run/beamOn $NBUILD" ;;
+      detailed) echo "/random/setSeeds 8765 4321"
+                echo "/run/beamOn $NEVT" ;;
+      kernel)   echo "/testhadr/tank/loadKernel $KERNEL"
+                echo "/random/setSeeds 2468 1357"
+                echo "/run/beamOn $NEVT" ;;
+    esac
+  } > $mac
+  $EXE --physics $PRESET $mac > $log 2>&1
+}
+
+run build
+if [ ! -s $KERNEL ]; then echo "kernel build failed, see $LOGDIR/build.log"; exit 1; fi
+grep "Tank transmission kernels written" $LOGDIR/build.log
+run detailed
+run kernel
+
+ref=$LOGDIR/detailed.log
+log=$LOGDIR/kernel.log
+for l in $ref $log; do
+  if ! grep -q "Tally statistics" $l; then echo "run failed, see $l"; exit 1; fi
+done
+
+printf "\nkernels versus detailed transport (%s preset, %s events, %s threads)\n" \
+  $PRESET $NEVT $NTHR
+header detailed kernel
+for t in $TALLIES; do compare $ref $log $t; done
+compare_rate $ref $log
@@ -0,0 +1,75 @@
+#!/bin/bash
+#
+# Two-pass simulation of Monitor against a single pass.
+#
+# 1. runs the presets.mac workload in a single pass (neutrons and gammas),
+# 2. runs it as pass one: neutrons only, the secondary gammas banked to
+#    twopass_logs/gammas.bank,
+# 3. runs pass two: the banked gammas, one event per history of pass one,
+#    optionally split and with another preset,
+# then compares every tally of the run summary (neutron tallies from pass
+# one, gamma tallies from pass two) and the event rates :
+#   z = (mean - mean_single)/sqrt(sigma^2 + sigma_single^2)
+# A |z| above 3 flags a tally that the two passes change significantly.
+#
+# usage: ./twopass.sh [events] [threads] [split] [preset] [gamma preset]
+#   events       default: 200000
+#   threads      default: number of cores
+#   split        default: 1
+#   preset       default: lean
+#   gamma preset default: same as preset
+#
+# The raw logs and the bank are kept in twopass_logs/ .
+
+EXE=${MONITOR_EXE:-./Monitor}
+NEVT=${1:-200000}
+NTHR=${2:-$(nproc)}
+SPLIT=${3:-1}
+PRESET=${4:-lean}
+GPRESET=${5:-$PRESET}
+LOGDIR=twopass_logs
+BANK=$LOGDIR/gammas.bank
+NTALLIES="nTank nSlab probe capDetector capTank capPoly inelDetector"
+GTALLIES="gTank gSlab"
+. "$(dirname "$0")/tallies.sh"
+mkdir -p $LOGDIR
+
+run() {
+  # $1 single|pass1|pass2
+  local mac=$LOGDIR/$1.mac log=$LOGDIR/$1.log preset=$PRESET
+  {
+    echo "/run/numberOfThreads $NTHR"
+    echo "/control/execute presets.mac"
+    case $1 in
+      single) echo "/random/setSeeds 8765 4321" ;;
+      pass1)  echo "/testhadr/twoPass/write $BANK"
+              echo "/random/setSeeds 2468 1357" ;;
+      pass2)  echo "/testhadr/twoPass/read $BANK"
+              echo "/testhadr/twoPass/split $SPLIT"
+              echo "/random/setSeeds 1357 2468" ;;
+    esac
+    echo "/run/beamOn $NEVT"
+  } > $mac
+  [ $1 = pass2 ] && preset=$GPRESET
+  $EXE --physics $preset $mac > $log 2>&1
+}
+
+run single
+run pass1
+if [ ! -s $BANK ]; then echo "pass one failed, see $LOGDIR/pass1.log"; exit 1; fi
+grep "Gamma bank written" $LOGDIR/pass1.log
+run pass2
+
+ref=$LOGDIR/single.log
+for l in $ref $LOGDIR/pass1.log $LOGDIR/pass2.log; do
+  if ! grep -q "Tally statistics" $l; then echo "run failed, see $l"; exit 1; fi
+done
+
+printf "\ntwo passes versus single pass (%s/%s presets, %s events, %s threads, split %s)\n" \
+  $PRESET $GPRESET $NEVT $NTHR $SPLIT
+header single two-pass
+for t in $NTALLIES; do compare $ref $LOGDIR/pass1.log $t; done
+for t in $GTALLIES; do compare $ref $LOGDIR/pass2.log $t; done
+for l in single pass1 pass2; do
+  printf "%13s %12s\n" "events/s $l" $(rate $LOGDIR/$l.log)
+done
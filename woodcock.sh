@@ -0,0 +1,64 @@
+#!/bin/bash
+#
+# Validation and timing of the Woodcock tracking of gammas of Monitor.
+#
+# Runs the presets.mac workload once with normal tracking and once with
+# the commands of a macro (default woodcock.mac), then compares every tally
+# of the run summary and the event rate :
+#   z = (mean - mean_normal)/sqrt(sigma^2 + sigma_normal^2)
+# A |z| above 3 flags a tally that Woodcock tracking changes significantly.
+# The gamma tank-exit ntuples (gFlux_tank) of both runs are then compared
+# with WoodcockCompare.C when ROOT is available.
+#
+# usage: ./woodcock.sh [events] [threads] [macro] [preset]
+#   events  default: 200000
+#   threads default: number of cores
+#   macro   default: woodcock.mac
+#   preset  default: reference (the general gamma process of "fast" is
+#           not supported)
+#
+# The raw logs and ntuple files are kept in woodcock_logs/ .
+
+EXE=${MONITOR_EXE:-./Monitor}
+NEVT=${1:-200000}
+NTHR=${2:-$(nproc)}
+WOOD=${3:-woodcock.mac}
+PRESET=${4:-reference}
+LOGDIR=woodcock_logs
+. "$(dirname "$0")/tallies.sh"
+mkdir -p $LOGDIR
+
+run() {
+  # $1 normal|woodcock
+  local mac=$LOGDIR/$1.mac log=$LOGDIR/$1.log
+  {
+    echo "/run/numberOfThreads $NTHR"
+    [ $1 = woodcock ] && echo "/control/execute $WOOD"
+    echo "/control/execute presets.mac"
+    echo "/testhadr/run/mergeNtuples true"
+    echo "/analysis/setFileName $LOGDIR/$1"
+    echo "/run/beamOn $NEVT"
+  } > $mac
+  $EXE --physics $PRESET $mac > $log 2>&1
+}
+
+run normal
+run woodcock
+
+ref=$LOGDIR/normal.log
+log=$LOGDIR/woodcock.log
+for l in $ref $log; do
+  if ! grep -q "Tally statistics" $l; then echo "run failed, see $l"; exit 1; fi
+done
+
+printf "\n%s versus normal tracking (%s preset, %s events, %s threads)\n" \
+  $WOOD $PRESET $NEVT $NTHR
+header normal woodcock
+for t in $TALLIES; do compare $ref $log $t; done
+compare_rate $ref $log
+awk '/Woodcock tracking of gammas:/ {on=1} on && /^ *$/ {exit} on' $log
+grep -q "majorant violations" $log && echo "WARNING: majorant violations, see $log"
+
+if command -v root > /dev/null; then
+  root -l -b -q "WoodcockCompare.C(\"$LOGDIR/normal.root\",\"$LOGDIR/woodcock.root\")"
+fi